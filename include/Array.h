@@ -288,7 +288,7 @@ namespace kong
         template <typename T>
         s32 Array<T>::BinarySearch(const T& element) const
         {
-            return LinearSearch(element, 0, used - 1);
+            return LinearSearch(element, 0, size_ - 1);
         }
 
         template <typename T>
@@ -0,0 +1,61 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CBLOCKCOMPRESSION_H_
+#define _CBLOCKCOMPRESSION_H_
+
+#include "IImage.h"
+
+namespace kong
+{
+    namespace core
+    {
+        class CThreadPool;
+    } // end namespace core
+
+    namespace video
+    {
+        //! Decodes the block compressed formats BC1 to BC7, encodes BC1, BC3, BC4, BC5 and BC7.
+        /** Drivers upload compressed images as they are. Decoding is the fallback
+        for drivers which do not support a format, and for the software driver. BC4
+        turns into gray, BC5 into red and green with blue 0, BC6H is clamped to
+        0..1, like the GPU would sample them.
+        The encoder fits the endpoints of every block to the principal axis of its
+        texels and refines them with a least squares fit. BC7 only uses the single
+        subset modes 5 and 6. */
+        class CBlockCompression
+        {
+        public:
+            //! Compresses an ECF_A8R8G8B8 image and a full mip chain filtered from it
+            /** \param format ECF_BC1, ECF_BC3, ECF_BC4, ECF_BC5 or ECF_BC7. BC4 keeps red, BC5 red and green.
+            \param srgb True if the colors are stored in sRGB, false for data like normals.
+            \param thread_pool Splits the rows of blocks between its threads, 0 to compress on the calling thread.
+            \return The new image with its mip maps, or 0 if the image or the format is not supported. */
+            static IImage* Compress(IImage* image, ECOLOR_FORMAT format, bool srgb, core::CThreadPool* thread_pool);
+
+            //! Compresses 16 A8R8G8B8 texels, row by row, into a block
+            static void CompressBlock(ECOLOR_FORMAT format, const u32 texels[16], u8* block);
+
+            //! Returns the compressed format which keeps the channels an ECF_A8R8G8B8 image uses
+            /** Opaque gray images get BC4, other opaque images BC1, images with alpha BC7,
+            or BC3 if allow_bc7 is false. */
+            static ECOLOR_FORMAT ChooseFormat(IImage* image, bool allow_bc7);
+
+            //! Decompresses level 0 of an image into a new ECF_A8R8G8B8 image
+            /** \return The new image, or 0 if the image is not compressed. */
+            static IImage* Decompress(IImage* image);
+
+            //! Decompresses a level into texels
+            /** \param blocks The blocks of the level, row by row.
+            \param size Size of the level in texels.
+            \param target A8R8G8B8 texels of the size of the level.
+            \param target_pitch Distance of two rows of the target in texels. */
+            static void Decompress(ECOLOR_FORMAT format, const void* blocks, const core::Dimension2d<u32>& size, u32* target, u32 target_pitch);
+
+            //! Decompresses a 4x4 block into 16 A8R8G8B8 texels, row by row
+            static void DecompressBlock(ECOLOR_FORMAT format, const u8* block, u32 texels[16]);
+        };
+    } // end namespace video
+} // end namespace kong
+
+#endif
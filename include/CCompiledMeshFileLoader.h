@@ -0,0 +1,58 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CCOMPILEDMESHFILELOADER_H_
+#define _CCOMPILEDMESHFILELOADER_H_
+
+#include "IMeshLoader.h"
+#include "ISceneManager.h"
+#include "IFileSystem.h"
+#include "SCompiledMeshFormat.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        //! Meshloader for the binary compiled meshes written by CCompiledMeshWriter.
+        /** The vertex and index arrays are copied as a whole out of the file, a
+        mapped file is used in place. Files of another version or vertex layout
+        are rejected, so the caller can compile the source again. So are files older
+        than one of their dependencies, before any buffer or texture is loaded. */
+        class CCompiledMeshFileLoader : public IMeshLoader
+        {
+        public:
+
+            //! Constructor
+            CCompiledMeshFileLoader(ISceneManager* smgr, io::IFileSystem* fs);
+
+            //! returns true if the file maybe is able to be loaded by this class
+            //! based on the file extension (e.g. ".kmesh")
+            bool isALoadableFileExtension(const io::path& filename) const override;
+
+            //! creates/loads an animated mesh from the file.
+            //! \return Pointer to the created mesh. Returns 0 if loading failed.
+            IAnimatedMesh* createMesh(io::IReadFile* file) override;
+
+            //! returns the files the last loaded mesh was built from
+            void getDependencies(core::Array<io::path>& files) const override;
+
+        private:
+
+            //! creates the mesh from the validated file contents
+            IAnimatedMesh* CreateMesh(const c8* data, u32 size, const io::path& filename);
+
+            //! restores a material and loads its textures
+            void ReadMaterial(const SCompiledMaterial& compiled, const SCompiledMaterialLayer* layers,
+                const c8* strings, u32 string_table_size, video::SMaterial& material) const;
+
+            ISceneManager* scene_manager_;
+            io::IFileSystem* file_system_;
+
+            //! dependencies stored in the last loaded file
+            core::Array<io::path> dependencies_;
+        };
+
+    } // end namespace scene
+} // end namespace kong
+
+#endif
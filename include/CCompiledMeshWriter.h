@@ -0,0 +1,46 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CCOMPILEDMESHWRITER_H_
+#define _CCOMPILEDMESHWRITER_H_
+
+#include "IAnimatedMesh.h"
+#include "IWriteFile.h"
+#include "SCompiledMeshFormat.h"
+#include "SMaterial.h"
+#include "Array.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        //! Writes meshes as binary compiled meshes, which CCompiledMeshFileLoader loads again.
+        class CCompiledMeshWriter
+        {
+        public:
+
+            //! Writes a static mesh to the file.
+            /** \param file: File to write to, positioned at its start.
+            \param mesh: Mesh with exactly one frame.
+            \param dependencies: Files besides the source which the mesh was built from.
+            \return True if the whole mesh was written. */
+            bool WriteMesh(io::IWriteFile* file, IAnimatedMesh* mesh, const core::Array<io::path>& dependencies);
+
+        private:
+
+            //! fills the compiled material and its layers, texture names are added to the string table
+            void WriteMaterial(const video::SMaterial& material, SCompiledMaterial& compiled, SCompiledMaterialLayer* layers);
+
+            //! returns the offset of the name in the string table, adds it if needed
+            u32 AddString(const c8* name);
+
+            //! writes zeros until the file position is a multiple of alignment
+            static bool WritePadding(io::IWriteFile* file, u32 alignment);
+
+            core::Array<c8> strings_;
+        };
+
+    } // end namespace scene
+} // end namespace kong
+
+#endif
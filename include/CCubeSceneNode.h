@@ -27,6 +27,8 @@ namespace kong
             //! render the node.
             void Render() override;
 
+            bool SubmitRenderItems(CRenderQueue& queue) override;
+
             video::SMaterial& GetMaterial(u32 num) override;
 
             u32 GetMaterialCount() const override;
@@ -0,0 +1,126 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CDYNAMICAABBTREE_H_
+#define _CDYNAMICAABBTREE_H_
+
+#include "Array.h"
+#include "aabbox3d.h"
+#include "SViewFrustum.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        class ISceneNode;
+
+        //! Bounding volume hierarchy of scene nodes for frustum culling.
+        /** Every scene node is a leaf (a proxy) with a box which is a little larger
+        than the node, so a moving node only has to be reinserted when it leaves
+        its box. Inner nodes bound their two children, the tree is kept balanced
+        by rotations while inserting. A frustum query skips whole subtrees which
+        are completely outside or completely inside the frustum. */
+        class CDynamicAabbTree
+        {
+        public:
+            CDynamicAabbTree();
+
+            //! Adds a node with its transformed bounding box, returns the id of the proxy
+            s32 CreateProxy(ISceneNode* node, const core::aabbox3df& box);
+
+            //! Removes a proxy, the id may be reused by the next CreateProxy()
+            void DestroyProxy(s32 proxy);
+
+            //! Updates the box of a proxy.
+            /** \return True if the proxy was reinserted, because the box left the enlarged box. */
+            bool MoveProxy(s32 proxy, const core::aabbox3df& box);
+
+            //! Returns the node of a proxy, or 0 if the id is not a live proxy
+            ISceneNode* GetSceneNode(s32 proxy) const;
+
+            //! Returns the enlarged box of a proxy
+            const core::aabbox3df& GetFatBox(s32 proxy) const;
+
+            //! Returns the amount of proxies
+            u32 GetProxyCount() const;
+
+            //! Marks a proxy as registered for rendering in a frame
+            void SetRegistered(s32 proxy, u32 frame);
+
+            //! Removes all proxies which were not registered in the frame
+            /** \param frame The frame.
+            \param removed Receives the ids of the removed proxies if not 0, it is not cleared. */
+            void RemoveUnregistered(u32 frame, core::Array<s32>* removed = nullptr);
+
+            //! Marks all proxies whose enlarged box is not outside of the frustum as visible in the frame
+            void MarkVisible(const SViewFrustum& frustum, u32 frame);
+
+            //! Returns true if the proxy was marked visible in the frame
+            bool IsVisible(s32 proxy, u32 frame) const;
+
+            //! Collects the nodes of all proxies whose enlarged box is not outside of the frustum
+            /** \param frustum Frustum to test.
+            \param nodes Receives the nodes, it is not cleared.
+            \param plane_mask Planes of the frustum to test, one bit per SViewFrustum::VFPLANES value. */
+            void CollectVisible(const SViewFrustum& frustum, core::Array<ISceneNode*>& nodes,
+                u32 plane_mask = SViewFrustum::ALL_PLANES) const;
+
+        private:
+            struct STreeNode
+            {
+                bool IsLeaf() const
+                {
+                    return child1_ == -1;
+                }
+
+                core::aabbox3df box_;
+
+                //! node of a leaf, 0 for inner nodes and free nodes
+                ISceneNode* scene_node_;
+
+                //! parent of a used node, next free node of a free node
+                s32 parent_;
+                s32 child1_;
+                s32 child2_;
+
+                //! leaves have height 0, free nodes -1
+                s32 height_;
+
+                //! frames of the last MarkVisible() and SetRegistered() call which hit the leaf
+                u32 visible_frame_;
+                u32 registered_frame_;
+            };
+
+            s32 AllocateNode();
+            void FreeNode(s32 node);
+            void InsertLeaf(s32 leaf);
+            void RemoveLeaf(s32 leaf);
+
+            //! rotates the subtree if it is unbalanced, returns the new root of the subtree
+            s32 Balance(s32 index);
+
+            //! recalculates box and height of the node and all its ancestors
+            void Refit(s32 index);
+
+            //! calls the function for all leaves of the subtree
+            template <typename F>
+            void ForEachLeaf(s32 index, F& function) const;
+
+            //! calls the function for all leaves which are not outside of the frustum
+            template <typename F>
+            void QueryFrustum(const SViewFrustum& frustum, u32 plane_mask, F& function) const;
+
+            core::Array<STreeNode> nodes_;
+            s32 root_;
+            s32 free_list_;
+            u32 proxy_count_;
+
+            //! stack of the tree traversals, kept to avoid allocations
+            mutable core::Array<s32> stack_;
+            mutable core::Array<u32> stack_masks_;
+        };
+
+    } // end namespace scene
+} // end namespace kong
+
+#endif
@@ -17,6 +17,9 @@ namespace kong
 
             //! opens a file for read access
             IReadFile* CreateAndOpenFile(const SPath &filename) override;
+
+            //! opens a file for read access through a memory mapping
+            IReadFile* CreateAndMapFile(const SPath &filename) override;
             
             //! Creates an IReadFile interface for accessing memory like a file.
             IReadFile* CreateMemoryReadFile(void* memory, s32 len, const SPath &fileName, bool deleteMemoryWhenDropped) override;
@@ -35,6 +38,9 @@ namespace kong
 
             //! Determines if a file exists and could be opened.
             bool ExistFile(const path& filename) const override;
+
+            //! Determines if a file was modified after another one.
+            bool IsFileNewer(const path& filename, const path& reference) const override;
         };
     } // end namepsace io
 } // end namespace kong
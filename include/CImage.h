@@ -6,7 +6,7 @@
 #define __C_IMAGE_H_INCLUDED__
 
 #include "IImage.h"
-#include "rect.h"
+#include "Rect.h"
 
 namespace kong
 {
@@ -80,6 +80,17 @@ namespace kong
             //! returns pitch of image
             virtual u32 GetPitch() const { return pitch_; }
 
+            //! returns the stored mip map levels after level 0
+            virtual void* GetMipMapsData() const { return mip_maps_data_; }
+
+            //! returns the amount of stored levels, including level 0
+            virtual u32 GetMipMapLevelCount() const { return mip_map_level_count_; }
+
+            //! sets the stored mip map levels after level 0
+            /** \param data Levels one after another, allocated with new[], the image deletes them.
+            \param level_count Amount of levels including level 0. */
+            void SetMipMapsData(u8* data, u32 level_count);
+
             //! copies this surface into another, scaling it to fit.
             virtual void CopyToScaling(void* target, u32 width, u32 height, ECOLOR_FORMAT format, u32 pitch = 0);
 
@@ -111,6 +122,8 @@ namespace kong
             inline SColor GetPixelBox(s32 x, s32 y, s32 fx, s32 fy, s32 bias) const;
 
             u8* data_;
+            u8* mip_maps_data_;
+            u32 mip_map_level_count_;
             core::Dimension2d<u32> size_;
             u32 bytes_per_pixel_;
             u32 pitch_;
@@ -0,0 +1,151 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CIMAGELOADER_DDS_H_
+#define _CIMAGELOADER_DDS_H_
+
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_DDS_LOADER_
+
+#include "IImageLoader.h"
+
+namespace kong
+{
+    namespace video
+    {
+        //! pixel format flags
+        const u32 DDPF_ALPHAPIXELS = 0x1;
+        const u32 DDPF_ALPHA = 0x2;
+        const u32 DDPF_FOURCC = 0x4;
+        const u32 DDPF_RGB = 0x40;
+        const u32 DDPF_LUMINANCE = 0x20000;
+
+        //! header flags and caps
+        const u32 DDSD_CAPS = 0x1;
+        const u32 DDSD_HEIGHT = 0x2;
+        const u32 DDSD_WIDTH = 0x4;
+        const u32 DDSD_PIXELFORMAT = 0x1000;
+        const u32 DDSD_MIPMAPCOUNT = 0x20000;
+        const u32 DDSD_LINEARSIZE = 0x80000;
+        const u32 DDSCAPS_COMPLEX = 0x8;
+        const u32 DDSCAPS_TEXTURE = 0x1000;
+        const u32 DDSCAPS_MIPMAP = 0x400000;
+        const u32 DDSCAPS2_CUBEMAP = 0x200;
+        const u32 DDSCAPS2_VOLUME = 0x200000;
+        const u32 DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+        const u32 DDS_DIMENSION_TEXTURE2D = 3;
+
+        //! largest width and height which is loaded, the texture limit of D3D11 class hardware
+        const u32 DDS_MAX_DIMENSION = 16384;
+
+        //! the DXGI formats of DX10 headers which can be loaded or written
+        enum E_DXGI_FORMAT
+        {
+            DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+            DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+            DXGI_FORMAT_BC1_UNORM = 71,
+            DXGI_FORMAT_BC1_UNORM_SRGB = 72,
+            DXGI_FORMAT_BC2_UNORM = 74,
+            DXGI_FORMAT_BC2_UNORM_SRGB = 75,
+            DXGI_FORMAT_BC3_UNORM = 77,
+            DXGI_FORMAT_BC3_UNORM_SRGB = 78,
+            DXGI_FORMAT_BC4_UNORM = 80,
+            DXGI_FORMAT_BC5_UNORM = 83,
+            DXGI_FORMAT_B8G8R8A8_UNORM = 87,
+            DXGI_FORMAT_B8G8R8X8_UNORM = 88,
+            DXGI_FORMAT_B8G8R8A8_UNORM_SRGB = 91,
+            DXGI_FORMAT_B8G8R8X8_UNORM_SRGB = 93,
+            DXGI_FORMAT_BC6H_UF16 = 95,
+            DXGI_FORMAT_BC7_UNORM = 98,
+            DXGI_FORMAT_BC7_UNORM_SRGB = 99
+        };
+
+        inline u32 MakeDDSFourCC(c8 a, c8 b, c8 c, c8 d)
+        {
+            return static_cast<u32>(a) | (static_cast<u32>(b) << 8) | (static_cast<u32>(c) << 16) | (static_cast<u32>(d) << 24);
+        }
+
+        // byte-align structures
+#include "KongPack.h"
+
+        struct SDDSPixelFormat
+        {
+            u32 Size;
+            u32 Flags;
+            u32 FourCC;
+            u32 RGBBitCount;
+            u32 RBitMask;
+            u32 GBitMask;
+            u32 BBitMask;
+            u32 ABitMask;
+        } PACK_STRUCT;
+
+        //! follows the magic number "DDS "
+        struct SDDSHeader
+        {
+            u32 Size;
+            u32 Flags;
+            u32 Height;
+            u32 Width;
+            u32 PitchOrLinearSize;
+            u32 Depth;
+            u32 MipMapCount;
+            u32 Reserved1[11];
+            SDDSPixelFormat PixelFormat;
+            u32 Caps;
+            u32 Caps2;
+            u32 Caps3;
+            u32 Caps4;
+            u32 Reserved2;
+        } PACK_STRUCT;
+
+        //! follows the header if the four cc of the pixel format is "DX10"
+        struct SDDSHeaderDX10
+        {
+            u32 DXGIFormat;
+            u32 ResourceDimension;
+            u32 MiscFlag;
+            u32 ArraySize;
+            u32 MiscFlags2;
+        } PACK_STRUCT;
+
+        // Default alignment
+#include "KongUnpack.h"
+
+        //! Surface Loader for dds files
+        /** Block compressed files stay compressed, so drivers can upload them as
+        they are. Uncompressed files are converted to ECF_A8R8G8B8. The mip map
+        levels stored in the file are kept in the image. Cube maps, volumes and
+        texture arrays are not supported. */
+        class CImageLoaderDDS : public IImageLoader
+        {
+        public:
+
+            //! returns true if the file maybe is able to be loaded by this class
+            //! based on the file extension (e.g. ".dds")
+            bool IsALoadableFileExtension(const io::path& filename) const override;
+
+            //! returns true if the file maybe is able to be loaded by this class
+            bool IsALoadableFileFormat(io::IReadFile* file) const override;
+
+            //! creates a surface from the file
+            IImage* LoadImage(io::IReadFile* file) const override;
+
+        private:
+
+            //! returns the color format of a block compressed file, ECF_UNKNOWN if it is not
+            ECOLOR_FORMAT GetCompressedFormat(const SDDSHeader& header, const SDDSHeaderDX10* header_dx10) const;
+
+            //! returns the bit masks of an uncompressed file, false if the format is not supported
+            bool GetUncompressedFormat(const SDDSHeader& header, const SDDSHeaderDX10* header_dx10, SDDSPixelFormat& format) const;
+
+            //! converts texels described by bit masks to A8R8G8B8
+            void ConvertToA8R8G8B8(const u8* source, u32 count, const SDDSPixelFormat& format, u32* target) const;
+        };
+
+    } // end namespace video
+} // end namespace kong
+
+#endif
+#endif
@@ -100,9 +100,6 @@ namespace kong
             data has been read.  Often a no-op. */
             static void TermSource(j_decompress_ptr cinfo);
 
-            // Copy filename to have it around for error-messages
-            static io::SPath filename_;
-
 #endif // _KONG_COMPILE_WITH_LIBJPEG_
         };
 
@@ -0,0 +1,64 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CIMAGEPYRAMID_H_
+#define _CIMAGEPYRAMID_H_
+
+#include "IImage.h"
+#include "Array.h"
+
+namespace kong
+{
+    namespace video
+    {
+        //! The mip map chain of an image, down to a size of 1x1.
+        /** Level 0 is the image itself, every further level has half the width and
+        height of the one before, at least one texel. A level is built from the one
+        before with a 2x2 box filter, an odd width or height is filtered with three
+        weighted taps so every source texel contributes. Colors stored in sRGB are
+        averaged after they
+        are turned into linear intensities, else dark texels win and the small
+        levels get too dark. Alpha is always averaged as it is. */
+        class CImagePyramid
+        {
+        public:
+            CImagePyramid();
+
+            //! frees the levels
+            ~CImagePyramid();
+
+            //! Builds all levels of an image
+            /** \param image Level 0, it is not copied, so it has to live as long as the pyramid.
+            \param srgb True if the colors are stored in sRGB, false for data like normals.
+            \return False if the image is not ECF_A8R8G8B8, the pyramid only has level 0 then. */
+            bool Build(IImage* image, bool srgb = true);
+
+            //! Frees all levels
+            void Clear();
+
+            //! Returns the amount of levels, including level 0
+            u32 GetLevelCount() const;
+
+            //! Returns a level, 0 is the image the pyramid was built from
+            IImage* GetLevel(u32 level) const;
+
+            //! Returns the amount of levels of a full chain, including level 0
+            static u32 GetLevelCount(const core::Dimension2d<u32>& size);
+
+            //! Returns the size of a level
+            static core::Dimension2d<u32> GetLevelSize(const core::Dimension2d<u32>& size, u32 level);
+
+        private:
+            //! filters a level into the next smaller one
+            static void Downsample(IImage* source, IImage* target, bool srgb);
+
+            //! level 0, not owned
+            IImage* base_;
+
+            //! levels 1 and up
+            core::Array<IImage*> levels_;
+        };
+    } // end namespace video
+} // end namespace kong
+
+#endif
@@ -0,0 +1,37 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CIMAGEWRITER_DDS_H_
+#define _CIMAGEWRITER_DDS_H_
+
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_DDS_LOADER_
+
+#include "IImage.h"
+#include "IWriteFile.h"
+
+namespace kong
+{
+    namespace video
+    {
+        //! extension of the block compressed copies of textures, appended to the source file name
+        const c8* const COMPRESSED_TEXTURE_EXTENSION = ".dds";
+
+        //! Writes block compressed images as dds files, which CImageLoaderDDS loads again.
+        class CImageWriterDDS
+        {
+        public:
+
+            //! Writes a block compressed image and all of its stored mip map levels to the file.
+            /** \param file: File to write to, positioned at its start.
+            \param image: Image with one of the formats ECF_BC1 to ECF_BC7.
+            \return True if the whole image was written. */
+            bool WriteImage(io::IWriteFile* file, IImage* image);
+        };
+
+    } // end namespace video
+} // end namespace kong
+
+#endif
+#endif
@@ -0,0 +1,72 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _C_KONG_DEVICE_HEADLESS_H_
+#define _C_KONG_DEVICE_HEADLESS_H_
+
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_HEADLESS_DEVICE_
+
+#include "CKongDeviceStub.h"
+#include "SKongCreationParameters.h"
+#include "SRenderStatistics.h"
+#include <chrono>
+
+namespace kong
+{
+    //! Device without a window, renders with the null or the software driver.
+    /** Every call of run() finishes a frame. The frame can be dumped to a file,
+    and frame and pass timings and node counts are accumulated and printed when
+    the device is destroyed or the frame count is reached. */
+    class CKongDeviceHeadless : public CKongDeviceStub
+    {
+    public:
+        CKongDeviceHeadless(const SKongCreationParameters &param);
+
+        virtual ~CKongDeviceHeadless();
+
+        //! Finishes the last frame, returns false when the frame count is reached.
+        bool run() override;
+
+        video::IVideoDriver* GetVideoDriver() override;
+
+        //! Provides access to the scene manager.
+        scene::ISceneManager* GetSceneManager() override;
+
+    protected:
+        //! create the driver
+        void CreateVideo();
+
+        //! writes the color buffer as binary ppm
+        void DumpFrame(u32 frame);
+
+        //! prints the average frame and pass timings and node counts
+        void PrintStatistics() const;
+
+        //! frames finished so far
+        u32 frame_;
+
+        //! accumulated milliseconds
+        f64 frame_time_;
+        f64 pass_time_[scene::ERPT_COUNT];
+
+        //! accumulated node counts
+        f64 visible_nodes_;
+        f64 culled_nodes_;
+        f64 shadow_casters_;
+
+        //! accumulated work of the render queue
+        f64 draw_calls_;
+        f64 instances_;
+        f64 material_changes_;
+
+        std::chrono::high_resolution_clock::time_point frame_start_;
+        bool frame_started_;
+        bool statistics_printed_;
+    };
+} // end namespace kong
+
+#endif // _KONG_COMPILE_WITH_HEADLESS_DEVICE_
+
+#endif
@@ -18,7 +18,7 @@ namespace kong
 
     namespace video
     {
-        //IVideoDriver *CreateNullDriver(io::IFileSystem *io, const core::Vector2D<u32> &screen_size);
+        IVideoDriver *CreateNullDriver(io::IFileSystem *io, const core::Dimension2d<u32> &screen_size);
     }
     class CKongDeviceStub : public KongDevice
     {
@@ -0,0 +1,118 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CLIGHTCLUSTERGRID_H_
+#define _CLIGHTCLUSTERGRID_H_
+
+#include "Array.h"
+#include "Matrix.h"
+#include "SLight.h"
+
+namespace kong
+{
+    namespace video
+    {
+        //! Bins the lights of a frame into a grid of view space clusters.
+        /** The view frustum is split into TILES_X * TILES_Y screen tiles and SLICES
+        depth slices, the slices get exponentially thicker with the distance to the
+        camera. Point and spot lights are bounded by a sphere of their range and only
+        added to the clusters the sphere touches, so a pixel only has to look at the
+        lights of its own cluster. Directional lights light every cluster, they are
+        kept at the start of the light index list. */
+        class CLightClusterGrid
+        {
+        public:
+            enum
+            {
+                TILES_X = 16,
+                TILES_Y = 9,
+                SLICES = 24,
+                CLUSTER_COUNT = TILES_X * TILES_Y * SLICES
+            };
+
+            CLightClusterGrid();
+
+            //! Assigns the lights to the clusters of the view frustum given by the camera transforms
+            void Update(const core::Matrixf& view, const core::Matrixf& projection, const SLight* lights, u32 count);
+
+            //! Returns the offset into the light index list and the light count, two values per cluster
+            /** Cluster (x, y, slice) is at (slice * TILES_Y + y) * TILES_X + x, tile
+            (0, 0) is at the bottom left of the screen. */
+            const u32* GetClusters() const;
+
+            //! Returns the light indices of all clusters
+            const u32* GetLightIndices() const;
+
+            //! Returns the length of the light index list
+            u32 GetLightIndexCount() const;
+
+            //! Returns the amount of lights at the start of the index list which light every cluster
+            u32 GetGlobalLightCount() const;
+
+            //! Returns the view space depth of the near plane
+            f32 GetNear() const;
+
+            //! Returns the view space depth of the far plane
+            f32 GetFar() const;
+
+            //! Returns scale and bias which turn the log of a view space depth into a slice
+            /** slice = floor(log(depth) * scale + bias) */
+            void GetSliceTransform(f32& scale, f32& bias) const;
+
+            //! Returns the distance at which a light stops lighting
+            /** That is the radius of the light, or less if the attenuation darkens
+            the light below 1 / 256 before. Directional lights have no range. */
+            static f32 GetLightRange(const SLight& light);
+
+        private:
+            //! recalculates the view space bounds of the clusters
+            void UpdateClusterBounds(const core::Matrixf& projection);
+
+            //! calculates a view space bounding sphere, returns false for lights which do not need one
+            bool GetLightSphere(const SLight& light, const core::Matrixf& view, f32* center, f32& radius) const;
+
+            //! adds a light to all clusters touched by a view space sphere
+            void AddLight(u32 idx, const f32* center, f32 radius);
+
+            //! returns the slice of a view space depth
+            s32 GetSlice(f32 depth) const;
+
+            //! returns the tile of a normalized device coordinate
+            static s32 GetTile(f32 ndc, s32 tiles);
+
+            //! the projection the bounds were calculated for
+            core::Matrixf projection_;
+            bool bounds_valid_;
+
+            f32 near_;
+            f32 far_;
+            f32 slice_scale_;
+            f32 slice_bias_;
+
+            //! view space depth of the slice borders
+            f32 slice_depth_[SLICES + 1];
+
+            //! view space bounds of the tiles in each slice
+            /** The x bounds of four neighbored tiles are next to each other in memory
+            so they can be tested at once. */
+            f32 tile_min_x_[SLICES][TILES_X];
+            f32 tile_max_x_[SLICES][TILES_X];
+            f32 tile_min_y_[SLICES][TILES_Y];
+            f32 tile_max_y_[SLICES][TILES_Y];
+
+            //! offset and count of each cluster
+            core::Array<u32> clusters_;
+
+            //! light indices sorted by cluster
+            core::Array<u32> light_indices_;
+
+            //! cluster and light of every hit, kept to avoid allocations
+            core::Array<u32> hit_clusters_;
+            core::Array<u32> hit_lights_;
+
+            u32 global_lights_;
+        };
+    } // end namespace video
+} // end namespace kong
+
+#endif
@@ -70,6 +70,18 @@ namespace kong
             //! Reset camera transform
             void ResetCameraTransform(core::Array<DefaultNodeEntry>& solid_nodes) override;
 
+            //! Extend the shadow camera toward the light
+            void FitShadowCasters(const core::Array<ISceneNode*>& casters) override;
+
+            //! Fit the shadow camera to a slice of the view frustum
+            bool FitShadowCascade(const core::vector3df* corners, const core::Array<DefaultNodeEntry>& receivers, u32 resolution) override;
+
+            //! Point the shadow camera along a view of a spot or point light
+            bool FitShadowView(u32 view) override;
+
+            //! Get the camera of the shadow map
+            ICameraSceneNode* GetShadowCamera() const override;
+
             //! Get main light index
             s32 GetLightIndex() const override;
 
@@ -88,6 +100,10 @@ namespace kong
 
             s32 main_light_index_;
             ICameraSceneNode *camera_;
+
+            //! size of the orthogonal shadow camera fitted by ResetCameraTransform
+            f32 shadow_height_;
+            f32 shadow_depth_;
         };
     }
 }
@@ -30,6 +30,9 @@ namespace kong
             void SetLODOn(bool on);
             bool GetLODOn() const;
 
+            //! Changes with the level of detail picked by the last Render()
+            u32 GetGeometryChangedID() override;
+
         private:
             class Vertex;
             class Triangle;
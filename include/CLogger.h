@@ -9,11 +9,14 @@
 #include "os.h"
 #include "KongString.h"
 #include "IEventReceiver.h"
+#include <mutex>
 
 namespace kong
 {
 
     //! Class for logging messages, warnings and errors to stdout
+    /** Messages may come from the worker threads of the texture streamer, they are
+    printed and sent to the event receiver one at a time. */
     class CLogger : public ILogger
     {
     public:
@@ -48,6 +51,7 @@ namespace kong
 
         ELOG_LEVEL LogLevel;
         IEventReceiver* Receiver;
+        std::mutex Mutex;
     };
 
 } // end namespace
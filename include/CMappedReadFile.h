@@ -0,0 +1,66 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CMAPPEDREADFILE_H_
+#define _CMAPPEDREADFILE_H_
+
+#include "KongCompileConfig.h"
+#include "IReadFile.h"
+#include "SPath.h"
+
+namespace kong
+{
+    namespace io
+    {
+        /*!
+        Class for reading a file from disk through a read only memory mapping.
+        */
+        class CMappedReadFile : public IReadFile
+        {
+        public:
+
+            CMappedReadFile(const io::SPath &fileName);
+
+            virtual ~CMappedReadFile();
+
+            //! returns how much was read
+            s32 Read(void* buffer, u32 size_to_read) override;
+
+            //! changes position in file, returns true if successful
+            bool Seek(long finalPos, bool relative_movement = false) override;
+
+            //! returns size of file
+            long GetSize() const override;
+
+            //! returns if the file is mapped
+            virtual bool IsOpen() const;
+
+            //! returns where in the file we are.
+            long GetPos() const override;
+
+            //! returns name of file
+            const io::SPath& GetFileName() const override;
+
+            //! returns the mapped contents of the file
+            const void* GetMappedData() const override;
+
+        private:
+
+            //! opens and maps the file
+            void MapFile();
+
+            const c8* data_;
+            long file_size_;
+            long pos_;
+            io::SPath filename_;
+
+#ifdef _KONG_WINDOWS_API_
+            void* file_handle_;
+            void* mapping_handle_;
+#endif
+        };
+
+    } // end namespace io
+} // end namespace kong
+
+#endif
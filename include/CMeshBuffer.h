@@ -47,6 +47,7 @@ namespace kong
             virtual u32 GetVertexCount() const;
 
             //! Get type of index data which is stored in this meshbuffer.
+            /** Buffers use 16 bit indices as long as all indices fit into them. */
             virtual video::E_INDEX_TYPE GetIndexType() const;
 
             //! Get access to Indices.
@@ -61,6 +62,19 @@ namespace kong
             /** \return Number of indices in this buffer. */
             virtual u32 GetIndexCount() const;
 
+            //! Returns index i, for both index types
+            virtual u32 GetIndex(u32 i) const;
+
+            //! Adds an index, switches to 32 bit indices if it does not fit into 16 bit
+            void PushBackIndex(u32 index);
+
+            //! Reserves memory for indices of the current index type
+            void ReallocateIndices(u32 count);
+
+            //! Converts the indices to another type
+            /** \return False if the indices do not fit into 16 bit, they stay 32 bit then. */
+            bool SetIndexType(video::E_INDEX_TYPE type);
+
             //! Get the currently used ID for identification of changes.
             /** This shouldn't be used for anything outside the VideoDriver. */
             virtual u32 GetVertexChangedID() const;
@@ -102,24 +116,48 @@ namespace kong
             virtual core::vector2df& GetTCoords(u32 i);
 
             //! Append the vertices and indices to the current buffer
+            /** Switches to 32 bit indices if the appended ones do not fit into 16 bit. */
             virtual void Append(const void* const vertices, u32 numVertices, const u16* const indices, u32 numIndices);
 
+            //! get the current hardware mapping hint
+            virtual E_HARDWARE_MAPPING GetHardwareMappingHintVertex() const;
+
+            //! get the current hardware mapping hint
+            virtual E_HARDWARE_MAPPING GetHardwareMappingHintIndex() const;
+
+            //! set the hardware mapping hint, for driver
+            virtual void SetHardwareMappingHint(E_HARDWARE_MAPPING new_mapping_hint, E_BUFFER_TYPE buffer = EBT_VERTEX_AND_INDEX);
+
+            //! flags the meshbuffer as changed, reloads hardware buffers
+            virtual void SetDirty(E_BUFFER_TYPE buffer = EBT_VERTEX_AND_INDEX);
+
             video::SMaterial material_;
             core::Array<T>  vertices_;
+
+            //! indices of a buffer with index_type_ EIT_16BIT
             core::Array<u16> indices_;
+
+            //! indices of a buffer with index_type_ EIT_32BIT
+            core::Array<u32> indices32_;
+            video::E_INDEX_TYPE index_type_;
             //! Bounding box of this meshbuffer.
             core::aabbox3d<f32> bounding_box_;
 
             u32 changed_id_vertex_;
             u32 changed_id_index;
 
+            //! hardware mapping hint
+            E_HARDWARE_MAPPING mapping_hint_vertex_;
+            E_HARDWARE_MAPPING mapping_hint_index_;
+
             // Bouding box of this meshbuffer
             //core::aabbox3d<f32> BoundingBox;
         };
 
         template <class T>
         CMeshBuffer<T>::CMeshBuffer() 
-            : changed_id_vertex_(1), changed_id_index(1)
+            : index_type_(video::EIT_16BIT), changed_id_vertex_(1), changed_id_index(1),
+            mapping_hint_vertex_(EHM_STATIC), mapping_hint_index_(EHM_STATIC)
         {
 
         }
@@ -163,25 +201,91 @@ namespace kong
         template <class T>
         video::E_INDEX_TYPE CMeshBuffer<T>::GetIndexType() const
         {
-            return video::EIT_16BIT;
+            return index_type_;
         }
 
         template <class T>
         const u16* CMeshBuffer<T>::GetIndices() const
         {
+            if (index_type_ == video::EIT_32BIT)
+                return reinterpret_cast<const u16*>(indices32_.ConstPointer());
             return indices_.ConstPointer();
         }
 
         template <class T>
         u16* CMeshBuffer<T>::GetIndices()
         {
+            if (index_type_ == video::EIT_32BIT)
+                return reinterpret_cast<u16*>(indices32_.Pointer());
             return indices_.Pointer();
         }
 
         template <class T>
         u32 CMeshBuffer<T>::GetIndexCount() const
         {
-            return indices_.Size();
+            return index_type_ == video::EIT_32BIT ? indices32_.Size() : indices_.Size();
+        }
+
+        template <class T>
+        u32 CMeshBuffer<T>::GetIndex(u32 i) const
+        {
+            return index_type_ == video::EIT_32BIT ? indices32_.ConstPointer()[i] : indices_.ConstPointer()[i];
+        }
+
+        template <class T>
+        void CMeshBuffer<T>::PushBackIndex(u32 index)
+        {
+            if (index_type_ == video::EIT_16BIT)
+            {
+                if (index <= 0xffff)
+                {
+                    indices_.PushBack(static_cast<u16>(index));
+                    return;
+                }
+                SetIndexType(video::EIT_32BIT);
+            }
+            indices32_.PushBack(index);
+        }
+
+        template <class T>
+        void CMeshBuffer<T>::ReallocateIndices(u32 count)
+        {
+            if (index_type_ == video::EIT_32BIT)
+                indices32_.Reallocate(count);
+            else
+                indices_.Reallocate(count);
+        }
+
+        template <class T>
+        bool CMeshBuffer<T>::SetIndexType(video::E_INDEX_TYPE type)
+        {
+            if (type == index_type_)
+                return true;
+
+            if (type == video::EIT_32BIT)
+            {
+                indices32_.Resize(indices_.Size());
+                for (u32 i = 0; i < indices_.Size(); ++i)
+                    indices32_.Pointer()[i] = indices_.ConstPointer()[i];
+                indices_.Clear();
+            }
+            else
+            {
+                for (u32 i = 0; i < indices32_.Size(); ++i)
+                {
+                    if (indices32_.ConstPointer()[i] > 0xffff)
+                        return false;
+                }
+
+                indices_.Resize(indices32_.Size());
+                for (u32 i = 0; i < indices32_.Size(); ++i)
+                    indices_.Pointer()[i] = static_cast<u16>(indices32_.ConstPointer()[i]);
+                indices32_.Clear();
+            }
+
+            index_type_ = type;
+            SetDirty(EBT_INDEX);
+            return true;
         }
 
         template <class T>
@@ -276,11 +380,43 @@ namespace kong
                 bounding_box_.addInternalPoint(reinterpret_cast<const T*>(vertices)[i].pos_);
             }
 
-            indices_.Reallocate(GetIndexCount() + numIndices);
+            ReallocateIndices(GetIndexCount() + numIndices);
             for (i = 0; i<numIndices; ++i)
             {
-                indices_.PushBack(indices[i] + vertexCount);
+                PushBackIndex(indices[i] + vertexCount);
             }
+
+            SetDirty();
+        }
+
+        template <class T>
+        E_HARDWARE_MAPPING CMeshBuffer<T>::GetHardwareMappingHintVertex() const
+        {
+            return mapping_hint_vertex_;
+        }
+
+        template <class T>
+        E_HARDWARE_MAPPING CMeshBuffer<T>::GetHardwareMappingHintIndex() const
+        {
+            return mapping_hint_index_;
+        }
+
+        template <class T>
+        void CMeshBuffer<T>::SetHardwareMappingHint(E_HARDWARE_MAPPING new_mapping_hint, E_BUFFER_TYPE buffer)
+        {
+            if (buffer == EBT_VERTEX_AND_INDEX || buffer == EBT_VERTEX)
+                mapping_hint_vertex_ = new_mapping_hint;
+            if (buffer == EBT_VERTEX_AND_INDEX || buffer == EBT_INDEX)
+                mapping_hint_index_ = new_mapping_hint;
+        }
+
+        template <class T>
+        void CMeshBuffer<T>::SetDirty(E_BUFFER_TYPE buffer)
+        {
+            if (buffer == EBT_VERTEX_AND_INDEX || buffer == EBT_VERTEX)
+                ++changed_id_vertex_;
+            if (buffer == EBT_VERTEX_AND_INDEX || buffer == EBT_INDEX)
+                ++changed_id_index;
         }
 
         //! Standard meshbuffer
@@ -0,0 +1,77 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CMESHCACHE_H_
+#define _CMESHCACHE_H_
+
+#include "IMeshCache.h"
+#include "Array.h"
+
+namespace kong
+{
+    namespace video
+    {
+        class IVideoDriver;
+    }
+
+    namespace scene
+    {
+        //! Mesh cache keeping the meshes sorted by name.
+        class CMeshCache : public IMeshCache
+        {
+        public:
+            //! constructor, the driver frees the hardware buffers of evicted meshes
+            explicit CMeshCache(video::IVideoDriver* driver);
+
+            //! destructor, drops all meshes
+            virtual ~CMeshCache();
+
+            void AddMesh(const io::path& name, IAnimatedMesh* mesh) override;
+
+            void RemoveMesh(const IMesh* mesh) override;
+
+            u32 GetMeshCount() const override;
+
+            IAnimatedMesh* GetMeshByIndex(u32 index) override;
+
+            IAnimatedMesh* GetMeshByName(const io::path& name) override;
+
+            const io::path& GetMeshName(const IMesh* mesh) const override;
+
+            bool IsMeshLoaded(const io::path& name) override;
+
+            void Clear() override;
+
+            void ClearUnusedMeshes() override;
+
+        private:
+            struct SMeshEntry
+            {
+                io::path name_;
+                IAnimatedMesh* mesh_;
+
+                bool operator<(const SMeshEntry& other) const
+                {
+                    return name_ < other.name_;
+                }
+            };
+
+            //! returns the index of the entry with the name, or -1
+            s32 FindMesh(const io::path& name) const;
+
+            //! true if only the cache holds the mesh and only the mesh holds its frames
+            static bool IsMeshUnused(IAnimatedMesh* mesh);
+
+            //! drops the reference of the cache, frees the hardware buffers if nothing else uses the mesh
+            void DropMesh(IAnimatedMesh* mesh) const;
+
+            video::IVideoDriver* driver_;
+
+            //! sorted by name
+            core::Array<SMeshEntry> meshes_;
+        };
+
+    } // end namespace scene
+} // end namespace kong
+
+#endif
@@ -14,7 +14,7 @@ namespace kong
         {
         public:
 
-            //! constructor
+            //! constructor, grabs the mesh
             CMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
                 const core::vector3df& position = core::vector3df(0, 0, 0),
                 const core::vector3df& rotation = core::vector3df(0, 0, 0),
@@ -33,6 +33,8 @@ namespace kong
 
             void Render() override;
 
+            bool SubmitRenderItems(CRenderQueue& queue) override;
+
             const core::aabbox3d<f32>& GetBoundingBox() const override;
 
             void NormalizeVertice() override;
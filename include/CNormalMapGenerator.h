@@ -0,0 +1,34 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CNORMALMAPGENERATOR_H_
+#define _CNORMALMAPGENERATOR_H_
+
+#include "IImage.h"
+
+namespace kong
+{
+    namespace video
+    {
+        //! Turns height maps into tangent space normal maps for all drivers.
+        /** The height is read from the red channel of ECF_A8R8G8B8 texels and from
+        the average of the color channels of ECF_A1R5G5B5 texels. The map wraps
+        around at its borders. */
+        class CNormalMapGenerator
+        {
+        public:
+            //! Returns true if the format can hold a height map
+            static bool IsFormatSupported(ECOLOR_FORMAT format);
+
+            //! Replaces the heights by normals in place
+            /** ECF_A8R8G8B8 texels keep the height in alpha.
+            \param pitch Bytes per row of the texels.
+            \param amplitude Scale of the heights against the texel spacing.
+            \return False if the format is not supported. */
+            static bool Make(void* data, ECOLOR_FORMAT format, const core::Dimension2d<u32>& size, u32 pitch, f32 amplitude);
+        };
+
+    } // end namespace video
+} // end namespace kong
+
+#endif
@@ -0,0 +1,268 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CNULLDRIVER_H_
+#define _CNULLDRIVER_H_
+
+#include "IVideoDriver.h"
+#include "SMaterial.h"
+#include "SLight.h"
+#include "IFileSystem.h"
+#include "Array.h"
+#include "IImageLoader.h"
+#include "Matrix.h"
+#include "ERenderingMode.h"
+
+namespace kong
+{
+    namespace video
+    {
+        //! Driver which keeps all device independent state but does not draw anything.
+        /** Used directly when no visualisation is needed, and as base class of the
+        CPU based drivers. */
+        class CNullDriver : public IVideoDriver
+        {
+        public:
+            CNullDriver(io::IFileSystem* io, const core::Dimension2d<u32>& screen_size);
+
+            virtual ~CNullDriver();
+
+            //! Sets a material.
+            void SetMaterial(const SMaterial& material) override;
+
+            //! Applications must call this method before performing any rendering.
+            bool BeginScene(bool back_buffer = true, bool z_buffer = true, SColor color = SColor(255, 0, 0, 0)) override;
+
+            //! Presents the rendered image to the screen.
+            bool EndScene() override;
+
+            //! Sets transformation matrices.
+            void SetTransform(u32 state, const core::Matrixf& mat) override;
+
+            //! Draws a 3d line.
+            void Draw3DLine(const core::Vector3Df& start,
+                const core::Vector3Df& end, SColor color = SColor(255, 255, 255, 255)) override;
+
+            //! Draws a 2d image using a color
+            void Draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+                const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect = 0,
+                SColor color = SColor(255, 255, 255, 255), bool useAlphaChannelOfTexture = false) override;
+
+            //! Draws a 2d image
+            void Draw2DImage(const video::ITexture* texture, const core::position2d<f32>& destPos,
+                const core::rect<f32>& sourceRect, SColor color = SColor(255, 255, 255, 255)) override;
+
+            //! Draws a mesh buffer
+            void DrawMeshBuffer(const scene::IMeshBuffer* mesh_buffer) override;
+
+            //! Draws a mesh buffer once for every world transform
+            void DrawMeshBufferInstanced(const scene::IMeshBuffer* mesh_buffer, const core::Matrixf* transforms, u32 count) override;
+
+            //! Remove hardware buffer
+            void RemoveHardwareBuffer(const scene::IMeshBuffer* mesh_buffer) override;
+
+            //! Remove all hardware buffers
+            void RemoveAllHardwareBuffers() override;
+
+            //! Creates an empty software image.
+            IImage* CreateImage(ECOLOR_FORMAT format, const core::Dimension2d<u32>& size) override;
+
+            //! Creates a software image by converting it to given format from another image.
+            IImage* CreateImage(ECOLOR_FORMAT format, IImage *imageToCopy) override;
+
+            //! Creates a software image from a file.
+            IImage* CreateImageFromFile(const io::path& filename) override;
+
+            //! Creates a software image from a file.
+            IImage* CreateImageFromFile(io::IReadFile* file) override;
+
+            //! Check if the image is already loaded.
+            ITexture* FindTexture(const io::path& filename) override;
+
+            //! Get access to a named texture.
+            ITexture* GetTexture(const io::path& filename) override;
+
+            //! Get access to a named texture.
+            ITexture* GetTexture(io::IReadFile* file) override;
+
+            //! Get access to a named texture without waiting for it to be loaded.
+            ITexture* GetTextureAsync(const io::path& filename) override;
+
+            //! Returns the number of textures which still show their placeholder
+            u32 GetPendingTextureCount() const override;
+
+            //! Sets how many bytes of streamed textures are uploaded per frame at most
+            void SetTextureUploadBudget(u32 bytes) override;
+
+            //! Sets how many bytes of video memory textures and render targets should use at most
+            void SetTextureMemoryBudget(u32 bytes) override;
+
+            //! Returns the bytes of video memory used by textures and render targets
+            u32 GetTextureMemorySize() const override;
+
+            //! Creates an empty texture of specified size.
+            ITexture* AddTexture(const core::Dimension2d<u32>& size,
+                const io::path& name, ECOLOR_FORMAT format = ECF_A8R8G8B8) override;
+
+            //! Creates a texture from an IImage.
+            ITexture* AddTexture(const io::path& name, IImage* image, void* mipmapData = nullptr) override;
+
+            //! adds a surface, not loaded or created by the Kong Engine
+            void AddTexture(video::ITexture* surface);
+
+            //! Returns a pointer to the mesh manipulator.
+            scene::IMeshManipulator* GetMeshManipulator() override;
+
+            //! Creates a normal map from a height map texture.
+            void MakeNormalMapTexture(video::ITexture* texture, f32 amplitude = 1.0f) const override;
+
+            //! Get the size of the screen or render window.
+            const core::Dimension2d<u32>& GetScreenSize() const override;
+
+            const core::Dimension2d<u32>& GetCurrentRenderTargetSize() const override;
+
+            //! Deletes all dynamic lights which were previously added with addDynamicLight().
+            void DeleteAllDynamicLights() override;
+
+            //! adds a dynamic light, returning an index to the light
+            s32 AddDynamicLight(const SLight& light) override;
+
+            void ActivateDynamicLights() override;
+
+            //! Returns the maximal amount of dynamic lights the device can handle
+            u32 GetMaximalDynamicLightAmount() const override;
+
+            //! Returns amount of dynamic lights currently set
+            u32 GetDynamicLightCount() const override;
+
+            //! Returns light data which was previously set by IVideoDriver::addDynamicLight().
+            const SLight& GetDynamicLight(u32 idx) const override;
+
+            //! Set main light, used for shadow rendering
+            void SetMainLight(const SLight& light) override;
+
+            //! Set active camera position
+            void SetActiveCameraPosition(core::Vector3Df position) const override;
+
+            //! Set rendering mode
+            void SetRenderingMode(E_RENDERING_MODE mode) override;
+
+            //! Get the current color format of the color buffer
+            ECOLOR_FORMAT GetColorFormat() const override;
+
+            //! Enable shadows.
+            void EnableShadow(bool flag) override;
+
+            //! Begin shadow rendering
+            void BeginShadowRender() override;
+
+            //! End shadow rendering
+            void EndShadowRender() override;
+
+            //! Begin rendering a cascade of the shadow map
+            void BeginShadowCascade(u32 cascade, const core::Matrixf& view, const core::Matrixf& projection, f32 split_depth) override;
+
+            //! Returns the maximal amount of cascades the shadow map can be split into
+            u32 GetMaximalShadowCascadeAmount() const override;
+
+            //! Returns the size of one cascade of the shadow map in texels
+            const core::Dimension2d<u32>& GetShadowTextureSize() const override;
+
+            //! Returns the width and height of the shadow atlas in texels
+            u32 GetShadowAtlasSize() const override;
+
+            //! Adds a view of a light which is sampled from a tile of the shadow atlas
+            void AddShadowAtlasView(u32 light, const core::rect<s32>& tile, const core::Matrixf& view,
+                const core::Matrixf& projection, f32 split_depth) override;
+
+            //! Begin rendering a tile of the shadow atlas
+            void BeginShadowAtlasTile(const core::rect<s32>& tile, const core::Matrixf& view, const core::Matrixf& projection) override;
+
+            //! Sets a new viewport.
+            void setViewPort(const core::rect<s32>& area) override;
+
+            //! Gets the area of the current viewport.
+            const core::rect<s32>& getViewPort() const override;
+
+            //! Render first pass for deferred render
+            void RenderFirstPass() override;
+
+            //! Render second pass for deferred render
+            void RenderSecondPass() override;
+
+            void CheckError() override;
+
+            // draw a space fill quad
+            void DrawSpaceFillQuad() override;
+
+            // Render fxaa pass
+            void RenderFxaaPass() override;
+
+            //! Make a screenshot of the last rendered frame.
+            IImage* CreateScreenShot() override;
+
+        protected:
+            //! returns a device dependent texture from a software surface (IImage)
+            //! THIS METHOD HAS TO BE OVERRIDDEN BY DERIVED DRIVERS WITH OWN TEXTURES
+            virtual video::ITexture* CreateDeviceDependentTexture(IImage* surface, const io::path& name, void* mipmapData = nullptr);
+
+            //! opens the file and loads it into the surface
+            video::ITexture* LoadTextureFromFile(io::IReadFile* file, const io::path& hashName = "");
+
+            struct SSurface
+            {
+                video::ITexture* Surface;
+
+                bool operator < (const SSurface& other) const
+                {
+                    return Surface->GetName() < other.Surface->GetName();
+                }
+            };
+
+            struct SDummyTexture : public ITexture
+            {
+                SDummyTexture(const io::path& name) : ITexture(name), size(0, 0) {};
+
+                virtual void* Lock(E_TEXTURE_LOCK_MODE mode = ETLM_READ_WRITE, u32 mipmapLevel = 0) { return 0; };
+                virtual void Unlock(){}
+                virtual const core::Dimension2d<u32>& GetOriginalSize() const { return size; }
+                virtual const core::Dimension2d<u32>& GetSize() const { return size; }
+                virtual E_DRIVER_TYPE GetDriverType() const { return video::EDT_NULL; }
+                virtual ECOLOR_FORMAT GetColorFormat() const { return video::ECF_A1R5G5B5; };
+                virtual u32 GetPitch() const { return 0; }
+                virtual void RegenerateMipMapLevels(void* mipmapData = nullptr) {};
+                core::Dimension2d<u32> size;
+            };
+
+            core::Array<SSurface> textures_;
+            core::Array<video::IImageLoader*> surface_loader_;
+
+            io::IFileSystem *io_;
+            core::Dimension2d<u32> screen_size_;
+            core::Matrixf matrices_[ETS_COUNT];
+            SMaterial material_;
+
+            //! mesh manipulator
+            scene::IMeshManipulator* mesh_manipulator_;
+
+            //! light array
+            core::Array<SLight> lights_;
+
+            //! rendering mode
+            E_RENDERING_MODE rendering_mode_;
+
+            // ! shadow enable flag
+            bool shadow_enable_;
+
+            //! size of one cascade of the shadow map
+            core::Dimension2d<u32> shadow_texture_size_;
+
+            //! width and height of the shadow atlas
+            u32 shadow_atlas_size_;
+
+            // viewport
+            core::rect<s32> view_port_;
+        };
+    } // end namespace video
+} // end namespace kong
+#endif
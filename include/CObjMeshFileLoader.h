@@ -10,7 +10,7 @@
 #include "ISceneManager.h"
 #include "KongString.h"
 #include "CMeshBuffer.h"
-#include "Map.h"
+#include "CThreadPool.h"
 
 namespace kong
 {
@@ -38,8 +38,38 @@ namespace kong
             //! See IReferenceCounted::drop() for more information.
             virtual IAnimatedMesh* createMesh(io::IReadFile* file);
 
+            //! returns the material files the last mesh was read with
+            virtual void getDependencies(core::Array<io::path>& files) const;
+
         private:
 
+            //! Maps the (v, vt, vn) indices of a face corner to its mesh buffer vertex.
+            /** Open addressing hash table kept in one array, so adding a vertex
+            never allocates a node and a lookup never compares vertex data. */
+            struct SObjVertexMap
+            {
+                SObjVertexMap() : Mask(0), Used(0) {}
+
+                //! Returns the vertex of the corner, or stores and returns newVertex if the corner is new.
+                s32 findOrInsert(const s32* idx, s32 newVertex);
+
+                //! Makes room for at least count corners without rehashing.
+                void reserve(u32 count);
+
+            private:
+                struct SEntry
+                {
+                    s32 Idx[3];
+                    s32 Vertex;
+                };
+
+                static u32 hash(const s32* idx);
+
+                core::Array<SEntry> Entries;
+                u32 Mask;
+                u32 Used;
+            };
+
             struct SObjMtl
             {
                 SObjMtl() : Meshbuffer(0), Bumpiness(1.0f), Illumination(0),
@@ -61,7 +91,7 @@ namespace kong
                     Meshbuffer->material_ = o.Meshbuffer->material_;
                 }
 
-                core::Map<video::S3DVertex, int> VertMap;
+                SObjVertexMap VertMap;
                 scene::SMeshBuffer *Meshbuffer;
                 core::stringc Name;
                 core::stringc Group;
@@ -70,6 +100,37 @@ namespace kong
                 bool RecalculateNormals;
             };
 
+            //! A face or a statement which changes the loader state, read by a chunk worker
+            struct SObjStatement
+            {
+                //! start of the line in the file
+                const c8* Line;
+                //! face corners in SObjChunk::Corners, three numbers per corner
+                u32 FirstCorner;
+                u32 CornerCount;
+                //! number of v, vt and vn records the chunk had read before this line
+                u32 PositionCount;
+                u32 TexCoordCount;
+                u32 NormalCount;
+            };
+
+            //! Part of the file which ends at a line break, parsed independently of the others
+            struct SObjChunk
+            {
+                const c8* Begin;
+                const c8* End;
+                core::Array<core::vector3df> Positions;
+                core::Array<core::vector3df> Normals;
+                core::Array<core::vector2df> TexCoords;
+                //! faces and state changes in file order, merged serially afterwards
+                core::Array<SObjStatement> Statements;
+                //! v/vt/vn numbers of the face corners as written in the file
+                core::Array<s32> Corners;
+            };
+
+            //! Reads the vertex data and face corners of a chunk, can run on any thread
+            void parseChunk(SObjChunk& chunk, const c8* const bufEnd);
+
             // helper method for material reading
             const c8* readTextures(const c8* bufPtr, const c8* const bufEnd, SObjMtl* currMaterial, const io::path& relPath);
 
@@ -83,8 +144,8 @@ namespace kong
             u32 copyWord(c8* outBuf, const c8* inBuf, u32 outBufLength, const c8* const pBufEnd);   
             // copies the current word from the inBuf to the outBuf
             u32 copyWordIgnorSpace(c8* outBuf, const c8* inBuf, u32 outBufLength, const c8* const pBufEnd);
-            // copies the current line from the inBuf to the outBuf
-            core::stringc copyLine(const c8* inBuf, const c8* const bufEnd);
+            // returns a pointer to the line break which ends the current line
+            const c8* goLineEnd(const c8* buf, const c8* const bufEnd);
 
             // combination of goNextWord followed by copyWord
             const c8* goAndCopyNextWord(c8* outBuf, const c8* inBuf, u32 outBufLength, const c8* const pBufEnd);
@@ -98,6 +159,11 @@ namespace kong
             //! Find and return the material with the given name
             SObjMtl* findMtl(const core::stringc& mtlName, const core::stringc& grpName);
 
+            //! Returns the file contents, copy receives the buffer to delete if the file is not mapped
+            const c8* getFileContents(io::IReadFile* file, c8*& copy);
+
+            //! Go to the next word and read a float in place
+            const c8* readFloat(const c8* bufPtr, f32& value, const c8* const bufEnd);
             //! Read RGB color
             const c8* readColor(const c8* bufPtr, video::SColor& color, const c8* const pBufEnd);
             //! Read 3d vector of floats
@@ -108,16 +174,26 @@ namespace kong
             const c8* readBool(const c8* bufPtr, bool& tf, const c8* const bufEnd);
 
             // reads and convert to integer the vertex indices in a line of obj file's face statement
-            // -1 for the index if it doesn't exist
-            // indices are changed to 0-based index instead of 1-based from the obj file
-            bool retrieveVertexIndices(c8* vertexData, s32* idx, const c8* bufEnd, u32 vbsize, u32 vtsize, u32 vnsize);
+            // 0 for the index if it doesn't exist, the numbers are kept as written in the file
+            // returns a pointer to the end of the vertex data
+            const c8* retrieveVertexIndices(const c8* vertexData, s32* idx, const c8* bufEnd);
+
+            // changes the indices to 0-based index instead of 1-based from the obj file
+            // relative indices are resolved with the buffer sizes, -1 for the index if it doesn't exist
+            void convertVertexIndices(s32* idx, u32 vbsize, u32 vtsize, u32 vnsize);
 
             void cleanUp();
 
             scene::ISceneManager* SceneManager;
             io::IFileSystem* FileSystem;
 
+            //! workers for large files, created with the first one
+            core::CThreadPool* ThreadPool;
+
             core::Array<SObjMtl*> Materials;
+
+            //! absolute names of the material files read by the last createMesh call
+            core::Array<io::path> MaterialFiles;
         };
 
     } // end namespace scene
@@ -16,6 +16,11 @@
 namespace kong
 {
     class CKongDeviceWin32;
+
+    namespace core
+    {
+        class CThreadPool;
+    }
 }
 
 namespace kong
@@ -24,6 +29,9 @@ namespace kong
     {
         class COpenGLFBOTexture;
         class COpenGLFBODepthTexture;
+        class COpenGLTextureStreamer;
+        class COpenGLResidencyManager;
+        class COpenGLTexture;
 
         void CheckErrorCode();
 
@@ -64,6 +72,15 @@ namespace kong
             //! Draws a mesh buffer
             void DrawMeshBuffer(const scene::IMeshBuffer* mesh_buffer) override;
 
+            //! Draws a mesh buffer once for every world transform
+            void DrawMeshBufferInstanced(const scene::IMeshBuffer* mesh_buffer, const core::Matrixf* transforms, u32 count) override;
+
+            //! Remove hardware buffer
+            void RemoveHardwareBuffer(const scene::IMeshBuffer* mesh_buffer) override;
+
+            //! Remove all hardware buffers
+            void RemoveAllHardwareBuffers() override;
+
             //! Creates an empty software image.
             IImage* CreateImage(ECOLOR_FORMAT format, const core::Dimension2d<u32>& size) override;
 
@@ -85,6 +102,21 @@ namespace kong
             //! Get access to a named texture.
             ITexture* GetTexture(io::IReadFile* file) override;
 
+            //! Get access to a named texture without waiting for it to be loaded.
+            ITexture* GetTextureAsync(const io::path& filename) override;
+
+            //! Returns the number of textures which still show their placeholder
+            u32 GetPendingTextureCount() const override;
+
+            //! Sets how many bytes of streamed textures are uploaded per frame at most
+            void SetTextureUploadBudget(u32 bytes) override;
+
+            //! Sets how many bytes of video memory textures and render targets should use at most
+            void SetTextureMemoryBudget(u32 bytes) override;
+
+            //! Returns the bytes of video memory used by textures and render targets
+            u32 GetTextureMemorySize() const override;
+
             //! Creates an empty texture of specified size.
             ITexture* AddTexture(const core::Dimension2d<u32>& size,
                 const io::path& name, ECOLOR_FORMAT format = ECF_A8R8G8B8) override;
@@ -107,6 +139,9 @@ namespace kong
             //! Returns whether disabling was successful or not.
             bool DisableTextures(u32 fromStage = 0);
 
+            //! Returns whether textures of a block compressed format can be uploaded without decompressing them
+            bool IsCompressedFormatSupported(ECOLOR_FORMAT format) const;
+
             //! Returns a pointer to the mesh manipulator.
             scene::IMeshManipulator* GetMeshManipulator() override;
 
@@ -156,6 +191,25 @@ namespace kong
             //! End shadow rendering
             void EndShadowRender() override;
 
+            //! Begin rendering a cascade of the shadow map
+            void BeginShadowCascade(u32 cascade, const core::Matrixf& view, const core::Matrixf& projection, f32 split_depth) override;
+
+            //! Returns the maximal amount of cascades the shadow map can be split into
+            u32 GetMaximalShadowCascadeAmount() const override;
+
+            //! Returns the size of one cascade of the shadow map in texels
+            const core::Dimension2d<u32>& GetShadowTextureSize() const override;
+
+            //! Returns 0, only the deferred shader driver has a shadow atlas
+            u32 GetShadowAtlasSize() const override;
+
+            //! Adds a view of a light which is sampled from a tile of the shadow atlas
+            void AddShadowAtlasView(u32 light, const core::rect<s32>& tile, const core::Matrixf& view,
+                const core::Matrixf& projection, f32 split_depth) override;
+
+            //! Begin rendering a tile of the shadow atlas
+            void BeginShadowAtlasTile(const core::rect<s32>& tile, const core::Matrixf& view, const core::Matrixf& projection) override;
+
             //! Sets a new viewport.
             void setViewPort(const core::rect<s32>& area) override;
 
@@ -176,6 +230,9 @@ namespace kong
             // Render fxaa pass
             void RenderFxaaPass() override;
 
+            //! Make a screenshot of the last rendered frame.
+            IImage* CreateScreenShot() override;
+
         protected:
             virtual void UpdateMaxSupportLights();
 
@@ -187,35 +244,6 @@ namespace kong
                 ERM_3D		// 3d rendering mode
             };
 
-            //! normal map lookup 32 bit version
-            inline f32 nml32(int x, int y, int pitch, int height, s32 *p) const
-            {
-                if (x < 0)
-                    x = pitch - 1;
-                if (x >= pitch)
-                    x = 0;
-                if (y < 0)
-                    y = height - 1;
-                if (y >= height)
-                    y = 0;
-                return (f32)(((p[(y * pitch) + x]) >> 16) & 0xff);
-            }
-
-            //! normal map lookup 16 bit version
-            inline f32 nml16(int x, int y, int pitch, int height, s16 *p) const
-            {
-                if (x < 0)
-                    x = pitch - 1;
-                if (x >= pitch)
-                    x = 0;
-                if (y < 0)
-                    y = height - 1;
-                if (y >= height)
-                    y = 0;
-
-                return (f32)getAverage(p[(y * pitch) + x]);
-            }
-
             struct SSurface
             {
                 video::ITexture* Surface;
@@ -250,6 +278,21 @@ namespace kong
             //! opens the file and loads it into the surface
             video::ITexture* LoadTextureFromFile(io::IReadFile* file, const io::path& hashName = "");
 
+            //! loads the compressed copy of the file if it is up to date, else loads the file and writes the copy
+            video::ITexture* LoadCachedTexture(io::IReadFile* file);
+
+            //! decodes the file like LoadCachedTexture, safe to call from worker threads
+            /** \param thread_pool Threads which compress the image, 0 to compress on the calling thread. */
+            IImage* LoadCachedImage(io::IReadFile* file, core::CThreadPool* thread_pool);
+
+            //! raises the streaming priority of the pending textures of the current material
+            /** \param world Transformation of the mesh buffer, whose screen area is the priority. */
+            void UpdateStreamingPriority(const scene::IMeshBuffer* mesh_buffer, const core::Matrixf& world);
+
+            //! streams an evicted texture from its file again
+            /** \return False if the file can not be opened. */
+            bool ReloadTexture(COpenGLTexture* texture);
+
             //! creates a transposed matrix in supplied GLfloat array to pass to OpenGL
             inline void GetGLMatrix(f32 gl_matrix[16], const core::Matrixf& m);
             inline void GetGLTextureMatrix(f32 gl_matrix[16], const core::Matrixf& m);
@@ -333,6 +376,9 @@ namespace kong
             core::Matrixf texture_flip_matrix_;
             s32 max_support_lights_;
 
+            //! largest anisotropy a texture filter can use, 0 without anisotropic filtering
+            f32 max_anisotropy_;
+
             //! shadow depth texture
             COpenGLFBOTexture *shadow_color_texture_;
             COpenGLFBODepthTexture *shadow_depth_texture_;
@@ -344,6 +390,18 @@ namespace kong
             //! mesh manipulator
             scene::IMeshManipulator* mesh_manipulator_;
 
+            //! threads which compress textures
+            core::CThreadPool* thread_pool_;
+
+            //! decodes the textures of GetTextureAsync
+            COpenGLTextureStreamer* texture_streamer_;
+
+            //! bytes of streamed textures uploaded per frame
+            u32 texture_upload_budget_;
+
+            //! keeps the video memory of the textures below the budget
+            COpenGLResidencyManager* residency_manager_;
+
             //! light array
             core::Array<SLight> lights_;
 
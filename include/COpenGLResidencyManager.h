@@ -0,0 +1,78 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _COPENGLRESIDENCYMANAGER_H_
+#define _COPENGLRESIDENCYMANAGER_H_
+
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_OPENGL_
+
+#include "KongTypes.h"
+#include "Array.h"
+#include <functional>
+
+namespace kong
+{
+    namespace video
+    {
+        class COpenGLTexture;
+
+        //! Keeps the video memory of the textures below a budget.
+        /** Textures which were not bound in the last frame are evicted first, the least
+        recently bound one first. If the textures of one frame do not fit either, the
+        largest of them drop their top levels. Textures bound again get their levels back
+        as soon as they fit, from the kept image or from their file. */
+        class COpenGLResidencyManager
+        {
+        public:
+            //! loads the file of an evicted texture again, returns false if it can not be loaded
+            typedef std::function<bool(COpenGLTexture*)> ReloadFunction;
+
+            //! constructor, a budget of 0 keeps every texture resident
+            COpenGLResidencyManager(const ReloadFunction& reload, u32 budget = 0);
+
+            //! Tracks the memory of a texture, which may drop levels and be evicted
+            void AddTexture(COpenGLTexture* texture);
+
+            //! Counts the memory of a render target, which always stays resident
+            void AddRenderTarget(const COpenGLTexture* render_target);
+
+            //! Sets the bytes of video memory the textures and render targets should not exceed
+            void SetBudget(u32 bytes);
+
+            //! Returns the budget, 0 if there is none
+            u32 GetBudget() const;
+
+            //! Returns the bytes of video memory used by the textures and render targets
+            u32 GetResidentSize() const;
+
+            //! Marks the texture as bound in the current frame
+            void UseTexture(const COpenGLTexture* texture) const;
+
+            //! Ends the frame and evicts, drops or restores levels until the budget is kept
+            /** \return True if levels were uploaded, which binds the textures to the active unit. */
+            bool Update();
+
+        private:
+            //! returns true if the texture was bound in the frame which just ended
+            bool IsUsed(const COpenGLTexture* texture) const;
+
+            //! returns the index of the least recently bound texture which is not used and can be evicted, -1 if there is none
+            s32 FindEvictable() const;
+
+            //! returns the index of the largest texture which can drop a level, -1 if there is none
+            s32 FindDroppable() const;
+
+            ReloadFunction reload_;
+            core::Array<COpenGLTexture*> textures_;
+            u32 render_target_size_;
+            u32 budget_;
+            u32 frame_;
+        };
+
+    } // end namespace video
+} // end namespace kong
+
+#endif
+#endif
@@ -6,6 +6,8 @@
 #include "COpenGLDriver.h"
 #include "IFileSystem.h"
 #include "IShaderHelper.h"
+#include "EHardwareBufferFlags.h"
+#include "Map.h"
 
 namespace kong
 {
@@ -32,27 +34,12 @@ namespace kong
             SL_COUNT
         };
 
-        enum MATERIAL_VAL_TYPE
+        //! binding points of the uniform blocks
+        enum SHADER_UNIFORM_BLOCK_TYPE
         {
-            SL_MAT_AMBIENT,
-            SL_MAT_DIFFUSE,
-            SL_MAT_SPECULAR,
-            SL_MAT_EMISSIVE,
-            SL_MAT_SHININESS,
-            SL_MATERIAL_COUNT
-        };
-
-        enum LIGHT_VAL_TYPE
-        {
-            SL_LIGHT_POSITION,
-            SL_LIGHT_DIRECTION,
-            SL_LIGHT_AMBIENT,
-            SL_LIGHT_DIFFUSE,
-            SL_LIGHT_SPECULAR,
-            SL_LIGHT_ATTENUATION,
-            SL_LIGHT_EXPONENT,
-            SL_LIGHT_CUTOFF,
-            SL_LIGHT_COUNT
+            SUB_MATERIAL = 0,
+            SUB_LIGHTS,
+            SUB_COUNT
         };
 
         const c8 *const shader_uniform_name[] = 
@@ -76,29 +63,59 @@ namespace kong
             nullptr
         };
 
-        const c8 *const material_uniform_name[] =
+        const c8 *const shader_uniform_on_name[] =
         {
-            "material.ambient",
-            "material.diffuse",
-            "material.specular",
-            "material.emissive",
-            "material.shininess",
+            "texture0_on",
+            "texture1_on",
+            "texture2_on",
+            "texture3_on",
+            "texture4_on",
+            "texture5_on",
+            "texture6_on",
+            "texture7_on",
+            "light0_on",
+            "light1_on",
+            "light2_on",
+            "light3_on",
+            "position_tex_on",
+            "normal_tex_on",
+            "diffuse_tex_on",
+            "shadow_tex_on",
             nullptr
         };
 
-        const c8 *const light_uniform_name[] =
+        const c8 *const shader_uniform_block_name[] =
         {
-            "position",
-            "direction",
-            "ambient",
-            "diffuse",
-            "specular",
-            "attenuation",
-            "exponent",
-            "cutoff",
+            "MaterialBlock",
+            "LightBlock",
             nullptr
         };
 
+        //! std140 layout of struct Material in the shaders
+        struct SShaderMaterial
+        {
+            f32 ambient[4];
+            f32 diffuse[4];
+            f32 specular[4];
+            f32 emissive[4];
+            f32 shininess;
+            f32 padding[3];
+        };
+
+        //! std140 layout of struct Light in the shaders
+        struct SShaderLight
+        {
+            f32 position[4];
+            f32 direction[4];
+            f32 ambient[4];
+            f32 diffuse[4];
+            f32 specular[4];
+            f32 attenuation[4];
+            f32 exponent;
+            f32 cutoff;
+            f32 padding[2];
+        };
+
         class COpenGLShaderDriver : public COpenGLDriver
         {
         public:
@@ -118,6 +135,15 @@ namespace kong
             //! Draws a mesh buffer
             void DrawMeshBuffer(const scene::IMeshBuffer* mesh_buffer) override;
 
+            //! Draws a mesh buffer once for every world transform
+            void DrawMeshBufferInstanced(const scene::IMeshBuffer* mesh_buffer, const core::Matrixf* transforms, u32 count) override;
+
+            //! Remove hardware buffer
+            void RemoveHardwareBuffer(const scene::IMeshBuffer* mesh_buffer) override;
+
+            //! Remove all hardware buffers
+            void RemoveAllHardwareBuffers() override;
+
             //! sets the current Texture
             //! Returns whether setting was a success or not.
             bool SetActiveTexture(u32 stage, const video::ITexture* texture) override;
@@ -140,10 +166,111 @@ namespace kong
             //! End shadow rendering
             void EndShadowRender() override;
 
+            //! Begin rendering a cascade of the shadow map
+            void BeginShadowCascade(u32 cascade, const core::Matrixf& view, const core::Matrixf& projection, f32 split_depth) override;
+
+            //! Returns the maximal amount of cascades the shadow map can be split into
+            u32 GetMaximalShadowCascadeAmount() const override;
+
             //! Enable shadows.
             void EnableShadow(bool flag) override;
 
         protected:
+            //! compact layout of the vertices in a vertex buffer
+            /** The positions come first as their own stream, so passes which only read
+            positions fetch less memory. The other attributes follow interleaved: normal,
+            color, texture coordinate and for tangent layouts tangent and binormal.
+            Normals, tangents and binormals are packed into 10:10:10:2 integers. */
+            struct SVertexLayout
+            {
+                //! positions are 16 bit fractions of the bounding box instead of floats
+                bool quantized_positions_;
+                //! texture coordinates are half floats
+                bool half_texcoords_;
+                bool tangents_;
+
+                u32 attribute_offset_;
+                u32 attribute_stride_;
+
+                //! position_scale and position_offset of the shaders, restore quantized positions
+                f32 position_scale_[4];
+                f32 position_offset_[4];
+            };
+
+            //! gpu copy of a mesh buffer
+            struct SHWBufferLink
+            {
+                SHWBufferLink(const scene::IMeshBuffer* mesh_buffer)
+                    : mesh_buffer_(mesh_buffer), vertices_(nullptr), vao_(0), vbo_(0), ebo_(0),
+                    vbo_size_(0), ebo_size_(0), changed_id_vertex_(0), changed_id_index_(0),
+                    mapping_vertex_(scene::EHM_NEVER), mapping_index_(scene::EHM_NEVER),
+                    tangent_layout_(false), expanded_(false), attributes_set_(false), instancing_on_(false),
+                    wire_link_(nullptr)
+                {
+                }
+
+                const scene::IMeshBuffer *mesh_buffer_;
+                //! vertex array the buffer was uploaded from, catches reused mesh buffer addresses
+                const void *vertices_;
+
+                u32 vao_;
+                u32 vbo_;
+                u32 ebo_;
+                u32 vbo_size_;
+                u32 ebo_size_;
+
+                u32 changed_id_vertex_;
+                u32 changed_id_index_;
+                scene::E_HARDWARE_MAPPING mapping_vertex_;
+                scene::E_HARDWARE_MAPPING mapping_index_;
+
+                bool tangent_layout_;
+
+                //! the vertices are not indexed, every three vertices are a triangle
+                bool expanded_;
+                bool attributes_set_;
+
+                //! the instance transform attributes are enabled in the vertex array
+                bool instancing_on_;
+
+                SVertexLayout layout_;
+
+                //! expanded copy for wireframe draws, created when the buffer is drawn as wireframe
+                /** The shaders derive the barycentric coordinates of the wireframe from the
+                vertex id, so they are not stored in the vertices. */
+                SHWBufferLink *wire_link_;
+            };
+
+            //! draw a mesh buffer with the normal or tangent vertex layout
+            void DrawHardwareBuffer(const scene::IMeshBuffer* mesh_buffer, bool tangent_layout);
+
+            //! returns the gpu copy of a mesh buffer, creates it if needed
+            /** Buffers mapped as EHM_NEVER share stream_link_ and are
+            uploaded again on every draw. */
+            SHWBufferLink *GetBufferLink(const scene::IMeshBuffer* mesh_buffer);
+
+            //! creates a link with new buffer objects
+            SHWBufferLink *CreateBufferLink(const scene::IMeshBuffer* mesh_buffer) const;
+
+            //! uploads changed vertices and indices of a link, binds its vertex array
+            /** \return the link to draw, the expanded copy in wireframe mode */
+            SHWBufferLink *UpdateHardwareBuffer(SHWBufferLink *link, bool tangent_layout);
+
+            //! packs the vertices of a mesh buffer into packed_vertices_
+            /** \param expand copy the vertex of every index instead of every vertex */
+            void PackVertices(const scene::IMeshBuffer* mesh_buffer, bool tangent_layout, bool expand, SVertexLayout& layout);
+
+            //! sets the vertex attribute pointers of the currently bound vertex array
+            void SetVertexAttributes(const SHWBufferLink *link) const;
+
+            //! uploads position_scale and position_offset of a link's layout to the current program
+            void SetPositionTransform(const SHWBufferLink *link);
+
+            //! enables or disables the per instance transforms in the currently bound vertex array
+            void SetInstanceAttributes(SHWBufferLink *link, bool on) const;
+
+            void DeleteHardwareBuffer(SHWBufferLink *link) const;
+
             //! draw a normal mesh buffer depended on its type
             virtual void DrawNormalMeshBuffer(const scene::IMeshBuffer* mesh_buffer);
 
@@ -152,10 +279,15 @@ namespace kong
 
             void UpdateMaxSupportLights() override;
 
-            void SetMaterialUniform(s32 material_val_type, const void *val) const;
-            void SetMaterialUniform(s32 material_val_type, f32 val) const;
-            virtual void SetLightUniform(s32 light_idx, s32 light_val_type, const void *val) const;
-            virtual void SetLightUniform(s32 light_idx, s32 light_val_type, f32 val) const;
+            //! connect the uniform blocks of a program to the driver's uniform buffers
+            void BindUniformBlocks(IShaderHelper *shader_helper) const;
+
+            //! write the light at idx into the light uniform buffer
+            void UpdateLightBlock(u32 idx, const SLight& light) const;
+
+            //! uploads the transforms and split depths of the shadow cascades to the current program
+            void SetShadowCascadeUniforms() const;
+
             void Enable(s32 idx) const;
             void Disable(s32 idx) const;
             const c8 *GetUniformName(s32 idx) const;
@@ -165,10 +297,43 @@ namespace kong
             IShaderHelper *base_shader_helper_;
             IShaderHelper *fxaa_shader_helper_;
 
+            //! shared buffers for EHM_NEVER mesh buffers and helper geometry
             u32 vao_;
             u32 vbo_;
             u32 ebo_;
 
+            //! world transforms of the instances of DrawMeshBufferInstanced()
+            u32 instance_vbo_;
+            u32 instance_vbo_size_;
+
+            //! uniform buffers for the material and light blocks
+            u32 uniform_buffers_[SUB_COUNT];
+            SShaderMaterial material_block_;
+
+            //! program and value of the last normal_mapping_on upload, uniforms belong to a program
+            const IShaderHelper *normal_mapping_program_;
+            bool normal_mapping_on_;
+
+            //! program and values of the last position_scale and position_offset upload
+            const IShaderHelper *position_program_;
+            f32 position_scale_[4];
+            f32 position_offset_[4];
+
+            //! vertices packed for the upload, kept to avoid allocations
+            core::Array<u8> packed_vertices_;
+
+            //! capacity of the light block, NR_LIGHTS in the shaders
+            u32 nr_lights_;
+
+            //! light view projection transforms and split depths of the cascades rendered since BeginShadowRender()
+            core::Matrixf shadow_cascade_transforms_[MAX_SHADOW_CASCADES];
+            f32 shadow_cascade_splits_[MAX_SHADOW_CASCADES];
+            u32 shadow_cascade_count_;
+
+            //! gpu copies of the drawn mesh buffers
+            core::Map<const scene::IMeshBuffer*, SHWBufferLink*> hw_buffer_map_;
+            SHWBufferLink stream_link_;
+
             io::SPath vertex_path_;
             io::SPath fragment_path_;
         };
@@ -7,6 +7,7 @@
 #include "SPath.h"
 #include "IShaderHelper.h"
 #include "IFileSystem.h"
+#include <unordered_map>
 
 namespace kong
 {
@@ -34,14 +35,32 @@ namespace kong
             void SetVec2i(const std::string &name, const s32 *vec2) const override;
             void SetVec4(const std::string &name, const f32 *vec4) const override;
 
+            s32 GetUniformLocation(const std::string &name) const override;
+
+            // uniform set functions by location
+            void SetBool(s32 location, bool value) const override;
+            void SetInt(s32 location, s32 value) const override;
+            void SetFloat(s32 location, f32 value) const override;
+            void SetMatrix4(s32 location, const core::Matrixf &mat) const override;
+            void SetVec2(s32 location, const f32 *vec2) const override;
+            void SetVec4(s32 location, const f32 *vec4) const override;
+
+            bool BindUniformBlock(const std::string &name, u32 binding) const override;
+
         private:
             void InitShader(const io::SPath &vertex_path, const io::SPath &fragment_path);
 
+            // fill the location table with all active uniforms of the linked program
+            void ResolveUniformLocations();
+
             // program id
             unsigned int id_;
 
             // file system
             io::IFileSystem *file_system_;
+
+            // uniform name to location table
+            std::unordered_map<std::string, s32> uniform_locations_;
         };
     } // end namespace video
 } // end namespace kong
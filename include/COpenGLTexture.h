@@ -7,6 +7,7 @@
 
 #include "ITexture.h"
 #include "IImage.h"
+#include "SMaterialLayer.h"
 
 #include "KongCompileConfig.h"
 #include "EGBufferType.h"
@@ -42,9 +43,18 @@
 
 namespace kong
 {
+    namespace core
+    {
+        class CThreadPool;
+    }
+
     namespace video
     {
         class COpenGLDriver;
+
+        //! Largest side of the levels an evicted texture keeps resident
+        const u32 EVICTED_TEXTURE_SIZE = 32;
+
         //! OpenGL texture.
         class COpenGLTexture : public ITexture
         {
@@ -103,7 +113,86 @@ namespace kong
             //! sets whether this texture is intended to be used as a render target.
             void SetIsRenderTarget(bool isTarget);
 
+            //! Sets filter, wrap mode and lod bias of the texture from a material layer
+            /** Only the parameters which differ from the last layer are sent to OpenGL.
+            Render targets keep the parameters they were created with.
+            \param stage Texture unit the texture is bound to.
+            \param max_anisotropy Largest anisotropy of the driver, 0 if it has no anisotropic filtering. */
+            void SetSamplerState(u32 stage, const SMaterialLayer& layer, f32 max_anisotropy) const;
+
+            //! Replaces the content of the texture, which may change its size and format
+            /** Block compressed images are uploaded as they are if the driver supports
+            their format, other images are converted to ECF_A8R8G8B8.
+            \param mipmapData Levels after level 0 in ECF_A8R8G8B8, if not set the levels
+            stored in the image are used or filtered from level 0. */
+            void SetImage(IImage* image, void* mipmapData = nullptr);
+
+            //! Converts the kept image to another format and uploads it again
+            /** Block compressed textures are decompressed to ECF_A8R8G8B8, ECF_A8R8G8B8
+            textures are compressed to one of the formats CBlockCompression can encode.
+            The levels are filtered as IsSRGB() tells.
+            \return True if the texture has the format afterwards. */
+            bool ConvertImage(ECOLOR_FORMAT format, core::CThreadPool* thread_pool = nullptr);
+
+            //! Sets whether the colors are stored in sRGB, false for data like normals
+            /** Decides how the levels are filtered, levels which already exist are not changed. */
+            void SetSRGB(bool srgb);
+
+            //! Returns whether the colors are stored in sRGB, true unless it was set otherwise
+            bool IsSRGB() const;
+
+            //! Returns the bytes of video memory used by the resident levels
+            u32 GetMemorySize() const;
+
+            //! Returns the bytes of video memory the levels from first_level on need
+            u32 GetLevelsMemorySize(u32 first_level) const;
+
+            //! Returns the amount of levels of the complete texture, including level 0
+            u32 GetLevelCount() const;
+
+            //! Returns the level which is resident as OpenGL level 0, 0 if no level was dropped
+            u32 GetFirstResidentLevel() const;
+
+            //! Returns the first level an evicted texture keeps, 0 if the texture can not drop levels
+            u32 GetEvictedLevel() const;
+
+            //! Uploads the levels from level on again and releases the larger ones
+            /** The levels are created from the kept image. GetSize still returns the size of
+            level 0, so texture coordinates and sampler states stay the same.
+            \return False if there is no kept image or the texture is a render target. */
+            bool SetFirstResidentLevel(u32 level);
+
+            //! Drops all levels larger than EVICTED_TEXTURE_SIZE
+            /** If the texture can be loaded from its file again, the kept image is released as
+            well and the texture can not be locked until it is restored. */
+            bool Evict();
+
+            //! Returns true if the levels can be restored without loading the file again
+            bool HasKeptImage() const;
+
+            //! Sets whether the name of the texture is the file it was loaded from
+            void SetHasSourceFile(bool has_source_file);
+
+            //! Returns whether the name of the texture is the file it was loaded from
+            bool HasSourceFile() const;
+
+            //! Sets the frame the texture was bound in the last time
+            void SetLastUseFrame(u32 frame) const;
+
+            //! Returns the frame the texture was bound in the last time
+            u32 GetLastUseFrame() const;
+
         protected:
+            //! texture parameters last sent to OpenGL
+            struct SSamplerState
+            {
+                GLint min_filter_;
+                GLint mag_filter_;
+                GLint wrap_u_;
+                GLint wrap_v_;
+                f32 anisotropy_;
+                f32 lod_bias_;
+            };
 
             //! protected constructor with basic setup, no GL texture name created, for derived classes
             COpenGLTexture(const io::path& name, COpenGLDriver* driver);
@@ -124,6 +213,24 @@ namespace kong
             \param mipLevel If set to non-zero, only that specific miplevel is updated, using the MipImage member. */
             void UploadTexture(bool newTexture = false, void* mipmapData = 0, u32 mipLevel = 0);
 
+            //! uploads the mip map levels after level 0 into the bound texture
+            /** \param mipmapData The levels one after another, if not set they are filtered from image_. */
+            void UploadMipMapLevels(void* mipmapData);
+
+            //! uploads a block compressed image and its stored mip map levels as they are
+            /** Compressed textures can not be locked.
+            \param first_level First stored level, which becomes OpenGL level 0. */
+            void UploadCompressedTexture(IImage* image, u32 first_level = 0);
+
+            //! uploads the levels of the kept image from first_level on, filtered from level 0
+            void UploadFilteredLevels(u32 first_level);
+
+            //! defines the OpenGL levels from first_level on with no texels, which releases their memory
+            void ReleaseLevels(u32 first_level, u32 level_count);
+
+            //! binds the texture and sets the default filter and wrap mode
+            void BindWithDefaultParameters();
+
             core::Dimension2d<u32> image_size_;
             core::Dimension2d<u32> texture_size_;
             ECOLOR_FORMAT ColorFormat;
@@ -143,6 +250,18 @@ namespace kong
             bool AutomaticMipmapUpdate;
             bool ReadOnlyLock;
             bool KeepImage;
+            bool has_source_file_;
+            bool srgb_;
+
+            //! levels of the complete texture and the first of them which is resident
+            u32 level_count_;
+            u32 first_level_;
+
+            //! bytes of video memory of the resident levels
+            u32 memory_size_;
+
+            mutable u32 last_use_frame_;
+            mutable SSamplerState sampler_state_;
         };
 
         //! OpenGL FBO texture.
@@ -178,7 +297,10 @@ namespace kong
         {
         public:
             //! FrameBufferObject depth constructor
-            COpenGLFBODepthTexture(const core::Dimension2d<u32>& size, const io::path& name, COpenGLDriver* driver = 0, bool useStencil = false);
+            /** \param layers With more than one layer the depth texture is a texture array,
+            like the cascades of a shadow map. Layers need useStencil. */
+            COpenGLFBODepthTexture(const core::Dimension2d<u32>& size, const io::path& name, COpenGLDriver* driver = 0, bool useStencil = false,
+                u32 layers = 1);
 
             //! destructor
             virtual ~COpenGLFBODepthTexture();
@@ -191,10 +313,20 @@ namespace kong
 
             bool attach(ITexture*);
 
+            //! Attaches a layer of the texture array as depth buffer of the bound frame buffer
+            void AttachLayer(u32 layer) const;
+
+            //! Returns the amount of layers
+            u32 GetLayerCount() const;
+
+            //! Returns GL_TEXTURE_2D_ARRAY for textures with layers, otherwise GL_TEXTURE_2D
+            GLenum GetOpenGLTextureTarget() const;
+
         protected:
             GLuint DepthRenderBuffer;
             GLuint StencilRenderBuffer;
             bool UseStencil;
+            u32 layers_;
         };
 
         class COpenGLFBODeferredTexture : public COpenGLTexture
@@ -0,0 +1,110 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _COPENGLTEXTURESTREAMER_H_
+#define _COPENGLTEXTURESTREAMER_H_
+
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_OPENGL_
+
+#include "IImage.h"
+#include "IReadFile.h"
+#include "ITexture.h"
+#include "Array.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kong
+{
+    namespace video
+    {
+        class COpenGLTexture;
+
+        //! Decodes texture files on worker threads and uploads them into placeholder textures.
+        /** The render thread adds requests and calls Update once per frame. Workers decode
+        the files of the textures with the largest on-screen size first, Update uploads the
+        decoded images in the same order until the byte budget of the frame is used up. */
+        class COpenGLTextureStreamer
+        {
+        public:
+            //! decodes a file into an image, called on the worker threads
+            typedef std::function<IImage*(io::IReadFile*)> DecodeFunction;
+
+            //! constructor, thread_count 0 means one thread per hardware core besides the render thread
+            explicit COpenGLTextureStreamer(const DecodeFunction& decode, u32 thread_count = 0);
+
+            //! stops the workers, textures which are still pending keep their placeholder
+            ~COpenGLTextureStreamer();
+
+            //! Queues a file to be decoded into the texture, the streamer deletes the file
+            void AddRequest(COpenGLTexture* texture, io::IReadFile* file);
+
+            //! Returns true if the texture still shows its placeholder
+            bool IsPending(const ITexture* texture) const;
+
+            //! Returns the number of textures which are not uploaded yet
+            u32 GetPendingCount() const;
+
+            //! Raises the priority of a pending texture for the next frame
+            /** \param screen_area Pixels covered by geometry which uses the texture. */
+            void RaisePriority(const ITexture* texture, f32 screen_area);
+
+            //! Uploads decoded images into their textures, the largest on-screen size first
+            /** At least one image is uploaded per call, so textures larger than the budget
+            do not wait forever.
+            \param byte_budget Bytes which should not be exceeded, including mip map levels.
+            \return Number of uploaded textures. */
+            u32 Update(u32 byte_budget);
+
+        private:
+            enum E_REQUEST_STATE
+            {
+                ERS_QUEUED,
+                ERS_DECODING,
+                ERS_DECODED
+            };
+
+            struct SRequest
+            {
+                COpenGLTexture* texture_;
+                io::IReadFile* file_;
+                IImage* image_;
+
+                //! largest screen area of the last frame, used by the workers and Update
+                f32 priority_;
+
+                //! largest screen area of the current frame, only used by the render thread
+                f32 frame_priority_;
+
+                E_REQUEST_STATE state_;
+            };
+
+            void WorkerLoop();
+
+            //! returns the index of the request in the state with the highest priority, -1 if there is none
+            /** mutex_ has to be locked. */
+            s32 FindRequest(E_REQUEST_STATE state) const;
+
+            //! returns the index of the request of the texture, -1 if it is not pending
+            s32 FindTexture(const ITexture* texture) const;
+
+            DecodeFunction decode_;
+
+            //! only changed by the render thread while mutex_ is locked
+            core::Array<SRequest*> requests_;
+
+            std::vector<std::thread> workers_;
+            mutable std::mutex mutex_;
+            std::condition_variable wake_condition_;
+            bool stop_;
+        };
+
+    } // end namespace video
+} // end namespace kong
+
+#endif
+#endif
@@ -0,0 +1,141 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CRENDERQUEUE_H_
+#define _CRENDERQUEUE_H_
+
+#include "Array.h"
+#include "Map.h"
+#include "Matrix.h"
+#include "SMaterial.h"
+#include "ERenderingMode.h"
+
+namespace kong
+{
+    namespace video
+    {
+        class IVideoDriver;
+        class ITexture;
+    } // end namespace video
+
+    namespace scene
+    {
+        class IMeshBuffer;
+
+        //! Collects the mesh buffers of a render pass and draws them sorted by render state.
+        /** Every item gets a 64 bit key, from the most to the least significant bits:
+        rendering mode, material type (the shader), texture set, a hash of the other
+        material values and mesh buffer.
+        Sorting by the key puts items with the same state next to each other, so the
+        driver only has to be told when the state really changes. Runs of the same mesh
+        buffer with the same material, like nodes sharing a mesh of the mesh cache, are
+        drawn with one instanced draw call. The queue only keeps pointers, the materials,
+        buffers and transforms have to live until Render(). Ids of buffers and texture
+        sets which were not added since the last Render() are given up, so removed
+        nodes and deleted buffers do not stay in the queue. */
+        class CRenderQueue
+        {
+        public:
+            CRenderQueue();
+
+            //! Adds a mesh buffer to draw with a material and a world transform
+            void Add(const IMeshBuffer* mesh_buffer, const video::SMaterial& material,
+                const core::Matrixf& transform, video::E_RENDERING_MODE rendering_mode = video::ERM_MESH);
+
+            //! Sorts and draws all items, then clears the queue.
+            void Render(video::IVideoDriver* driver);
+
+            //! Removes all items without drawing them
+            void Clear();
+
+            //! Returns the amount of items waiting for Render()
+            u32 GetItemCount() const;
+
+            //! Returns the amount of draw calls of the last Render() call, an instanced draw counts once
+            u32 GetDrawCallCount() const;
+
+            //! Returns the amount of items the last Render() call drew with instanced draws
+            u32 GetInstanceCount() const;
+
+            //! Returns the amount of SetMaterial() calls made by the last Render() call
+            u32 GetMaterialChangeCount() const;
+
+        private:
+            //! bit widths of the key fields
+            enum
+            {
+                KEY_BUFFER_BITS = 24,
+                KEY_MATERIAL_BITS = 16,
+                KEY_TEXTURE_BITS = 16,
+                KEY_TYPE_BITS = 6,
+                KEY_MODE_BITS = 2
+            };
+
+            struct SRenderItem
+            {
+                bool operator<(const SRenderItem& other) const
+                {
+                    return key_ < other.key_;
+                }
+
+                u64 key_;
+                u32 texture_set_;
+                const IMeshBuffer* mesh_buffer_;
+                const video::SMaterial* material_;
+                const core::Matrixf* transform_;
+                video::E_RENDERING_MODE rendering_mode_;
+            };
+
+            //! textures of all layers of a material
+            struct STextureSet
+            {
+                bool operator<(const STextureSet& other) const;
+                bool operator==(const STextureSet& other) const;
+
+                const video::ITexture* textures_[video::MATERIAL_MAX_TEXTURES];
+            };
+
+            //! hashes the values compared by SMaterial::operator!= which are uploaded to the shaders
+            static u32 HashMaterial(const video::SMaterial& material);
+
+            //! returns true if the item can be drawn in the same instanced draw as the other item
+            static bool CanInstance(const SRenderItem& item, const SRenderItem& other);
+
+            //! id of a key and the frame it was last added in
+            struct SKeyId
+            {
+                u32 id_;
+                u32 frame_;
+            };
+
+            //! returns the id of the key, a new key gets the next free id.
+            /** The ids are kept over frames, so equal scenes sort equally. When a
+            field runs out of ids all ids of the map are given out again. */
+            template <typename K>
+            u32 GetId(core::Map<K, SKeyId>& ids, u32& next_id, const K& key, u32 bits) const;
+
+            //! removes the keys which were not added in the current frame.
+            /** The remaining keys are numbered again when half of the ids were given out. */
+            template <typename K>
+            void PruneIds(core::Map<K, SKeyId>& ids, u32& next_id, u32 bits) const;
+
+            core::Array<SRenderItem> items_;
+
+            //! world transforms of the current instanced draw, kept to avoid allocations
+            core::Array<core::Matrixf> instance_transforms_;
+
+            core::Map<STextureSet, SKeyId> texture_set_ids_;
+            core::Map<const IMeshBuffer*, SKeyId> buffer_ids_;
+            u32 next_texture_set_id_;
+            u32 next_buffer_id_;
+            u32 frame_;
+
+            u32 draw_calls_;
+            u32 instances_;
+            u32 material_changes_;
+        };
+
+    } // end namespace scene
+} // end namespace kong
+
+#endif
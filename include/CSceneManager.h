@@ -9,6 +9,9 @@
 #include "ICameraSceneNode.h"
 #include "IVideoDriver.h"
 #include "DefaultNodeEntry.h"
+#include "CDynamicAabbTree.h"
+#include "CRenderQueue.h"
+#include "CShadowAtlas.h"
 
 namespace kong
 {
@@ -17,6 +20,9 @@ namespace kong
     }
     namespace scene
     {
+        class CCompiledMeshFileLoader;
+        class CMeshCache;
+
         class CSceneManager : public ISceneManager, public ISceneNode
         {
         public:
@@ -89,6 +95,9 @@ namespace kong
             //! Enable shadows.
             virtual void EnableShadow(bool flag);
 
+            //! Sets how the shadows of a directional main light are split into cascades.
+            void SetShadowCascades(u32 count, f32 split_lambda = 0.75f, f32 max_distance = 0.f) override;
+
             //! Returns the current color of shadows.
             virtual video::SColor GetShadowColor() const;
 
@@ -113,6 +122,9 @@ namespace kong
             //! Draws all the scene nodes.
             virtual void DrawAll();
 
+            //! Get the pass timings and node counts of the last draw call.
+            const SRenderStatistics& GetRenderStatistics() const override;
+
             virtual video::IVideoDriver *GetVideoDriver() const;
 
             //! Registers a node for rendering it at a specific time.
@@ -121,6 +133,9 @@ namespace kong
             //! Get pointer to the mesh manipulator.
             virtual IMeshManipulator* GetMeshManipulator();
 
+            //! Get pointer to the mesh cache.
+            IMeshCache* GetMeshCache() override;
+
             //! returns the axis aligned bounding box of this node
             virtual const core::aabbox3d<f32>& GetBoundingBox() const;
 
@@ -129,6 +144,51 @@ namespace kong
 
         private:
 
+            //! loads the compiled copy of a mesh file if it is newer than the file and the files it was built from
+            IAnimatedMesh* LoadCompiledMesh(const io::path& filename);
+
+            //! writes the compiled copy of a parsed mesh file, with the files besides it the loader read
+            void WriteCompiledMesh(const io::path& filename, IAnimatedMesh* mesh, const IMeshLoader* loader);
+
+            //! culls the culling tree against the view frustum of the active camera
+            void BeginCulling();
+
+            //! removes the nodes which did not register this frame from the culling tree
+            void EndCulling();
+
+            //! returns true if the node is outside of the view frustum
+            bool IsCulled(ISceneNode* node);
+
+            //! compares a registered node to the last frame, adds its old and new box to the dirty boxes if it changed
+            void TrackNodeChanges(ISceneNode* node, s32 proxy, const core::aabbox3df& box, bool created);
+
+            //! returns true if a node changed in the part of the scene which throws shadows into the frustum of a light view
+            bool IsShadowViewDirty(const SViewFrustum& frustum) const;
+
+            //! fits the shadow camera of the light to the visible nodes and collects the nodes casting shadows onto them
+            void CollectShadowCasters(ILightSceneNode* light);
+
+            //! renders the shadow maps of the main light, one per cascade
+            void RenderShadowMaps(ILightSceneNode* light);
+
+            //! renders the shadow maps of the first lights into the shadow atlas of the driver
+            void RenderShadowAtlas(u32 light_count);
+
+            //! calculates the view space depth at the far end of each cascade of the active camera
+            void GetShadowSplits(u32 cascades, f32& split_near, f32* splits) const;
+
+            //! returns the part of the screen height a light covers, 1 for directional lights
+            f32 GetScreenCoverage(const video::SLight& light) const;
+
+            //! calculates the world space corners of the view between two view space depths
+            void GetViewSliceCorners(ICameraSceneNode* camera, f32 near_depth, f32 far_depth, core::vector3df* corners) const;
+
+            //! adds the buffers of the node to the render queue, renders nodes which can not be queued right away
+            void SubmitNode(ISceneNode* node);
+
+            //! draws the render queue and counts its state changes
+            void FlushRenderQueue();
+
             //! video driver
             video::IVideoDriver* driver_;
 
@@ -137,8 +197,34 @@ namespace kong
             core::Array<ISceneNode *> shadow_node_list_;
             core::Array<DefaultNodeEntry> solid_node_list_;
 
+            //! nodes rendered into the shadow map, filled by CollectShadowCasters()
+            core::Array<ISceneNode *> shadow_caster_list_;
+
+            //! a light with shadows in the shadow atlas
+            struct SShadowLight
+            {
+                ILightSceneNode* light_;
+
+                //! index of the light in the driver
+                u32 slot_;
+
+                //! atlas requests of the views of the light
+                u32 first_request_;
+                u32 view_count_;
+            };
+            core::Array<SShadowLight> shadow_light_list_;
+
+            //! shadow maps of all lights, used if the driver has a shadow atlas
+            CShadowAtlas shadow_atlas_;
+
             core::Array<IMeshLoader*> MeshLoaderList;
 
+            //! loader of the compiled copies, also in MeshLoaderList
+            CCompiledMeshFileLoader* compiled_mesh_loader_;
+
+            //! all meshes loaded by getMesh, keyed by absolute path
+            CMeshCache* mesh_cache_;
+
             video::SColor shadow_color_;
             video::SColor ambient_light_;
 
@@ -150,9 +236,47 @@ namespace kong
             // ! Render shadow
             bool shadow_enable_;
 
+            //! cascades of a directional main light, see SetShadowCascades()
+            u32 shadow_cascades_;
+            f32 shadow_split_lambda_;
+            f32 shadow_distance_;
+
             //! light index number
             s32 light_index_num_;
             s32 main_light_index_;
+
+            //! timings and node counts of the last frame
+            SRenderStatistics render_statistics_;
+
+            //! transformed bounding boxes of all nodes registered for rendering
+            CDynamicAabbTree culling_tree_;
+
+            //! view frustum of the active camera, valid if culling_enabled_
+            SViewFrustum view_frustum_;
+            bool culling_enabled_;
+
+            //! counts the frames, tags the visible and registered nodes in the culling tree
+            u32 culling_frame_;
+
+            //! a node in the culling tree as it was registered the last time
+            struct SProxyState
+            {
+                core::Matrixf transform_;
+                core::aabbox3df box_;
+                u32 geometry_id_;
+            };
+
+            //! states of the nodes in the culling tree, by proxy id
+            core::Array<SProxyState> proxy_states_;
+
+            //! proxies removed from the culling tree this frame
+            core::Array<s32> removed_proxies_;
+
+            //! boxes of the nodes which moved, changed, appeared or disappeared this frame, before and after
+            core::Array<core::aabbox3df> dirty_boxes_;
+
+            //! mesh buffers of the solid and shadow passes, sorted by render state
+            CRenderQueue render_queue_;
         };
     }
 }
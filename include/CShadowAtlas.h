@@ -0,0 +1,152 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CSHADOWATLAS_H_
+#define _CSHADOWATLAS_H_
+
+#include "Array.h"
+#include "Matrix.h"
+#include "Rect.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        //! Places the shadow maps of many lights as square tiles in one texture.
+        /** The atlas is a quad tree, every tile is a node, so a tile size is the atlas
+        size divided by a power of two. Tiles are owned by a light and a view of it,
+        like a cascade or a cube face. A view which asks for the same size as in the
+        last frame keeps its tile, also a smaller one it got from a full atlas, and
+        with it the content rendered into it, so the shadow maps of lights which
+        did not change need not be rendered again. */
+        class CShadowAtlas
+        {
+        public:
+            CShadowAtlas();
+
+            //! Sets the size of the atlas and of its smallest tile, frees all tiles if they change
+            void SetSize(u32 size, u32 min_tile_size);
+
+            //! Returns the size of the atlas in texels
+            u32 GetSize() const;
+
+            //! Returns the size of the smallest tile in texels
+            u32 GetMinTileSize() const;
+
+            //! Starts collecting the requests of a frame
+            void BeginFrame();
+
+            //! Asks for a tile of a view of a light
+            /** \param owner The light.
+            \param view Index of the view of the light.
+            \param size Wanted size in texels, it is rounded down to a tile size.
+            \param priority Requests with a higher priority are placed first.
+            \return Index of the request for GetTile(). */
+            u32 Request(const void* owner, u32 view, u32 size, f32 priority);
+
+            //! Places the requests of the frame
+            /** Views keeping their size keep their tile. The others are placed by
+            priority, if the atlas is full they get smaller tiles down to the
+            smallest tile size, or none at all. Tiles which were not requested
+            again are freed. */
+            void EndFrame();
+
+            //! Returns the tile of a request, an empty rectangle if it did not fit
+            const core::rect<s32>& GetTile(u32 request) const;
+
+            //! Returns true if the tile of a request holds what was rendered into it the last frame
+            /** \param transform Light view projection transform the tile would be rendered with. */
+            bool IsTileValid(u32 request, const core::Matrixf& transform) const;
+
+            //! Marks the tile of a request as rendered with a light view projection transform
+            void SetTileRendered(u32 request, const core::Matrixf& transform);
+
+            //! Forgets the content of all tiles, the next frame renders them again
+            void InvalidateTiles();
+
+        private:
+            enum E_NODE_STATE
+            {
+                ENS_FREE = 0,
+                ENS_SPLIT,
+                ENS_USED
+            };
+
+            //! a tile kept across frames
+            struct STile
+            {
+                const void* owner_;
+                u32 view_;
+                u32 node_;
+                u32 size_;
+
+                //! size the view asked for, larger than size_ for a smaller tile of a full atlas
+                u32 requested_size_;
+                core::rect<s32> rect_;
+                core::Matrixf transform_;
+                bool rendered_;
+                bool requested_;
+            };
+
+            struct SRequest
+            {
+                const void* owner_;
+                u32 view_;
+                u32 size_;
+                f32 priority_;
+
+                //! index into tiles_, -1 if the request got no tile
+                s32 tile_;
+            };
+
+            //! a request waiting for a new tile, sorts by priority, larger tiles first if the priorities are equal
+            struct SPlacement
+            {
+                bool operator<(const SPlacement& other) const
+                {
+                    if (priority_ != other.priority_)
+                    {
+                        return priority_ > other.priority_;
+                    }
+                    if (size_ != other.size_)
+                    {
+                        return size_ > other.size_;
+                    }
+                    return request_ < other.request_;
+                }
+
+                f32 priority_;
+                u32 size_;
+                u32 request_;
+            };
+
+            //! returns the quad tree level of the largest tile not larger than size
+            u32 GetLevel(u32 size) const;
+
+            //! finds a free node of a level below a node and marks it used, returns -1 if there is none
+            s32 Allocate(u32 node, u32 level, u32 target_level);
+
+            //! frees a used node and merges its free siblings
+            void Free(u32 node);
+
+            u32 size_;
+            u32 min_tile_size_;
+            u32 levels_;
+
+            //! state and position of the quad tree nodes, the children of node n are 4n+1 to 4n+4
+            core::Array<u8> node_state_;
+            core::Array<s32> node_x_;
+            core::Array<s32> node_y_;
+
+            core::Array<STile> tiles_;
+            core::Array<SRequest> requests_;
+
+            //! requests in the order they are placed, kept to avoid allocations
+            core::Array<SPlacement> placements_;
+
+            core::rect<s32> empty_tile_;
+        };
+    } // end namespace scene
+} // end namespace kong
+
+#endif
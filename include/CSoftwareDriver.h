@@ -0,0 +1,258 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CSOFTWAREDRIVER_H_
+#define _CSOFTWAREDRIVER_H_
+
+#include "KongCompileConfig.h"
+#include "CNullDriver.h"
+#include "CImage.h"
+#include "CThreadPool.h"
+#include "SKongCreationParameters.h"
+
+namespace kong
+{
+    namespace video
+    {
+        class CSoftwareTexture;
+
+        //! buffers the rasterizer can write into
+        enum E_SOFTWARE_RENDER_TARGET
+        {
+            ESRT_COLOR = 0,
+            ESRT_SHADOW,
+            ESRT_GBUFFER,
+            ESRT_COUNT
+        };
+
+        //! offsets of the interpolated attributes in SRasterVertex::varying_
+        enum E_SOFTWARE_VARYING
+        {
+            ESV_WORLD = 0,
+            ESV_NORMAL = 3,
+            ESV_COLOR = 6,
+            ESV_TEXCOORD = 10,
+            ESV_LIGHT = 12,
+            ESV_COUNT = 16
+        };
+
+        //! Multithreaded tile based rasterizer which renders into system memory.
+        /** Triangles are transformed and set up on the calling thread and binned
+        into screen tiles. The tiles are rasterized in parallel when the render
+        target changes or the frame ends. It implements the forward, shadow and
+        deferred passes of the OpenGL shader drivers on the CPU. */
+        class CSoftwareDriver : public CNullDriver
+        {
+        public:
+            CSoftwareDriver(const SKongCreationParameters& params, io::IFileSystem* io);
+
+            virtual ~CSoftwareDriver();
+
+            //! Applications must call this method before performing any rendering.
+            bool BeginScene(bool back_buffer = true, bool z_buffer = true, SColor color = SColor(255, 0, 0, 0)) override;
+
+            //! Rasterizes all pending triangles.
+            bool EndScene() override;
+
+            //! Sets transformation matrices.
+            void SetTransform(u32 state, const core::Matrixf& mat) override;
+
+            //! Draws a 3d line.
+            void Draw3DLine(const core::Vector3Df& start,
+                const core::Vector3Df& end, SColor color = SColor(255, 255, 255, 255)) override;
+
+            //! Draws a 2d image using a color
+            void Draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+                const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect = 0,
+                SColor color = SColor(255, 255, 255, 255), bool useAlphaChannelOfTexture = false) override;
+
+            //! Draws a 2d image
+            void Draw2DImage(const video::ITexture* texture, const core::position2d<f32>& destPos,
+                const core::rect<f32>& sourceRect, SColor color = SColor(255, 255, 255, 255)) override;
+
+            //! Draws a mesh buffer
+            void DrawMeshBuffer(const scene::IMeshBuffer* mesh_buffer) override;
+
+            //! Make a screenshot of the last rendered frame.
+            IImage* CreateScreenShot() override;
+
+            const core::Dimension2d<u32>& GetCurrentRenderTargetSize() const override;
+
+            //! Deletes all dynamic lights which were previously added with addDynamicLight().
+            void DeleteAllDynamicLights() override;
+
+            //! adds a dynamic light, returning an index to the light
+            s32 AddDynamicLight(const SLight& light) override;
+
+            //! Returns the maximal amount of dynamic lights the device can handle
+            u32 GetMaximalDynamicLightAmount() const override;
+
+            //! Begin shadow rendering
+            void BeginShadowRender() override;
+
+            //! End shadow rendering
+            void EndShadowRender() override;
+
+            //! Returns the maximal amount of cascades the shadow map can be split into
+            /** The light space position is interpolated from the vertices, so it can not change the cascade per pixel. */
+            u32 GetMaximalShadowCascadeAmount() const override;
+
+            //! Returns 0, the software driver only renders the shadow map of the main light
+            u32 GetShadowAtlasSize() const override;
+
+            //! Render first pass for deferred render
+            void RenderFirstPass() override;
+
+            //! Render second pass for deferred render
+            void RenderSecondPass() override;
+
+            // draw a space fill quad
+            void DrawSpaceFillQuad() override;
+
+            // Render fxaa pass
+            void RenderFxaaPass() override;
+
+        protected:
+            //! creates a texture which keeps its texels in system memory
+            video::ITexture* CreateDeviceDependentTexture(IImage* surface, const io::path& name, void* mipmapData = nullptr) override;
+
+        private:
+            //! transformed vertex, clip_ is the clip space position
+            struct SRasterVertex
+            {
+                f32 clip_[4];
+                f32 varying_[ESV_COUNT];
+            };
+
+            //! triangle after setup, the edge functions are scaled to give barycentrics directly
+            struct SRasterTriangle
+            {
+                f32 edge_a_[3];
+                f32 edge_b_[3];
+                f32 edge_c_[3];
+                bool edge_owner_[3];
+
+                //! depth and 1/w as planes over the screen
+                f32 depth_[3];
+                f32 inv_w_[3];
+
+                f32 varying_[3][ESV_COUNT];
+
+                s32 min_x_, min_y_, max_x_, max_y_;
+                u32 state_;
+            };
+
+            //! material and flags of a draw call, kept until its triangles are rasterized
+            struct SRasterState
+            {
+                f32 ambient_[4];
+                f32 diffuse_[4];
+                f32 specular_[4];
+                f32 shininess_;
+                const CSoftwareTexture* texture_;
+                bool wireframe_;
+                bool shadow_;
+                f32 camera_[3];
+            };
+
+            //! light in the layout used by the pixel stage
+            struct SShadeLight
+            {
+                f32 position_[4];
+                f32 direction_[3];
+                f32 ambient_[3];
+                f32 diffuse_[3];
+                f32 specular_[3];
+                f32 attenuation_[3];
+                f32 exponent_;
+                f32 cutoff_cos_;
+            };
+
+            //! one texel of the geometry buffer written by the first deferred pass
+            struct SGBufferTexel
+            {
+                f32 position_[3];
+                f32 normal_[3];
+                f32 diffuse_[4];
+            };
+
+            //! Makes target the destination of the following triangles.
+            void SetRenderTarget(E_SOFTWARE_RENDER_TARGET target);
+
+            //! Rasterizes and shades all binned triangles.
+            void Flush();
+
+            //! Clips a triangle against the near plane and sets up the visible parts.
+            void ClipAndSetupTriangle(const SRasterVertex& v0, const SRasterVertex& v1, const SRasterVertex& v2, u32 state);
+
+            //! Computes edge functions and bounding box, and adds the triangle to the tile bins.
+            void SetupTriangle(const SRasterVertex* v[3], u32 state);
+
+            //! Rasterizes the triangles binned into one tile.
+            void RasterizeTile(u32 tile);
+
+            //! Shades a covered pixel of the color or geometry buffer.
+            void ShadePixel(const SRasterTriangle& triangle, s32 x, s32 y, const f32 lambda[3]);
+
+            //! Evaluates the lights at a surface point, the result is added to light_color.
+            void AccumulateLights(const f32 position[3], const f32 normal[3], const f32 camera[3],
+                const f32 ambient[4], const f32 diffuse[4], const f32 specular[4], f32 shininess,
+                f32 shadow, f32 ambient_scale, f32 light_color[3]) const;
+
+            //! Returns the shadow factor of a point given in light clip space.
+            f32 CalculateShadowFactor(const f32 light_position[4]) const;
+
+            //! Lights the geometry buffer into the color buffer.
+            void ResolveGBuffer();
+
+            //! Rebuilds the shade light array from the dynamic lights.
+            void UpdateShadeLights();
+
+            SKongCreationParameters params_;
+            core::CThreadPool* thread_pool_;
+
+            //! color buffer, A8R8G8B8
+            CImage* color_buffer_;
+            u32* color_data_;
+            u32 color_pitch_;
+
+            //! depth buffers, rows are padded to a multiple of four
+            f32* depth_buffer_;
+            u32 depth_pitch_;
+            f32* shadow_buffer_;
+            u32 shadow_pitch_;
+
+            //! geometry buffer of the deferred path
+            SGBufferTexel* gbuffer_;
+
+            //! state of the current render target
+            E_SOFTWARE_RENDER_TARGET target_;
+            f32* target_depth_;
+            u32 target_pitch_;
+            core::Dimension2d<u32> target_size_;
+            core::rect<s32> target_view_port_;
+            u32 tiles_x_;
+            u32 tiles_y_;
+
+            //! triangles waiting for the tile workers
+            core::Array<SRasterVertex> vertices_;
+            core::Array<SRasterTriangle> triangles_;
+            core::Array<SRasterState> states_;
+            core::Array<u32>* bins_;
+            u32 bin_count_;
+
+            core::Array<SShadeLight> shade_lights_;
+            bool lights_dirty_;
+
+            core::Matrixf light_transform_;
+            f32 camera_position_[3];
+
+            bool color_buffer_clear_;
+            bool z_buffer_clear_;
+            SColor color_clear_;
+            bool shadow_map_valid_;
+            bool resolve_pending_;
+        };
+    } // end namespace video
+} // end namespace kong
+#endif
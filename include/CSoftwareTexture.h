@@ -0,0 +1,58 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CSOFTWARETEXTURE_H_
+#define _CSOFTWARETEXTURE_H_
+
+#include "ITexture.h"
+#include "CImage.h"
+
+namespace kong
+{
+    namespace video
+    {
+        //! Texture of the software driver, the texels are kept as A8R8G8B8 in system memory.
+        class CSoftwareTexture : public ITexture
+        {
+        public:
+            //! constructor
+            CSoftwareTexture(IImage* surface, const io::path& name);
+
+            //! destructor
+            virtual ~CSoftwareTexture();
+
+            //! lock function
+            void* Lock(E_TEXTURE_LOCK_MODE mode = ETLM_READ_WRITE, u32 mipmapLevel = 0) override;
+
+            //! unlock function
+            void Unlock() override;
+
+            //! Returns original size of the texture.
+            const core::Dimension2d<u32>& GetOriginalSize() const override;
+
+            //! Returns size of the texture.
+            const core::Dimension2d<u32>& GetSize() const override;
+
+            //! returns driver type of texture (=the driver, who created the texture)
+            E_DRIVER_TYPE GetDriverType() const override;
+
+            //! returns color format of texture
+            ECOLOR_FORMAT GetColorFormat() const override;
+
+            //! returns pitch of texture (in bytes)
+            u32 GetPitch() const override;
+
+            //! there are no mip map levels, nothing to regenerate
+            void RegenerateMipMapLevels(void* mipmapData = nullptr) override;
+
+            //! returns the image holding the texels
+            CImage* GetImage() const { return image_; }
+
+        private:
+            CImage* image_;
+            core::Dimension2d<u32> original_size_;
+        };
+    } // end namespace video
+} // end namespace kong
+
+#endif
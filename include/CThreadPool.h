@@ -0,0 +1,56 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CTHREADPOOL_H_
+#define _CTHREADPOOL_H_
+
+#include "KongTypes.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kong
+{
+    namespace core
+    {
+        //! Fixed set of worker threads used to split CPU work into independent jobs.
+        class CThreadPool
+        {
+        public:
+            //! constructor, thread_count 0 means one thread per hardware core
+            explicit CThreadPool(u32 thread_count = 0);
+
+            ~CThreadPool();
+
+            //! Returns the number of threads which execute jobs, including the calling thread.
+            u32 GetThreadCount() const;
+
+            //! Runs job(i) for every i in [0, job_count) and returns when all of them are done.
+            /** The calling thread takes jobs too. Jobs are handed out in ascending order,
+            but may finish in any order. */
+            void ParallelFor(u32 job_count, const std::function<void(u32)>& job);
+
+        private:
+            void WorkerLoop();
+
+            void RunJobs();
+
+            std::vector<std::thread> workers_;
+            std::mutex mutex_;
+            std::condition_variable wake_condition_;
+            std::condition_variable done_condition_;
+
+            const std::function<void(u32)>* job_;
+            std::atomic<u32> next_job_;
+            u32 job_count_;
+            u32 busy_workers_;
+            u32 generation_;
+            bool stop_;
+        };
+    } // end namespace core
+} // end namespace kong
+
+#endif
@@ -0,0 +1,116 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _CVERTEXHASHGRID_H_
+#define _CVERTEXHASHGRID_H_
+
+#include "KongTypes.h"
+#include "Vector.h"
+#include "Array.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        //! Uniform grid over vertex positions, used to find duplicate vertices.
+        /** Vertices are added in order and get consecutive indices. A lookup only
+        visits the 27 cells around a position, so deduplicating n vertices is O(n)
+        for any sane mesh instead of comparing every pair. Two positions are
+        candidates if they are equal per axis within the tolerance passed to the
+        constructor, the full comparison is left to the caller. */
+        class CVertexHashGrid
+        {
+        public:
+            //! constructor
+            /** \param tolerance: Per axis distance of positions which count as equal.
+            \param expected_vertex_count: Number of vertices to reserve memory for. */
+            explicit CVertexHashGrid(f32 tolerance, u32 expected_vertex_count = 0);
+
+            //! Removes all vertices, the next added vertex gets index 0 again.
+            void Clear();
+
+            //! Returns the number of added vertices.
+            u32 GetVertexCount() const { return vertex_count_; }
+
+            //! Adds a vertex position and returns its index.
+            u32 Add(const core::vector3df& position);
+
+            //! Returns the smallest index for which equals(index) returns true.
+            /** Only vertices near position are tested. equals is called with the
+            index of an added vertex and has to compare it against the searched one.
+            \return Index of the first matching vertex, or -1 if there is none. */
+            template <class T>
+            s32 FindFirst(const core::vector3df& position, const T& equals) const;
+
+        private:
+            struct SCell
+            {
+                s32 x_, y_, z_;
+
+                //! first and last vertex of the cell, in insertion order
+                u32 first_;
+                u32 last_;
+            };
+
+            static const u32 EMPTY_CELL = 0xFFFFFFFF;
+
+            s32 GetCellCoordinate(f32 value) const;
+
+            static u32 HashCell(s32 x, s32 y, s32 z);
+
+            //! returns the slot of the cell, or of the empty slot where it belongs
+            u32 FindSlot(s32 x, s32 y, s32 z) const;
+
+            //! doubles the hash table when it is half full
+            void Grow();
+
+            f64 inv_cell_size_;
+
+            //! open addressing hash table of the occupied cells, size is a power of two
+            core::Array<SCell> cells_;
+            u32 cell_mask_;
+            u32 used_cells_;
+
+            //! next vertex in the same cell for every vertex
+            core::Array<u32> next_;
+            u32 vertex_count_;
+        };
+
+        template <class T>
+        s32 CVertexHashGrid::FindFirst(const core::vector3df& position, const T& equals) const
+        {
+            const s32 cx = GetCellCoordinate(position.x_);
+            const s32 cy = GetCellCoordinate(position.y_);
+            const s32 cz = GetCellCoordinate(position.z_);
+
+            const SCell* cells = cells_.ConstPointer();
+            const u32* next = next_.ConstPointer();
+            u32 best = EMPTY_CELL;
+
+            for (s32 dz = -1; dz <= 1; ++dz)
+            {
+                for (s32 dy = -1; dy <= 1; ++dy)
+                {
+                    for (s32 dx = -1; dx <= 1; ++dx)
+                    {
+                        const SCell& cell = cells[FindSlot(cx + dx, cy + dy, cz + dz)];
+
+                        // chains are ascending, the rest of the cell cannot beat best
+                        for (u32 i = cell.first_; i < best; i = next[i])
+                        {
+                            if (equals(i))
+                            {
+                                best = i;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            return best == EMPTY_CELL ? -1 : static_cast<s32>(best);
+        }
+    } // end namespace scene
+} // end namespace kong
+
+#endif
@@ -0,0 +1,27 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _EDEVICETYPES_H_
+#define _EDEVICETYPES_H_
+
+namespace kong
+{
+    //! An enum for the different device types supported by the Kong Engine.
+    enum E_DEVICE_TYPE
+    {
+        //! A device native to Microsoft Windows
+        /** This device uses the Win32 API and works in all versions of Windows. */
+        EIDT_WIN32,
+
+        //! A device which opens no window and renders into system memory.
+        /** It uses the null or the software driver and can run a fixed number of
+        frames, so it is suited for batch jobs and hosts without a display. */
+        EIDT_HEADLESS,
+
+        //! This selection allows the engine to choose the best device for the platform.
+        /** The Win32 device on Windows, the headless device everywhere else. */
+        EIDT_BEST
+    };
+} // end namespace kong
+
+#endif
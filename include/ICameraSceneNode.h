@@ -8,6 +8,7 @@
 
 #include "ISceneNode.h"
 #include "ISceneManager.h"
+#include "SViewFrustum.h"
 
 namespace kong
 {
@@ -43,9 +44,13 @@ namespace kong
             core::Vector3Df GetEye() const;
             core::Vector3Df GetLookAt() const;
             f32 GetZn() const;
+            f32 GetZf() const;
 
             virtual int GetCameraType() = 0;
 
+            //! Returns the frustum of the current view and projection transforms.
+            const SViewFrustum& GetViewFrustum();
+
             // register node
             void OnRegisterSceneNode() override;
 
@@ -67,6 +72,7 @@ namespace kong
 
         private:
             core::Matrixf view_;
+            SViewFrustum view_frustum_;
         };
 
         inline ICameraSceneNode::ICameraSceneNode(ISceneNode *parent, ISceneManager * mgr, s32 id)
@@ -165,6 +171,20 @@ namespace kong
             return zn_;
         }
 
+        inline f32 ICameraSceneNode::GetZf() const
+        {
+            return zf_;
+        }
+
+        inline const SViewFrustum& ICameraSceneNode::GetViewFrustum()
+        {
+            UpdateViewTransform();
+            UpdateProjectTransform();
+            view_frustum_.SetFrom(view_ * project_);
+            view_frustum_.camera_position_ = eye_;
+            return view_frustum_;
+        }
+
         inline void ICameraSceneNode::OnRegisterSceneNode()
         {
             if (scene_manager_->GetActiveCamera() == this)
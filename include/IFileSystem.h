@@ -26,6 +26,15 @@ namespace kong
             See IReferenceCounted::drop() for more information. */
             virtual IReadFile* CreateAndOpenFile(const SPath &filename) = 0;
 
+            //! Opens a file for read access through a memory mapping.
+            /** Parsers can use IReadFile::GetMappedData() to work on the file
+            without copying it. If the file cannot be mapped it is opened like
+            with CreateAndOpenFile().
+            \param filename: Name of file to open.
+            \return Pointer to the created file interface, or 0 if the file
+            could not be opened. */
+            virtual IReadFile* CreateAndMapFile(const SPath &filename) = 0;
+
             //! Creates an IReadFile interface for accessing memory like a file.
             /** This allows you to use a pointer to memory where an IReadFile is requested.
             \param memory: A pointer to the start of the file in memory
@@ -70,6 +79,12 @@ namespace kong
             /** \param filename is the string identifying the file which should be tested for existence.
             \return True if file exists, and false if it does not exist or an error occured. */
             virtual bool ExistFile(const path& filename) const = 0;
+
+            //! Determines if a file was modified after another one.
+            /** \param filename: File which is tested, e.g. a cache generated from reference.
+            \param reference: File to compare the modification time with.
+            \return True if both files exist and filename was written later than reference. */
+            virtual bool IsFileNewer(const path& filename, const path& reference) const = 0;
         };
     }
 }
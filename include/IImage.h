@@ -5,8 +5,8 @@
 #ifndef __I_IMAGE_H_INCLUDED__
 #define __I_IMAGE_H_INCLUDED__
 
-#include "Position2d.h"
-#include "rect.h"
+#include "Position2D.h"
+#include "Rect.h"
 #include "SColor.h"
 
 namespace kong
@@ -73,8 +73,16 @@ namespace kong
             virtual u32 GetAlphaMask() const = 0;
 
             //! Returns pitch of image
+            /** For compressed formats it is the size of a row of blocks. */
             virtual u32 GetPitch() const = 0;
 
+            //! Returns the mip map levels after level 0, one after another, or 0 if the image has none
+            /** Loaders set them for files which store their own levels, like dds. */
+            virtual void* GetMipMapsData() const = 0;
+
+            //! Returns the amount of stored levels, including level 0
+            virtual u32 GetMipMapLevelCount() const = 0;
+
             //! Copies the image into the target, scaling the image to fit
             virtual void CopyToScaling(void* target, u32 width, u32 height, ECOLOR_FORMAT format = ECF_A8R8G8B8, u32 pitch = 0) = 0;
 
@@ -123,11 +131,49 @@ namespace kong
                     return 64;
                 case ECF_A32B32G32R32F:
                     return 128;
+                case ECF_BC1:
+                case ECF_BC4:
+                    return 4;
+                case ECF_BC2:
+                case ECF_BC3:
+                case ECF_BC5:
+                case ECF_BC6H:
+                case ECF_BC7:
+                    return 8;
                 default:
                     return 0;
                 }
             }
 
+            //! test if the color format stores blocks of 4x4 texels
+            static bool IsCompressedFormat(const ECOLOR_FORMAT format)
+            {
+                switch (format)
+                {
+                case ECF_BC1:
+                case ECF_BC2:
+                case ECF_BC3:
+                case ECF_BC4:
+                case ECF_BC5:
+                case ECF_BC6H:
+                case ECF_BC7:
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            //! get the amount of bytes an image of the given color format and size needs
+            /** Compressed formats store whole blocks, so their sizes are rounded up to a multiple of 4. */
+            static u32 GetDataSizeFromFormat(const ECOLOR_FORMAT format, u32 width, u32 height)
+            {
+                if (IsCompressedFormat(format))
+                {
+                    return ((width + 3) / 4) * ((height + 3) / 4) * GetBitsPerPixelFromFormat(format) * 2;
+                }
+                return width * height * (GetBitsPerPixelFromFormat(format) / 8);
+            }
+
             //! test if the color format is only viable for RenderTarget textures
             /** Since we don't have support for e.g. floating point IImage formats
             one should test if the color format can be used for arbitrary usage, or
@@ -12,6 +12,8 @@ namespace kong
 {
     namespace scene
     {
+        class ICameraSceneNode;
+
         class ILightSceneNode : public ISceneNode
         {
         public:
@@ -69,8 +71,36 @@ namespace kong
             virtual void RenderShadow() = 0;
 
             //! Reset camera transform
+            /** Fits the shadow camera around the nodes which receive shadows. */
             virtual void ResetCameraTransform(core::Array<DefaultNodeEntry>& solid_nodes) = 0;
 
+            //! Moves the near plane of the shadow camera toward the light until it covers the casters
+            /** Call after ResetCameraTransform().
+            \param casters Nodes which may cast shadows onto the receivers. */
+            virtual void FitShadowCasters(const core::Array<ISceneNode*>& casters) = 0;
+
+            //! Fits the shadow camera around a slice of the view frustum
+            /** Used for the cascades of directional lights. The camera covers the
+            bounding sphere of the slice, so its size does not change when the view
+            turns, and it moves in steps of whole shadow map texels, so the shadows
+            do not shimmer when the view moves. The depth range is tightened to the
+            receivers inside the sphere.
+            \param corners The eight world space corners of the slice.
+            \param receivers Nodes which receive shadows.
+            \param resolution Width of the shadow map in texels.
+            \return False if no receiver is inside the slice or the light has no cascades. */
+            virtual bool FitShadowCascade(const core::vector3df* corners, const core::Array<DefaultNodeEntry>& receivers, u32 resolution) = 0;
+
+            //! Points the shadow camera of a spot or point light along one of its shadow views
+            /** Spot lights have one view along their direction, point lights six views
+            looking along +x, -x, +y, -y, +z and -z. The far plane is the radius of the light.
+            \param view Index of the view.
+            \return False if the light has no such view. */
+            virtual bool FitShadowView(u32 view) = 0;
+
+            //! Returns the camera the shadow map is rendered with
+            virtual ICameraSceneNode* GetShadowCamera() const = 0;
+
             //! Get main light index
             virtual s32 GetLightIndex() const = 0;
         };
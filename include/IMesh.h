@@ -7,6 +7,7 @@
 #include "SMaterial.h"
 #include "aabbox3d.h"
 #include "EHardwareBufferFlags.h"
+#include "IReferenceCounted.h"
 
 namespace kong
 {
@@ -14,7 +15,10 @@ namespace kong
     {
         class IMeshBuffer;
 
-        class IMesh
+        //! Static geometry made of mesh buffers.
+        /** Meshes are reference counted, so a loaded mesh can be shared by the mesh
+        cache and all scene nodes showing it. */
+        class IMesh : public IReferenceCounted
         {
         public:
             //! virtual deconstructor
@@ -8,6 +8,7 @@
 #include "SMaterial.h"
 #include "S3DVertex.h"
 #include "aabbox3d.h"
+#include "EHardwareBufferFlags.h"
 
 namespace kong
 {
@@ -48,17 +49,22 @@ namespace kong
             virtual video::E_INDEX_TYPE GetIndexType() const = 0;
 
             //! Get access to Indices.
-            /** \return Pointer to indices array. */
+            /** The array holds u32 values if GetIndexType() is EIT_32BIT.
+            \return Pointer to indices array. */
             virtual const u16* GetIndices() const = 0;
 
             //! Get access to Indices.
-            /** \return Pointer to indices array. */
+            /** The array holds u32 values if GetIndexType() is EIT_32BIT.
+            \return Pointer to indices array. */
             virtual u16* GetIndices() = 0;
 
             //! Get amount of indices in this meshbuffer.
             /** \return Number of indices in this buffer. */
             virtual u32 GetIndexCount() const = 0;
 
+            //! Returns index i, for both index types
+            virtual u32 GetIndex(u32 i) const = 0;
+
             //! Get the currently used ID for identification of changes.
             /** This shouldn't be used for anything outside the VideoDriver. */
             virtual u32 GetVertexChangedID() const = 0;
@@ -104,6 +110,21 @@ namespace kong
             \param indices Pointer to index array.
             \param numIndices Number of indices in array. */
             virtual void Append(const void* const vertices, u32 numVertices, const u16* const indices, u32 numIndices) = 0;
+
+            //! get the current hardware mapping hint
+            virtual E_HARDWARE_MAPPING GetHardwareMappingHintVertex() const = 0;
+
+            //! get the current hardware mapping hint
+            virtual E_HARDWARE_MAPPING GetHardwareMappingHintIndex() const = 0;
+
+            //! set the hardware mapping hint, for driver
+            virtual void SetHardwareMappingHint(E_HARDWARE_MAPPING new_mapping_hint, E_BUFFER_TYPE buffer = EBT_VERTEX_AND_INDEX) = 0;
+
+            //! flags the meshbuffer as changed, reloads hardware buffers
+            /** This method has to be called every time the vertices or
+            indices have changed. Otherwise, changes won't be updated
+            on the GPU in the next render cycle. */
+            virtual void SetDirty(E_BUFFER_TYPE buffer = EBT_VERTEX_AND_INDEX) = 0;
         };
     } // end namespace scene
 } // end namespace kong
@@ -0,0 +1,63 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _IMESHCACHE_H_
+#define _IMESHCACHE_H_
+
+#include "SPath.h"
+#include "KongTypes.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        class IAnimatedMesh;
+        class IMesh;
+
+        //! The mesh cache stores already loaded meshes and provides an interface to them.
+        /** ISceneManager::getMesh() looks up a file in the cache before loading it,
+        so every mesh file is loaded only once and all scene nodes showing it share
+        its vertex memory. The cache holds one reference of every mesh, scene nodes
+        grab the meshes they show. A mesh stays loaded until it is removed from the
+        cache and the last scene node using it is gone. */
+        class IMeshCache
+        {
+        public:
+            virtual ~IMeshCache() = default;
+
+            //! Adds a mesh to the cache and grabs it.
+            /** \param name: Name of the mesh, ISceneManager::getMesh() uses the absolute path of the file.
+            \param mesh: Mesh to add. */
+            virtual void AddMesh(const io::path& name, IAnimatedMesh* mesh) = 0;
+
+            //! Removes a mesh from the cache and drops it.
+            /** The mesh is deleted if no scene node uses it anymore.
+            \param mesh: Mesh to remove. */
+            virtual void RemoveMesh(const IMesh* mesh) = 0;
+
+            //! Returns the amount of loaded meshes in the cache.
+            virtual u32 GetMeshCount() const = 0;
+
+            //! Returns a mesh by index, or 0 if index is out of range.
+            virtual IAnimatedMesh* GetMeshByIndex(u32 index) = 0;
+
+            //! Returns a mesh by name, or 0 if it is not in the cache.
+            virtual IAnimatedMesh* GetMeshByName(const io::path& name) = 0;
+
+            //! Returns the name of a mesh, or an empty path if it is not in the cache.
+            virtual const io::path& GetMeshName(const IMesh* mesh) const = 0;
+
+            //! Returns true if a mesh with this name is in the cache.
+            virtual bool IsMeshLoaded(const io::path& name) = 0;
+
+            //! Removes and drops all meshes.
+            virtual void Clear() = 0;
+
+            //! Removes and drops the meshes which are not used by anything else than the cache.
+            virtual void ClearUnusedMeshes() = 0;
+        };
+
+    } // end namespace scene
+} // end namespace kong
+
+#endif
@@ -5,6 +5,7 @@
 #define _IMESHLOADER_H_
 
 #include "SPath.h"
+#include "Array.h"
 
 namespace kong
 {
@@ -42,6 +43,12 @@ namespace kong
             If you no longer need the mesh, you should call IAnimatedMesh::drop().
             See IReferenceCounted::drop() for more information. */
             virtual IAnimatedMesh* createMesh(io::IReadFile* file) = 0;
+
+            //! Returns the files besides the mesh file which the last createMesh() call read.
+            /** These are for example the material libraries of a mesh. Textures
+            are not listed, they are loaded by name whenever the mesh is.
+            \param files Receives the names of the files. */
+            virtual void getDependencies(core::Array<io::path>& /*files*/) const {}
         };
 
 
@@ -28,6 +28,8 @@ namespace kong
         class IMeshManipulator
         {
         public:
+            //! destructor
+            virtual ~IMeshManipulator() = default;
 
             //! Flips the direction of surfaces.
             /** Changes backfacing triangles to frontfacing
@@ -5,13 +5,14 @@
 #define _IMESHSCENENODE_H_
 
 #include "ISceneNode.h"
+#include "IMesh.h"
+#include "IMeshBuffer.h"
+#include "ISceneManager.h"
 
 namespace kong
 {
     namespace scene
     {
-        class IMesh;
-
         class IMeshSceneNode : public ISceneNode
         {
         public:
@@ -30,6 +31,49 @@ namespace kong
             virtual void SetMesh(IMesh *mesh) = 0;
 
             virtual IMesh *GetMesh() = 0;
+
+            //! Changes with the mesh and with edits of its buffers
+            u32 GetGeometryChangedID() override
+            {
+                IMesh *mesh = GetMesh();
+                if (mesh == nullptr)
+                {
+                    return 0;
+                }
+
+                u32 id = static_cast<u32>(reinterpret_cast<size_t>(mesh) >> 4);
+                for (u32 i = 0; i < mesh->GetMeshBufferCount(); ++i)
+                {
+                    const IMeshBuffer *buffer = mesh->GetMeshBuffer(i);
+                    id = id * 31 + buffer->GetVertexChangedID();
+                    id = id * 31 + buffer->GetIndexChangedID();
+                }
+                return id;
+            }
+
+        protected:
+            //! Drops a mesh of the node and sets it to null
+            /** The hardware buffers are only freed if the node held the last reference,
+            a mesh cache or other nodes may still draw a shared mesh. */
+            void DropMesh(IMesh*& mesh)
+            {
+                if (mesh == nullptr)
+                {
+                    return;
+                }
+
+                video::IVideoDriver *driver = scene_manager_ != nullptr ? scene_manager_->GetVideoDriver() : nullptr;
+                if (mesh->GetReferenceCount() == 1 && driver != nullptr)
+                {
+                    for (u32 i = 0; i < mesh->GetMeshBufferCount(); ++i)
+                    {
+                        driver->RemoveHardwareBuffer(mesh->GetMeshBuffer(i));
+                    }
+                }
+
+                mesh->Drop();
+                mesh = nullptr;
+            }
         };
     }
 }
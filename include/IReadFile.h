@@ -43,11 +43,18 @@ namespace kong
             //! Get name of file.
             /** \return File name as zero terminated character string. */
             virtual const SPath& GetFileName() const = 0;
+
+            //! Get the contents of the file if it is mapped into memory.
+            /** \return Pointer to GetSize() bytes which stay valid as long as the
+            file exists, or 0 if the file has to be accessed with Read(). */
+            virtual const void* GetMappedData() const { return nullptr; }
         };
 
         //! Internal function, please do not use.
         IReadFile* CreateReadFile(const SPath& filename);
         //! Internal function, please do not use.
+        IReadFile* CreateMappedReadFile(const SPath& filename);
+        //! Internal function, please do not use.
         IReadFile* CreateLimitReadFile(const io::SPath& filename, IReadFile* already_opened_file, long pos, long area_size);
         //! Internal function, please do not use.
         IReadFile* CreateMemoryReadFile(void* memory, long size, const io::SPath& filename, bool delete_memory_when_dropped);
@@ -0,0 +1,56 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _IREFERENCECOUNTED_H_
+#define _IREFERENCECOUNTED_H_
+
+#include "KongTypes.h"
+
+namespace kong
+{
+    //! Base class of objects which are shared by several owners.
+    /** An object starts with a reference count of 1, which belongs to whoever
+    created it. Every additional owner calls Grab() and calls Drop() when it
+    no longer needs the object. The last Drop() deletes the object. Objects
+    which never got a second owner can still be deleted directly. */
+    class IReferenceCounted
+    {
+    public:
+        //! Constructor, the creator holds the first reference
+        IReferenceCounted()
+            : reference_counter_(1)
+        {
+        }
+
+        virtual ~IReferenceCounted() = default;
+
+        //! Adds a reference to the object.
+        void Grab() const
+        {
+            ++reference_counter_;
+        }
+
+        //! Removes a reference and deletes the object if it was the last one.
+        /** \return True if the object was deleted. */
+        bool Drop() const
+        {
+            if (--reference_counter_ == 0)
+            {
+                delete this;
+                return true;
+            }
+            return false;
+        }
+
+        //! Returns the number of references.
+        s32 GetReferenceCount() const
+        {
+            return reference_counter_;
+        }
+
+    private:
+        mutable s32 reference_counter_;
+    };
+} // end namespace kong
+
+#endif
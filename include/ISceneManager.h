@@ -5,6 +5,7 @@
 #define _ISCENEMANAGER_H_
 #include "ISceneNode.h"
 #include "IVideoDriver.h"
+#include "SRenderStatistics.h"
 
 namespace kong
 {
@@ -22,6 +23,7 @@ namespace kong
         class ICameraSceneNode;
         class ILightSceneNode;
         class IMeshSceneNode;
+        class IMeshCache;
         class IMeshLoader;
         class IMeshManipulator;
         class ISceneNode;
@@ -494,6 +496,15 @@ namespace kong
             //! Enable shadows.
             virtual void EnableShadow(bool flag = true) = 0;
 
+            //! Sets how the shadows of a directional main light are split into cascades.
+            /** The view is split by depth, each slice gets its own shadow map, so
+            near shadows get more texels than far ones. Other lights always use a
+            single shadow map.
+            \param count: Amount of cascades, limited by IVideoDriver::GetMaximalShadowCascadeAmount().
+            \param split_lambda: Blends between uniform splits at 0 and logarithmic splits at 1.
+            \param max_distance: Distance from the camera at which the shadows end, 0 for the far plane of the camera. */
+            virtual void SetShadowCascades(u32 count, f32 split_lambda = 0.75f, f32 max_distance = 0.f) = 0;
+
             //! Draws all the scene nodes.
             /** This can only be invoked between
             IVideoDriver::beginScene() and IVideoDriver::endScene(). Please note that
@@ -508,6 +519,9 @@ namespace kong
             by existing scene node animators, culling of scene nodes is done, etc. */
             virtual void DrawAllDeferred() = 0;
 
+            //! Get the pass timings and node counts of the last DrawAll() or DrawAllDeferred() call.
+            virtual const SRenderStatistics& GetRenderStatistics() const = 0;
+
             //! Clears the whole scene.
             /** All scene nodes are removed. */
             virtual void Clear() = 0;
@@ -532,6 +546,13 @@ namespace kong
             This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
             virtual IMeshManipulator* GetMeshManipulator() = 0;
 
+            //! Get pointer to the mesh cache.
+            /** All meshes loaded with getMesh() stay in the cache until they are
+            removed from it, use IMeshCache::ClearUnusedMeshes() to free the meshes
+            no scene node shows anymore.
+            \return Pointer to the mesh cache. This pointer should not be dropped. */
+            virtual IMeshCache* GetMeshCache() = 0;
+
             //! Set main light for shadow rendering
             /** \param light_node: main light for shadow rendering*/
             virtual void SetMainLight(const ILightSceneNode *light_node) = 0;
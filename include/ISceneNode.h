@@ -19,6 +19,7 @@ namespace kong
     namespace scene
     {
         class ISceneManager;
+        class CRenderQueue;
 
         //! Typedef for list of scene nodes
         //typedef core::List<ISceneNode*> ISceneNodeList;
@@ -38,7 +39,8 @@ namespace kong
                 const core::Vector3Df &rotation = core::Vector3Df(0.f, 0.f, 0.f),
                 const core::Vector3Df &scale = core::Vector3Df(1.f, 1.f, 1.f))
                 : relative_translation_(position), relative_rotation_(rotation), relative_scale_(scale),
-                parent_(nullptr), id_(id), scene_manager_(mgr), is_visible_(true), rendering_mode_(video::ERM_MESH), draw_bounding_box_(false)
+                parent_(nullptr), id_(id), scene_manager_(mgr), is_visible_(true), rendering_mode_(video::ERM_MESH), draw_bounding_box_(false),
+                culling_proxy_(-1)
             {
                 if (parent != nullptr)
                 {
@@ -189,6 +191,15 @@ namespace kong
             //! Renders the node.
             virtual void Render() = 0;
 
+            //! Adds the mesh buffers of the node to a render queue instead of rendering them.
+            /** Called by the scene manager for nodes of the solid pass, the queue draws
+            the buffers of all nodes sorted by their render state.
+            \return False if the node can not be queued, Render() is called then. */
+            virtual bool SubmitRenderItems(CRenderQueue& /*queue*/)
+            {
+                return false;
+            }
+
             //! Returns whether the node should be visible (if all of its parents are visible).
             /** This is only an option set by the user, but has nothing to
             do with geometry culling
@@ -435,6 +446,26 @@ namespace kong
                 bounding_box_mesh_.RebuildBoundingBoxMesh(GetTransformedBoundingBox());
             }
 
+            //! Returns the id of the node in the culling tree of the scene manager, or -1
+            s32 GetCullingProxy() const
+            {
+                return culling_proxy_;
+            }
+
+            //! Sets the id of the node in the culling tree, only used by the scene manager
+            void SetCullingProxy(s32 proxy)
+            {
+                culling_proxy_ = proxy;
+            }
+
+            //! Returns a number which changes whenever the geometry of the node changes
+            /** The scene manager compares it between frames, together with the absolute
+            transformation and the bounding box, to find the shadows to render again. */
+            virtual u32 GetGeometryChangedID()
+            {
+                return 0;
+            }
+
         protected:
             //! Sets the new scene manager for this node and all children.
             //! Called by addChild when moving nodes between scene managers
@@ -465,12 +496,13 @@ namespace kong
             //! rendering mode
             video::E_RENDERING_MODE rendering_mode_;
 
-            static core::Array<core::Vector3Df> barycentric_;
-
             //! draw bounding box
             bool draw_bounding_box_;
 
             SBoundingBoxMesh bounding_box_mesh_;
+
+            //! id in the culling tree of the scene manager
+            s32 culling_proxy_;
         };
     } // end namespace scene
 } // end namespace kong
@@ -31,6 +31,20 @@ namespace kong
             virtual void SetVec2i(const std::string &name, const s32 *vec2) const = 0;;
             virtual void SetVec4(const std::string &name, const f32 *vec4) const = 0;;
             //virtual void SetVec4i(const std::string &name, const s32 *vec4) const = 0;;
+
+            // location of a uniform, resolved when the program is linked. -1 if it is not active
+            virtual s32 GetUniformLocation(const std::string &name) const = 0;
+
+            // uniform set functions by location
+            virtual void SetBool(s32 location, bool value) const = 0;
+            virtual void SetInt(s32 location, s32 value) const = 0;
+            virtual void SetFloat(s32 location, f32 value) const = 0;
+            virtual void SetMatrix4(s32 location, const core::Matrixf &mat) const = 0;
+            virtual void SetVec2(s32 location, const f32 *vec2) const = 0;
+            virtual void SetVec4(s32 location, const f32 *vec4) const = 0;
+
+            // connect a uniform block to a buffer binding point, false if the program has no such block
+            virtual bool BindUniformBlock(const std::string &name, u32 binding) const = 0;
         };
     } // end namespace video
 } // end namespace kong
@@ -177,6 +177,24 @@ namespace kong
             /** \param mb Buffer to draw */
             virtual void DrawMeshBuffer(const scene::IMeshBuffer* mb) = 0;
 
+            //! Draws a mesh buffer once for every world transform
+            /** Uses the current material like DrawMeshBuffer(). Drivers without
+            hardware instancing draw the buffer once per transform, the world
+            transform of the driver is undefined afterwards.
+            \param mb Buffer to draw
+            \param transforms World transforms of the instances
+            \param count Amount of transforms */
+            virtual void DrawMeshBufferInstanced(const scene::IMeshBuffer* mb, const core::Matrixf* transforms, u32 count) = 0;
+
+            //! Remove hardware buffer
+            /** Has to be called before a mesh buffer which was drawn by
+            this driver is deleted, otherwise its gpu copy is kept alive.
+            \param mb Buffer whose hardware buffer should be released */
+            virtual void RemoveHardwareBuffer(const scene::IMeshBuffer* mb) = 0;
+
+            //! Remove all hardware buffers
+            virtual void RemoveAllHardwareBuffers() = 0;
+
             //! Creates an empty software image.
             /**
             \param format Desired color format of the image.
@@ -240,6 +258,35 @@ namespace kong
             IReferenceCounted::drop() for more information. */
             virtual ITexture* GetTexture(io::IReadFile* file) = 0;
 
+            //! Get access to a named texture without waiting for it to be loaded.
+            /** Returns a small gray placeholder at once, which materials can use
+            right away. The file is decoded on worker threads and replaces the
+            placeholder at the beginning of a later frame. Textures which cover
+            more of the screen are decoded and uploaded first. GetTexture() and
+            FindTexture() return the placeholder while it is pending. Drivers
+            without worker threads load the texture like GetTexture().
+            \param filename Filename of the texture to be loaded.
+            \return Pointer to the texture, or 0 if the file could not be opened. */
+            virtual ITexture* GetTextureAsync(const io::path& filename) = 0;
+
+            //! Returns the number of textures from GetTextureAsync() which still show their placeholder
+            virtual u32 GetPendingTextureCount() const = 0;
+
+            //! Sets how many bytes of streamed textures are uploaded per frame at most
+            /** At least one texture is uploaded per frame, however large it is. */
+            virtual void SetTextureUploadBudget(u32 bytes) = 0;
+
+            //! Sets how many bytes of video memory textures and render targets should use at most
+            /** Textures which were not drawn recently are evicted first, the least recently
+            drawn one first. If the textures drawn in one frame exceed the budget, the largest
+            ones drop their most detailed mip map levels. Their levels come back from the kept
+            image or the texture file when they fit again.
+            \param bytes The budget, 0 keeps every texture resident. */
+            virtual void SetTextureMemoryBudget(u32 bytes) = 0;
+
+            //! Returns the bytes of video memory used by textures and render targets
+            virtual u32 GetTextureMemorySize() const = 0;
+
             //! Check if the image is already loaded.
             /** Works similar to getTexture(), but does not load the texture
             if it is not currently loaded.
@@ -346,6 +393,52 @@ namespace kong
             //! End shadow rendering
             virtual void EndShadowRender() = 0;
 
+            //! Begin rendering a cascade of the shadow map
+            /** Called between BeginShadowRender() and EndShadowRender(), the nodes
+            drawn afterwards are rendered into the cascade. The cascades have to be
+            begun in the order of their split depths.
+            \param cascade Index of the cascade, smaller than GetMaximalShadowCascadeAmount().
+            \param view View transform of the light camera of the cascade.
+            \param projection Projection transform of the light camera of the cascade.
+            \param split_depth View space depth of the active camera at which the cascade ends. */
+            virtual void BeginShadowCascade(u32 cascade, const core::Matrixf& view, const core::Matrixf& projection, f32 split_depth) = 0;
+
+            //! Returns the maximal amount of cascades the shadow map can be split into
+            virtual u32 GetMaximalShadowCascadeAmount() const = 0;
+
+            //! Returns the size of one cascade of the shadow map in texels
+            virtual const core::Dimension2d<u32>& GetShadowTextureSize() const = 0;
+
+            //! Returns the width and height of the shadow atlas in texels
+            /** A driver with a shadow atlas renders the shadow maps of all lights into
+            tiles of one texture, the deferred post pass samples them for every light.
+            ISceneManager::DrawAllDeferred() then uses AddShadowAtlasView() and
+            BeginShadowAtlasTile() instead of BeginShadowCascade().
+            \return 0 if the driver only renders the shadow map of the main light. */
+            virtual u32 GetShadowAtlasSize() const = 0;
+
+            //! Adds a view of a light which is sampled from a tile of the shadow atlas
+            /** Called between BeginShadowRender() and EndShadowRender() for every
+            shadow view of the frame, also for those whose tile was not rendered again.
+            The views of a light have to be added one after another. Directional lights
+            use them as cascades, point lights have six views looking along +x, -x,
+            +y, -y, +z and -z.
+            \param light Index the light gets from AddDynamicLight() after EndShadowRender().
+            \param tile Texels of the atlas holding the view, (0, 0) is the first texel of the texture.
+            \param view View transform of the light camera.
+            \param projection Projection transform of the light camera.
+            \param split_depth For cascades the view space depth of the active camera at which the view ends. */
+            virtual void AddShadowAtlasView(u32 light, const core::rect<s32>& tile, const core::Matrixf& view,
+                const core::Matrixf& projection, f32 split_depth) = 0;
+
+            //! Begin rendering a tile of the shadow atlas
+            /** Clears the tile, the nodes drawn afterwards are rendered into it. Tiles
+            which are not begun keep what was rendered into them before.
+            \param tile Texels of the atlas to render to.
+            \param view View transform of the light camera.
+            \param projection Projection transform of the light camera. */
+            virtual void BeginShadowAtlasTile(const core::rect<s32>& tile, const core::Matrixf& view, const core::Matrixf& projection) = 0;
+
             //! Sets a new viewport.
             /** Every rendering operation is done into this new area.
             \param area: Rectangle defining the new area of rendering
@@ -373,6 +466,11 @@ namespace kong
 
             // Render fxaa pass
             virtual void RenderFxaaPass() = 0;
+
+            //! Make a screenshot of the last rendered frame.
+            /** \return An image created from the color buffer, or nullptr if
+            the driver has none. Drop it with delete when no longer needed. */
+            virtual IImage* CreateScreenShot() = 0;
         };
     }
 }
@@ -15,6 +15,14 @@
 #define _KONG_COMPILE_WITH_WINDOWS_DEVICE_
 #endif
 
+//! Define _KONG_COMPILE_WITH_HEADLESS_DEVICE_ to compile the device which renders without a window.
+/** It is available on every platform and is the default device where no window
+system is supported. */
+#define _KONG_COMPILE_WITH_HEADLESS_DEVICE_
+#ifdef NO_KONG_COMPILE_WITH_HEADLESS_DEVICE_
+#undef _KONG_COMPILE_WITH_HEADLESS_DEVICE_
+#endif
+
 #ifdef _KONG_WINDOWS_API_
 
 // To build KongEngine as a static library, you must define _KONG_STATIC_LIB_ in both the
@@ -49,17 +57,64 @@
 
 #endif // _KONG_WINDOWS_API_
 
+//! Define __KONG_HAS_S64 if the kong::s64 and kong::u64 types should be enabled.
+/** They need long long, which is available on all supported compilers. The render
+queue packs its sort keys into an u64. */
+#define __KONG_HAS_S64
+#ifdef NO__KONG_HAS_S64
+#undef __KONG_HAS_S64
+#endif
+
 //! Maximum number of texture an SMaterial can have, up to 8 are supported by Irrlicht.
 #define _KONG_MATERIAL_MAX_TEXTURES_ 4
 
 //! Define _KONG_COMPILE_WITH_OPENGL_ to compile the Irrlicht engine with OpenGL.
 /** If you do not wish the engine to be compiled with OpenGL, comment this
-define out. */
+define out. The OpenGL drivers create their context with WGL, so they are
+only available on Windows. */
+#ifdef _KONG_WINDOWS_API_
 #define _KONG_COMPILE_WITH_OPENGL_
+#endif
 #ifdef NO_KONG_COMPILE_WITH_OPENGL_
 #undef _KONG_COMPILE_WITH_OPENGL_
 #endif
 
+//! Define _KONG_COMPILE_WITH_SOFTWARE_ to compile the engine with the software rasterizer.
+/** It renders on the CPU into system memory and needs no window, so it can be
+used for headless rendering. */
+#define _KONG_COMPILE_WITH_SOFTWARE_
+#ifdef NO_KONG_COMPILE_WITH_SOFTWARE_
+#undef _KONG_COMPILE_WITH_SOFTWARE_
+#endif
+
+//! Define _KONG_COMPILE_WITH_SSE2_ to use SSE2 intrinsics in the software rasterizer, the light clustering and the mip map filter.
+/** Enabled automatically when the compiler targets a CPU with SSE2. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _KONG_COMPILE_WITH_SSE2_
+#endif
+#ifdef NO_KONG_COMPILE_WITH_SSE2_
+#undef _KONG_COMPILE_WITH_SSE2_
+#endif
+
+//! Define _KONG_COMPILE_WITH_MAPPED_FILES_ to read files through memory mappings.
+/** Loaders which support it parse a mapped file in place instead of copying it
+into a heap buffer first. Mappings are available with the Windows and POSIX APIs,
+elsewhere files are always read with fread. */
+#if defined(_KONG_WINDOWS_API_) || defined(__unix__) || defined(__APPLE__)
+#define _KONG_COMPILE_WITH_MAPPED_FILES_
+#endif
+#ifdef NO_KONG_COMPILE_WITH_MAPPED_FILES_
+#undef _KONG_COMPILE_WITH_MAPPED_FILES_
+#endif
+
+//! Define _KONG_COMPILE_WITH_COMPILED_MESH_CACHE_ to keep binary copies of loaded meshes.
+/** ISceneManager::getMesh writes a .kmesh file next to every mesh it parsed and
+loads it instead of the source as long as the source is not modified again. */
+#define _KONG_COMPILE_WITH_COMPILED_MESH_CACHE_
+#ifdef NO_KONG_COMPILE_WITH_COMPILED_MESH_CACHE_
+#undef _KONG_COMPILE_WITH_COMPILED_MESH_CACHE_
+#endif
+
 //! Define _KONG_COMPILE_WITH_KONG_SCENE_LOADER_ if you want to be able to load
 /** .irr scenes using ISceneManager::loadScene */
 #define _KONG_COMPILE_WITH_KONG_SCENE_LOADER_
@@ -274,15 +329,23 @@ B3D, MS3D or X meshes */
 #undef _KONG_COMPILE_WITH_PSD_LOADER_
 #endif
 //! Define _KONG_COMPILE_WITH_DDS_LOADER_ if you want to load .dds files
-// Outcommented because
-// a) it doesn't compile on 64-bit currently
-// b) anyone enabling it should be aware that S3TC compression algorithm which might be used in that loader
-// is patented in the US by S3 and they do collect license fees when it's used in applications.
-// So if you are unfortunate enough to develop applications for US market and their broken patent system be careful.
-// #define _KONG_COMPILE_WITH_DDS_LOADER_
+/** Block compressed files (DXT1 to DXT5, BC4 to BC7) stay compressed up to
+the driver, which decompresses them only if the hardware can not sample them. */
+#define _KONG_COMPILE_WITH_DDS_LOADER_
 #ifdef NO_KONG_COMPILE_WITH_DDS_LOADER_
 #undef _KONG_COMPILE_WITH_DDS_LOADER_
 #endif
+//! Define _KONG_COMPILE_WITH_COMPRESSED_TEXTURE_CACHE_ to keep block compressed copies of textures.
+/** IVideoDriver::GetTexture compresses every texture file it decoded, writes a .dds
+file next to it and loads it instead of the source as long as the source is not
+modified again. Needs the dds loader. */
+#define _KONG_COMPILE_WITH_COMPRESSED_TEXTURE_CACHE_
+#ifdef NO_KONG_COMPILE_WITH_COMPRESSED_TEXTURE_CACHE_
+#undef _KONG_COMPILE_WITH_COMPRESSED_TEXTURE_CACHE_
+#endif
+#ifndef _KONG_COMPILE_WITH_DDS_LOADER_
+#undef _KONG_COMPILE_WITH_COMPRESSED_TEXTURE_CACHE_
+#endif
 //! Define _KONG_COMPILE_WITH_TGA_LOADER_ if you want to load .tga files
 #define _KONG_COMPILE_WITH_TGA_LOADER_
 #ifdef NO_KONG_COMPILE_WITH_TGA_LOADER_
@@ -205,14 +205,7 @@ namespace kong
         template <typename T>
         bool Matrix<T>::operator!=(const Matrix<T>& other) const
         {
-            for (int i = 0; i < 16; i++)
-            {
-                if (m_[i] == other.m_[i])
-                {
-                    return false;
-                }
-            }
-            return true;
+            return !(*this == other);
         }
 
         template <typename T>
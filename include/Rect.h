@@ -5,9 +5,9 @@
 #ifndef __KONG_RECT_H_INCLUDED__
 #define __KONG_RECT_H_INCLUDED__
 
-#include "kongTypes.h"
-#include "dimension2d.h"
-#include "Position2d.h"
+#include "KongTypes.h"
+#include "Dimension2d.h"
+#include "Position2D.h"
 
 namespace kong
 {
@@ -51,9 +51,6 @@ namespace kong
             S3DVertex(const core::Vector3Df &pos, const core::Vector3Df & normal, 
                 const SColor &color, const core::Vector2Df &texcoord);
 
-            S3DVertex(const core::Vector3Df &pos, const core::Vector3Df & normal,
-                const SColor &color, const core::Vector2Df &texcoord, const core::Vector3Df &barycentric);
-
             bool operator==(const S3DVertex &other) const;
 
             bool operator!=(const S3DVertex& other) const;
@@ -67,7 +64,6 @@ namespace kong
             core::Vector3Df pos_;
             core::Vector3Df normal_;
             core::Vector2Df texcoord_;
-            core::Vector3Df barycentric_;
             SColor color_;
         };
 
@@ -86,13 +82,6 @@ namespace kong
 
         }
 
-        inline S3DVertex::S3DVertex(const core::Vector3Df& pos, const core::Vector3Df& normal, const SColor& color,
-            const core::Vector2Df& texcoord, const core::Vector3Df& barycentric)
-            : pos_(pos), normal_(normal), texcoord_(texcoord), barycentric_(barycentric), color_(color)
-        {
-
-        }
-
         inline bool S3DVertex::operator==(const S3DVertex& other) const
         {
             return pos_ == other.pos_ && normal_ == other.normal_ && texcoord_ == other.texcoord_ && color_ == other.color_;
@@ -31,10 +31,10 @@ namespace kong
             //! destructor
             virtual ~SAnimatedMesh()
             {
-                // drop meshes
+                // drop meshes, a scene node may still show one of them
                 for (u32 i = 0; i < Meshes.Size(); ++i)
                 {
-                    delete Meshes[i];
+                    Meshes[i]->Drop();
                 }
             }
 
@@ -76,7 +76,7 @@ namespace kong
                 return Meshes[frame];
             }
 
-            //! adds a Mesh
+            //! adds a Mesh, the animated mesh takes over the reference of the caller
             void addMesh(IMesh* mesh)
             {
                 if (mesh)
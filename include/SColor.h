@@ -49,6 +49,29 @@ namespace kong
             //! 128 bit floating point format. 32 bits are used for the red, green, blue and alpha channels.
             ECF_A32B32G32R32F,
 
+            /** Block compressed formats. Every 4x4 block of texels is stored in 8 or 16 bytes. */
+
+            //! DXT1, 4 bits per texel, color and 1 bit alpha.
+            ECF_BC1,
+
+            //! DXT3, 8 bits per texel, color and explicit 4 bit alpha.
+            ECF_BC2,
+
+            //! DXT5, 8 bits per texel, color and interpolated alpha.
+            ECF_BC3,
+
+            //! ATI1, 4 bits per texel, a single channel.
+            ECF_BC4,
+
+            //! ATI2, 8 bits per texel, two channels, used for normal maps.
+            ECF_BC5,
+
+            //! 8 bits per texel, unsigned half float color.
+            ECF_BC6H,
+
+            //! 8 bits per texel, color and alpha of high quality.
+            ECF_BC7,
+
             //! Unknown color format:
             ECF_UNKNOWN
         };
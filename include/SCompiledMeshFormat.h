@@ -0,0 +1,131 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _SCOMPILEDMESHFORMAT_H_
+#define _SCOMPILEDMESHFORMAT_H_
+
+#include "KongTypes.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        //! Layout of the binary compiled mesh files (.kmesh).
+        /** A file starts with a SCompiledMeshHeader, followed by one
+        SCompiledMeshBuffer per mesh buffer and the SCompiledMaterialLayer
+        arrays of their materials. The vertex and index arrays are
+        stored exactly as they are in memory, so loading them is a plain copy.
+        Texture names and the names of the files the mesh was built from are
+        zero terminated strings in a table at the end of the file. All offsets are in bytes from the start of the file. The files are
+        a cache for the machine which wrote them and are not meant to be shipped:
+        they use the native byte order and vertex layout, and every change of
+        these structs or of the vertex types has to bump the version. */
+
+        //! "KMSH"
+        const u32 COMPILED_MESH_MAGIC = 0x48534D4B;
+
+        //! version of the layout below
+        const u32 COMPILED_MESH_VERSION = 3;
+
+        //! extension which is appended to the name of the source file
+        const c8* const COMPILED_MESH_EXTENSION = ".kmesh";
+
+        //! texture name of a layer without texture
+        const u32 COMPILED_MESH_NO_TEXTURE = 0xFFFFFFFF;
+
+        //! bits of SCompiledMaterial::Flags
+        enum E_COMPILED_MATERIAL_FLAG
+        {
+            ECMF_WIREFRAME = 1 << 0,
+            ECMF_POINT_CLOUD = 1 << 1,
+            ECMF_GOURAUD_SHADING = 1 << 2,
+            ECMF_LIGHTING = 1 << 3,
+            ECMF_ZWRITE_ENABLE = 1 << 4,
+            ECMF_BACKFACE_CULLING = 1 << 5,
+            ECMF_FRONTFACE_CULLING = 1 << 6,
+            ECMF_FOG_ENABLE = 1 << 7,
+            ECMF_NORMALIZE_NORMALS = 1 << 8,
+            ECMF_USE_MIP_MAPS = 1 << 9
+        };
+
+        struct SCompiledMaterialLayer
+        {
+            //! offset of the texture name in the string table, or COMPILED_MESH_NO_TEXTURE
+            u32 TextureName;
+            u8 TextureWrapU;
+            u8 TextureWrapV;
+            u8 BilinearFilter;
+            u8 TrilinearFilter;
+            u8 AnisotropicFilter;
+            s8 LODBias;
+            //! 1 if TextureMatrix is not the identity
+            u8 HasTextureMatrix;
+            u8 Padding;
+            f32 TextureMatrix[16];
+        };
+
+        struct SCompiledMaterial
+        {
+            u32 AmbientColor;
+            u32 DiffuseColor;
+            u32 SpecularColor;
+            u32 EmissiveColor;
+            f32 Shininess;
+            u32 MaterialType;
+            f32 Thickness;
+            f32 MaterialTypeParam;
+            u8 ZBuffer;
+            u8 AntiAliasing;
+            u8 ColorMask;
+            u8 ColorMaterial;
+            u8 BlendOperation;
+            u8 PolygonOffsetFactor;
+            u8 PolygonOffsetDirection;
+            u8 Padding;
+            //! E_COMPILED_MATERIAL_FLAG bits
+            u32 Flags;
+        };
+
+        struct SCompiledMeshBuffer
+        {
+            //! video::E_VERTEX_TYPE
+            u32 VertexType;
+            //! size of one vertex, has to match the vertex type of the loading program
+            u32 VertexSize;
+            u32 VertexCount;
+            u32 VertexOffset;
+            //! video::E_INDEX_TYPE
+            u32 IndexType;
+            u32 IndexCount;
+            u32 IndexOffset;
+            //! index of the first of SCompiledMeshHeader::LayerCount layers
+            u32 FirstLayer;
+            f32 BoundingBox[6];
+            SCompiledMaterial Material;
+        };
+
+        struct SCompiledMeshHeader
+        {
+            u32 Magic;
+            u32 Version;
+            //! size of the whole file, a shorter file was not completely written
+            u32 FileSize;
+            u32 MeshBufferCount;
+            //! scene::E_ANIMATED_MESH_TYPE of the source mesh
+            u32 MeshType;
+            //! texture layers per material, video::MATERIAL_MAX_TEXTURES of the writer
+            u32 LayerCount;
+            //! SCompiledMaterialLayer array of all mesh buffers
+            u32 LayerOffset;
+            u32 StringTableOffset;
+            u32 StringTableSize;
+            //! string table offsets of the files besides the source which the mesh was built from
+            u32 DependencyCount;
+            u32 DependencyOffset;
+            f32 BoundingBox[6];
+        };
+
+    } // end namespace scene
+} // end namespace kong
+
+#endif
@@ -6,6 +6,9 @@
 
 #include "KongTypes.h"
 #include "Dimension2d.h"
+#include "EDeviceTypes.h"
+#include "EDriverTypes.h"
+#include "SPath.h"
 
 namespace kong
 {
@@ -15,13 +18,16 @@ namespace kong
     {
     public:
         SKongCreationParameters() :
+            device_type_(EIDT_BEST), driver_type_(video::EDT_SOFTWARE),
             window_size_(core::Dimension2d<u32>(800, 600)), fullscreen_(false), color_bits_(24), z_buffer_bits_(32), stencil_buffer_(true),
-            window_id_(nullptr), event_receiver_(nullptr)
+            window_id_(nullptr), event_receiver_(nullptr), frame_count_(0), quantize_vertex_positions_(false)
         {
         }
 
         SKongCreationParameters(const SKongCreationParameters &other)
         {
+            device_type_ = other.device_type_;
+            driver_type_ = other.driver_type_;
             window_size_ = other.window_size_;
             fullscreen_ = other.fullscreen_;
             color_bits_ = other.color_bits_;
@@ -29,10 +35,15 @@ namespace kong
             stencil_buffer_ = other.stencil_buffer_;
             window_id_ = other.window_id_;
             event_receiver_ = other.event_receiver_;
+            frame_count_ = other.frame_count_;
+            frame_dump_path_ = other.frame_dump_path_;
+            quantize_vertex_positions_ = other.quantize_vertex_positions_;
         }
 
         SKongCreationParameters &operator=(const SKongCreationParameters &other)
         {
+            device_type_ = other.device_type_;
+            driver_type_ = other.driver_type_;
             window_size_ = other.window_size_;
             fullscreen_ = other.fullscreen_;
             color_bits_ = other.color_bits_;
@@ -40,9 +51,21 @@ namespace kong
             stencil_buffer_ = other.stencil_buffer_;
             window_id_ = other.window_id_;
             event_receiver_ = other.event_receiver_;
+            frame_count_ = other.frame_count_;
+            frame_dump_path_ = other.frame_dump_path_;
+            quantize_vertex_positions_ = other.quantize_vertex_positions_;
             return *this;
         }
 
+        //! Type of the device.
+        /** This setting decides the windowing system used by the device, most device
+        types are native to a specific operating system. Default: EIDT_BEST. */
+        E_DEVICE_TYPE device_type_;
+
+        //! Type of video driver used by the headless device.
+        /** Only EDT_NULL and EDT_SOFTWARE work without a window. Default: EDT_SOFTWARE. */
+        video::E_DRIVER_TYPE driver_type_;
+
         core::Dimension2d<u32> window_size_;
 
         //! Should be set to true if the device should run in fullscreen.
@@ -63,6 +86,19 @@ namespace kong
 
         //! A user created event receiver.
         IEventReceiver* event_receiver_;
+
+        //! Number of frames the headless device renders before run() returns false.
+        /** 0 runs until the application stops calling run(). Default: 0. */
+        u32 frame_count_;
+
+        //! Prefix of the files the headless device dumps every frame to.
+        /** The frame number and ".ppm" are appended. Empty disables dumping. Default: empty. */
+        io::SPath frame_dump_path_;
+
+        //! Upload vertex positions as 16 bit fractions of the mesh buffer's bounding box.
+        /** Halves the position stream of the OpenGL shader drivers, the precision is
+        the size of the box divided by 65535. Default: false. */
+        bool quantize_vertex_positions_;
     };
 }
 
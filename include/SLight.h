@@ -36,6 +36,9 @@ namespace kong
             nullptr
         };
 
+        //! Most cascades the shadow map of a directional light can be split into
+        const u32 MAX_SHADOW_CASCADES = 4;
+
         //! structure for holding data describing a dynamic point light.
         /** Irrlicht supports point lights, spot lights, and directional lights.
         */
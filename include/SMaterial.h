@@ -457,7 +457,7 @@ namespace kong
 
         inline bool SMaterial::operator!=(const SMaterial& other) const
         {
-            const bool different = ambient_color_ != other.ambient_color_ ||
+            bool different = ambient_color_ != other.ambient_color_ ||
                 diffuse_color_ != other.diffuse_color_ ||
                 specular_color_ != other.specular_color_ ||
                 emissive_color_ != other.emissive_color_ ||
@@ -469,7 +469,7 @@ namespace kong
                 Thickness != other.Thickness ||
                 AntiAliasing != other.AntiAliasing ||
                 ColorMask != other.ColorMask ||
-                ColorMaterial != other.ColorMask || 
+                ColorMaterial != other.ColorMaterial ||
                 BlendOperation != other.BlendOperation ||
                 PolygonOffsetDirection != other.PolygonOffsetDirection ||
                 PolygonOffsetFactor != other.PolygonOffsetFactor ||
@@ -482,7 +482,11 @@ namespace kong
                 FrontfaceCulling != other.FrontfaceCulling ||
                 FogEnable != other.FogEnable ||
                 NormalizeNormals != other.NormalizeNormals;
-            
+
+            for (u32 i = 0; !different && i < MATERIAL_MAX_TEXTURES; ++i)
+            {
+                different = texture_layer_[i] != other.texture_layer_[i];
+            }
             return different;
         }
 
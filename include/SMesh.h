@@ -149,15 +149,15 @@ namespace kong
 
         inline void SMesh::SetHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint, E_BUFFER_TYPE buffer)
         {
-            //for (u32 i = 0; i<mesh_buffer_.Size(); ++i)
-            //    mesh_buffer_[i]->SetHardwareMappingHint(newMappingHint, buffer);
+            for (u32 i = 0; i<mesh_buffer_.Size(); ++i)
+                mesh_buffer_[i]->SetHardwareMappingHint(newMappingHint, buffer);
         }
 
         //! flags the meshbuffer as changed, reloads hardware buffers
         inline void SMesh::SetDirty(E_BUFFER_TYPE buffer)
         {
-            //for (u32 i = 0; i<mesh_buffer_.Size(); ++i)
-            //    mesh_buffer_[i]->SetDirty(buffer);
+            for (u32 i = 0; i<mesh_buffer_.Size(); ++i)
+                mesh_buffer_[i]->SetDirty(buffer);
         }
     }
 }
@@ -0,0 +1,111 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#ifndef _SRENDERSTATISTICS_H_
+#define _SRENDERSTATISTICS_H_
+
+#include "KongTypes.h"
+#include "SLight.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        //! Passes of a frame which are timed by the scene manager.
+        enum E_RENDER_PASS_TIMING
+        {
+            //! rendering the shadow map
+            ERPT_SHADOW = 0,
+
+            //! forward rendering, or filling the geometry buffer of the deferred path
+            ERPT_GEOMETRY,
+
+            //! lighting the geometry buffer
+            ERPT_LIGHTING,
+
+            //! fxaa and other full screen passes
+            ERPT_POST_PROCESS,
+
+            ERPT_COUNT
+        };
+
+        //! Measurements of the last ISceneManager::DrawAll() or DrawAllDeferred() call.
+        struct SRenderStatistics
+        {
+            SRenderStatistics()
+            {
+                Reset();
+            }
+
+            void Reset()
+            {
+                for (u32 i = 0; i < ERPT_COUNT; ++i)
+                {
+                    pass_time_[i] = 0.f;
+                }
+                for (u32 i = 0; i < video::MAX_SHADOW_CASCADES; ++i)
+                {
+                    cascade_time_[i] = 0.f;
+                    cascade_casters_[i] = 0;
+                }
+                shadow_cascades_ = 0;
+                shadow_views_ = 0;
+                cached_shadow_views_ = 0;
+                changed_nodes_ = 0;
+                registered_nodes_ = 0;
+                visible_nodes_ = 0;
+                culled_nodes_ = 0;
+                shadow_casters_ = 0;
+                draw_calls_ = 0;
+                instances_ = 0;
+                material_changes_ = 0;
+            }
+
+            //! milliseconds spent in each pass
+            /** Measured on the CPU. Drivers which defer their work, like the
+            OpenGL drivers, only report the time needed to submit it. */
+            f32 pass_time_[ERPT_COUNT];
+
+            //! milliseconds spent in each cascade of the shadow map, part of pass_time_[ERPT_SHADOW]
+            f32 cascade_time_[video::MAX_SHADOW_CASCADES];
+
+            //! nodes rendered into each cascade of the shadow map
+            u32 cascade_casters_[video::MAX_SHADOW_CASCADES];
+
+            //! cascades the shadow map was split into
+            u32 shadow_cascades_;
+
+            //! views of all lights in the shadow atlas, cascades and cube faces count one each
+            u32 shadow_views_;
+
+            //! shadow atlas views which kept their content from the last frame
+            u32 cached_shadow_views_;
+
+            //! registered nodes which moved, changed their geometry, appeared or disappeared since the last frame
+            u32 changed_nodes_;
+
+            //! calls of ISceneManager::RegisterNodeForRendering()
+            u32 registered_nodes_;
+
+            //! nodes which were taken for rendering
+            u32 visible_nodes_;
+
+            //! nodes which were rejected, mostly because they are outside of the view frustum
+            u32 culled_nodes_;
+
+            //! nodes rendered into the shadow map, summed over all cascades
+            u32 shadow_casters_;
+
+            //! draw calls of the render queue in all passes, an instanced draw counts once
+            u32 draw_calls_;
+
+            //! mesh buffers the render queue drew with instanced draws
+            u32 instances_;
+
+            //! materials set by the render queue, the other draw calls reused the previous one
+            u32 material_changes_;
+        };
+    } // end namespace scene
+} // end namespace kong
+
+#endif
@@ -5,13 +5,32 @@
 #define _SVIEWFRUSTUM_H_
 #include "Vector.h"
 #include "Matrix.h"
+#include "plane3d.h"
+#include "aabbox3d.h"
 
 namespace kong
 {
     namespace scene
     {
+        //! Relation of a bounding box to a view frustum
+        enum E_FRUSTUM_RELATION
+        {
+            //! the box is completely outside, it can be culled
+            EFR_OUTSIDE = 0,
+
+            //! the box is completely inside
+            EFR_INSIDE,
+
+            //! the box crosses at least one plane
+            EFR_INTERSECTING
+        };
+
+        //! Defines the view frustum. That's the space visible by the camera.
+        /** The planes are extracted from the view projection matrix, their normals
+        point out of the frustum. */
         class SViewFrustum
         {
+        public:
             enum VFPLANES
             {
                 //! Far plane of the frustum. That is the plane farest away from the eye.
@@ -31,6 +50,9 @@ namespace kong
                 VF_PLANE_COUNT
             };
 
+            //! Mask with a bit for every plane, see ClassifyBox()
+            enum { ALL_PLANES = (1 << VF_PLANE_COUNT) - 1 };
+
             SViewFrustum();
 
             //! Copy Constructor
@@ -39,8 +61,27 @@ namespace kong
             //! This constructor creates a view frustum based on a projection and/or view matrix.
             SViewFrustum(const core::Matrixf& mat);
 
+            //! Extracts the planes of a view matrix multiplied with a projection matrix.
+            /** The near plane is taken at a clip space depth of -w, so frustums of
+            projections mapping the depth to [0, w] are a little longer than needed. */
+            void SetFrom(const core::Matrixf& mat);
+
+            //! Returns true if the box is completely outside of the frustum
+            bool IsBoxOutside(const core::aabbox3df& box) const;
+
+            //! Classifies the box against the planes selected by the mask.
+            /** Planes the box is completely inside of are removed from the mask,
+            so the children of a bounding volume need not test them again.
+            \param box Box to classify.
+            \param plane_mask Planes to test, one bit per VFPLANES value.
+            \return The relation of the box to the tested planes. */
+            E_FRUSTUM_RELATION ClassifyBox(const core::aabbox3df& box, u32& plane_mask) const;
+
             core::Vector3Df camera_position_;
 
+            //! all planes enclosing the view frustum
+            core::plane3df planes_[VF_PLANE_COUNT];
+
         private:
             //! Hold a copy of important transform matrices
             enum E_TRANSFORMATION_STATE_FRUSTUM
@@ -60,6 +101,11 @@ namespace kong
         {
             camera_position_ = other.camera_position_;
 
+            for (u32 i = 0; i < VF_PLANE_COUNT; i++)
+            {
+                planes_[i] = other.planes_[i];
+            }
+
             for (u32 i = 0; i < ETS_COUNT_FRUSTUM; i++)
             {
                 matrices[i] = other.matrices[i];
@@ -68,8 +114,78 @@ namespace kong
 
         inline SViewFrustum::SViewFrustum(const core::Matrixf& mat)
         {
+            SetFrom(mat);
+        }
+
+        inline void SViewFrustum::SetFrom(const core::Matrixf& mat)
+        {
+            // vectors are multiplied from the left, so the planes are sums of the columns
+            for (u32 i = 0; i < 3; ++i)
+            {
+                planes_[VF_LEFT_PLANE].Normal(i) = mat(i, 3) + mat(i, 0);
+                planes_[VF_RIGHT_PLANE].Normal(i) = mat(i, 3) - mat(i, 0);
+                planes_[VF_BOTTOM_PLANE].Normal(i) = mat(i, 3) + mat(i, 1);
+                planes_[VF_TOP_PLANE].Normal(i) = mat(i, 3) - mat(i, 1);
+                planes_[VF_NEAR_PLANE].Normal(i) = mat(i, 3) + mat(i, 2);
+                planes_[VF_FAR_PLANE].Normal(i) = mat(i, 3) - mat(i, 2);
+            }
+            planes_[VF_LEFT_PLANE].D = mat(3, 3) + mat(3, 0);
+            planes_[VF_RIGHT_PLANE].D = mat(3, 3) - mat(3, 0);
+            planes_[VF_BOTTOM_PLANE].D = mat(3, 3) + mat(3, 1);
+            planes_[VF_TOP_PLANE].D = mat(3, 3) - mat(3, 1);
+            planes_[VF_NEAR_PLANE].D = mat(3, 3) + mat(3, 2);
+            planes_[VF_FAR_PLANE].D = mat(3, 3) - mat(3, 2);
+
+            // normalize and turn the normals outwards
+            for (u32 i = 0; i < VF_PLANE_COUNT; ++i)
+            {
+                const f32 length = planes_[i].Normal.GetLength();
+                if (length > 0.f)
+                {
+                    const f32 scale = -1.f / length;
+                    planes_[i].Normal.x_ *= scale;
+                    planes_[i].Normal.y_ *= scale;
+                    planes_[i].Normal.z_ *= scale;
+                    planes_[i].D *= scale;
+                }
+            }
+        }
+
+        inline bool SViewFrustum::IsBoxOutside(const core::aabbox3df& box) const
+        {
+            for (u32 i = 0; i < VF_PLANE_COUNT; ++i)
+            {
+                if (box.classifyPlaneRelation(planes_[i]) == core::ISREL3D_FRONT)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline E_FRUSTUM_RELATION SViewFrustum::ClassifyBox(const core::aabbox3df& box, u32& plane_mask) const
+        {
+            for (u32 i = 0; i < VF_PLANE_COUNT; ++i)
+            {
+                if ((plane_mask & (1 << i)) == 0)
+                {
+                    continue;
+                }
+
+                const core::EIntersectionRelation3D relation = box.classifyPlaneRelation(planes_[i]);
+                if (relation == core::ISREL3D_FRONT)
+                {
+                    return EFR_OUTSIDE;
+                }
+                if (relation == core::ISREL3D_BACK)
+                {
+                    plane_mask &= ~(1 << i);
+                }
+            }
+
+            return plane_mask == 0 ? EFR_INSIDE : EFR_INTERSECTING;
         }
     }
 }
 
-#endif
\ No newline at end of file
+#endif
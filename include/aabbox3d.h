@@ -312,10 +312,10 @@ namespace kong
                     farPoint.z_ = MaxEdge.z_;
                 }
 
-                if (plane.Normal.dotProduct(nearPoint) + plane.D > (T)0)
+                if (plane.Normal.DotProduct(nearPoint) + plane.D > (T)0)
                     return ISREL3D_FRONT;
 
-                if (plane.Normal.dotProduct(farPoint) + plane.D > (T)0)
+                if (plane.Normal.DotProduct(farPoint) + plane.D > (T)0)
                     return ISREL3D_CLIPPED;
 
                 return ISREL3D_BACK;
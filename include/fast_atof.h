@@ -6,6 +6,7 @@
 
 #include "KongMath.h"
 #include "KongString.h"
+#include <climits>
 
 namespace kong
 {
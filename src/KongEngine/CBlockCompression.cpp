@@ -0,0 +1,1255 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CBlockCompression.h"
+#include "CImage.h"
+#include "CImagePyramid.h"
+#include "CThreadPool.h"
+#include <cmath>
+#include <cstring>
+
+namespace kong
+{
+    namespace video
+    {
+        //! subset of every texel in the 64 partitions of two subsets, one bit per texel
+        static const u16 PARTITIONS_2[64] =
+        {
+            0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+            0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+            0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+            0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+            0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+            0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+            0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+            0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22
+        };
+
+        //! subset of every texel in the 64 partitions of three subsets, two bits per texel
+        static const u32 PARTITIONS_3[64] =
+        {
+            0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+            0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+            0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+            0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+            0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+            0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+            0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+            0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254
+        };
+
+        //! texel whose index is one bit shorter in the second subset of two
+        static const u8 ANCHORS_2[64] =
+        {
+            15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+            15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+            15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+            6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+        };
+
+        //! texels whose indices are one bit shorter in the second and third subset of three
+        static const u8 ANCHORS_3[64][2] =
+        {
+            { 3, 15 }, { 3, 8 }, { 15, 8 }, { 15, 3 }, { 8, 15 }, { 3, 15 }, { 15, 3 }, { 15, 8 },
+            { 8, 15 }, { 8, 15 }, { 6, 15 }, { 6, 15 }, { 6, 15 }, { 5, 15 }, { 3, 15 }, { 3, 8 },
+            { 3, 15 }, { 3, 8 }, { 8, 15 }, { 15, 3 }, { 3, 15 }, { 3, 8 }, { 6, 15 }, { 10, 8 },
+            { 5, 3 }, { 8, 15 }, { 8, 6 }, { 6, 10 }, { 8, 15 }, { 5, 15 }, { 15, 10 }, { 15, 8 },
+            { 8, 15 }, { 15, 3 }, { 3, 15 }, { 5, 10 }, { 6, 10 }, { 10, 8 }, { 8, 9 }, { 15, 10 },
+            { 15, 6 }, { 3, 15 }, { 15, 8 }, { 5, 15 }, { 15, 3 }, { 15, 6 }, { 15, 6 }, { 15, 8 },
+            { 3, 15 }, { 15, 3 }, { 5, 15 }, { 5, 15 }, { 5, 15 }, { 8, 15 }, { 5, 15 }, { 10, 15 },
+            { 5, 15 }, { 10, 15 }, { 8, 15 }, { 13, 15 }, { 15, 3 }, { 12, 15 }, { 3, 15 }, { 3, 8 }
+        };
+
+        //! weights of the interpolated endpoints of BC6H and BC7, in 64ths
+        static const u8 WEIGHTS_2[4] = { 0, 21, 43, 64 };
+        static const u8 WEIGHTS_3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+        static const u8 WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        static const u8* GetWeights(u32 index_bits)
+        {
+            return index_bits == 2 ? WEIGHTS_2 : (index_bits == 3 ? WEIGHTS_3 : WEIGHTS_4);
+        }
+
+        //! reads the fields of a block, lowest bit first
+        struct SBitReader
+        {
+            explicit SBitReader(const u8* data)
+                : data_(data), position_(0)
+            {
+            }
+
+            u32 Read(u32 count)
+            {
+                u32 value = 0;
+                for (u32 i = 0; i < count; ++i, ++position_)
+                {
+                    value |= ((data_[position_ >> 3] >> (position_ & 7)) & 1u) << i;
+                }
+                return value;
+            }
+
+            const u8* data_;
+            u32 position_;
+        };
+
+        static u32 MakeColor(u32 a, u32 r, u32 g, u32 b)
+        {
+            return (a << 24) | (r << 16) | (g << 8) | b;
+        }
+
+        //! the four colors two endpoints of BC1 to BC3 stand for
+        static void GetColorPalette(u32 c0, u32 c1, bool three_color_mode, u32 r[4], u32 g[4], u32 b[4], u32 a[4])
+        {
+            a[0] = a[1] = a[2] = a[3] = 255;
+            r[0] = ((c0 >> 11) & 0x1f) << 3;
+            g[0] = ((c0 >> 5) & 0x3f) << 2;
+            b[0] = (c0 & 0x1f) << 3;
+            r[1] = ((c1 >> 11) & 0x1f) << 3;
+            g[1] = ((c1 >> 5) & 0x3f) << 2;
+            b[1] = (c1 & 0x1f) << 3;
+            for (u32 i = 0; i < 2; ++i)
+            {
+                r[i] |= r[i] >> 5;
+                g[i] |= g[i] >> 6;
+                b[i] |= b[i] >> 5;
+            }
+
+            if (c0 > c1 || !three_color_mode)
+            {
+                r[2] = (2 * r[0] + r[1]) / 3;
+                g[2] = (2 * g[0] + g[1]) / 3;
+                b[2] = (2 * b[0] + b[1]) / 3;
+                r[3] = (r[0] + 2 * r[1]) / 3;
+                g[3] = (g[0] + 2 * g[1]) / 3;
+                b[3] = (b[0] + 2 * b[1]) / 3;
+            }
+            else
+            {
+                r[2] = (r[0] + r[1]) / 2;
+                g[2] = (g[0] + g[1]) / 2;
+                b[2] = (b[0] + b[1]) / 2;
+                r[3] = g[3] = b[3] = a[3] = 0;
+            }
+        }
+
+        //! color of BC1 to BC3, the three color mode with transparent black is only used by BC1
+        static void DecodeColorBlock(const u8* block, u32 texels[16], bool three_color_mode)
+        {
+            const u32 c0 = block[0] | (block[1] << 8);
+            const u32 c1 = block[2] | (block[3] << 8);
+
+            u32 r[4], g[4], b[4], a[4];
+            GetColorPalette(c0, c1, three_color_mode, r, g, b, a);
+
+            const u32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<u32>(block[7]) << 24);
+            for (u32 i = 0; i < 16; ++i)
+            {
+                const u32 index = (indices >> (i * 2)) & 3;
+                texels[i] = MakeColor(a[index], r[index], g[index], b[index]);
+            }
+        }
+
+        //! the eight values two endpoints of a channel block stand for
+        static void GetChannelPalette(u32 e0, u32 e1, u32 palette[8])
+        {
+            palette[0] = e0;
+            palette[1] = e1;
+            if (palette[0] > palette[1])
+            {
+                for (u32 i = 2; i < 8; ++i)
+                {
+                    palette[i] = ((8 - i) * palette[0] + (i - 1) * palette[1]) / 7;
+                }
+            }
+            else
+            {
+                for (u32 i = 2; i < 6; ++i)
+                {
+                    palette[i] = ((6 - i) * palette[0] + (i - 1) * palette[1]) / 5;
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        //! alpha of BC3, also the channels of BC4 and BC5
+        static void DecodeChannelBlock(const u8* block, u8 values[16])
+        {
+            u32 palette[8];
+            GetChannelPalette(block[0], block[1], palette);
+
+            u64 indices = 0;
+            for (u32 i = 0; i < 6; ++i)
+            {
+                indices |= static_cast<u64>(block[2 + i]) << (i * 8);
+            }
+            for (u32 i = 0; i < 16; ++i)
+            {
+                values[i] = static_cast<u8>(palette[(indices >> (i * 3)) & 7]);
+            }
+        }
+
+        //! a BC7 mode, the fields follow in this order
+        struct SBC7Mode
+        {
+            u8 subsets_;
+            u8 partition_bits_;
+            u8 rotation_bits_;
+            u8 index_selection_bits_;
+            u8 color_bits_;
+            u8 alpha_bits_;
+            u8 endpoint_pbits_;
+            u8 shared_pbits_;
+            u8 index_bits_;
+            u8 index_bits2_;
+        };
+
+        static const SBC7Mode BC7_MODES[8] =
+        {
+            { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+            { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+            { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+            { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+            { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+            { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+            { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+            { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+        };
+
+        static void DecodeBC7(const u8* block, u32 texels[16])
+        {
+            u32 mode = 0;
+            while (mode < 8 && !(block[0] & (1 << mode)))
+            {
+                ++mode;
+            }
+            if (mode == 8)
+            {
+                // reserved
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    texels[i] = 0;
+                }
+                return;
+            }
+
+            const SBC7Mode &info = BC7_MODES[mode];
+            SBitReader reader(block);
+            reader.Read(mode + 1);
+            const u32 partition = reader.Read(info.partition_bits_);
+            const u32 rotation = reader.Read(info.rotation_bits_);
+            const u32 index_selection = reader.Read(info.index_selection_bits_);
+
+            // red, green, blue and alpha of the two endpoints of every subset
+            u32 endpoints[3][2][4];
+            for (u32 c = 0; c < 4; ++c)
+            {
+                const u32 bits = c < 3 ? info.color_bits_ : info.alpha_bits_;
+                for (u32 s = 0; s < info.subsets_; ++s)
+                {
+                    for (u32 e = 0; e < 2; ++e)
+                    {
+                        endpoints[s][e][c] = reader.Read(bits);
+                    }
+                }
+            }
+
+            u32 pbits[3][2] = { { 0, 0 }, { 0, 0 }, { 0, 0 } };
+            for (u32 s = 0; s < info.subsets_; ++s)
+            {
+                if (info.endpoint_pbits_)
+                {
+                    pbits[s][0] = reader.Read(1);
+                    pbits[s][1] = reader.Read(1);
+                }
+                else if (info.shared_pbits_)
+                {
+                    pbits[s][0] = pbits[s][1] = reader.Read(1);
+                }
+            }
+
+            const bool has_pbits = info.endpoint_pbits_ || info.shared_pbits_;
+            for (u32 s = 0; s < info.subsets_; ++s)
+            {
+                for (u32 e = 0; e < 2; ++e)
+                {
+                    for (u32 c = 0; c < 4; ++c)
+                    {
+                        u32 bits = c < 3 ? info.color_bits_ : info.alpha_bits_;
+                        if (bits == 0)
+                        {
+                            endpoints[s][e][c] = 255;
+                            continue;
+                        }
+
+                        u32 value = endpoints[s][e][c];
+                        if (has_pbits)
+                        {
+                            value = (value << 1) | pbits[s][e];
+                            ++bits;
+                        }
+                        value <<= 8 - bits;
+                        endpoints[s][e][c] = value | (value >> bits);
+                    }
+                }
+            }
+
+            u32 subset_of[16];
+            for (u32 i = 0; i < 16; ++i)
+            {
+                subset_of[i] = info.subsets_ == 1 ? 0 :
+                    (info.subsets_ == 2 ? (PARTITIONS_2[partition] >> i) & 1 : (PARTITIONS_3[partition] >> (i * 2)) & 3);
+            }
+
+            // the first index of every subset has an implied highest bit of 0
+            u32 indices[16];
+            for (u32 i = 0; i < 16; ++i)
+            {
+                bool anchor = i == 0;
+                if (info.subsets_ == 2)
+                {
+                    anchor = anchor || i == ANCHORS_2[partition];
+                }
+                else if (info.subsets_ == 3)
+                {
+                    anchor = anchor || i == ANCHORS_3[partition][0] || i == ANCHORS_3[partition][1];
+                }
+                indices[i] = reader.Read(info.index_bits_ - (anchor ? 1 : 0));
+            }
+
+            u32 indices2[16];
+            for (u32 i = 0; i < 16 && info.index_bits2_ > 0; ++i)
+            {
+                indices2[i] = reader.Read(info.index_bits2_ - (i == 0 ? 1 : 0));
+            }
+
+            for (u32 i = 0; i < 16; ++i)
+            {
+                const u32 (&endpoint)[2][4] = endpoints[subset_of[i]];
+                u32 color_weight = GetWeights(info.index_bits_)[indices[i]];
+                u32 alpha_weight = color_weight;
+                if (info.index_bits2_ > 0)
+                {
+                    if (index_selection)
+                    {
+                        color_weight = GetWeights(info.index_bits2_)[indices2[i]];
+                    }
+                    else
+                    {
+                        alpha_weight = GetWeights(info.index_bits2_)[indices2[i]];
+                    }
+                }
+
+                u32 value[4];
+                for (u32 c = 0; c < 4; ++c)
+                {
+                    const u32 weight = c < 3 ? color_weight : alpha_weight;
+                    value[c] = ((64 - weight) * endpoint[0][c] + weight * endpoint[1][c] + 32) >> 6;
+                }
+                if (rotation > 0)
+                {
+                    core::swap(value[3], value[rotation - 1]);
+                }
+                texels[i] = MakeColor(value[3], value[0], value[1], value[2]);
+            }
+        }
+
+        //! where bits of a BC6H block go: endpoint * 3 + channel, lowest bit and count
+        struct SBC6HField
+        {
+            u8 field_;
+            u8 shift_;
+            u8 count_;
+        };
+
+        //! a BC6H mode, the fields follow the mode bits
+        struct SBC6HMode
+        {
+            u8 mode_;
+            u8 mode_bits_;
+            u8 regions_;
+            bool transformed_;
+            u8 endpoint_bits_;
+            u8 delta_bits_[3];
+            SBC6HField fields_[28];
+        };
+
+        enum E_BC6H_FIELD { R0 = 0, G0, B0, R1, G1, B1, R2, G2, B2, R3, G3, B3 };
+
+        static const SBC6HMode BC6H_MODES[14] =
+        {
+            { 0x00, 2, 2, true, 10, { 5, 5, 5 }, { { G2, 4, 1 }, { B2, 4, 1 }, { B3, 4, 1 }, { R0, 0, 10 }, { G0, 0, 10 }, { B0, 0, 10 },
+                { R1, 0, 5 }, { G3, 4, 1 }, { G2, 0, 4 }, { G1, 0, 5 }, { B3, 0, 1 }, { G3, 0, 4 }, { B1, 0, 5 }, { B3, 1, 1 },
+                { B2, 0, 4 }, { R2, 0, 5 }, { B3, 2, 1 }, { R3, 0, 5 }, { B3, 3, 1 } } },
+            { 0x01, 2, 2, true, 7, { 6, 6, 6 }, { { G2, 5, 1 }, { G3, 4, 1 }, { G3, 5, 1 }, { R0, 0, 7 }, { B3, 0, 1 }, { B3, 1, 1 },
+                { B2, 4, 1 }, { G0, 0, 7 }, { B2, 5, 1 }, { B3, 2, 1 }, { G2, 4, 1 }, { B0, 0, 7 }, { B3, 3, 1 }, { B3, 5, 1 },
+                { B3, 4, 1 }, { R1, 0, 6 }, { G2, 0, 4 }, { G1, 0, 6 }, { G3, 0, 4 }, { B1, 0, 6 }, { B2, 0, 4 }, { R2, 0, 6 },
+                { R3, 0, 6 } } },
+            { 0x02, 5, 2, true, 11, { 5, 4, 4 }, { { R0, 0, 10 }, { G0, 0, 10 }, { B0, 0, 10 }, { R1, 0, 5 }, { R0, 10, 1 },
+                { G2, 0, 4 }, { G1, 0, 4 }, { G0, 10, 1 }, { B3, 0, 1 }, { G3, 0, 4 }, { B1, 0, 4 }, { B0, 10, 1 }, { B3, 1, 1 },
+                { B2, 0, 4 }, { R2, 0, 5 }, { B3, 2, 1 }, { R3, 0, 5 }, { B3, 3, 1 } } },
+            { 0x06, 5, 2, true, 11, { 4, 5, 4 }, { { R0, 0, 10 }, { G0, 0, 10 }, { B0, 0, 10 }, { R1, 0, 4 }, { R0, 10, 1 },
+                { G3, 4, 1 }, { G2, 0, 4 }, { G1, 0, 5 }, { G0, 10, 1 }, { G3, 0, 4 }, { B1, 0, 4 }, { B0, 10, 1 }, { B3, 1, 1 },
+                { B2, 0, 4 }, { R2, 0, 4 }, { B3, 0, 1 }, { B3, 2, 1 }, { R3, 0, 4 }, { G2, 4, 1 }, { B3, 3, 1 } } },
+            { 0x0a, 5, 2, true, 11, { 4, 4, 5 }, { { R0, 0, 10 }, { G0, 0, 10 }, { B0, 0, 10 }, { R1, 0, 4 }, { R0, 10, 1 },
+                { B2, 4, 1 }, { G2, 0, 4 }, { G1, 0, 4 }, { G0, 10, 1 }, { B3, 0, 1 }, { G3, 0, 4 }, { B1, 0, 5 }, { B0, 10, 1 },
+                { B2, 0, 4 }, { R2, 0, 4 }, { B3, 1, 1 }, { B3, 2, 1 }, { R3, 0, 4 }, { B3, 4, 1 }, { B3, 3, 1 } } },
+            { 0x0e, 5, 2, true, 9, { 5, 5, 5 }, { { R0, 0, 9 }, { B2, 4, 1 }, { G0, 0, 9 }, { G2, 4, 1 }, { B0, 0, 9 }, { B3, 4, 1 },
+                { R1, 0, 5 }, { G3, 4, 1 }, { G2, 0, 4 }, { G1, 0, 5 }, { B3, 0, 1 }, { G3, 0, 4 }, { B1, 0, 5 }, { B3, 1, 1 },
+                { B2, 0, 4 }, { R2, 0, 5 }, { B3, 2, 1 }, { R3, 0, 5 }, { B3, 3, 1 } } },
+            { 0x12, 5, 2, true, 8, { 6, 5, 5 }, { { R0, 0, 8 }, { G3, 4, 1 }, { B2, 4, 1 }, { G0, 0, 8 }, { B3, 2, 1 }, { G2, 4, 1 },
+                { B0, 0, 8 }, { B3, 3, 1 }, { B3, 4, 1 }, { R1, 0, 6 }, { G2, 0, 4 }, { G1, 0, 5 }, { B3, 0, 1 }, { G3, 0, 4 },
+                { B1, 0, 5 }, { B3, 1, 1 }, { B2, 0, 4 }, { R2, 0, 6 }, { R3, 0, 6 } } },
+            { 0x16, 5, 2, true, 8, { 5, 6, 5 }, { { R0, 0, 8 }, { B3, 0, 1 }, { B2, 4, 1 }, { G0, 0, 8 }, { G2, 5, 1 }, { G2, 4, 1 },
+                { B0, 0, 8 }, { G3, 5, 1 }, { B3, 4, 1 }, { R1, 0, 5 }, { G3, 4, 1 }, { G2, 0, 4 }, { G1, 0, 6 }, { G3, 0, 4 },
+                { B1, 0, 5 }, { B3, 1, 1 }, { B2, 0, 4 }, { R2, 0, 5 }, { B3, 2, 1 }, { R3, 0, 5 }, { B3, 3, 1 } } },
+            { 0x1a, 5, 2, true, 8, { 5, 5, 6 }, { { R0, 0, 8 }, { B3, 1, 1 }, { B2, 4, 1 }, { G0, 0, 8 }, { B2, 5, 1 }, { G2, 4, 1 },
+                { B0, 0, 8 }, { B3, 5, 1 }, { B3, 4, 1 }, { R1, 0, 5 }, { G3, 4, 1 }, { G2, 0, 4 }, { G1, 0, 5 }, { B3, 0, 1 },
+                { G3, 0, 4 }, { B1, 0, 6 }, { B2, 0, 4 }, { R2, 0, 5 }, { B3, 2, 1 }, { R3, 0, 5 }, { B3, 3, 1 } } },
+            { 0x1e, 5, 2, false, 6, { 6, 6, 6 }, { { R0, 0, 6 }, { G3, 4, 1 }, { B3, 0, 1 }, { B3, 1, 1 }, { B2, 4, 1 }, { G0, 0, 6 },
+                { G2, 5, 1 }, { B2, 5, 1 }, { B3, 2, 1 }, { G2, 4, 1 }, { B0, 0, 6 }, { G3, 5, 1 }, { B3, 3, 1 }, { B3, 5, 1 },
+                { B3, 4, 1 }, { R1, 0, 6 }, { G2, 0, 4 }, { G1, 0, 6 }, { G3, 0, 4 }, { B1, 0, 6 }, { B2, 0, 4 }, { R2, 0, 6 },
+                { R3, 0, 6 } } },
+            { 0x03, 5, 1, false, 10, { 10, 10, 10 }, { { R0, 0, 10 }, { G0, 0, 10 }, { B0, 0, 10 }, { R1, 0, 10 }, { G1, 0, 10 },
+                { B1, 0, 10 } } },
+            { 0x07, 5, 1, true, 11, { 9, 9, 9 }, { { R0, 0, 10 }, { G0, 0, 10 }, { B0, 0, 10 }, { R1, 0, 9 }, { R0, 10, 1 },
+                { G1, 0, 9 }, { G0, 10, 1 }, { B1, 0, 9 }, { B0, 10, 1 } } },
+            { 0x0b, 5, 1, true, 12, { 8, 8, 8 }, { { R0, 0, 10 }, { G0, 0, 10 }, { B0, 0, 10 }, { R1, 0, 8 }, { R0, 11, 1 },
+                { R0, 10, 1 }, { G1, 0, 8 }, { G0, 11, 1 }, { G0, 10, 1 }, { B1, 0, 8 }, { B0, 11, 1 }, { B0, 10, 1 } } },
+            { 0x0f, 5, 1, true, 16, { 4, 4, 4 }, { { R0, 0, 10 }, { G0, 0, 10 }, { B0, 0, 10 }, { R1, 0, 4 }, { R0, 15, 1 },
+                { R0, 14, 1 }, { R0, 13, 1 }, { R0, 12, 1 }, { R0, 11, 1 }, { R0, 10, 1 }, { G1, 0, 4 }, { G0, 15, 1 },
+                { G0, 14, 1 }, { G0, 13, 1 }, { G0, 12, 1 }, { G0, 11, 1 }, { G0, 10, 1 }, { B1, 0, 4 }, { B0, 15, 1 },
+                { B0, 14, 1 }, { B0, 13, 1 }, { B0, 12, 1 }, { B0, 11, 1 }, { B0, 10, 1 } } }
+        };
+
+        //! turns an unsigned half float into an 8 bit channel, clamped to 0..1
+        static u32 HalfToUnorm8(u32 half)
+        {
+            const u32 exponent = (half >> 10) & 0x1f;
+            const u32 mantissa = half & 0x3ff;
+            if (exponent >= 15)
+            {
+                // 1 and more, also infinity and nan
+                return 255;
+            }
+            const f32 value = exponent == 0 ? mantissa / 16777216.f :
+                (1.f + mantissa / 1024.f) / static_cast<f32>(1 << (15 - exponent));
+            return static_cast<u32>(value * 255.f + 0.5f);
+        }
+
+        static void DecodeBC6H(const u8* block, u32 texels[16])
+        {
+            SBitReader reader(block);
+            u32 mode_value = reader.Read(2);
+            if (mode_value > 1)
+            {
+                mode_value |= reader.Read(3) << 2;
+            }
+
+            const SBC6HMode *mode = nullptr;
+            for (u32 i = 0; i < 14; ++i)
+            {
+                if (BC6H_MODES[i].mode_ == mode_value)
+                {
+                    mode = &BC6H_MODES[i];
+                    break;
+                }
+            }
+            if (mode == nullptr)
+            {
+                // reserved
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    texels[i] = 0xff000000;
+                }
+                return;
+            }
+
+            u32 endpoints[4][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+            for (u32 i = 0; i < 28 && mode->fields_[i].count_ > 0; ++i)
+            {
+                const SBC6HField &field = mode->fields_[i];
+                endpoints[field.field_ / 3][field.field_ % 3] |= reader.Read(field.count_) << field.shift_;
+            }
+            const u32 partition = mode->regions_ == 2 ? reader.Read(5) : 0;
+
+            // the other endpoints are signed deltas to the first one
+            const u32 endpoint_count = mode->regions_ * 2;
+            const u32 endpoint_mask = (1u << mode->endpoint_bits_) - 1;
+            if (mode->transformed_)
+            {
+                for (u32 e = 1; e < endpoint_count; ++e)
+                {
+                    for (u32 c = 0; c < 3; ++c)
+                    {
+                        const u32 bits = mode->delta_bits_[c];
+                        s32 delta = static_cast<s32>(endpoints[e][c]);
+                        if (delta & (1 << (bits - 1)))
+                        {
+                            delta -= 1 << bits;
+                        }
+                        endpoints[e][c] = (endpoints[0][c] + delta) & endpoint_mask;
+                    }
+                }
+            }
+
+            for (u32 e = 0; e < endpoint_count; ++e)
+            {
+                for (u32 c = 0; c < 3; ++c)
+                {
+                    u32 &value = endpoints[e][c];
+                    if (mode->endpoint_bits_ >= 15)
+                    {
+                        continue;
+                    }
+                    if (value == endpoint_mask)
+                    {
+                        value = 0xffff;
+                    }
+                    else if (value != 0)
+                    {
+                        value = ((value << 16) + 0x8000) >> mode->endpoint_bits_;
+                    }
+                }
+            }
+
+            const u32 index_bits = mode->regions_ == 2 ? 3 : 4;
+            const u8 *weights = GetWeights(index_bits);
+            for (u32 i = 0; i < 16; ++i)
+            {
+                const u32 region = mode->regions_ == 2 ? (PARTITIONS_2[partition] >> i) & 1 : 0;
+                const bool anchor = i == 0 || (mode->regions_ == 2 && i == ANCHORS_2[partition]);
+                const u32 weight = weights[reader.Read(index_bits - (anchor ? 1 : 0))];
+
+                u32 value[3];
+                for (u32 c = 0; c < 3; ++c)
+                {
+                    const u32 interpolated = ((64 - weight) * endpoints[region * 2][c] + weight * endpoints[region * 2 + 1][c] + 32) >> 6;
+                    value[c] = HalfToUnorm8((interpolated * 31) >> 6);
+                }
+                texels[i] = MakeColor(255, value[0], value[1], value[2]);
+            }
+        }
+
+        //! writes the fields of a block, lowest bit first
+        struct SBitWriter
+        {
+            explicit SBitWriter(u8* data)
+                : data_(data), position_(0)
+            {
+                memset(data, 0, 16);
+            }
+
+            void Write(u32 value, u32 count)
+            {
+                for (u32 i = 0; i < count; ++i, ++position_)
+                {
+                    data_[position_ >> 3] |= static_cast<u8>(((value >> i) & 1u) << (position_ & 7));
+                }
+            }
+
+            u8* data_;
+            u32 position_;
+        };
+
+        //! red, green, blue and alpha of the texels of a block
+        static void GetChannels(const u32 texels[16], f32 colors[16][4])
+        {
+            for (u32 i = 0; i < 16; ++i)
+            {
+                colors[i][0] = static_cast<f32>((texels[i] >> 16) & 0xff);
+                colors[i][1] = static_cast<f32>((texels[i] >> 8) & 0xff);
+                colors[i][2] = static_cast<f32>(texels[i] & 0xff);
+                colors[i][3] = static_cast<f32>(texels[i] >> 24);
+            }
+        }
+
+        //! places both endpoints at the ends of the line along which the texels spread most
+        /** \param channels 3 to fit colors, 4 to fit colors and alpha. */
+        static void FitEndpoints(const f32 colors[16][4], u32 channels, f32 end0[4], f32 end1[4])
+        {
+            f32 mean[4] = { 0.f, 0.f, 0.f, 0.f };
+            for (u32 i = 0; i < 16; ++i)
+            {
+                for (u32 c = 0; c < channels; ++c)
+                {
+                    mean[c] += colors[i][c] / 16.f;
+                }
+            }
+
+            f32 covariance[4][4] = {};
+            for (u32 i = 0; i < 16; ++i)
+            {
+                for (u32 a = 0; a < channels; ++a)
+                {
+                    for (u32 b = 0; b < channels; ++b)
+                    {
+                        covariance[a][b] += (colors[i][a] - mean[a]) * (colors[i][b] - mean[b]);
+                    }
+                }
+            }
+
+            // power iteration, starting at the channel which varies most
+            u32 largest = 0;
+            for (u32 c = 1; c < channels; ++c)
+            {
+                if (covariance[c][c] > covariance[largest][largest])
+                {
+                    largest = c;
+                }
+            }
+            f32 axis[4] = { 0.f, 0.f, 0.f, 0.f };
+            for (u32 c = 0; c < channels; ++c)
+            {
+                axis[c] = covariance[largest][c];
+            }
+            for (u32 iteration = 0; iteration < 8; ++iteration)
+            {
+                f32 next[4] = { 0.f, 0.f, 0.f, 0.f };
+                f32 length = 0.f;
+                for (u32 a = 0; a < channels; ++a)
+                {
+                    for (u32 b = 0; b < channels; ++b)
+                    {
+                        next[a] += covariance[a][b] * axis[b];
+                    }
+                    length += next[a] * next[a];
+                }
+                if (length < 1e-6f)
+                {
+                    break;
+                }
+                length = 1.f / sqrtf(length);
+                for (u32 c = 0; c < channels; ++c)
+                {
+                    axis[c] = next[c] * length;
+                }
+            }
+
+            f32 min_t = 0.f, max_t = 0.f;
+            for (u32 i = 0; i < 16; ++i)
+            {
+                f32 t = 0.f;
+                for (u32 c = 0; c < channels; ++c)
+                {
+                    t += (colors[i][c] - mean[c]) * axis[c];
+                }
+                min_t = core::min_(min_t, t);
+                max_t = core::max_(max_t, t);
+            }
+            for (u32 c = 0; c < channels; ++c)
+            {
+                end0[c] = core::clamp(mean[c] + axis[c] * max_t, 0.f, 255.f);
+                end1[c] = core::clamp(mean[c] + axis[c] * min_t, 0.f, 255.f);
+            }
+        }
+
+        //! least squares fit of both endpoints to texels which are end0 * (1 - weight) + end1 * weight
+        /** \return False if the weights do not determine the endpoints, e.g. if they are all equal. */
+        static bool RefitEndpoints(const f32 colors[16][4], const f32 weights[16], u32 channels, f32 end0[4], f32 end1[4])
+        {
+            f32 aa = 0.f, bb = 0.f, ab = 0.f;
+            f32 ax[4] = { 0.f, 0.f, 0.f, 0.f };
+            f32 bx[4] = { 0.f, 0.f, 0.f, 0.f };
+            for (u32 i = 0; i < 16; ++i)
+            {
+                const f32 a = 1.f - weights[i];
+                const f32 b = weights[i];
+                aa += a * a;
+                bb += b * b;
+                ab += a * b;
+                for (u32 c = 0; c < channels; ++c)
+                {
+                    ax[c] += a * colors[i][c];
+                    bx[c] += b * colors[i][c];
+                }
+            }
+
+            const f32 determinant = aa * bb - ab * ab;
+            if (fabsf(determinant) < 1e-4f)
+            {
+                return false;
+            }
+            for (u32 c = 0; c < channels; ++c)
+            {
+                end0[c] = core::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.f, 255.f);
+                end1[c] = core::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.f, 255.f);
+            }
+            return true;
+        }
+
+        static u32 ToRGB565(const f32 color[4])
+        {
+            const u32 r = static_cast<u32>(color[0] * 31.f / 255.f + 0.5f);
+            const u32 g = static_cast<u32>(color[1] * 63.f / 255.f + 0.5f);
+            const u32 b = static_cast<u32>(color[2] * 31.f / 255.f + 0.5f);
+            return (r << 11) | (g << 5) | b;
+        }
+
+        //! chooses the nearest of the four colors for every texel
+        /** \param weights Receives how far every chosen color is from c0 to c1.
+        \return The summed squared error. */
+        static f32 FindColorIndices(const f32 colors[16][4], u32 c0, u32 c1, u32& indices, f32 weights[16])
+        {
+            static const f32 PALETTE_WEIGHTS[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+
+            u32 r[4], g[4], b[4], a[4];
+            GetColorPalette(c0, c1, false, r, g, b, a);
+
+            indices = 0;
+            f32 error = 0.f;
+            for (u32 i = 0; i < 16; ++i)
+            {
+                u32 best = 0;
+                f32 best_error = 0.f;
+                for (u32 j = 0; j < 4; ++j)
+                {
+                    const f32 dr = colors[i][0] - r[j];
+                    const f32 dg = colors[i][1] - g[j];
+                    const f32 db = colors[i][2] - b[j];
+                    const f32 distance = dr * dr + dg * dg + db * db;
+                    if (j == 0 || distance < best_error)
+                    {
+                        best = j;
+                        best_error = distance;
+                    }
+                }
+                indices |= best << (i * 2);
+                weights[i] = PALETTE_WEIGHTS[best];
+                error += best_error;
+            }
+            return error;
+        }
+
+        //! color of BC1 and BC3, always in the four color mode, alpha is ignored
+        static void EncodeColorBlock(const u32 texels[16], u8* block)
+        {
+            f32 colors[16][4];
+            GetChannels(texels, colors);
+
+            f32 end0[4], end1[4];
+            FitEndpoints(colors, 3, end0, end1);
+
+            // fitting the endpoints to the chosen indices moves them closer to the texels
+            u32 best_c0 = 0, best_c1 = 0, best_indices = 0;
+            f32 best_error = -1.f;
+            for (u32 iteration = 0; iteration < 3; ++iteration)
+            {
+                u32 c0 = ToRGB565(end0);
+                u32 c1 = ToRGB565(end1);
+                if (c0 < c1)
+                {
+                    core::swap(c0, c1);
+                }
+
+                u32 indices;
+                f32 weights[16];
+                const f32 error = FindColorIndices(colors, c0, c1, indices, weights);
+                if (best_error < 0.f || error < best_error)
+                {
+                    best_c0 = c0;
+                    best_c1 = c1;
+                    best_indices = indices;
+                    best_error = error;
+                }
+                if (c0 == c1 || !RefitEndpoints(colors, weights, 3, end0, end1))
+                {
+                    break;
+                }
+            }
+
+            block[0] = static_cast<u8>(best_c0);
+            block[1] = static_cast<u8>(best_c0 >> 8);
+            block[2] = static_cast<u8>(best_c1);
+            block[3] = static_cast<u8>(best_c1 >> 8);
+            for (u32 i = 0; i < 4; ++i)
+            {
+                block[4 + i] = static_cast<u8>(best_indices >> (i * 8));
+            }
+        }
+
+        //! chooses the nearest of the eight values for every texel, returns the summed squared error
+        static u32 FindChannelIndices(const u8 values[16], u32 e0, u32 e1, u64& indices)
+        {
+            u32 palette[8];
+            GetChannelPalette(e0, e1, palette);
+
+            indices = 0;
+            u32 error = 0;
+            for (u32 i = 0; i < 16; ++i)
+            {
+                u32 best = 0;
+                u32 best_error = 0;
+                for (u32 j = 0; j < 8; ++j)
+                {
+                    const s32 difference = static_cast<s32>(values[i]) - static_cast<s32>(palette[j]);
+                    const u32 distance = static_cast<u32>(difference * difference);
+                    if (j == 0 || distance < best_error)
+                    {
+                        best = j;
+                        best_error = distance;
+                    }
+                }
+                indices |= static_cast<u64>(best) << (i * 3);
+                error += best_error;
+            }
+            return error;
+        }
+
+        //! alpha of BC3, also the channels of BC4 and BC5
+        static void EncodeChannelBlock(const u8 values[16], u8* block)
+        {
+            u32 min_value = 255, max_value = 0;
+            u32 inner_min = 255, inner_max = 0;
+            for (u32 i = 0; i < 16; ++i)
+            {
+                min_value = core::min_(min_value, static_cast<u32>(values[i]));
+                max_value = core::max_(max_value, static_cast<u32>(values[i]));
+                if (values[i] != 0 && values[i] != 255)
+                {
+                    inner_min = core::min_(inner_min, static_cast<u32>(values[i]));
+                    inner_max = core::max_(inner_max, static_cast<u32>(values[i]));
+                }
+            }
+
+            // eight values between the extremes
+            u32 e0 = max_value, e1 = min_value;
+            u64 indices;
+            const u32 error = FindChannelIndices(values, e0, e1, indices);
+
+            // six values between the others, if the block also has exact 0 and 255
+            if (error > 0 && (min_value == 0 || max_value == 255) && inner_min <= inner_max)
+            {
+                u64 inner_indices;
+                if (FindChannelIndices(values, inner_min, inner_max, inner_indices) < error)
+                {
+                    e0 = inner_min;
+                    e1 = inner_max;
+                    indices = inner_indices;
+                }
+            }
+
+            block[0] = static_cast<u8>(e0);
+            block[1] = static_cast<u8>(e1);
+            for (u32 i = 0; i < 6; ++i)
+            {
+                block[2 + i] = static_cast<u8>(indices >> (i * 8));
+            }
+        }
+
+        //! endpoints and indices of some channels of a BC7 block with a single subset
+        struct SBC7Fit
+        {
+            u32 endpoints_[2][4];
+            u32 pbits_[2];
+            u32 indices_[16];
+            f32 error_;
+        };
+
+        //! fits the endpoints of a single subset to channels first to first + channels - 1 of the texels
+        /** \param bits Bits of an endpoint channel, without the parity bit.
+        \param pbits True if every endpoint has a parity bit as its lowest bit. */
+        static void FitBC7(const f32 colors[16][4], u32 first, u32 channels, u32 bits, bool pbits, u32 index_bits, SBC7Fit& fit)
+        {
+            f32 values[16][4];
+            for (u32 i = 0; i < 16; ++i)
+            {
+                for (u32 c = 0; c < channels; ++c)
+                {
+                    values[i][c] = colors[i][first + c];
+                }
+            }
+
+            f32 end0[4], end1[4];
+            FitEndpoints(values, channels, end0, end1);
+
+            const u8 *weights = GetWeights(index_bits);
+            const u32 index_count = 1 << index_bits;
+            const u32 max_endpoint = (1 << bits) - 1;
+            f32 best_weights[16];
+            fit.error_ = -1.f;
+            for (u32 iteration = 0; iteration < 2; ++iteration)
+            {
+                // every combination of the parity bits moves the endpoints differently
+                for (u32 p = 0; p < (pbits ? 4u : 1u); ++p)
+                {
+                    SBC7Fit candidate;
+                    candidate.pbits_[0] = p & 1;
+                    candidate.pbits_[1] = p >> 1;
+                    u32 decoded[2][4];
+                    for (u32 c = 0; c < channels; ++c)
+                    {
+                        const f32 ends[2] = { end0[c], end1[c] };
+                        for (u32 e = 0; e < 2; ++e)
+                        {
+                            u32 &endpoint = candidate.endpoints_[e][c];
+                            if (pbits)
+                            {
+                                endpoint = static_cast<u32>(core::clamp((ends[e] - candidate.pbits_[e]) * 0.5f + 0.5f, 0.f, static_cast<f32>(max_endpoint)));
+                                decoded[e][c] = (endpoint << 1) | candidate.pbits_[e];
+                            }
+                            else
+                            {
+                                endpoint = static_cast<u32>(ends[e] * max_endpoint / 255.f + 0.5f);
+                                decoded[e][c] = (endpoint << (8 - bits)) | (endpoint >> (2 * bits - 8));
+                            }
+                        }
+                    }
+
+                    f32 candidate_weights[16];
+                    candidate.error_ = 0.f;
+                    for (u32 i = 0; i < 16; ++i)
+                    {
+                        f32 texel_error = 0.f;
+                        for (u32 j = 0; j < index_count; ++j)
+                        {
+                            f32 distance = 0.f;
+                            for (u32 c = 0; c < channels; ++c)
+                            {
+                                const u32 interpolated = ((64 - weights[j]) * decoded[0][c] + weights[j] * decoded[1][c] + 32) >> 6;
+                                const f32 difference = values[i][c] - interpolated;
+                                distance += difference * difference;
+                            }
+                            if (j == 0 || distance < texel_error)
+                            {
+                                candidate.indices_[i] = j;
+                                texel_error = distance;
+                            }
+                        }
+                        candidate_weights[i] = weights[candidate.indices_[i]] / 64.f;
+                        candidate.error_ += texel_error;
+                    }
+
+                    if (fit.error_ < 0.f || candidate.error_ < fit.error_)
+                    {
+                        fit = candidate;
+                        memcpy(best_weights, candidate_weights, sizeof(best_weights));
+                    }
+                }
+
+                if (!RefitEndpoints(values, best_weights, channels, end0, end1))
+                {
+                    break;
+                }
+            }
+
+            // the highest bit of the first index is implied 0, swapping the endpoints mirrors the weights
+            if (fit.indices_[0] >= index_count / 2)
+            {
+                for (u32 c = 0; c < channels; ++c)
+                {
+                    core::swap(fit.endpoints_[0][c], fit.endpoints_[1][c]);
+                }
+                core::swap(fit.pbits_[0], fit.pbits_[1]);
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    fit.indices_[i] = index_count - 1 - fit.indices_[i];
+                }
+            }
+        }
+
+        //! BC7 with a single subset, in mode 6 if color and alpha change together, else in mode 5
+        static void EncodeBC7(const u32 texels[16], u8* block)
+        {
+            f32 colors[16][4];
+            GetChannels(texels, colors);
+
+            // mode 6: 7 bit colors and alpha with a parity bit per endpoint, 4 bit indices
+            SBC7Fit combined;
+            FitBC7(colors, 0, 4, 7, true, 4, combined);
+
+            // mode 5: 7 bit colors and 8 bit alpha, each with their own 2 bit indices
+            SBC7Fit color, alpha;
+            FitBC7(colors, 0, 3, 7, false, 2, color);
+            FitBC7(colors, 3, 1, 8, false, 2, alpha);
+
+            SBitWriter writer(block);
+            if (combined.error_ <= color.error_ + alpha.error_)
+            {
+                writer.Write(1 << 6, 7);
+                for (u32 c = 0; c < 4; ++c)
+                {
+                    writer.Write(combined.endpoints_[0][c], 7);
+                    writer.Write(combined.endpoints_[1][c], 7);
+                }
+                writer.Write(combined.pbits_[0], 1);
+                writer.Write(combined.pbits_[1], 1);
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    writer.Write(combined.indices_[i], i == 0 ? 3 : 4);
+                }
+            }
+            else
+            {
+                // no rotation of the channels
+                writer.Write(1 << 5, 6);
+                writer.Write(0, 2);
+                for (u32 c = 0; c < 3; ++c)
+                {
+                    writer.Write(color.endpoints_[0][c], 7);
+                    writer.Write(color.endpoints_[1][c], 7);
+                }
+                writer.Write(alpha.endpoints_[0][0], 8);
+                writer.Write(alpha.endpoints_[1][0], 8);
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    writer.Write(color.indices_[i], i == 0 ? 1 : 2);
+                }
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    writer.Write(alpha.indices_[i], i == 0 ? 1 : 2);
+                }
+            }
+        }
+
+        //! compresses the rows of blocks of an ECF_A8R8G8B8 image, split between the threads of the pool
+        static void CompressLevel(ECOLOR_FORMAT format, IImage* image, u8* blocks, core::CThreadPool* thread_pool)
+        {
+            const core::Dimension2d<u32> size = image->GetDimension();
+            const u32 pitch = image->GetPitch() / 4;
+            const u32 *data = static_cast<const u32 *>(image->Lock());
+            const u32 block_size = IImage::GetDataSizeFromFormat(format, 4, 4);
+            const u32 blocks_x = (size.width_ + 3) / 4;
+            const u32 blocks_y = (size.height_ + 3) / 4;
+
+            const auto compress_row = [&](u32 y)
+            {
+                u32 texels[16];
+                u8 *block = blocks + y * blocks_x * block_size;
+                for (u32 x = 0; x < blocks_x; ++x, block += block_size)
+                {
+                    // blocks at the right and bottom edge repeat the last texels
+                    for (u32 i = 0; i < 16; ++i)
+                    {
+                        const u32 texel_x = core::min_(x * 4 + (i & 3), size.width_ - 1);
+                        const u32 texel_y = core::min_(y * 4 + (i >> 2), size.height_ - 1);
+                        texels[i] = data[texel_y * pitch + texel_x];
+                    }
+                    CBlockCompression::CompressBlock(format, texels, block);
+                }
+            };
+
+            if (thread_pool != nullptr)
+            {
+                thread_pool->ParallelFor(blocks_y, compress_row);
+            }
+            else
+            {
+                for (u32 y = 0; y < blocks_y; ++y)
+                {
+                    compress_row(y);
+                }
+            }
+            image->Unlock();
+        }
+
+        IImage* CBlockCompression::Decompress(IImage* image)
+        {
+            if (image == nullptr || !IImage::IsCompressedFormat(image->GetColorFormat()))
+            {
+                return nullptr;
+            }
+
+            const core::Dimension2d<u32> size = image->GetDimension();
+            CImage *result = new CImage(ECF_A8R8G8B8, size);
+            Decompress(image->GetColorFormat(), image->Lock(), size, static_cast<u32 *>(result->Lock()), result->GetPitch() / 4);
+            image->Unlock();
+            result->Unlock();
+            return result;
+        }
+
+        void CBlockCompression::Decompress(ECOLOR_FORMAT format, const void* blocks, const core::Dimension2d<u32>& size, u32* target, u32 target_pitch)
+        {
+            const u32 block_size = IImage::GetDataSizeFromFormat(format, 4, 4);
+            const u8 *block = static_cast<const u8 *>(blocks);
+            u32 texels[16];
+            for (u32 y = 0; y < size.height_; y += 4)
+            {
+                for (u32 x = 0; x < size.width_; x += 4, block += block_size)
+                {
+                    DecompressBlock(format, block, texels);
+
+                    // blocks at the right and bottom edge may stick out of the level
+                    const u32 width = core::min_(size.width_ - x, 4u);
+                    const u32 height = core::min_(size.height_ - y, 4u);
+                    for (u32 row = 0; row < height; ++row)
+                    {
+                        u32 *line = target + (y + row) * target_pitch + x;
+                        for (u32 column = 0; column < width; ++column)
+                        {
+                            line[column] = texels[row * 4 + column];
+                        }
+                    }
+                }
+            }
+        }
+
+        void CBlockCompression::DecompressBlock(ECOLOR_FORMAT format, const u8* block, u32 texels[16])
+        {
+            u8 values[16];
+            switch (format)
+            {
+            case ECF_BC1:
+                DecodeColorBlock(block, texels, true);
+                break;
+            case ECF_BC2:
+                DecodeColorBlock(block + 8, texels, false);
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    const u32 alpha = (block[i / 2] >> ((i & 1) * 4)) & 0xf;
+                    texels[i] = (texels[i] & 0x00ffffff) | ((alpha * 17) << 24);
+                }
+                break;
+            case ECF_BC3:
+                DecodeColorBlock(block + 8, texels, false);
+                DecodeChannelBlock(block, values);
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    texels[i] = (texels[i] & 0x00ffffff) | (static_cast<u32>(values[i]) << 24);
+                }
+                break;
+            case ECF_BC4:
+                DecodeChannelBlock(block, values);
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    texels[i] = MakeColor(255, values[i], values[i], values[i]);
+                }
+                break;
+            case ECF_BC5:
+            {
+                u8 green[16];
+                DecodeChannelBlock(block, values);
+                DecodeChannelBlock(block + 8, green);
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    texels[i] = MakeColor(255, values[i], green[i], 0);
+                }
+            }
+                break;
+            case ECF_BC6H:
+                DecodeBC6H(block, texels);
+                break;
+            case ECF_BC7:
+                DecodeBC7(block, texels);
+                break;
+            default:
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    texels[i] = 0;
+                }
+                break;
+            }
+        }
+
+        IImage* CBlockCompression::Compress(IImage* image, ECOLOR_FORMAT format, bool srgb, core::CThreadPool* thread_pool)
+        {
+            if (image == nullptr || image->GetColorFormat() != ECF_A8R8G8B8 ||
+                (format != ECF_BC1 && format != ECF_BC3 && format != ECF_BC4 && format != ECF_BC5 && format != ECF_BC7))
+            {
+                return nullptr;
+            }
+
+            CImagePyramid pyramid;
+            pyramid.Build(image, srgb);
+            const core::Dimension2d<u32> size = image->GetDimension();
+            const u32 count = pyramid.GetLevelCount();
+
+            CImage *result = new CImage(format, size);
+            CompressLevel(format, image, static_cast<u8 *>(result->Lock()), thread_pool);
+            result->Unlock();
+
+            // the levels after level 0 are stored one after another
+            u32 mip_maps_size = 0;
+            for (u32 level = 1; level < count; ++level)
+            {
+                const core::Dimension2d<u32> level_size = CImagePyramid::GetLevelSize(size, level);
+                mip_maps_size += IImage::GetDataSizeFromFormat(format, level_size.width_, level_size.height_);
+            }
+
+            u8 *mip_maps = count > 1 ? new u8[mip_maps_size] : nullptr;
+            u8 *target = mip_maps;
+            for (u32 level = 1; level < count; ++level)
+            {
+                IImage *level_image = pyramid.GetLevel(level);
+                CompressLevel(format, level_image, target, thread_pool);
+                target += IImage::GetDataSizeFromFormat(format, level_image->GetDimension().width_, level_image->GetDimension().height_);
+            }
+            result->SetMipMapsData(mip_maps, count);
+            return result;
+        }
+
+        void CBlockCompression::CompressBlock(ECOLOR_FORMAT format, const u32 texels[16], u8* block)
+        {
+            u8 values[16];
+            switch (format)
+            {
+            case ECF_BC1:
+                EncodeColorBlock(texels, block);
+                break;
+            case ECF_BC3:
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    values[i] = static_cast<u8>(texels[i] >> 24);
+                }
+                EncodeChannelBlock(values, block);
+                EncodeColorBlock(texels, block + 8);
+                break;
+            case ECF_BC4:
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    values[i] = static_cast<u8>(texels[i] >> 16);
+                }
+                EncodeChannelBlock(values, block);
+                break;
+            case ECF_BC5:
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    values[i] = static_cast<u8>(texels[i] >> 16);
+                }
+                EncodeChannelBlock(values, block);
+                for (u32 i = 0; i < 16; ++i)
+                {
+                    values[i] = static_cast<u8>(texels[i] >> 8);
+                }
+                EncodeChannelBlock(values, block + 8);
+                break;
+            case ECF_BC7:
+                EncodeBC7(texels, block);
+                break;
+            default:
+                memset(block, 0, IImage::GetDataSizeFromFormat(format, 4, 4));
+                break;
+            }
+        }
+
+        ECOLOR_FORMAT CBlockCompression::ChooseFormat(IImage* image, bool allow_bc7)
+        {
+            if (image == nullptr || image->GetColorFormat() != ECF_A8R8G8B8)
+            {
+                return ECF_UNKNOWN;
+            }
+
+            const core::Dimension2d<u32> size = image->GetDimension();
+            const u32 pitch = image->GetPitch() / 4;
+            const u32 *data = static_cast<const u32 *>(image->Lock());
+            bool opaque = true, gray = true;
+            for (u32 y = 0; y < size.height_ && (opaque || gray); ++y)
+            {
+                for (u32 x = 0; x < size.width_; ++x)
+                {
+                    const u32 texel = data[y * pitch + x];
+                    const u32 green = (texel >> 8) & 0xff;
+                    opaque = opaque && (texel >> 24) == 0xff;
+                    gray = gray && ((texel >> 16) & 0xff) == green && (texel & 0xff) == green;
+                }
+            }
+            image->Unlock();
+
+            if (!opaque)
+            {
+                return allow_bc7 ? ECF_BC7 : ECF_BC3;
+            }
+            return gray ? ECF_BC4 : ECF_BC1;
+        }
+    } // end namespace video
+} // end namespace kong
@@ -4,6 +4,7 @@
 
 #include "CColorConverter.h"
 #include "SColor.h"
+#include <cstring>
 
 namespace kong
 {
@@ -0,0 +1,261 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CCompiledMeshFileLoader.h"
+#include "CMeshBuffer.h"
+#include "IReadFile.h"
+#include "SAnimatedMesh.h"
+#include "SMesh.h"
+#include "coreutil.h"
+#include "os.h"
+#include <cstring>
+
+namespace kong
+{
+    namespace scene
+    {
+        //! returns true if count elements of element_size bytes at offset lie inside the file
+        static bool IsInsideFile(u32 offset, u32 count, u32 element_size, u32 file_size)
+        {
+            return offset <= file_size && count <= (file_size - offset) / element_size;
+        }
+
+        //! returns true if a zero terminated string starts at offset inside the string table
+        static bool IsInsideStringTable(u32 offset, const c8* strings, u32 string_table_size)
+        {
+            return offset < string_table_size && memchr(strings + offset, 0, string_table_size - offset) != nullptr;
+        }
+
+        static void ReadBoundingBox(const f32* values, core::aabbox3df& box)
+        {
+            box.MinEdge.Set(values[0], values[1], values[2]);
+            box.MaxEdge.Set(values[3], values[4], values[5]);
+        }
+
+        //! copies the arrays of a mesh buffer with vertices of type T
+        template <class T>
+        static IMeshBuffer* ReadMeshBuffer(const SCompiledMeshBuffer& compiled, const c8* data)
+        {
+            if (compiled.VertexSize != sizeof(T) ||
+                (compiled.IndexType != video::EIT_16BIT && compiled.IndexType != video::EIT_32BIT))
+            {
+                return nullptr;
+            }
+
+            CMeshBuffer<T>* buffer = new CMeshBuffer<T>();
+            buffer->vertices_.Resize(compiled.VertexCount);
+            memcpy(static_cast<void*>(buffer->vertices_.Pointer()), data + compiled.VertexOffset, compiled.VertexCount * sizeof(T));
+            buffer->SetIndexType(static_cast<video::E_INDEX_TYPE>(compiled.IndexType));
+            if (compiled.IndexType == video::EIT_32BIT)
+            {
+                buffer->indices32_.Resize(compiled.IndexCount);
+                memcpy(buffer->indices32_.Pointer(), data + compiled.IndexOffset, compiled.IndexCount * sizeof(u32));
+            }
+            else
+            {
+                buffer->indices_.Resize(compiled.IndexCount);
+                memcpy(buffer->indices_.Pointer(), data + compiled.IndexOffset, compiled.IndexCount * sizeof(u16));
+            }
+            ReadBoundingBox(compiled.BoundingBox, buffer->bounding_box_);
+            return buffer;
+        }
+
+        CCompiledMeshFileLoader::CCompiledMeshFileLoader(ISceneManager* smgr, io::IFileSystem* fs)
+            : scene_manager_(smgr), file_system_(fs)
+        {
+        }
+
+        bool CCompiledMeshFileLoader::isALoadableFileExtension(const io::path& filename) const
+        {
+            return core::hasFileExtension(filename, COMPILED_MESH_EXTENSION + 1);
+        }
+
+        IAnimatedMesh* CCompiledMeshFileLoader::createMesh(io::IReadFile* file)
+        {
+            dependencies_.Clear();
+            const long size = file->GetSize();
+            if (size < static_cast<long>(sizeof(SCompiledMeshHeader)))
+            {
+                return nullptr;
+            }
+
+            // a mapped file is used in place, anything else is read completely first
+            const c8* data = static_cast<const c8*>(file->GetMappedData());
+            c8* copy = nullptr;
+            if (data == nullptr)
+            {
+                copy = new c8[size];
+                if (file->Read(copy, static_cast<u32>(size)) != size)
+                {
+                    delete[] copy;
+                    return nullptr;
+                }
+                data = copy;
+            }
+
+            IAnimatedMesh* mesh = CreateMesh(data, static_cast<u32>(size), file->GetFileName());
+            delete[] copy;
+            return mesh;
+        }
+
+        void CCompiledMeshFileLoader::getDependencies(core::Array<io::path>& files) const
+        {
+            for (u32 i = 0; i < dependencies_.Size(); ++i)
+            {
+                files.PushBack(dependencies_[i]);
+            }
+        }
+
+        IAnimatedMesh* CCompiledMeshFileLoader::CreateMesh(const c8* data, u32 size, const io::path& filename)
+        {
+            const SCompiledMeshHeader* header = reinterpret_cast<const SCompiledMeshHeader*>(data);
+            if (header->Magic != COMPILED_MESH_MAGIC || header->Version != COMPILED_MESH_VERSION ||
+                header->LayerCount != video::MATERIAL_MAX_TEXTURES)
+            {
+                os::Printer::log("Compiled mesh was written by another version", filename, ELL_INFORMATION);
+                return nullptr;
+            }
+
+            const u32 buffer_count = header->MeshBufferCount;
+            const u32 layer_count = buffer_count * video::MATERIAL_MAX_TEXTURES;
+            if (header->FileSize != size ||
+                !IsInsideFile(sizeof(SCompiledMeshHeader), buffer_count, sizeof(SCompiledMeshBuffer), size) ||
+                !IsInsideFile(header->LayerOffset, layer_count, sizeof(SCompiledMaterialLayer), size) ||
+                !IsInsideFile(header->StringTableOffset, header->StringTableSize, 1, size) ||
+                !IsInsideFile(header->DependencyOffset, header->DependencyCount, sizeof(u32), size))
+            {
+                os::Printer::log("Compiled mesh is damaged", filename, ELL_WARNING);
+                return nullptr;
+            }
+
+            const SCompiledMeshBuffer* buffers = reinterpret_cast<const SCompiledMeshBuffer*>(header + 1);
+            const SCompiledMaterialLayer* layers = reinterpret_cast<const SCompiledMaterialLayer*>(data + header->LayerOffset);
+            const c8* strings = data + header->StringTableOffset;
+
+            const u32* dependencies = reinterpret_cast<const u32*>(data + header->DependencyOffset);
+            for (u32 i = 0; i < header->DependencyCount; ++i)
+            {
+                if (!IsInsideStringTable(dependencies[i], strings, header->StringTableSize))
+                {
+                    os::Printer::log("Compiled mesh is damaged", filename, ELL_WARNING);
+                    dependencies_.Clear();
+                    return nullptr;
+                }
+                dependencies_.PushBack(io::path(strings + dependencies[i]));
+            }
+
+            // edited material files have to be read again with the source, check before loading any texture
+            for (u32 i = 0; i < dependencies_.Size(); ++i)
+            {
+                if (file_system_ != nullptr && !file_system_->IsFileNewer(filename, dependencies_[i]))
+                {
+                    os::Printer::log("Compiled mesh is older than", dependencies_[i], ELL_INFORMATION);
+                    return nullptr;
+                }
+            }
+
+            SMesh* mesh = new SMesh();
+            for (u32 i = 0; i < buffer_count; ++i)
+            {
+                const SCompiledMeshBuffer& compiled = buffers[i];
+
+                IMeshBuffer* buffer = nullptr;
+                if (compiled.FirstLayer <= layer_count - video::MATERIAL_MAX_TEXTURES &&
+                    IsInsideFile(compiled.VertexOffset, compiled.VertexCount, compiled.VertexSize ? compiled.VertexSize : 1, size) &&
+                    IsInsideFile(compiled.IndexOffset, compiled.IndexCount,
+                        compiled.IndexType == video::EIT_32BIT ? sizeof(u32) : sizeof(u16), size))
+                {
+                    switch (compiled.VertexType)
+                    {
+                    case video::EVT_STANDARD:
+                        buffer = ReadMeshBuffer<video::S3DVertex>(compiled, data);
+                        break;
+                    case video::EVT_2TCOORDS:
+                        buffer = ReadMeshBuffer<video::S3DVertex2TCoords>(compiled, data);
+                        break;
+                    case video::EVT_TANGENTS:
+                        buffer = ReadMeshBuffer<video::S3DVertexTangents>(compiled, data);
+                        break;
+                    default:
+                        break;
+                    }
+                }
+
+                if (buffer == nullptr)
+                {
+                    os::Printer::log("Compiled mesh has an unsupported mesh buffer", filename, ELL_WARNING);
+                    delete mesh;
+                    return nullptr;
+                }
+
+                ReadMaterial(compiled.Material, layers + compiled.FirstLayer, strings, header->StringTableSize, buffer->GetMaterial());
+                mesh->AddMeshBuffer(buffer);
+            }
+            ReadBoundingBox(header->BoundingBox, mesh->bounding_box_);
+
+            SAnimatedMesh* animated_mesh = new SAnimatedMesh();
+            animated_mesh->Type = static_cast<E_ANIMATED_MESH_TYPE>(header->MeshType);
+            animated_mesh->addMesh(mesh);
+            animated_mesh->RecalculateBoundingBox();
+            return animated_mesh;
+        }
+
+        void CCompiledMeshFileLoader::ReadMaterial(const SCompiledMaterial& compiled, const SCompiledMaterialLayer* layers,
+            const c8* strings, u32 string_table_size, video::SMaterial& material) const
+        {
+            material.ambient_color_.color_ = compiled.AmbientColor;
+            material.diffuse_color_.color_ = compiled.DiffuseColor;
+            material.specular_color_.color_ = compiled.SpecularColor;
+            material.emissive_color_.color_ = compiled.EmissiveColor;
+            material.shininess_ = compiled.Shininess;
+            material.MaterialType = static_cast<video::E_MATERIAL_TYPE>(compiled.MaterialType);
+            material.Thickness = compiled.Thickness;
+            material.material_type_param_ = compiled.MaterialTypeParam;
+            material.ZBuffer = compiled.ZBuffer;
+            material.AntiAliasing = compiled.AntiAliasing;
+            material.ColorMask = compiled.ColorMask;
+            material.ColorMaterial = compiled.ColorMaterial;
+            material.BlendOperation = static_cast<video::E_BLEND_OPERATION>(compiled.BlendOperation);
+            material.PolygonOffsetFactor = compiled.PolygonOffsetFactor;
+            material.PolygonOffsetDirection = static_cast<video::E_POLYGON_OFFSET>(compiled.PolygonOffsetDirection);
+            material.Wireframe = (compiled.Flags & ECMF_WIREFRAME) != 0;
+            material.PointCloud = (compiled.Flags & ECMF_POINT_CLOUD) != 0;
+            material.GouraudShading = (compiled.Flags & ECMF_GOURAUD_SHADING) != 0;
+            material.Lighting = (compiled.Flags & ECMF_LIGHTING) != 0;
+            material.ZWriteEnable = (compiled.Flags & ECMF_ZWRITE_ENABLE) != 0;
+            material.BackfaceCulling = (compiled.Flags & ECMF_BACKFACE_CULLING) != 0;
+            material.FrontfaceCulling = (compiled.Flags & ECMF_FRONTFACE_CULLING) != 0;
+            material.FogEnable = (compiled.Flags & ECMF_FOG_ENABLE) != 0;
+            material.NormalizeNormals = (compiled.Flags & ECMF_NORMALIZE_NORMALS) != 0;
+            material.use_mip_maps_ = (compiled.Flags & ECMF_USE_MIP_MAPS) != 0;
+
+            video::IVideoDriver* driver = scene_manager_->GetVideoDriver();
+            for (u32 i = 0; i < video::MATERIAL_MAX_TEXTURES; ++i)
+            {
+                const SCompiledMaterialLayer& compiled_layer = layers[i];
+                video::SMaterialLayer& layer = material.texture_layer_[i];
+
+                layer.TextureWrapU = compiled_layer.TextureWrapU;
+                layer.TextureWrapV = compiled_layer.TextureWrapV;
+                layer.BilinearFilter = compiled_layer.BilinearFilter != 0;
+                layer.TrilinearFilter = compiled_layer.TrilinearFilter != 0;
+                layer.AnisotropicFilter = compiled_layer.AnisotropicFilter;
+                layer.LODBias = compiled_layer.LODBias;
+                if (compiled_layer.HasTextureMatrix)
+                {
+                    core::Matrixf matrix;
+                    memcpy(matrix.Pointer(), compiled_layer.TextureMatrix, sizeof(compiled_layer.TextureMatrix));
+                    layer.SetTextureMatrix(matrix);
+                }
+
+                // the name has to end inside the string table
+                const u32 name = compiled_layer.TextureName;
+                if (IsInsideStringTable(name, strings, string_table_size) && driver != nullptr)
+                {
+                    layer.Texture = driver->GetTexture(io::path(strings + name));
+                }
+            }
+        }
+
+    } // end namespace scene
+} // end namespace kong
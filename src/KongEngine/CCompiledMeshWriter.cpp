@@ -0,0 +1,262 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CCompiledMeshWriter.h"
+#include "IMesh.h"
+#include "IMeshBuffer.h"
+#include "ITexture.h"
+#include "S3DVertex.h"
+#include "KongString.h"
+#include <cstring>
+
+namespace kong
+{
+    namespace scene
+    {
+        static u32 Align(u32 offset, u32 alignment)
+        {
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+
+        static u32 GetIndexSize(video::E_INDEX_TYPE type)
+        {
+            return type == video::EIT_32BIT ? sizeof(u32) : sizeof(u16);
+        }
+
+        static void WriteBoundingBox(const core::aabbox3df& box, f32* values)
+        {
+            values[0] = box.MinEdge.x_;
+            values[1] = box.MinEdge.y_;
+            values[2] = box.MinEdge.z_;
+            values[3] = box.MaxEdge.x_;
+            values[4] = box.MaxEdge.y_;
+            values[5] = box.MaxEdge.z_;
+        }
+
+        //! returns the size of a vertex, or 0 for types the loader does not know
+        static u32 GetVertexSize(video::E_VERTEX_TYPE type)
+        {
+            switch (type)
+            {
+            case video::EVT_STANDARD:
+                return sizeof(video::S3DVertex);
+            case video::EVT_2TCOORDS:
+                return sizeof(video::S3DVertex2TCoords);
+            case video::EVT_TANGENTS:
+                return sizeof(video::S3DVertexTangents);
+            default:
+                return 0;
+            }
+        }
+
+        bool CCompiledMeshWriter::WriteMesh(io::IWriteFile* file, IAnimatedMesh* animated_mesh,
+            const core::Array<io::path>& dependencies)
+        {
+            if (file == nullptr || animated_mesh == nullptr || animated_mesh->getFrameCount() != 1)
+            {
+                return false;
+            }
+
+            IMesh* mesh = animated_mesh->getMesh(0);
+            const u32 buffer_count = mesh->GetMeshBufferCount();
+
+            SCompiledMeshHeader header;
+            memset(&header, 0, sizeof(header));
+            header.Magic = COMPILED_MESH_MAGIC;
+            header.Version = COMPILED_MESH_VERSION;
+            header.MeshBufferCount = buffer_count;
+            header.MeshType = animated_mesh->getMeshType();
+            header.LayerCount = video::MATERIAL_MAX_TEXTURES;
+            WriteBoundingBox(mesh->GetBoundingBox(), header.BoundingBox);
+
+            core::Array<SCompiledMeshBuffer> buffers;
+            buffers.Resize(buffer_count);
+            core::Array<SCompiledMaterialLayer> layers;
+            layers.Resize(buffer_count * video::MATERIAL_MAX_TEXTURES);
+            if (buffer_count != 0)
+            {
+                memset(buffers.Pointer(), 0, buffer_count * sizeof(SCompiledMeshBuffer));
+                memset(layers.Pointer(), 0, buffer_count * video::MATERIAL_MAX_TEXTURES * sizeof(SCompiledMaterialLayer));
+            }
+            strings_.Clear();
+
+            core::Array<u32> dependency_names;
+            for (u32 i = 0; i < dependencies.Size(); ++i)
+            {
+                const core::stringc name(dependencies[i]);
+                dependency_names.PushBack(AddString(name.c_str()));
+            }
+
+            // the arrays follow the descriptions, vertices aligned for any vertex type
+            u32 offset = sizeof(SCompiledMeshHeader) + buffer_count * sizeof(SCompiledMeshBuffer);
+            header.LayerOffset = offset;
+            offset += buffer_count * video::MATERIAL_MAX_TEXTURES * sizeof(SCompiledMaterialLayer);
+            header.DependencyCount = dependency_names.Size();
+            header.DependencyOffset = offset;
+            offset += dependency_names.Size() * sizeof(u32);
+
+            for (u32 i = 0; i < buffer_count; ++i)
+            {
+                const IMeshBuffer* buffer = mesh->GetMeshBuffer(i);
+                SCompiledMeshBuffer& compiled = buffers.Pointer()[i];
+
+                compiled.VertexType = buffer->GetVertexType();
+                compiled.VertexSize = GetVertexSize(buffer->GetVertexType());
+                compiled.VertexCount = buffer->GetVertexCount();
+                compiled.IndexType = buffer->GetIndexType();
+                compiled.IndexCount = buffer->GetIndexCount();
+                if (compiled.VertexSize == 0 ||
+                    (compiled.IndexType != video::EIT_16BIT && compiled.IndexType != video::EIT_32BIT))
+                {
+                    return false;
+                }
+
+                offset = Align(offset, 16);
+                compiled.VertexOffset = offset;
+                offset += compiled.VertexCount * compiled.VertexSize;
+                offset = Align(offset, 4);
+                compiled.IndexOffset = offset;
+                offset += compiled.IndexCount * GetIndexSize(buffer->GetIndexType());
+
+                compiled.FirstLayer = i * video::MATERIAL_MAX_TEXTURES;
+                WriteBoundingBox(buffer->GetBoundingBox(), compiled.BoundingBox);
+                WriteMaterial(buffer->GetMaterial(), compiled.Material, layers.Pointer() + compiled.FirstLayer);
+            }
+
+            header.StringTableOffset = offset;
+            header.StringTableSize = strings_.Size();
+            header.FileSize = offset + strings_.Size();
+
+            // the size is written first, so a file which was cut off is never loaded
+            if (file->Write(&header, sizeof(header)) != sizeof(header))
+            {
+                return false;
+            }
+            if (buffer_count != 0)
+            {
+                const u32 buffer_bytes = buffer_count * sizeof(SCompiledMeshBuffer);
+                const u32 layer_bytes = buffer_count * video::MATERIAL_MAX_TEXTURES * sizeof(SCompiledMaterialLayer);
+                if (file->Write(buffers.ConstPointer(), buffer_bytes) != static_cast<s32>(buffer_bytes) ||
+                    file->Write(layers.ConstPointer(), layer_bytes) != static_cast<s32>(layer_bytes))
+                {
+                    return false;
+                }
+            }
+            if (!dependency_names.Empty())
+            {
+                const u32 dependency_bytes = dependency_names.Size() * sizeof(u32);
+                if (file->Write(dependency_names.ConstPointer(), dependency_bytes) != static_cast<s32>(dependency_bytes))
+                {
+                    return false;
+                }
+            }
+
+            for (u32 i = 0; i < buffer_count; ++i)
+            {
+                const IMeshBuffer* buffer = mesh->GetMeshBuffer(i);
+                const SCompiledMeshBuffer& compiled = buffers.ConstPointer()[i];
+                const u32 vertex_bytes = compiled.VertexCount * compiled.VertexSize;
+                const u32 index_bytes = compiled.IndexCount * GetIndexSize(buffer->GetIndexType());
+
+                if (!WritePadding(file, 16) ||
+                    file->Write(buffer->GetVertices(), vertex_bytes) != static_cast<s32>(vertex_bytes) ||
+                    !WritePadding(file, 4) ||
+                    file->Write(buffer->GetIndices(), index_bytes) != static_cast<s32>(index_bytes))
+                {
+                    return false;
+                }
+            }
+
+            return strings_.Empty() ||
+                file->Write(strings_.ConstPointer(), strings_.Size()) == static_cast<s32>(strings_.Size());
+        }
+
+        void CCompiledMeshWriter::WriteMaterial(const video::SMaterial& material, SCompiledMaterial& compiled, SCompiledMaterialLayer* layers)
+        {
+            compiled.AmbientColor = material.ambient_color_.color_;
+            compiled.DiffuseColor = material.diffuse_color_.color_;
+            compiled.SpecularColor = material.specular_color_.color_;
+            compiled.EmissiveColor = material.emissive_color_.color_;
+            compiled.Shininess = material.shininess_;
+            compiled.MaterialType = material.MaterialType;
+            compiled.Thickness = material.Thickness;
+            compiled.MaterialTypeParam = material.material_type_param_;
+            compiled.ZBuffer = material.ZBuffer;
+            compiled.AntiAliasing = material.AntiAliasing;
+            compiled.ColorMask = material.ColorMask;
+            compiled.ColorMaterial = material.ColorMaterial;
+            compiled.BlendOperation = static_cast<u8>(material.BlendOperation);
+            compiled.PolygonOffsetFactor = material.PolygonOffsetFactor;
+            compiled.PolygonOffsetDirection = static_cast<u8>(material.PolygonOffsetDirection);
+            compiled.Flags =
+                (material.Wireframe ? ECMF_WIREFRAME : 0) |
+                (material.PointCloud ? ECMF_POINT_CLOUD : 0) |
+                (material.GouraudShading ? ECMF_GOURAUD_SHADING : 0) |
+                (material.Lighting ? ECMF_LIGHTING : 0) |
+                (material.ZWriteEnable ? ECMF_ZWRITE_ENABLE : 0) |
+                (material.BackfaceCulling ? ECMF_BACKFACE_CULLING : 0) |
+                (material.FrontfaceCulling ? ECMF_FRONTFACE_CULLING : 0) |
+                (material.FogEnable ? ECMF_FOG_ENABLE : 0) |
+                (material.NormalizeNormals ? ECMF_NORMALIZE_NORMALS : 0) |
+                (material.use_mip_maps_ ? ECMF_USE_MIP_MAPS : 0);
+
+            for (u32 i = 0; i < video::MATERIAL_MAX_TEXTURES; ++i)
+            {
+                const video::SMaterialLayer& layer = material.texture_layer_[i];
+                SCompiledMaterialLayer& compiled_layer = layers[i];
+
+                compiled_layer.TextureWrapU = layer.TextureWrapU;
+                compiled_layer.TextureWrapV = layer.TextureWrapV;
+                compiled_layer.BilinearFilter = layer.BilinearFilter;
+                compiled_layer.TrilinearFilter = layer.TrilinearFilter;
+                compiled_layer.AnisotropicFilter = layer.AnisotropicFilter;
+                compiled_layer.LODBias = layer.LODBias;
+
+                const core::Matrixf& matrix = layer.GetTextureMatrix();
+                compiled_layer.HasTextureMatrix = matrix.IsIdentity() ? 0 : 1;
+                memcpy(compiled_layer.TextureMatrix, matrix.Pointer(), sizeof(compiled_layer.TextureMatrix));
+
+                // textures are referenced by the name they were loaded with
+                if (layer.Texture != nullptr)
+                {
+                    const core::stringc name(layer.Texture->GetName().GetPath());
+                    compiled_layer.TextureName = AddString(name.c_str());
+                }
+                else
+                {
+                    compiled_layer.TextureName = COMPILED_MESH_NO_TEXTURE;
+                }
+            }
+        }
+
+        u32 CCompiledMeshWriter::AddString(const c8* name)
+        {
+            // materials of one mesh share few textures
+            const c8* strings = strings_.ConstPointer();
+            for (u32 i = 0; i < strings_.Size(); i += static_cast<u32>(strlen(strings + i)) + 1)
+            {
+                if (strcmp(strings + i, name) == 0)
+                {
+                    return i;
+                }
+            }
+
+            const u32 offset = strings_.Size();
+            do
+            {
+                strings_.PushBack(*name);
+            } while (*name++ != 0);
+            return offset;
+        }
+
+        bool CCompiledMeshWriter::WritePadding(io::IWriteFile* file, u32 alignment)
+        {
+            static const c8 zeros[16] = { 0 };
+
+            const u32 position = static_cast<u32>(file->GetPos());
+            const u32 padding = Align(position, alignment) - position;
+            return padding == 0 || file->Write(zeros, padding) == static_cast<s32>(padding);
+        }
+
+    } // end namespace scene
+} // end namespace kong
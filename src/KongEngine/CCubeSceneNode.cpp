@@ -6,6 +6,7 @@
 #include "CMeshBuffer.h"
 #include "IVideoDriver.h"
 #include "ISceneManager.h"
+#include "CRenderQueue.h"
 #include "stdio.h"
 
 namespace kong
@@ -21,7 +22,7 @@ namespace kong
 
         CCubeSceneNode::~CCubeSceneNode()
         {
-            delete mesh_;
+            DropMesh(mesh_);
         }
 
         const core::aabbox3d<f32>& CCubeSceneNode::GetBoundingBox() const
@@ -67,6 +68,17 @@ namespace kong
             }
         }
 
+        bool CCubeSceneNode::SubmitRenderItems(CRenderQueue& queue)
+        {
+            if (draw_bounding_box_)
+            {
+                return false;
+            }
+
+            queue.Add(mesh_->GetMeshBuffer(0), mesh_->GetMeshBuffer(0)->GetMaterial(), absolute_tranform_, rendering_mode_);
+            return true;
+        }
+
         video::SMaterial& CCubeSceneNode::GetMaterial(u32 num)
         {
             return mesh_->GetMeshBuffer(num)->GetMaterial();
@@ -79,8 +91,12 @@ namespace kong
 
         void CCubeSceneNode::SetMesh(IMesh* mesh)
         {
-            //delete mesh_;
-            mesh_ = mesh;
+            if (mesh != nullptr)
+            {
+                mesh->Grab();
+                DropMesh(mesh_);
+                mesh_ = mesh;
+            }
         }
 
         IMesh* CCubeSceneNode::GetMesh()
@@ -150,16 +166,6 @@ namespace kong
 
             buffer->indices_.Reallocate(36);
 
-            // reallocate the barycentric buffer
-            for (int i = 0; i < 6; i++)
-            {
-                int idx = i * 4;
-                buffer->vertices_[idx].barycentric_ = core::vector3df(1.f, 0.f, 0.f);
-                buffer->vertices_[idx + 1].barycentric_ = core::vector3df(0.f, 1.f, 0.f);
-                buffer->vertices_[idx + 2].barycentric_ = core::vector3df(0.f, 0.f, 1.f);
-                buffer->vertices_[idx + 3].barycentric_ = core::vector3df(0.f, 1.f, 0.f);
-            }
-
             for (auto indice : indices)
             {
                 buffer->indices_.PushBack(indice);
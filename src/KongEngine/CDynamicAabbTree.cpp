@@ -0,0 +1,485 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CDynamicAabbTree.h"
+#include "KongMath.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        //! part of the extent a box is enlarged by on every side
+        static const f32 FAT_BOX_MARGIN = 0.1f;
+
+        static core::aabbox3df Combine(const core::aabbox3df& a, const core::aabbox3df& b)
+        {
+            core::aabbox3df box(a);
+            box.addInternalBox(b);
+            return box;
+        }
+
+        static core::aabbox3df Enlarge(const core::aabbox3df& box)
+        {
+            const core::vector3df margin = box.getExtent() * FAT_BOX_MARGIN;
+            return core::aabbox3df(box.MinEdge - margin, box.MaxEdge + margin);
+        }
+
+        CDynamicAabbTree::CDynamicAabbTree()
+            : root_(-1), free_list_(-1), proxy_count_(0)
+        {
+        }
+
+        s32 CDynamicAabbTree::CreateProxy(ISceneNode* node, const core::aabbox3df& box)
+        {
+            const s32 proxy = AllocateNode();
+            STreeNode& leaf = nodes_.Pointer()[proxy];
+            leaf.box_ = Enlarge(box);
+            leaf.scene_node_ = node;
+            leaf.height_ = 0;
+            leaf.visible_frame_ = 0;
+            leaf.registered_frame_ = 0;
+
+            InsertLeaf(proxy);
+            ++proxy_count_;
+            return proxy;
+        }
+
+        void CDynamicAabbTree::DestroyProxy(s32 proxy)
+        {
+            if (GetSceneNode(proxy) == nullptr)
+            {
+                return;
+            }
+
+            RemoveLeaf(proxy);
+            FreeNode(proxy);
+            --proxy_count_;
+        }
+
+        bool CDynamicAabbTree::MoveProxy(s32 proxy, const core::aabbox3df& box)
+        {
+            STreeNode& leaf = nodes_.Pointer()[proxy];
+            if (box.isFullInside(leaf.box_))
+            {
+                return false;
+            }
+
+            RemoveLeaf(proxy);
+            nodes_.Pointer()[proxy].box_ = Enlarge(box);
+            InsertLeaf(proxy);
+            return true;
+        }
+
+        ISceneNode* CDynamicAabbTree::GetSceneNode(s32 proxy) const
+        {
+            if (proxy < 0 || static_cast<u32>(proxy) >= nodes_.Size())
+            {
+                return nullptr;
+            }
+
+            const STreeNode& leaf = nodes_.ConstPointer()[proxy];
+            return leaf.height_ == 0 ? leaf.scene_node_ : nullptr;
+        }
+
+        const core::aabbox3df& CDynamicAabbTree::GetFatBox(s32 proxy) const
+        {
+            return nodes_.ConstPointer()[proxy].box_;
+        }
+
+        u32 CDynamicAabbTree::GetProxyCount() const
+        {
+            return proxy_count_;
+        }
+
+        void CDynamicAabbTree::SetRegistered(s32 proxy, u32 frame)
+        {
+            nodes_.Pointer()[proxy].registered_frame_ = frame;
+        }
+
+        void CDynamicAabbTree::RemoveUnregistered(u32 frame, core::Array<s32>* removed)
+        {
+            // nodes which were deleted or hidden since the last frame
+            for (u32 i = 0; i < nodes_.Size(); ++i)
+            {
+                const STreeNode& node = nodes_.ConstPointer()[i];
+                if (node.height_ == 0 && node.registered_frame_ != frame)
+                {
+                    DestroyProxy(static_cast<s32>(i));
+                    if (removed != nullptr)
+                    {
+                        removed->PushBack(static_cast<s32>(i));
+                    }
+                }
+            }
+        }
+
+        void CDynamicAabbTree::MarkVisible(const SViewFrustum& frustum, u32 frame)
+        {
+            struct SMarkVisible
+            {
+                void operator()(s32 leaf)
+                {
+                    tree_nodes_[leaf].visible_frame_ = frame_;
+                }
+
+                STreeNode* tree_nodes_;
+                u32 frame_;
+            } mark = { nodes_.Pointer(), frame };
+
+            QueryFrustum(frustum, SViewFrustum::ALL_PLANES, mark);
+        }
+
+        bool CDynamicAabbTree::IsVisible(s32 proxy, u32 frame) const
+        {
+            return nodes_.ConstPointer()[proxy].visible_frame_ == frame;
+        }
+
+        void CDynamicAabbTree::CollectVisible(const SViewFrustum& frustum, core::Array<ISceneNode*>& nodes, u32 plane_mask) const
+        {
+            struct SCollect
+            {
+                void operator()(s32 leaf)
+                {
+                    result_.PushBack(tree_nodes_[leaf].scene_node_);
+                }
+
+                const STreeNode* tree_nodes_;
+                core::Array<ISceneNode*>& result_;
+            } collect = { nodes_.ConstPointer(), nodes };
+
+            QueryFrustum(frustum, plane_mask, collect);
+        }
+
+        s32 CDynamicAabbTree::AllocateNode()
+        {
+            if (free_list_ == -1)
+            {
+                // chain the new nodes into the free list
+                const u32 old_size = nodes_.Size();
+                const u32 new_size = old_size == 0 ? 16 : old_size * 2;
+                nodes_.Resize(new_size);
+                for (u32 i = old_size; i < new_size; ++i)
+                {
+                    STreeNode& node = nodes_.Pointer()[i];
+                    node.parent_ = i + 1 < new_size ? static_cast<s32>(i + 1) : -1;
+                    node.height_ = -1;
+                    node.scene_node_ = nullptr;
+                }
+                free_list_ = static_cast<s32>(old_size);
+            }
+
+            const s32 index = free_list_;
+            STreeNode& node = nodes_.Pointer()[index];
+            free_list_ = node.parent_;
+            node.parent_ = -1;
+            node.child1_ = -1;
+            node.child2_ = -1;
+            node.height_ = 0;
+            node.scene_node_ = nullptr;
+            return index;
+        }
+
+        void CDynamicAabbTree::FreeNode(s32 index)
+        {
+            STreeNode& node = nodes_.Pointer()[index];
+            node.parent_ = free_list_;
+            node.height_ = -1;
+            node.scene_node_ = nullptr;
+            free_list_ = index;
+        }
+
+        void CDynamicAabbTree::InsertLeaf(s32 leaf)
+        {
+            if (root_ == -1)
+            {
+                root_ = leaf;
+                nodes_.Pointer()[leaf].parent_ = -1;
+                return;
+            }
+
+            // descend to the sibling which costs the least surface area
+            const core::aabbox3df leaf_box = nodes_.ConstPointer()[leaf].box_;
+            s32 index = root_;
+            while (!nodes_.ConstPointer()[index].IsLeaf())
+            {
+                const STreeNode& node = nodes_.ConstPointer()[index];
+                const f32 area = node.box_.getArea();
+                const f32 combined_area = Combine(node.box_, leaf_box).getArea();
+
+                // cost of a new parent for this node and the leaf
+                const f32 cost = 2.f * combined_area;
+
+                // minimum cost of pushing the leaf further down the tree
+                const f32 inheritance_cost = 2.f * (combined_area - area);
+
+                f32 child_cost[2];
+                const s32 children[2] = { node.child1_, node.child2_ };
+                for (u32 i = 0; i < 2; ++i)
+                {
+                    const STreeNode& child = nodes_.ConstPointer()[children[i]];
+                    const f32 child_area = Combine(child.box_, leaf_box).getArea();
+                    child_cost[i] = (child.IsLeaf() ? child_area : child_area - child.box_.getArea()) + inheritance_cost;
+                }
+
+                if (cost < child_cost[0] && cost < child_cost[1])
+                {
+                    break;
+                }
+
+                index = child_cost[0] < child_cost[1] ? children[0] : children[1];
+            }
+
+            const s32 sibling = index;
+            const s32 new_parent = AllocateNode();
+            STreeNode* nodes = nodes_.Pointer();
+            const s32 old_parent = nodes[sibling].parent_;
+
+            nodes[new_parent].parent_ = old_parent;
+            nodes[new_parent].box_ = Combine(leaf_box, nodes[sibling].box_);
+            nodes[new_parent].height_ = nodes[sibling].height_ + 1;
+            nodes[new_parent].child1_ = sibling;
+            nodes[new_parent].child2_ = leaf;
+            nodes[sibling].parent_ = new_parent;
+            nodes[leaf].parent_ = new_parent;
+
+            if (old_parent == -1)
+            {
+                root_ = new_parent;
+            }
+            else if (nodes[old_parent].child1_ == sibling)
+            {
+                nodes[old_parent].child1_ = new_parent;
+            }
+            else
+            {
+                nodes[old_parent].child2_ = new_parent;
+            }
+
+            Refit(new_parent);
+        }
+
+        void CDynamicAabbTree::RemoveLeaf(s32 leaf)
+        {
+            if (leaf == root_)
+            {
+                root_ = -1;
+                return;
+            }
+
+            STreeNode* nodes = nodes_.Pointer();
+            const s32 parent = nodes[leaf].parent_;
+            const s32 grand_parent = nodes[parent].parent_;
+            const s32 sibling = nodes[parent].child1_ == leaf ? nodes[parent].child2_ : nodes[parent].child1_;
+
+            // the sibling takes the place of the parent
+            nodes[sibling].parent_ = grand_parent;
+            FreeNode(parent);
+            if (grand_parent == -1)
+            {
+                root_ = sibling;
+                return;
+            }
+
+            if (nodes[grand_parent].child1_ == parent)
+            {
+                nodes[grand_parent].child1_ = sibling;
+            }
+            else
+            {
+                nodes[grand_parent].child2_ = sibling;
+            }
+            Refit(grand_parent);
+        }
+
+        s32 CDynamicAabbTree::Balance(s32 index_a)
+        {
+            STreeNode* nodes = nodes_.Pointer();
+            STreeNode& a = nodes[index_a];
+            if (a.IsLeaf() || a.height_ < 2)
+            {
+                return index_a;
+            }
+
+            const s32 index_b = a.child1_;
+            const s32 index_c = a.child2_;
+            STreeNode& b = nodes[index_b];
+            STreeNode& c = nodes[index_c];
+            const s32 balance = c.height_ - b.height_;
+
+            if (balance > 1)
+            {
+                // rotate c up
+                const s32 index_f = c.child1_;
+                const s32 index_g = c.child2_;
+                STreeNode& f = nodes[index_f];
+                STreeNode& g = nodes[index_g];
+
+                c.child1_ = index_a;
+                c.parent_ = a.parent_;
+                a.parent_ = index_c;
+
+                if (c.parent_ == -1)
+                {
+                    root_ = index_c;
+                }
+                else if (nodes[c.parent_].child1_ == index_a)
+                {
+                    nodes[c.parent_].child1_ = index_c;
+                }
+                else
+                {
+                    nodes[c.parent_].child2_ = index_c;
+                }
+
+                // the higher grandchild stays below c
+                if (f.height_ > g.height_)
+                {
+                    c.child2_ = index_f;
+                    a.child2_ = index_g;
+                    g.parent_ = index_a;
+                    a.box_ = Combine(b.box_, g.box_);
+                    c.box_ = Combine(a.box_, f.box_);
+                    a.height_ = 1 + core::max_(b.height_, g.height_);
+                    c.height_ = 1 + core::max_(a.height_, f.height_);
+                }
+                else
+                {
+                    c.child2_ = index_g;
+                    a.child2_ = index_f;
+                    f.parent_ = index_a;
+                    a.box_ = Combine(b.box_, f.box_);
+                    c.box_ = Combine(a.box_, g.box_);
+                    a.height_ = 1 + core::max_(b.height_, f.height_);
+                    c.height_ = 1 + core::max_(a.height_, g.height_);
+                }
+
+                return index_c;
+            }
+
+            if (balance < -1)
+            {
+                // rotate b up
+                const s32 index_d = b.child1_;
+                const s32 index_e = b.child2_;
+                STreeNode& d = nodes[index_d];
+                STreeNode& e = nodes[index_e];
+
+                b.child1_ = index_a;
+                b.parent_ = a.parent_;
+                a.parent_ = index_b;
+
+                if (b.parent_ == -1)
+                {
+                    root_ = index_b;
+                }
+                else if (nodes[b.parent_].child1_ == index_a)
+                {
+                    nodes[b.parent_].child1_ = index_b;
+                }
+                else
+                {
+                    nodes[b.parent_].child2_ = index_b;
+                }
+
+                if (d.height_ > e.height_)
+                {
+                    b.child2_ = index_d;
+                    a.child1_ = index_e;
+                    e.parent_ = index_a;
+                    a.box_ = Combine(c.box_, e.box_);
+                    b.box_ = Combine(a.box_, d.box_);
+                    a.height_ = 1 + core::max_(c.height_, e.height_);
+                    b.height_ = 1 + core::max_(a.height_, d.height_);
+                }
+                else
+                {
+                    b.child2_ = index_e;
+                    a.child1_ = index_d;
+                    d.parent_ = index_a;
+                    a.box_ = Combine(c.box_, d.box_);
+                    b.box_ = Combine(a.box_, e.box_);
+                    a.height_ = 1 + core::max_(c.height_, d.height_);
+                    b.height_ = 1 + core::max_(a.height_, e.height_);
+                }
+
+                return index_b;
+            }
+
+            return index_a;
+        }
+
+        void CDynamicAabbTree::Refit(s32 index)
+        {
+            STreeNode* nodes = nodes_.Pointer();
+            while (index != -1)
+            {
+                index = Balance(index);
+
+                STreeNode& node = nodes[index];
+                const STreeNode& child1 = nodes[node.child1_];
+                const STreeNode& child2 = nodes[node.child2_];
+                node.height_ = 1 + core::max_(child1.height_, child2.height_);
+                node.box_ = Combine(child1.box_, child2.box_);
+
+                index = node.parent_;
+            }
+        }
+
+        template <typename F>
+        void CDynamicAabbTree::ForEachLeaf(s32 index, F& function) const
+        {
+            const STreeNode& node = nodes_.ConstPointer()[index];
+            if (node.IsLeaf())
+            {
+                function(index);
+                return;
+            }
+
+            ForEachLeaf(node.child1_, function);
+            ForEachLeaf(node.child2_, function);
+        }
+
+        template <typename F>
+        void CDynamicAabbTree::QueryFrustum(const SViewFrustum& frustum, u32 plane_mask, F& function) const
+        {
+            if (root_ == -1)
+            {
+                return;
+            }
+
+            stack_.Resize(0);
+            stack_masks_.Resize(0);
+            stack_.PushBack(root_);
+            stack_masks_.PushBack(plane_mask);
+
+            while (!stack_.Empty())
+            {
+                const u32 top = stack_.Size() - 1;
+                const s32 index = stack_.ConstPointer()[top];
+                u32 node_mask = stack_masks_.ConstPointer()[top];
+                stack_.Resize(top);
+                stack_masks_.Resize(top);
+
+                const STreeNode& node = nodes_.ConstPointer()[index];
+                const E_FRUSTUM_RELATION relation = frustum.ClassifyBox(node.box_, node_mask);
+                if (relation == EFR_OUTSIDE)
+                {
+                    continue;
+                }
+
+                // nothing below a box inside of the frustum needs a test
+                if (relation == EFR_INSIDE || node.IsLeaf())
+                {
+                    ForEachLeaf(index, function);
+                    continue;
+                }
+
+                stack_.PushBack(node.child1_);
+                stack_masks_.PushBack(node_mask);
+                stack_.PushBack(node.child2_);
+                stack_masks_.PushBack(node_mask);
+            }
+        }
+
+    } // end namespace scene
+} // end namespace kong
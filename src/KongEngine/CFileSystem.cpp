@@ -5,6 +5,8 @@
 #include "IReadFile.h"
 #include "IWriteFile.h"
 #include <gzguts.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 namespace kong
 {
@@ -15,6 +17,11 @@ namespace kong
             return CreateReadFile(filename);
         }
 
+        IReadFile* CFileSystem::CreateAndMapFile(const SPath& filename)
+        {
+            return CreateMappedReadFile(filename);
+        }
+
         IReadFile* CFileSystem::CreateMemoryReadFile(void* memory, s32 len, const SPath& fileName,
             bool deleteMemoryWhenDropped)
         {
@@ -148,6 +155,26 @@ namespace kong
 #endif
         }
 
+        bool CFileSystem::IsFileNewer(const path& filename, const path& reference) const
+        {
+#if defined(_MSC_VER)
+            struct _stat64 file_info;
+            struct _stat64 reference_info;
+#if defined(_KONG_WCHAR_FILESYSTEM)
+            if (_wstat64(filename.c_str(), &file_info) != 0 || _wstat64(reference.c_str(), &reference_info) != 0)
+#else
+            if (_stat64(filename.c_str(), &file_info) != 0 || _stat64(reference.c_str(), &reference_info) != 0)
+#endif
+                return false;
+#else
+            struct stat file_info;
+            struct stat reference_info;
+            if (stat(filename.c_str(), &file_info) != 0 || stat(reference.c_str(), &reference_info) != 0)
+                return false;
+#endif
+            return file_info.st_mtime > reference_info.st_mtime;
+        }
+
         //! creates a filesystem which is able to open files from the ordinary file system,
         //! and out of zipfiles, which are able to be added to the filesystem.
         IFileSystem* CreateFileSystem()
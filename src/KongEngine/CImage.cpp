@@ -6,16 +6,27 @@
 //#include "irrString.h"
 #include "CColorConverter.h"
 #include "CBlit.h"
+#include "os.h"
 #include <cstring>
 
 namespace kong
 {
     namespace video
     {
+        //! blitting works on texels, so it cannot read or write compressed blocks
+        static bool CanBlit(ECOLOR_FORMAT source, ECOLOR_FORMAT target)
+        {
+            if (IImage::IsCompressedFormat(source) || IImage::IsCompressedFormat(target))
+            {
+                os::Printer::log("Compressed images can not be copied, decompress them first.", ELL_WARNING);
+                return false;
+            }
+            return true;
+        }
 
         //! Constructor of empty image
         CImage::CImage(ECOLOR_FORMAT format, const core::Dimension2d<u32>& size)
-            :data_(nullptr), size_(size), format_(format), delete_memory_(true)
+            :data_(nullptr), mip_maps_data_(nullptr), mip_map_level_count_(1), size_(size), format_(format), delete_memory_(true)
         {
             InitData();
         }
@@ -24,7 +35,7 @@ namespace kong
         //! Constructor from raw data
         CImage::CImage(ECOLOR_FORMAT format, const core::Dimension2d<u32>& size, void* data,
             bool ownForeignMemory, bool deleteForeignMemory)
-            : data_(nullptr), size_(size), format_(format), delete_memory_(deleteForeignMemory)
+            : data_(nullptr), mip_maps_data_(nullptr), mip_map_level_count_(1), size_(size), format_(format), delete_memory_(deleteForeignMemory)
         {
             if (ownForeignMemory)
             {
@@ -36,7 +47,7 @@ namespace kong
             {
                 data_ = 0;
                 InitData();
-                memcpy(data_, data, size_.height_ * pitch_);
+                memcpy(data_, data, GetImageDataSizeInBytes());
             }
         }
 
@@ -50,12 +61,12 @@ namespace kong
             bytes_per_pixel_ = GetBitsPerPixelFromFormat(format_) / 8;
 
             // Pitch should be aligned...
-            pitch_ = bytes_per_pixel_ * size_.width_;
+            pitch_ = IsCompressedFormat(format_) ? GetDataSizeFromFormat(format_, size_.width_, 4) : bytes_per_pixel_ * size_.width_;
 
             if (!data_)
             {
                 delete_memory_ = true;
-                data_ = new u8[size_.height_ * pitch_];
+                data_ = new u8[GetImageDataSizeInBytes()];
             }
         }
 
@@ -65,6 +76,16 @@ namespace kong
         {
             if (delete_memory_)
                 delete[] data_;
+            delete[] mip_maps_data_;
+        }
+
+
+        //! sets the stored mip map levels after level 0
+        void CImage::SetMipMapsData(u8* data, u32 level_count)
+        {
+            delete[] mip_maps_data_;
+            mip_maps_data_ = data;
+            mip_map_level_count_ = data != nullptr ? core::max_(level_count, 1u) : 1;
         }
 
 
@@ -92,7 +113,7 @@ namespace kong
         //! Returns image data size in bytes
         u32 CImage::GetImageDataSizeInBytes() const
         {
-            return pitch_ * size_.height_;
+            return GetDataSizeFromFormat(format_, size_.width_, size_.height_);
         }
 
 
@@ -259,6 +280,9 @@ namespace kong
         //! copies this surface into another at given position
         void CImage::CopyTo(IImage* target, const core::position2d<s32>& pos)
         {
+            if (!CanBlit(format_, target->GetColorFormat()))
+                return;
+
             Blit(BLITTER_TEXTURE, target, 0, &pos, this, 0, 0);
         }
 
@@ -266,6 +290,9 @@ namespace kong
         //! copies this surface partially into another at given position
         void CImage::CopyTo(IImage* target, const core::position2d<s32>& pos, const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect)
         {
+            if (!CanBlit(format_, target->GetColorFormat()))
+                return;
+
             Blit(BLITTER_TEXTURE, target, clipRect, &pos, this, &sourceRect, 0);
         }
 
@@ -273,6 +300,9 @@ namespace kong
         //! copies this surface into another, using the alpha mask, a cliprect and a color to add with
         void CImage::CopyToWithAlpha(IImage* target, const core::position2d<s32>& pos, const core::rect<s32>& sourceRect, const SColor &color, const core::rect<s32>* clipRect)
         {
+            if (!CanBlit(format_, target->GetColorFormat()))
+                return;
+
             // color blend only necessary on not full spectrum aka. color.color_ != 0xFFFFFFFF
             Blit(color.color_ == 0xFFFFFFFF ? BLITTER_TEXTURE_ALPHA_BLEND : BLITTER_TEXTURE_ALPHA_COLOR_BLEND,
                 target, clipRect, &pos, this, &sourceRect, color.color_);
@@ -283,7 +313,7 @@ namespace kong
         // note: this is very very slow.
         void CImage::CopyToScaling(void* target, u32 width, u32 height, ECOLOR_FORMAT format, u32 pitch)
         {
-            if (!target || !width || !height)
+            if (!target || !width || !height || !CanBlit(format_, format))
                 return;
 
             const u32 bpp = GetBitsPerPixelFromFormat(format) / 8;
@@ -0,0 +1,332 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CImageLoaderDDS.h"
+
+#ifdef _KONG_COMPILE_WITH_DDS_LOADER_
+
+#include "IReadFile.h"
+#include "os.h"
+#include "CImage.h"
+#include "CImagePyramid.h"
+#include "coreutil.h"
+
+namespace kong
+{
+    namespace video
+    {
+        //! returns the lowest bit of a mask and the largest value it can hold
+        static void GetMaskRange(u32 mask, u32& shift, u32& max)
+        {
+            shift = 0;
+            max = 0;
+            if (mask == 0)
+            {
+                return;
+            }
+            while (!(mask & (1u << shift)))
+            {
+                ++shift;
+            }
+            max = mask >> shift;
+        }
+
+
+        //! returns true if the file maybe is able to be loaded by this class
+        //! based on the file extension (e.g. ".dds")
+        bool CImageLoaderDDS::IsALoadableFileExtension(const io::path& filename) const
+        {
+            return core::hasFileExtension(filename, "dds");
+        }
+
+
+        //! returns true if the file maybe is able to be loaded by this class
+        bool CImageLoaderDDS::IsALoadableFileFormat(io::IReadFile* file) const
+        {
+            if (!file)
+                return false;
+
+            c8 magic[4];
+            return file->Read(magic, 4) == 4 && magic[0] == 'D' && magic[1] == 'D' && magic[2] == 'S' && magic[3] == ' ';
+        }
+
+
+        ECOLOR_FORMAT CImageLoaderDDS::GetCompressedFormat(const SDDSHeader& header, const SDDSHeaderDX10* header_dx10) const
+        {
+            if (header_dx10 != nullptr)
+            {
+                switch (header_dx10->DXGIFormat)
+                {
+                case DXGI_FORMAT_BC1_UNORM:
+                case DXGI_FORMAT_BC1_UNORM_SRGB:
+                    return ECF_BC1;
+                case DXGI_FORMAT_BC2_UNORM:
+                case DXGI_FORMAT_BC2_UNORM_SRGB:
+                    return ECF_BC2;
+                case DXGI_FORMAT_BC3_UNORM:
+                case DXGI_FORMAT_BC3_UNORM_SRGB:
+                    return ECF_BC3;
+                case DXGI_FORMAT_BC4_UNORM:
+                    return ECF_BC4;
+                case DXGI_FORMAT_BC5_UNORM:
+                    return ECF_BC5;
+                case DXGI_FORMAT_BC6H_UF16:
+                    return ECF_BC6H;
+                case DXGI_FORMAT_BC7_UNORM:
+                case DXGI_FORMAT_BC7_UNORM_SRGB:
+                    return ECF_BC7;
+                default:
+                    return ECF_UNKNOWN;
+                }
+            }
+
+            if (!(header.PixelFormat.Flags & DDPF_FOURCC))
+            {
+                return ECF_UNKNOWN;
+            }
+
+            // DXT2 and DXT4 have premultiplied alpha, they are decoded like DXT3 and DXT5
+            const u32 four_cc = header.PixelFormat.FourCC;
+            if (four_cc == MakeDDSFourCC('D', 'X', 'T', '1'))
+                return ECF_BC1;
+            if (four_cc == MakeDDSFourCC('D', 'X', 'T', '2') || four_cc == MakeDDSFourCC('D', 'X', 'T', '3'))
+                return ECF_BC2;
+            if (four_cc == MakeDDSFourCC('D', 'X', 'T', '4') || four_cc == MakeDDSFourCC('D', 'X', 'T', '5'))
+                return ECF_BC3;
+            if (four_cc == MakeDDSFourCC('A', 'T', 'I', '1') || four_cc == MakeDDSFourCC('B', 'C', '4', 'U'))
+                return ECF_BC4;
+            if (four_cc == MakeDDSFourCC('A', 'T', 'I', '2') || four_cc == MakeDDSFourCC('B', 'C', '5', 'U'))
+                return ECF_BC5;
+            return ECF_UNKNOWN;
+        }
+
+
+        bool CImageLoaderDDS::GetUncompressedFormat(const SDDSHeader& header, const SDDSHeaderDX10* header_dx10, SDDSPixelFormat& format) const
+        {
+            format = header.PixelFormat;
+            if (header_dx10 != nullptr)
+            {
+                format.Flags = DDPF_RGB | DDPF_ALPHAPIXELS;
+                format.RGBBitCount = 32;
+                switch (header_dx10->DXGIFormat)
+                {
+                case DXGI_FORMAT_R8G8B8A8_UNORM:
+                case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+                    format.RBitMask = 0x000000ff;
+                    format.GBitMask = 0x0000ff00;
+                    format.BBitMask = 0x00ff0000;
+                    format.ABitMask = 0xff000000;
+                    return true;
+                case DXGI_FORMAT_B8G8R8A8_UNORM:
+                case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+                case DXGI_FORMAT_B8G8R8X8_UNORM:
+                case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+                    format.RBitMask = 0x00ff0000;
+                    format.GBitMask = 0x0000ff00;
+                    format.BBitMask = 0x000000ff;
+                    format.ABitMask = 0xff000000;
+                    if (header_dx10->DXGIFormat == DXGI_FORMAT_B8G8R8X8_UNORM || header_dx10->DXGIFormat == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB)
+                    {
+                        format.Flags = DDPF_RGB;
+                    }
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            if (!(format.Flags & (DDPF_RGB | DDPF_LUMINANCE | DDPF_ALPHA)))
+            {
+                return false;
+            }
+            return format.RGBBitCount == 8 || format.RGBBitCount == 16 || format.RGBBitCount == 24 || format.RGBBitCount == 32;
+        }
+
+
+        void CImageLoaderDDS::ConvertToA8R8G8B8(const u8* source, u32 count, const SDDSPixelFormat& format, u32* target) const
+        {
+            const u32 bytes_per_texel = format.RGBBitCount / 8;
+            const bool has_color = (format.Flags & (DDPF_RGB | DDPF_LUMINANCE)) != 0;
+            const bool luminance = (format.Flags & DDPF_LUMINANCE) != 0;
+            const bool has_alpha = (format.Flags & (DDPF_ALPHAPIXELS | DDPF_ALPHA)) != 0 && format.ABitMask != 0;
+
+            u32 shift[4], max[4];
+            GetMaskRange(format.RBitMask, shift[0], max[0]);
+            GetMaskRange(format.GBitMask, shift[1], max[1]);
+            GetMaskRange(format.BBitMask, shift[2], max[2]);
+            GetMaskRange(format.ABitMask, shift[3], max[3]);
+
+            for (u32 i = 0; i < count; ++i, source += bytes_per_texel)
+            {
+                u32 texel = 0;
+                for (u32 b = 0; b < bytes_per_texel; ++b)
+                {
+                    texel |= static_cast<u32>(source[b]) << (b * 8);
+                }
+
+                u32 channels[4] = { 0, 0, 0, 255 };
+                for (u32 c = 0; c < 4; ++c)
+                {
+                    if (max[c] > 0 && (c < 3 ? has_color : has_alpha))
+                    {
+                        channels[c] = (((texel >> shift[c]) & max[c]) * 255 + max[c] / 2) / max[c];
+                    }
+                }
+                if (luminance)
+                {
+                    channels[1] = channels[2] = channels[0];
+                }
+                target[i] = (channels[3] << 24) | (channels[0] << 16) | (channels[1] << 8) | channels[2];
+            }
+        }
+
+
+        //! creates a surface from the file
+        IImage* CImageLoaderDDS::LoadImage(io::IReadFile* file) const
+        {
+            u32 magic;
+            SDDSHeader header;
+            if (file->Read(&magic, sizeof(magic)) != sizeof(magic) || file->Read(&header, sizeof(SDDSHeader)) != sizeof(SDDSHeader))
+            {
+                os::Printer::log("DDS file is too short", file->GetFileName(), ELL_ERROR);
+                return nullptr;
+            }
+
+#ifdef __BIG_ENDIAN__
+            magic = os::Byteswap::byteswap(magic);
+            u32 *fields = reinterpret_cast<u32 *>(&header);
+            for (u32 i = 0; i < sizeof(SDDSHeader) / sizeof(u32); ++i)
+            {
+                fields[i] = os::Byteswap::byteswap(fields[i]);
+            }
+#endif
+
+            if (magic != MakeDDSFourCC('D', 'D', 'S', ' ') || header.Size != sizeof(SDDSHeader) || header.Width == 0 || header.Height == 0)
+            {
+                os::Printer::log("Not a valid DDS file", file->GetFileName(), ELL_ERROR);
+                return nullptr;
+            }
+            if (header.Width > DDS_MAX_DIMENSION || header.Height > DDS_MAX_DIMENSION)
+            {
+                os::Printer::log("DDS texture is larger than the largest texture size", file->GetFileName(), ELL_ERROR);
+                return nullptr;
+            }
+
+            SDDSHeaderDX10 header_dx10;
+            const bool has_dx10 = (header.PixelFormat.Flags & DDPF_FOURCC) && header.PixelFormat.FourCC == MakeDDSFourCC('D', 'X', '1', '0');
+            if (has_dx10)
+            {
+                if (file->Read(&header_dx10, sizeof(SDDSHeaderDX10)) != sizeof(SDDSHeaderDX10))
+                {
+                    os::Printer::log("DDS file is too short", file->GetFileName(), ELL_ERROR);
+                    return nullptr;
+                }
+#ifdef __BIG_ENDIAN__
+                fields = reinterpret_cast<u32 *>(&header_dx10);
+                for (u32 i = 0; i < sizeof(SDDSHeaderDX10) / sizeof(u32); ++i)
+                {
+                    fields[i] = os::Byteswap::byteswap(fields[i]);
+                }
+#endif
+            }
+
+            if ((header.Caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) ||
+                (has_dx10 && ((header_dx10.MiscFlag & DDS_RESOURCE_MISC_TEXTURECUBE) || header_dx10.ArraySize > 1)))
+            {
+                os::Printer::log("DDS cube maps, volumes and arrays are not supported", file->GetFileName(), ELL_ERROR);
+                return nullptr;
+            }
+
+            const SDDSHeaderDX10 *dx10 = has_dx10 ? &header_dx10 : nullptr;
+            const ECOLOR_FORMAT compressed_format = GetCompressedFormat(header, dx10);
+            SDDSPixelFormat pixel_format;
+            if (compressed_format == ECF_UNKNOWN && !GetUncompressedFormat(header, dx10, pixel_format))
+            {
+                os::Printer::log("Unsupported DDS format", file->GetFileName(), ELL_ERROR);
+                return nullptr;
+            }
+
+            const core::Dimension2d<u32> size(header.Width, header.Height);
+            u32 level_count = (header.Flags & DDSD_MIPMAPCOUNT) ? header.MipMapCount : 1;
+            level_count = core::clamp(level_count, 1u, CImagePyramid::GetLevelCount(size));
+
+            // size of level 0 and of all further levels, which follow each other
+            u64 sizes[2] = { 0, 0 };
+            for (u32 level = 0; level < level_count; ++level)
+            {
+                const core::Dimension2d<u32> level_size = CImagePyramid::GetLevelSize(size, level);
+                const u64 level_data_size = compressed_format != ECF_UNKNOWN ?
+                    IImage::GetDataSizeFromFormat(compressed_format, level_size.width_, level_size.height_) :
+                    static_cast<u64>(level_size.width_) * level_size.height_ * (pixel_format.RGBBitCount / 8);
+                sizes[level == 0 ? 0 : 1] += level_data_size;
+            }
+
+            // the header alone decides the sizes, so nothing is allocated for levels the file does not have
+            const u64 remaining = static_cast<u64>(file->GetSize() - file->GetPos());
+            if (sizes[0] + sizes[1] > remaining)
+            {
+                os::Printer::log("DDS file is too short", file->GetFileName(), ELL_ERROR);
+                return nullptr;
+            }
+            const u32 data_sizes[2] = { static_cast<u32>(sizes[0]), static_cast<u32>(sizes[1]) };
+
+            // compressed levels are read as they are, the others are converted afterwards
+            CImage *image = nullptr;
+            u8 *mip_maps = level_count > 1 ? new u8[data_sizes[1]] : nullptr;
+            u8 *data = nullptr;
+            if (compressed_format != ECF_UNKNOWN)
+            {
+                image = new CImage(compressed_format, size);
+                data = static_cast<u8 *>(image->Lock());
+            }
+            else
+            {
+                data = new u8[data_sizes[0]];
+            }
+
+            const bool complete = file->Read(data, data_sizes[0]) == static_cast<s32>(data_sizes[0]) &&
+                (mip_maps == nullptr || file->Read(mip_maps, data_sizes[1]) == static_cast<s32>(data_sizes[1]));
+
+            if (compressed_format == ECF_UNKNOWN)
+            {
+                if (complete)
+                {
+                    image = new CImage(ECF_A8R8G8B8, size);
+                    ConvertToA8R8G8B8(data, size.width_ * size.height_, pixel_format, static_cast<u32 *>(image->Lock()));
+                    if (mip_maps != nullptr)
+                    {
+                        const u32 texel_count = data_sizes[1] / (pixel_format.RGBBitCount / 8);
+                        u8 *converted = new u8[texel_count * 4];
+                        ConvertToA8R8G8B8(mip_maps, texel_count, pixel_format, reinterpret_cast<u32 *>(converted));
+                        delete[] mip_maps;
+                        mip_maps = converted;
+                    }
+                }
+                delete[] data;
+            }
+
+            if (!complete)
+            {
+                os::Printer::log("DDS file is too short", file->GetFileName(), ELL_ERROR);
+                delete image;
+                delete[] mip_maps;
+                return nullptr;
+            }
+
+            image->Unlock();
+            image->SetMipMapsData(mip_maps, level_count);
+            return image;
+        }
+
+
+        //! creates a loader which is able to load dds images
+        IImageLoader* CreateImageLoaderDDS()
+        {
+            return new CImageLoaderDDS();
+        }
+
+
+    } // end namespace video
+} // end namespace kong
+
+#endif
@@ -17,11 +17,6 @@ namespace kong
     namespace video
     {
 
-#ifdef _KONG_COMPILE_WITH_LIBJPEG_
-        // Static members
-        io::path CImageLoaderJpg::filename_;
-#endif
-
         //! constructor
         CImageLoaderJpg::CImageLoaderJpg()
         {
@@ -57,6 +52,9 @@ namespace kong
 
             // for longjmp, to return to caller on a fatal error
             jmp_buf setjmp_buffer;
+
+            // file of the image for error messages, loaders run on several threads at once
+            const io::SPath* filename;
         };
 
         void CImageLoaderJpg::InitSource(j_decompress_ptr cinfo)
@@ -114,7 +112,7 @@ namespace kong
             c8 temp1[JMSG_LENGTH_MAX];
             (*cinfo->err->format_message)(cinfo, temp1);
             core::stringc errMsg("JPEG FATAL ERROR in ");
-            errMsg += core::stringc(filename_);
+            errMsg += *((irr_jpeg_error_mgr*)cinfo->err)->filename;
             //os::Printer::log(errMsg.c_str(), temp1, ELL_ERROR);
         }
 #endif // _KONG_COMPILE_WITH_LIBJPEG_
@@ -148,8 +146,6 @@ namespace kong
             if (!file)
                 return 0;
 
-            filename_ = file->GetFileName();
-
             u8 **rowPtr = 0;
             u8* input = new u8[file->GetSize()];
             file->Read(input, file->GetSize());
@@ -166,6 +162,7 @@ namespace kong
             cinfo.err = jpeg_std_error(&jerr.pub);
             cinfo.err->error_exit = ErrorExit;
             cinfo.err->output_message = OutputMessage;
+            jerr.filename = &file->GetFileName();
 
             // compatibility fudge:
             // we need to use setjmp/longjmp for error handling as gcc-linux
@@ -0,0 +1,208 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CImagePyramid.h"
+#include "CImage.h"
+#include "KongMath.h"
+#include <cmath>
+
+namespace kong
+{
+    namespace video
+    {
+        //! steps of the table which turns linear intensities back into sRGB
+        static const u32 LINEAR_STEPS = 4096;
+
+        //! conversions between 8 bit channels and floats, built once
+        struct SGammaTables
+        {
+            SGammaTables()
+            {
+                for (u32 i = 0; i < 256; ++i)
+                {
+                    const f32 value = i / 255.f;
+                    unorm_to_float_[i] = value;
+                    srgb_to_linear_[i] = value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+                }
+                for (u32 i = 0; i <= LINEAR_STEPS; ++i)
+                {
+                    const f32 value = static_cast<f32>(i) / LINEAR_STEPS;
+                    const f32 srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.f / 2.4f) - 0.055f;
+                    linear_to_srgb_[i] = static_cast<u8>(srgb * 255.f + 0.5f);
+                }
+            }
+
+            f32 unorm_to_float_[256];
+            f32 srgb_to_linear_[256];
+            u8 linear_to_srgb_[LINEAR_STEPS + 1];
+        };
+
+        //! the tables are built by the first caller, also if several threads build pyramids
+        static const SGammaTables& GetGammaTables()
+        {
+            static const SGammaTables tables;
+            return tables;
+        }
+
+        //! source texels of a target texel along one axis and their weights
+        struct SFilterTaps
+        {
+            //! target is the index of the target texel, target_extent the width or height of the target
+            SFilterTaps(u32 target, u32 source_extent, u32 target_extent)
+            {
+                if (source_extent == 1)
+                {
+                    count_ = 1;
+                    index_[0] = 0;
+                    weight_[0] = 1.f;
+                }
+                else if (source_extent == target_extent * 2)
+                {
+                    count_ = 2;
+                    index_[0] = target * 2;
+                    index_[1] = target * 2 + 1;
+                    weight_[0] = weight_[1] = 0.5f;
+                }
+                else
+                {
+                    // an odd extent of 2n+1 texels spreads over n target texels, the
+                    // middle tap is covered completely, the outer ones partly
+                    const f32 scale = 1.f / source_extent;
+                    count_ = 3;
+                    index_[0] = target * 2;
+                    index_[1] = target * 2 + 1;
+                    index_[2] = target * 2 + 2;
+                    weight_[0] = (target_extent - target) * scale;
+                    weight_[1] = target_extent * scale;
+                    weight_[2] = (target + 1) * scale;
+                }
+            }
+
+            u32 count_;
+            u32 index_[3];
+            f32 weight_[3];
+        };
+
+        CImagePyramid::CImagePyramid()
+            : base_(nullptr)
+        {
+        }
+
+        CImagePyramid::~CImagePyramid()
+        {
+            Clear();
+        }
+
+        bool CImagePyramid::Build(IImage* image, bool srgb)
+        {
+            Clear();
+            base_ = image;
+            if (image == nullptr || image->GetColorFormat() != ECF_A8R8G8B8)
+            {
+                return false;
+            }
+
+            const core::Dimension2d<u32> size = image->GetDimension();
+            const u32 count = GetLevelCount(size);
+            IImage *source = image;
+            for (u32 level = 1; level < count; ++level)
+            {
+                IImage *target = new CImage(ECF_A8R8G8B8, GetLevelSize(size, level));
+                Downsample(source, target, srgb);
+                levels_.PushBack(target);
+                source = target;
+            }
+            return true;
+        }
+
+        void CImagePyramid::Clear()
+        {
+            for (u32 i = 0; i < levels_.Size(); ++i)
+            {
+                delete levels_.ConstPointer()[i];
+            }
+            levels_.Resize(0);
+            base_ = nullptr;
+        }
+
+        u32 CImagePyramid::GetLevelCount() const
+        {
+            return base_ != nullptr ? levels_.Size() + 1 : 0;
+        }
+
+        IImage* CImagePyramid::GetLevel(u32 level) const
+        {
+            if (level == 0)
+            {
+                return base_;
+            }
+            return level <= levels_.Size() ? levels_.ConstPointer()[level - 1] : nullptr;
+        }
+
+        u32 CImagePyramid::GetLevelCount(const core::Dimension2d<u32>& size)
+        {
+            u32 count = 1;
+            for (u32 extent = core::max_(size.width_, size.height_); extent > 1; extent >>= 1)
+            {
+                ++count;
+            }
+            return count;
+        }
+
+        core::Dimension2d<u32> CImagePyramid::GetLevelSize(const core::Dimension2d<u32>& size, u32 level)
+        {
+            return core::Dimension2d<u32>(core::max_(size.width_ >> level, 1u), core::max_(size.height_ >> level, 1u));
+        }
+
+        void CImagePyramid::Downsample(IImage* source, IImage* target, bool srgb)
+        {
+            const SGammaTables &tables = GetGammaTables();
+            const f32 *to_float = srgb ? tables.srgb_to_linear_ : tables.unorm_to_float_;
+
+            const core::Dimension2d<u32> source_size = source->GetDimension();
+            const core::Dimension2d<u32> target_size = target->GetDimension();
+            const u32 source_pitch = source->GetPitch() / 4;
+            const u32 target_pitch = target->GetPitch() / 4;
+            const u32 *source_data = static_cast<const u32 *>(source->Lock());
+            u32 *target_data = static_cast<u32 *>(target->Lock());
+
+            for (u32 y = 0; y < target_size.height_; ++y)
+            {
+                const SFilterTaps rows(y, source_size.height_, target_size.height_);
+                u32 *target_row = target_data + y * target_pitch;
+                for (u32 x = 0; x < target_size.width_; ++x)
+                {
+                    const SFilterTaps columns(x, source_size.width_, target_size.width_);
+
+                    // blue, green, red and alpha of the weighted average
+                    f32 average[4] = { 0.f, 0.f, 0.f, 0.f };
+                    for (u32 r = 0; r < rows.count_; ++r)
+                    {
+                        const u32 *source_row = source_data + rows.index_[r] * source_pitch;
+                        for (u32 c = 0; c < columns.count_; ++c)
+                        {
+                            const u32 texel = source_row[columns.index_[c]];
+                            const f32 weight = rows.weight_[r] * columns.weight_[c];
+                            average[0] += weight * to_float[texel & 0xff];
+                            average[1] += weight * to_float[(texel >> 8) & 0xff];
+                            average[2] += weight * to_float[(texel >> 16) & 0xff];
+                            average[3] += weight * tables.unorm_to_float_[texel >> 24];
+                        }
+                    }
+
+                    u32 result = static_cast<u32>(average[3] * 255.f + 0.5f) << 24;
+                    for (u32 c = 0; c < 3; ++c)
+                    {
+                        const u32 value = srgb ? tables.linear_to_srgb_[static_cast<u32>(average[c] * LINEAR_STEPS + 0.5f)] :
+                            static_cast<u32>(average[c] * 255.f + 0.5f);
+                        result |= value << (c * 8);
+                    }
+                    target_row[x] = result;
+                }
+            }
+
+            source->Unlock();
+            target->Unlock();
+        }
+    } // end namespace video
+} // end namespace kong
@@ -0,0 +1,132 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CImageWriterDDS.h"
+
+#ifdef _KONG_COMPILE_WITH_DDS_LOADER_
+
+#include "CImageLoaderDDS.h"
+#include "CImagePyramid.h"
+#include "os.h"
+#include <cstring>
+
+namespace kong
+{
+    namespace video
+    {
+        //! fills the four cc of the pixel format, or the DXGI format if the format needs a DX10 header
+        static bool SetFormat(ECOLOR_FORMAT format, SDDSHeader& header, SDDSHeaderDX10& header_dx10)
+        {
+            switch (format)
+            {
+            case ECF_BC1:
+                header.PixelFormat.FourCC = MakeDDSFourCC('D', 'X', 'T', '1');
+                return true;
+            case ECF_BC2:
+                header.PixelFormat.FourCC = MakeDDSFourCC('D', 'X', 'T', '3');
+                return true;
+            case ECF_BC3:
+                header.PixelFormat.FourCC = MakeDDSFourCC('D', 'X', 'T', '5');
+                return true;
+            case ECF_BC4:
+                header.PixelFormat.FourCC = MakeDDSFourCC('A', 'T', 'I', '1');
+                return true;
+            case ECF_BC5:
+                header.PixelFormat.FourCC = MakeDDSFourCC('A', 'T', 'I', '2');
+                return true;
+            case ECF_BC6H:
+                header_dx10.DXGIFormat = DXGI_FORMAT_BC6H_UF16;
+                break;
+            case ECF_BC7:
+                header_dx10.DXGIFormat = DXGI_FORMAT_BC7_UNORM;
+                break;
+            default:
+                return false;
+            }
+
+            header.PixelFormat.FourCC = MakeDDSFourCC('D', 'X', '1', '0');
+            header_dx10.ResourceDimension = DDS_DIMENSION_TEXTURE2D;
+            header_dx10.ArraySize = 1;
+            return true;
+        }
+
+
+        //! Writes a block compressed image and all of its stored mip map levels to the file.
+        bool CImageWriterDDS::WriteImage(io::IWriteFile* file, IImage* image)
+        {
+            if (!file || !image || !IImage::IsCompressedFormat(image->GetColorFormat()))
+            {
+                return false;
+            }
+
+            const ECOLOR_FORMAT format = image->GetColorFormat();
+            const core::Dimension2d<u32> &size = image->GetDimension();
+            const u32 level_count = image->GetMipMapLevelCount();
+
+            SDDSHeader header;
+            SDDSHeaderDX10 header_dx10;
+            memset(&header, 0, sizeof(SDDSHeader));
+            memset(&header_dx10, 0, sizeof(SDDSHeaderDX10));
+            if (!SetFormat(format, header, header_dx10))
+            {
+                return false;
+            }
+
+            header.Size = sizeof(SDDSHeader);
+            header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+            header.Height = size.height_;
+            header.Width = size.width_;
+            header.PitchOrLinearSize = image->GetImageDataSizeInBytes();
+            header.PixelFormat.Size = sizeof(SDDSPixelFormat);
+            header.PixelFormat.Flags = DDPF_FOURCC;
+            header.Caps = DDSCAPS_TEXTURE;
+            if (level_count > 1)
+            {
+                header.Flags |= DDSD_MIPMAPCOUNT;
+                header.MipMapCount = level_count;
+                header.Caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+            }
+
+            const bool has_dx10 = header.PixelFormat.FourCC == MakeDDSFourCC('D', 'X', '1', '0');
+            u32 magic = MakeDDSFourCC('D', 'D', 'S', ' ');
+
+#ifdef __BIG_ENDIAN__
+            magic = os::Byteswap::byteswap(magic);
+            u32 *fields = reinterpret_cast<u32 *>(&header);
+            for (u32 i = 0; i < sizeof(SDDSHeader) / sizeof(u32); ++i)
+            {
+                fields[i] = os::Byteswap::byteswap(fields[i]);
+            }
+            fields = reinterpret_cast<u32 *>(&header_dx10);
+            for (u32 i = 0; i < sizeof(SDDSHeaderDX10) / sizeof(u32); ++i)
+            {
+                fields[i] = os::Byteswap::byteswap(fields[i]);
+            }
+#endif
+
+            if (file->Write(&magic, sizeof(magic)) != sizeof(magic) ||
+                file->Write(&header, sizeof(SDDSHeader)) != sizeof(SDDSHeader) ||
+                (has_dx10 && file->Write(&header_dx10, sizeof(SDDSHeaderDX10)) != sizeof(SDDSHeaderDX10)))
+            {
+                return false;
+            }
+
+            // the further levels follow each other in the same order as in the file
+            u32 mip_maps_size = 0;
+            for (u32 level = 1; level < level_count; ++level)
+            {
+                const core::Dimension2d<u32> level_size = CImagePyramid::GetLevelSize(size, level);
+                mip_maps_size += IImage::GetDataSizeFromFormat(format, level_size.width_, level_size.height_);
+            }
+
+            const u32 data_size = image->GetImageDataSizeInBytes();
+            const bool written = file->Write(image->Lock(), data_size) == static_cast<s32>(data_size) &&
+                (mip_maps_size == 0 || file->Write(image->GetMipMapsData(), mip_maps_size) == static_cast<s32>(mip_maps_size));
+            image->Unlock();
+            return written;
+        }
+
+    } // end namespace video
+} // end namespace kong
+
+#endif
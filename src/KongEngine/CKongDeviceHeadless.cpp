@@ -0,0 +1,206 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CKongDeviceHeadless.h"
+
+#ifdef _KONG_COMPILE_WITH_HEADLESS_DEVICE_
+
+#include <cstdio>
+#include "ISceneManager.h"
+#include "IWriteFile.h"
+#include "IImage.h"
+#include "os.h"
+
+namespace kong
+{
+    namespace video
+    {
+#ifdef _KONG_COMPILE_WITH_SOFTWARE_
+        IVideoDriver* CreateSoftwareDriver(const SKongCreationParameters& params, io::IFileSystem* io);
+#endif
+    }
+
+    CKongDeviceHeadless::CKongDeviceHeadless(const SKongCreationParameters &param)
+        : CKongDeviceStub(param), frame_(0), frame_time_(0.0), visible_nodes_(0.0), culled_nodes_(0.0), shadow_casters_(0.0), draw_calls_(0.0), instances_(0.0), material_changes_(0.0), frame_started_(false), statistics_printed_(false)
+    {
+        for (u32 i = 0; i < scene::ERPT_COUNT; ++i)
+        {
+            pass_time_[i] = 0.0;
+        }
+
+        CreateVideo();
+
+        if (video_driver_ != nullptr)
+        {
+            CreateScene();
+        }
+    }
+
+    CKongDeviceHeadless::~CKongDeviceHeadless()
+    {
+        if (!statistics_printed_)
+        {
+            PrintStatistics();
+        }
+    }
+
+    bool CKongDeviceHeadless::run()
+    {
+        StartEventFromUser();
+
+        if (close_)
+        {
+            return false;
+        }
+
+        // every call after the first one ends a frame
+        const std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+        if (frame_started_)
+        {
+            if (video_driver_ != nullptr && !create_params_.frame_dump_path_.empty())
+            {
+                DumpFrame(frame_);
+            }
+
+            if (scene_manager_ != nullptr)
+            {
+                const scene::SRenderStatistics& statistics = scene_manager_->GetRenderStatistics();
+                for (u32 i = 0; i < scene::ERPT_COUNT; ++i)
+                {
+                    pass_time_[i] += statistics.pass_time_[i];
+                }
+                visible_nodes_ += statistics.visible_nodes_;
+                culled_nodes_ += statistics.culled_nodes_;
+                shadow_casters_ += statistics.shadow_casters_;
+                draw_calls_ += statistics.draw_calls_;
+                instances_ += statistics.instances_;
+                material_changes_ += statistics.material_changes_;
+            }
+
+            frame_time_ += std::chrono::duration<f64, std::milli>(now - frame_start_).count();
+            ++frame_;
+        }
+        frame_started_ = true;
+        frame_start_ = std::chrono::high_resolution_clock::now();
+
+        if (create_params_.frame_count_ != 0 && frame_ >= create_params_.frame_count_)
+        {
+            close_ = true;
+            PrintStatistics();
+            statistics_printed_ = true;
+        }
+
+        return !close_;
+    }
+
+    video::IVideoDriver* CKongDeviceHeadless::GetVideoDriver()
+    {
+        return video_driver_;
+    }
+
+    scene::ISceneManager* CKongDeviceHeadless::GetSceneManager()
+    {
+        return scene_manager_;
+    }
+
+    void CKongDeviceHeadless::CreateVideo()
+    {
+        switch (create_params_.driver_type_)
+        {
+        case video::EDT_NULL:
+            video_driver_ = video::CreateNullDriver(file_system_, create_params_.window_size_);
+            break;
+
+        case video::EDT_SOFTWARE:
+#ifdef _KONG_COMPILE_WITH_SOFTWARE_
+            video_driver_ = video::CreateSoftwareDriver(create_params_, file_system_);
+#else
+            os::Printer::log("No software driver support compiled in.", ELL_ERROR);
+#endif
+            break;
+
+        default:
+            os::Printer::log("The headless device only supports the null and the software driver.", ELL_ERROR);
+            break;
+        }
+    }
+
+    void CKongDeviceHeadless::DumpFrame(u32 frame)
+    {
+        video::IImage* image = video_driver_->CreateScreenShot();
+        if (image == nullptr)
+        {
+            return;
+        }
+
+        c8 suffix[32];
+        snprintf(suffix, sizeof(suffix), "%05u.ppm", frame);
+        io::SPath filename = create_params_.frame_dump_path_;
+        filename += suffix;
+
+        io::IWriteFile* file = file_system_->CreateAndWriteFile(filename);
+        if (file == nullptr)
+        {
+            os::Printer::log("Could not open frame dump file", filename, ELL_ERROR);
+            delete image;
+            return;
+        }
+
+        const core::Dimension2d<u32>& size = image->GetDimension();
+        c8 header[64];
+        const s32 header_size = snprintf(header, sizeof(header), "P6\n%u %u\n255\n", size.width_, size.height_);
+        file->Write(header, header_size);
+
+        // ppm stores rgb triples, the image is A8R8G8B8
+        u8* row = new u8[size.width_ * 3];
+        const u8* pixels = static_cast<const u8*>(image->Lock());
+        for (u32 y = 0; y < size.height_; ++y)
+        {
+            const u32* src = reinterpret_cast<const u32*>(pixels + y * image->GetPitch());
+            for (u32 x = 0; x < size.width_; ++x)
+            {
+                row[x * 3 + 0] = static_cast<u8>((src[x] >> 16) & 0xff);
+                row[x * 3 + 1] = static_cast<u8>((src[x] >> 8) & 0xff);
+                row[x * 3 + 2] = static_cast<u8>(src[x] & 0xff);
+            }
+            file->Write(row, size.width_ * 3);
+        }
+        image->Unlock();
+
+        delete[] row;
+        delete file;
+        delete image;
+    }
+
+    void CKongDeviceHeadless::PrintStatistics() const
+    {
+        if (frame_ == 0)
+        {
+            return;
+        }
+
+        static const c8* const pass_names[scene::ERPT_COUNT] = { "shadow", "geometry", "lighting", "post process" };
+
+        c8 text[256];
+        const f64 average = frame_time_ / frame_;
+        snprintf(text, sizeof(text), "%u frames, %.3f ms per frame, %.2f fps", frame_, average,
+            average > 0.0 ? 1000.0 / average : 0.0);
+        os::Printer::print(text);
+
+        for (u32 i = 0; i < scene::ERPT_COUNT; ++i)
+        {
+            snprintf(text, sizeof(text), "  %-12s %.3f ms", pass_names[i], pass_time_[i] / frame_);
+            os::Printer::print(text);
+        }
+
+        snprintf(text, sizeof(text), "  %.1f visible and %.1f culled nodes, %.1f shadow casters per frame",
+            visible_nodes_ / frame_, culled_nodes_ / frame_, shadow_casters_ / frame_);
+        os::Printer::print(text);
+
+        snprintf(text, sizeof(text), "  %.1f draw calls, %.1f instanced buffers and %.1f material changes per frame",
+            draw_calls_ / frame_, instances_ / frame_, material_changes_ / frame_);
+        os::Printer::print(text);
+    }
+} // end namespace kong
+
+#endif // _KONG_COMPILE_WITH_HEADLESS_DEVICE_
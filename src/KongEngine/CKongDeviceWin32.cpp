@@ -1,6 +1,10 @@
 // Copyright (C) 2018 Lyu Luan
 // This file is part of the "Kong Engine".
 
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_WINDOWS_DEVICE_
+
 #include "IEventReceiver.h"
 #include "List.h"
 int screen_exit = 0;
@@ -307,3 +311,5 @@ namespace kong
         video_driver_ = video::CreateOpenGLDeferredShaderDriver(create_params_, file_system_, this);
     }
 }
+
+#endif // _KONG_COMPILE_WITH_WINDOWS_DEVICE_
@@ -0,0 +1,391 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CLightClusterGrid.h"
+#include "KongCompileConfig.h"
+#include "KongMath.h"
+
+#ifdef _KONG_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
+namespace kong
+{
+    namespace video
+    {
+        //! a light is cut off where its attenuation drops below this value
+        static const f32 MIN_LIGHT_ATTENUATION = 1.f / 256.f;
+
+        //! the near plane used for the slices of projections starting at or behind the camera
+        static const f32 MIN_NEAR_FAR_RATIO = 0.001f;
+
+        //! returns a coordinate of the point (x, depth) after the projection, row vector convention
+        static inline f32 ProjectAxis(const core::Matrixf& projection, u32 axis, f32 value, f32 depth)
+        {
+            const f32 w = depth * projection(2, 3) + projection(3, 3);
+            return (value * projection(axis, axis) + depth * projection(2, axis) + projection(3, axis)) / w;
+        }
+
+        //! inverse of ProjectAxis() for a known depth
+        static inline f32 UnprojectAxis(const core::Matrixf& projection, u32 axis, f32 ndc, f32 depth)
+        {
+            const f32 w = depth * projection(2, 3) + projection(3, 3);
+            return (ndc * w - depth * projection(2, axis) - projection(3, axis)) / projection(axis, axis);
+        }
+
+        //! returns the view space depth which is projected to a normalized device depth
+        static inline f32 UnprojectDepth(const core::Matrixf& projection, f32 ndc)
+        {
+            return (projection(3, 3) * ndc - projection(3, 2)) / (projection(2, 2) - ndc * projection(2, 3));
+        }
+
+        CLightClusterGrid::CLightClusterGrid()
+            : bounds_valid_(false), near_(0.f), far_(0.f), slice_scale_(0.f), slice_bias_(0.f), global_lights_(0)
+        {
+            clusters_.Resize(CLUSTER_COUNT * 2);
+            clusters_.SetAll(0);
+        }
+
+        void CLightClusterGrid::Update(const core::Matrixf& view, const core::Matrixf& projection, const SLight* lights, u32 count)
+        {
+            if (!bounds_valid_ || projection != projection_)
+            {
+                UpdateClusterBounds(projection);
+            }
+
+            hit_clusters_.Resize(0);
+            hit_lights_.Resize(0);
+            global_lights_ = 0;
+
+            for (u32 i = 0; i < count; ++i)
+            {
+                f32 center[3];
+                f32 radius;
+                if (lights[i].type_ == ELT_DIRECTIONAL)
+                {
+                    ++global_lights_;
+                }
+                else if (GetLightSphere(lights[i], view, center, radius))
+                {
+                    AddLight(i, center, radius);
+                }
+            }
+
+            // counting sort of the hits, the lights of a cluster stay in their order
+            u32 *clusters = clusters_.Pointer();
+            for (u32 i = 0; i < CLUSTER_COUNT; ++i)
+            {
+                clusters[i * 2 + 1] = 0;
+            }
+            for (u32 i = 0; i < hit_clusters_.Size(); ++i)
+            {
+                ++clusters[hit_clusters_.ConstPointer()[i] * 2 + 1];
+            }
+
+            u32 offset = global_lights_;
+            for (u32 i = 0; i < CLUSTER_COUNT; ++i)
+            {
+                clusters[i * 2] = offset;
+                offset += clusters[i * 2 + 1];
+            }
+
+            light_indices_.Resize(offset);
+            u32 *indices = light_indices_.Pointer();
+            u32 global = 0;
+            for (u32 i = 0; i < count; ++i)
+            {
+                if (lights[i].type_ == ELT_DIRECTIONAL)
+                {
+                    indices[global++] = i;
+                }
+            }
+
+            // the offsets are moved to the end of each list while filling, then moved back
+            for (u32 i = 0; i < hit_clusters_.Size(); ++i)
+            {
+                const u32 cluster = hit_clusters_.ConstPointer()[i];
+                indices[clusters[cluster * 2]++] = hit_lights_.ConstPointer()[i];
+            }
+            for (u32 i = 0; i < CLUSTER_COUNT; ++i)
+            {
+                clusters[i * 2] -= clusters[i * 2 + 1];
+            }
+        }
+
+        const u32* CLightClusterGrid::GetClusters() const
+        {
+            return clusters_.ConstPointer();
+        }
+
+        const u32* CLightClusterGrid::GetLightIndices() const
+        {
+            return light_indices_.ConstPointer();
+        }
+
+        u32 CLightClusterGrid::GetLightIndexCount() const
+        {
+            return light_indices_.Size();
+        }
+
+        u32 CLightClusterGrid::GetGlobalLightCount() const
+        {
+            return global_lights_;
+        }
+
+        f32 CLightClusterGrid::GetNear() const
+        {
+            return near_;
+        }
+
+        f32 CLightClusterGrid::GetFar() const
+        {
+            return far_;
+        }
+
+        void CLightClusterGrid::GetSliceTransform(f32& scale, f32& bias) const
+        {
+            scale = slice_scale_;
+            bias = slice_bias_;
+        }
+
+        f32 CLightClusterGrid::GetLightRange(const SLight& light)
+        {
+            f32 range = light.radius_;
+
+            // solve constant + linear * d + quadratic * d * d = 1 / MIN_LIGHT_ATTENUATION
+            const f32 c = light.attenuation_.x_ - 1.f / MIN_LIGHT_ATTENUATION;
+            const f32 l = light.attenuation_.y_;
+            const f32 q = light.attenuation_.z_;
+            if (q > 0.f)
+            {
+                range = core::min_(range, (-l + sqrtf(core::max_(l * l - 4.f * q * c, 0.f))) / (2.f * q));
+            }
+            else if (l > 0.f)
+            {
+                range = core::min_(range, -c / l);
+            }
+
+            return core::max_(range, 0.f);
+        }
+
+        void CLightClusterGrid::UpdateClusterBounds(const core::Matrixf& projection)
+        {
+            projection_ = projection;
+            bounds_valid_ = true;
+
+            far_ = UnprojectDepth(projection, 1.f);
+            near_ = core::max_(UnprojectDepth(projection, -1.f), far_ * MIN_NEAR_FAR_RATIO);
+
+            const f32 log_ratio = logf(far_ / near_);
+            slice_scale_ = SLICES / log_ratio;
+            slice_bias_ = -logf(near_) * slice_scale_;
+
+            for (u32 i = 0; i <= SLICES; ++i)
+            {
+                slice_depth_[i] = near_ * expf(log_ratio * i / SLICES);
+            }
+
+            // the borders of a tile are planes through the camera, so the bounds are at the slice borders
+            for (u32 slice = 0; slice < SLICES; ++slice)
+            {
+                const f32 depth[2] = { slice_depth_[slice], slice_depth_[slice + 1] };
+                for (u32 x = 0; x < TILES_X; ++x)
+                {
+                    const f32 ndc[2] = { 2.f * x / TILES_X - 1.f, 2.f * (x + 1) / TILES_X - 1.f };
+                    f32 &min_x = tile_min_x_[slice][x];
+                    f32 &max_x = tile_max_x_[slice][x];
+                    min_x = max_x = UnprojectAxis(projection, 0, ndc[0], depth[0]);
+                    for (u32 i = 1; i < 4; ++i)
+                    {
+                        const f32 value = UnprojectAxis(projection, 0, ndc[i & 1], depth[i >> 1]);
+                        min_x = core::min_(min_x, value);
+                        max_x = core::max_(max_x, value);
+                    }
+                }
+
+                for (u32 y = 0; y < TILES_Y; ++y)
+                {
+                    const f32 ndc[2] = { 2.f * y / TILES_Y - 1.f, 2.f * (y + 1) / TILES_Y - 1.f };
+                    f32 &min_y = tile_min_y_[slice][y];
+                    f32 &max_y = tile_max_y_[slice][y];
+                    min_y = max_y = UnprojectAxis(projection, 1, ndc[0], depth[0]);
+                    for (u32 i = 1; i < 4; ++i)
+                    {
+                        const f32 value = UnprojectAxis(projection, 1, ndc[i & 1], depth[i >> 1]);
+                        min_y = core::min_(min_y, value);
+                        max_y = core::max_(max_y, value);
+                    }
+                }
+            }
+        }
+
+        bool CLightClusterGrid::GetLightSphere(const SLight& light, const core::Matrixf& view, f32* center, f32& radius) const
+        {
+            const f32 range = GetLightRange(light);
+            if (range <= 0.f)
+            {
+                return false;
+            }
+
+            core::vector3df position = light.position_;
+            radius = range;
+
+            // the smallest sphere around the cone of a spot light
+            if (light.type_ == ELT_SPOT && light.outer_cone_ < 90.f && light.direction_.GetLengthSQ() > 0.f)
+            {
+                core::vector3df direction = light.direction_;
+                direction.Normalize();
+
+                const f32 angle = light.outer_cone_ * core::DEGTORAD;
+                const f32 cos_angle = cosf(angle);
+                if (angle > core::PI / 4.f)
+                {
+                    position = position + direction * (range * cos_angle);
+                    radius = range * sinf(angle);
+                }
+                else
+                {
+                    radius = range / (2.f * cos_angle);
+                    position = position + direction * radius;
+                }
+            }
+
+            for (u32 i = 0; i < 3; ++i)
+            {
+                center[i] = position.x_ * view(0, i) + position.y_ * view(1, i) + position.z_ * view(2, i) + view(3, i);
+            }
+
+            return center[2] + radius >= near_ && center[2] - radius <= far_;
+        }
+
+        void CLightClusterGrid::AddLight(u32 idx, const f32* center, f32 radius)
+        {
+            const f32 near_depth = core::max_(center[2] - radius, near_);
+            const f32 far_depth = core::min_(center[2] + radius, far_);
+            const s32 first_slice = GetSlice(near_depth);
+            const s32 last_slice = GetSlice(far_depth);
+
+            // the extremes of a projected box are at its corners
+            s32 first_tile[2];
+            s32 last_tile[2];
+            const s32 tiles[2] = { TILES_X, TILES_Y };
+            for (u32 axis = 0; axis < 2; ++axis)
+            {
+                f32 min_ndc = ProjectAxis(projection_, axis, center[axis] - radius, near_depth);
+                f32 max_ndc = min_ndc;
+                for (u32 i = 1; i < 4; ++i)
+                {
+                    const f32 ndc = ProjectAxis(projection_, axis, center[axis] + ((i & 1) ? radius : -radius),
+                        (i >> 1) ? far_depth : near_depth);
+                    min_ndc = core::min_(min_ndc, ndc);
+                    max_ndc = core::max_(max_ndc, ndc);
+                }
+
+                if (max_ndc < -1.f || min_ndc > 1.f)
+                {
+                    return;
+                }
+                first_tile[axis] = GetTile(min_ndc, tiles[axis]);
+                last_tile[axis] = GetTile(max_ndc, tiles[axis]);
+            }
+
+            const f32 radius_sq = radius * radius;
+            for (s32 slice = first_slice; slice <= last_slice; ++slice)
+            {
+                // distance of the sphere center to the cluster box, axis by axis
+                f32 dz = 0.f;
+                if (center[2] < slice_depth_[slice])
+                {
+                    dz = slice_depth_[slice] - center[2];
+                }
+                else if (center[2] > slice_depth_[slice + 1])
+                {
+                    dz = center[2] - slice_depth_[slice + 1];
+                }
+
+                for (s32 y = first_tile[1]; y <= last_tile[1]; ++y)
+                {
+                    f32 dy = 0.f;
+                    if (center[1] < tile_min_y_[slice][y])
+                    {
+                        dy = tile_min_y_[slice][y] - center[1];
+                    }
+                    else if (center[1] > tile_max_y_[slice][y])
+                    {
+                        dy = center[1] - tile_max_y_[slice][y];
+                    }
+
+                    const f32 rest_sq = radius_sq - dz * dz - dy * dy;
+                    if (rest_sq < 0.f)
+                    {
+                        continue;
+                    }
+
+                    const u32 row = (slice * TILES_Y + y) * TILES_X;
+#ifdef _KONG_COMPILE_WITH_SSE2_
+                    // four tiles per step, TILES_X is a multiple of four
+                    const __m128 zero = _mm_setzero_ps();
+                    const __m128 cx = _mm_set1_ps(center[0]);
+                    const __m128 rest = _mm_set1_ps(rest_sq);
+                    const __m128 lane = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+                    const __m128 first_x = _mm_set1_ps(static_cast<f32>(first_tile[0]));
+                    const __m128 last_x = _mm_set1_ps(static_cast<f32>(last_tile[0]));
+                    for (s32 x = first_tile[0] & ~3; x <= last_tile[0]; x += 4)
+                    {
+                        const __m128 min_x = _mm_loadu_ps(&tile_min_x_[slice][x]);
+                        const __m128 max_x = _mm_loadu_ps(&tile_max_x_[slice][x]);
+                        const __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(min_x, cx), zero), _mm_max_ps(_mm_sub_ps(cx, max_x), zero));
+                        const __m128 tile = _mm_add_ps(_mm_set1_ps(static_cast<f32>(x)), lane);
+                        __m128 hit = _mm_cmple_ps(_mm_mul_ps(dx, dx), rest);
+                        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(tile, first_x), _mm_cmple_ps(tile, last_x)));
+
+                        s32 mask = _mm_movemask_ps(hit);
+                        for (u32 i = 0; mask != 0; ++i, mask >>= 1)
+                        {
+                            if (mask & 1)
+                            {
+                                hit_clusters_.PushBack(row + x + i);
+                                hit_lights_.PushBack(idx);
+                            }
+                        }
+                    }
+#else
+                    for (s32 x = first_tile[0]; x <= last_tile[0]; ++x)
+                    {
+                        f32 dx = 0.f;
+                        if (center[0] < tile_min_x_[slice][x])
+                        {
+                            dx = tile_min_x_[slice][x] - center[0];
+                        }
+                        else if (center[0] > tile_max_x_[slice][x])
+                        {
+                            dx = center[0] - tile_max_x_[slice][x];
+                        }
+
+                        if (dx * dx <= rest_sq)
+                        {
+                            hit_clusters_.PushBack(row + x);
+                            hit_lights_.PushBack(idx);
+                        }
+                    }
+#endif
+                }
+            }
+        }
+
+        s32 CLightClusterGrid::GetSlice(f32 depth) const
+        {
+            if (depth <= near_)
+            {
+                return 0;
+            }
+
+            return core::clamp(static_cast<s32>(floorf(logf(depth) * slice_scale_ + slice_bias_)), 0, SLICES - 1);
+        }
+
+        s32 CLightClusterGrid::GetTile(f32 ndc, s32 tiles)
+        {
+            return core::clamp(static_cast<s32>(floorf((ndc * 0.5f + 0.5f) * tiles)), 0, tiles - 1);
+        }
+    } // end namespace video
+} // end namespace kong
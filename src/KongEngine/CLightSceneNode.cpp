@@ -12,7 +12,8 @@ namespace kong
     {
         CLightSceneNode::CLightSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
             const core::vector3df& position, video::SColorf& color, f32 radius, s32 main_light_index)
-            : ILightSceneNode(parent, mgr, id, position), driver_light_index_(-1), light_is_on_(true), main_light_index_(main_light_index), camera_(nullptr)
+            : ILightSceneNode(parent, mgr, id, position), driver_light_index_(-1), light_is_on_(true), main_light_index_(main_light_index), camera_(nullptr),
+            shadow_height_(0.f), shadow_depth_(0.f)
         {
             light_data_.diffuse_color_ = color;
             // set some useful specular color
@@ -183,9 +184,9 @@ namespace kong
                     CalculateLightBoundingBox(light_box, solid_nodes[i].node_->GetTransformedBoundingBox());
                 }
                 core::vector3df box_center = light_box.getCenter();
-                f32 height = core::max_(light_box.MaxEdge.x_ - light_box.MinEdge.x_, light_box.MaxEdge.y_ - light_box.MinEdge.y_);
-                f32 depth = light_box.MaxEdge.z_ - light_box.MinEdge.z_;
-                dynamic_cast<COrthogonalCameraSceneNode *>(camera_)->SetValues(height, 1.f, 1.f, 1.f + depth);
+                shadow_height_ = core::max_(light_box.MaxEdge.x_ - light_box.MinEdge.x_, light_box.MaxEdge.y_ - light_box.MinEdge.y_);
+                shadow_depth_ = light_box.MaxEdge.z_ - light_box.MinEdge.z_;
+                dynamic_cast<COrthogonalCameraSceneNode *>(camera_)->SetValues(shadow_height_, 1.f, 1.f, 1.f + shadow_depth_);
                 core::vector3df new_eye = camera_->eye_ + camera_->right_ * box_center.x_ + camera_->up_ * box_center.y_
                     + camera_->to_ * (light_box.MinEdge.z_ - 1);
                 camera_->SetEye(new_eye);
@@ -197,6 +198,170 @@ namespace kong
             }
         }
 
+        void CLightSceneNode::FitShadowCasters(const core::Array<ISceneNode*>& casters)
+        {
+            if (camera_->GetCameraType() != ECT_ORTHOGONAL || casters.Empty())
+            {
+                return;
+            }
+
+            core::aabbox3df caster_box(core::vector3df(1e6, 1e6, 1e6));
+            for (u32 i = 0; i < casters.Size(); ++i)
+            {
+                CalculateLightBoundingBox(caster_box, casters.ConstPointer()[i]->GetTransformedBoundingBox());
+            }
+
+            // the receivers start at the near plane, casters in front of it move the eye back
+            const f32 shift = camera_->GetZn() - caster_box.MinEdge.z_;
+            if (shift <= 0.f)
+            {
+                return;
+            }
+
+            shadow_depth_ += shift;
+            dynamic_cast<COrthogonalCameraSceneNode *>(camera_)->SetValues(shadow_height_, 1.f, 1.f, 1.f + shadow_depth_);
+            const core::vector3df new_eye = camera_->eye_ - camera_->to_ * shift;
+            camera_->SetEye(new_eye);
+            camera_->LookAt(new_eye + camera_->to_);
+        }
+
+        bool CLightSceneNode::FitShadowCascade(const core::vector3df* corners, const core::Array<DefaultNodeEntry>& receivers, u32 resolution)
+        {
+            if (camera_->GetCameraType() != ECT_ORTHOGONAL || resolution == 0)
+            {
+                return false;
+            }
+
+            core::vector3df center(0.f, 0.f, 0.f);
+            for (u32 i = 0; i < 8; ++i)
+            {
+                center += corners[i];
+            }
+            center = center / 8.f;
+
+            f32 radius = 0.f;
+            for (u32 i = 0; i < 8; ++i)
+            {
+                radius = core::max_(radius, corners[i].GetDistanceFrom(center));
+            }
+
+            // the sphere keeps its size while the view turns, rounding up hides the float noise of the corners
+            radius = ceilf(radius * 16.f) / 16.f;
+            const f32 extent = radius * 2.f;
+            const f32 texel = extent / resolution;
+
+            // the axes are taken from the light direction, the axes of the camera pick up
+            // rounding errors whenever it moves, which would turn the texel grid
+            core::vector3df to = light_data_.direction_;
+            to.Normalize();
+            core::vector3df up = to + core::vector3df(0.f, 1.f, 0.f);
+            core::vector3df right;
+            right.CrossProduct(up, to);
+            right.Normalize();
+            up.CrossProduct(to, right);
+            camera_->SetUp(up);
+
+            // light space is measured from the world origin, so its texel grid is fixed in the world
+            camera_->UpdateViewTransform();
+            const core::vector3df eye_offset(camera_->eye_.DotProduct(camera_->right_),
+                camera_->eye_.DotProduct(camera_->up_), camera_->eye_.DotProduct(camera_->to_));
+
+            // snapping to the grid moves the shadow map by whole texels
+            const f32 x = floorf(center.DotProduct(right) / texel + 0.5f) * texel;
+            const f32 y = floorf(center.DotProduct(up) / texel + 0.5f) * texel;
+            const f32 z = center.DotProduct(to);
+            const core::aabbox3df cascade_box(x - radius, y - radius, z - radius, x + radius, y + radius, z + radius);
+
+            core::aabbox3df receiver_box(core::vector3df(1e6, 1e6, 1e6));
+            bool found = false;
+            for (u32 i = 0; i < receivers.Size(); ++i)
+            {
+                // the box is relative to the eye of the camera
+                core::aabbox3df node_box(core::vector3df(1e6, 1e6, 1e6));
+                CalculateLightBoundingBox(node_box, receivers.ConstPointer()[i].node_->GetTransformedBoundingBox());
+                node_box.MinEdge += eye_offset;
+                node_box.MaxEdge += eye_offset;
+                if (node_box.intersectsWithBox(cascade_box))
+                {
+                    receiver_box.addInternalBox(node_box);
+                    found = true;
+                }
+            }
+
+            if (!found)
+            {
+                return false;
+            }
+
+            const f32 min_z = core::max_(receiver_box.MinEdge.z_, cascade_box.MinEdge.z_);
+            const f32 max_z = core::min_(receiver_box.MaxEdge.z_, cascade_box.MaxEdge.z_);
+            shadow_height_ = extent;
+            shadow_depth_ = max_z - min_z;
+            dynamic_cast<COrthogonalCameraSceneNode *>(camera_)->SetValues(shadow_height_, 1.f, 1.f, 1.f + shadow_depth_);
+            const core::vector3df new_eye = right * x + up * y + to * (min_z - 1.f);
+            camera_->SetEye(new_eye);
+            camera_->LookAt(new_eye + to);
+            return true;
+        }
+
+        bool CLightSceneNode::FitShadowView(u32 view)
+        {
+            if (camera_->GetCameraType() != ECT_PERSPECTIVE)
+            {
+                return false;
+            }
+
+            core::vector3df to;
+            core::vector3df up(0.f, 1.f, 0.f);
+            f32 fov;
+            if (light_data_.type_ == video::ELT_POINT)
+            {
+                if (view >= 6)
+                {
+                    return false;
+                }
+
+                // the faces of a cube around the light
+                static const f32 axes[6][3] = { { 1.f, 0.f, 0.f }, { -1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f },
+                    { 0.f, -1.f, 0.f }, { 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f } };
+                to = core::vector3df(axes[view][0], axes[view][1], axes[view][2]);
+                if (view == 2 || view == 3)
+                {
+                    up = core::vector3df(0.f, 0.f, 1.f);
+                }
+                fov = 90.f;
+            }
+            else
+            {
+                if (view > 0)
+                {
+                    return false;
+                }
+
+                to = light_data_.direction_;
+                to.Normalize();
+                if (fabsf(to.y_) > 0.99f)
+                {
+                    up = core::vector3df(0.f, 0.f, 1.f);
+                }
+                fov = core::min_(light_data_.outer_cone_ * 2.f, 170.f);
+            }
+
+            // a near plane close to the light wastes the depth precision
+            const f32 zf = light_data_.radius_;
+            const f32 zn = core::max_(zf * 0.01f, 0.05f);
+            dynamic_cast<CPerspectiveCameraSceneNode *>(camera_)->SetValues(fov, 1.f, zn, zf);
+            camera_->SetEye(light_data_.position_);
+            camera_->SetUp(up);
+            camera_->LookAt(light_data_.position_ + to);
+            return true;
+        }
+
+        ICameraSceneNode* CLightSceneNode::GetShadowCamera() const
+        {
+            return camera_;
+        }
+
         s32 CLightSceneNode::GetLightIndex() const
         {
             return main_light_index_;
@@ -252,6 +417,8 @@ namespace kong
         {
             if (delete_camera)
             {
+                // the camera is a child of the light
+                camera_->Remove();
                 delete camera_;
             }
             if (light_data_.type_ == video::ELT_DIRECTIONAL)
@@ -71,15 +71,18 @@ namespace kong
         {
             SMeshBuffer* newm = new SMeshBuffer();
             newm->material_ = oldmb->GetMaterial();
-            u16* indices = new u16[arr.Size() * 3];
+            newm->Append(oldmb->GetVertices(), oldmb->GetVertexCount(), nullptr, 0);
+
+            // keeps the index type of the source buffer, large buffers need 32 bit indices
+            newm->SetIndexType(oldmb->GetIndexType());
+            newm->ReallocateIndices(arr.Size() * 3);
             for (u32 x = 0; x < arr.Size(); x++)
             {
                 for (u32 y = 0; y < 3; y++) 
                 {
-                    indices[x * 3 + y] = arr[x]->vertex[y]->id;
+                    newm->PushBackIndex(arr[x]->vertex[y]->id);
                 }
             }
-            newm->Append(oldmb->GetVertices(), oldmb->GetVertexCount(), indices, arr.Size() * 3);
             return newm;
         }
 
@@ -98,9 +101,15 @@ namespace kong
             lod_mesh_ = new IMesh*[numOfLevels];
             lod_on_ = true;
 
+            // the welded copy belongs to this node, a shared mesh is grabbed
             if (combineDuplicateVertices)
             {
                 default_mesh_ = scene_manager_->GetMeshManipulator()->createMeshWelded(default_mesh_);
+                current_mesh_ = default_mesh_;
+            }
+            else
+            {
+                default_mesh_->Grab();
             }
 
 
@@ -119,12 +128,12 @@ namespace kong
 
             for (u32 x = 0; x < default_mesh_->GetMeshBufferCount(); x++)
             {
-                u16* indices = default_mesh_->GetMeshBuffer(x)->GetIndices();
+                const IMeshBuffer* buffer = default_mesh_->GetMeshBuffer(x);
 
-                for (u32 y = 0; y < default_mesh_->GetMeshBuffer(x)->GetIndexCount(); y += 3)
+                for (u32 y = 0; y < buffer->GetIndexCount(); y += 3)
                 {
-                    Triangle* tri = new Triangle(verts_[x][indices[y]], verts_[x][indices[y + 1]],
-                                                 verts_[x][indices[y + 2]]);
+                    Triangle* tri = new Triangle(verts_[x][buffer->GetIndex(y)], verts_[x][buffer->GetIndex(y + 1)],
+                                                 verts_[x][buffer->GetIndex(y + 2)]);
 
                     triangles_[x].PushBack(tri);
                 }
@@ -174,13 +183,14 @@ namespace kong
 
         CLodSceneNode::~CLodSceneNode()
         {
-            for (u32 i = 0; i < level_count_; i++)
+            // level 0 is the default mesh, which is dropped below
+            for (u32 i = 1; i < level_count_; i++)
             {
                 delete lod_mesh_[i];
             }
             delete[] lod_mesh_;
 
-            delete default_mesh_;
+            default_mesh_->Drop();
 
             for (u32 i = 0; i < 8; i++)
             {
@@ -251,5 +261,10 @@ namespace kong
         {
             return lod_on_;
         }
+
+        u32 CLodSceneNode::GetGeometryChangedID()
+        {
+            return lod_on_ ? current_level_ + 1u : 0u;
+        }
     }
 }
\ No newline at end of file
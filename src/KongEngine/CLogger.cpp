@@ -33,6 +33,7 @@ namespace kong
         if (ll < LogLevel)
             return;
 
+        std::lock_guard<std::mutex> lock(Mutex);
         if (Receiver)
         {
             SEvent event;
@@ -94,6 +95,7 @@ namespace kong
     //! Sets a new event receiver
     void CLogger::setReceiver(IEventReceiver* r)
     {
+        std::lock_guard<std::mutex> lock(Mutex);
         Receiver = r;
     }
 
@@ -0,0 +1,197 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CMappedReadFile.h"
+#include <cstring>
+
+#ifdef _KONG_COMPILE_WITH_MAPPED_FILES_
+#ifdef _KONG_WINDOWS_API_
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif
+
+namespace kong
+{
+    namespace io
+    {
+        CMappedReadFile::CMappedReadFile(const io::SPath &filename)
+            : data_(nullptr), file_size_(-1), pos_(0), filename_(filename)
+#ifdef _KONG_WINDOWS_API_
+            , file_handle_(nullptr), mapping_handle_(nullptr)
+#endif
+        {
+            MapFile();
+        }
+
+        CMappedReadFile::~CMappedReadFile()
+        {
+#ifdef _KONG_COMPILE_WITH_MAPPED_FILES_
+#ifdef _KONG_WINDOWS_API_
+            if (data_ != nullptr)
+            {
+                UnmapViewOfFile(data_);
+            }
+            if (mapping_handle_ != nullptr)
+            {
+                CloseHandle(mapping_handle_);
+            }
+            if (file_handle_ != nullptr)
+            {
+                CloseHandle(file_handle_);
+            }
+#else
+            if (data_ != nullptr)
+            {
+                munmap(const_cast<c8*>(data_), file_size_);
+            }
+#endif
+#endif
+        }
+
+        s32 CMappedReadFile::Read(void* buffer, u32 size_to_read)
+        {
+            if (!IsOpen())
+            {
+                return 0;
+            }
+
+            if (static_cast<long>(size_to_read) > file_size_ - pos_)
+            {
+                size_to_read = static_cast<u32>(file_size_ - pos_);
+            }
+
+            memcpy(buffer, data_ + pos_, size_to_read);
+            pos_ += size_to_read;
+            return static_cast<s32>(size_to_read);
+        }
+
+        bool CMappedReadFile::Seek(long finalPos, bool relative_movement)
+        {
+            if (!IsOpen())
+            {
+                return false;
+            }
+
+            if (relative_movement)
+            {
+                finalPos += pos_;
+            }
+
+            if (finalPos < 0 || finalPos > file_size_)
+            {
+                return false;
+            }
+
+            pos_ = finalPos;
+            return true;
+        }
+
+        long CMappedReadFile::GetSize() const
+        {
+            return file_size_;
+        }
+
+        bool CMappedReadFile::IsOpen() const
+        {
+            return data_ != nullptr;
+        }
+
+        long CMappedReadFile::GetPos() const
+        {
+            return pos_;
+        }
+
+        const SPath& CMappedReadFile::GetFileName() const
+        {
+            return filename_;
+        }
+
+        const void* CMappedReadFile::GetMappedData() const
+        {
+            return data_;
+        }
+
+        void CMappedReadFile::MapFile()
+        {
+            if (filename_.empty())
+            {
+                return;
+            }
+
+#ifdef _KONG_COMPILE_WITH_MAPPED_FILES_
+#ifdef _KONG_WINDOWS_API_
+#if defined ( _KONG_WCHAR_FILESYSTEM )
+            HANDLE file = CreateFileW(filename_.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+#else
+            HANDLE file = CreateFileA(filename_.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+#endif
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return;
+            }
+            file_handle_ = file;
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || size.QuadPart > 0x7FFFFFFF)
+            {
+                return;
+            }
+
+            mapping_handle_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_handle_ == nullptr)
+            {
+                return;
+            }
+
+            data_ = static_cast<const c8*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+            if (data_ != nullptr)
+            {
+                file_size_ = static_cast<long>(size.QuadPart);
+            }
+#else
+            const int file = open(filename_.c_str(), O_RDONLY);
+            if (file < 0)
+            {
+                return;
+            }
+
+            struct stat info;
+            if (fstat(file, &info) == 0 && info.st_size > 0 && info.st_size <= 0x7FFFFFFF)
+            {
+                void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+                if (data != MAP_FAILED)
+                {
+                    // the parsers walk through the file front to back
+                    madvise(data, info.st_size, MADV_SEQUENTIAL);
+                    data_ = static_cast<const c8*>(data);
+                    file_size_ = static_cast<long>(info.st_size);
+                }
+            }
+
+            // the mapping keeps the file alive
+            close(file);
+#endif
+#endif
+        }
+
+        IReadFile* CreateMappedReadFile(const io::SPath& filename)
+        {
+            CMappedReadFile* file = new CMappedReadFile(filename);
+            if (file->IsOpen())
+            {
+                return file;
+            }
+
+            // empty files and platforms without mappings use fread
+            delete file;
+            return CreateReadFile(filename);
+        }
+
+    } // end namespace io
+} // end namespace kong
@@ -0,0 +1,195 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CMeshCache.h"
+#include "IAnimatedMesh.h"
+#include "IMeshBuffer.h"
+#include "IVideoDriver.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        static const io::path EMPTY_MESH_NAME;
+
+        CMeshCache::CMeshCache(video::IVideoDriver* driver)
+            : driver_(driver)
+        {
+        }
+
+        CMeshCache::~CMeshCache()
+        {
+            Clear();
+        }
+
+        void CMeshCache::AddMesh(const io::path& name, IAnimatedMesh* mesh)
+        {
+            if (mesh == nullptr)
+            {
+                return;
+            }
+
+            mesh->Grab();
+
+            // keep the entries sorted for the binary search
+            u32 position = 0;
+            while (position < meshes_.Size() && meshes_.ConstPointer()[position].name_ < name)
+            {
+                ++position;
+            }
+
+            SMeshEntry entry;
+            entry.name_ = name;
+            entry.mesh_ = mesh;
+            meshes_.Insert(entry, position);
+        }
+
+        void CMeshCache::RemoveMesh(const IMesh* mesh)
+        {
+            if (mesh == nullptr)
+            {
+                return;
+            }
+
+            for (u32 i = 0; i < meshes_.Size(); ++i)
+            {
+                IAnimatedMesh* cached = meshes_.ConstPointer()[i].mesh_;
+                if (cached == mesh || (cached->getFrameCount() != 0 && cached->getMesh(0) == mesh))
+                {
+                    meshes_.Erase(i);
+                    DropMesh(cached);
+                    return;
+                }
+            }
+        }
+
+        u32 CMeshCache::GetMeshCount() const
+        {
+            return meshes_.Size();
+        }
+
+        IAnimatedMesh* CMeshCache::GetMeshByIndex(u32 index)
+        {
+            if (index >= meshes_.Size())
+            {
+                return nullptr;
+            }
+
+            return meshes_.ConstPointer()[index].mesh_;
+        }
+
+        IAnimatedMesh* CMeshCache::GetMeshByName(const io::path& name)
+        {
+            const s32 index = FindMesh(name);
+            return index != -1 ? meshes_.ConstPointer()[index].mesh_ : nullptr;
+        }
+
+        const io::path& CMeshCache::GetMeshName(const IMesh* mesh) const
+        {
+            if (mesh == nullptr)
+            {
+                return EMPTY_MESH_NAME;
+            }
+
+            for (u32 i = 0; i < meshes_.Size(); ++i)
+            {
+                const SMeshEntry& entry = meshes_.ConstPointer()[i];
+                if (entry.mesh_ == mesh || (entry.mesh_->getFrameCount() != 0 && entry.mesh_->getMesh(0) == mesh))
+                {
+                    return entry.name_;
+                }
+            }
+
+            return EMPTY_MESH_NAME;
+        }
+
+        bool CMeshCache::IsMeshLoaded(const io::path& name)
+        {
+            return FindMesh(name) != -1;
+        }
+
+        void CMeshCache::Clear()
+        {
+            for (u32 i = 0; i < meshes_.Size(); ++i)
+            {
+                DropMesh(meshes_.ConstPointer()[i].mesh_);
+            }
+            meshes_.Clear();
+        }
+
+        void CMeshCache::ClearUnusedMeshes()
+        {
+            // the entries which stay keep their order
+            u32 kept = 0;
+            for (u32 i = 0; i < meshes_.Size(); ++i)
+            {
+                SMeshEntry& entry = meshes_.Pointer()[i];
+                if (IsMeshUnused(entry.mesh_))
+                {
+                    DropMesh(entry.mesh_);
+                }
+                else
+                {
+                    meshes_.Pointer()[kept++] = entry;
+                }
+            }
+
+            while (meshes_.Size() > kept)
+            {
+                meshes_.Erase(meshes_.Size() - 1);
+            }
+        }
+
+        s32 CMeshCache::FindMesh(const io::path& name) const
+        {
+            SMeshEntry key;
+            key.name_ = name;
+            key.mesh_ = nullptr;
+            return meshes_.BinarySearch(key, 0, static_cast<s32>(meshes_.Size()) - 1);
+        }
+
+        bool CMeshCache::IsMeshUnused(IAnimatedMesh* mesh)
+        {
+            if (mesh->GetReferenceCount() != 1)
+            {
+                return false;
+            }
+
+            // scene nodes grab the frames they draw, not the animated mesh
+            for (u32 f = 0; f < mesh->getFrameCount(); ++f)
+            {
+                const IMesh* frame = mesh->getMesh(f);
+                if (frame != nullptr && frame != mesh && frame->GetReferenceCount() != 1)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void CMeshCache::DropMesh(IAnimatedMesh* mesh) const
+        {
+            // a node still holding a frame frees its buffers when it drops the frame
+            if (driver_ != nullptr && IsMeshUnused(mesh))
+            {
+                for (u32 f = 0; f < mesh->getFrameCount(); ++f)
+                {
+                    IMesh* frame = mesh->getMesh(f);
+                    if (frame == nullptr)
+                    {
+                        continue;
+                    }
+
+                    for (u32 i = 0; i < frame->GetMeshBufferCount(); ++i)
+                    {
+                        driver_->RemoveHardwareBuffer(frame->GetMeshBuffer(i));
+                    }
+                }
+            }
+
+            mesh->Drop();
+        }
+
+    } // end namespace scene
+} // end namespace kong
@@ -2,6 +2,7 @@
 #include "IVideoDriver.h"
 #include "ISceneManager.h"
 #include "IMeshBuffer.h"
+#include "CRenderQueue.h"
 
 namespace kong
 {
@@ -11,17 +12,23 @@ namespace kong
             const core::vector3df& position, const core::vector3df& rotation, const core::vector3df& scale):
             IMeshSceneNode(parent, mgr, id, position, rotation, scale), mesh_(mesh)
         {
+            if (mesh_ != nullptr)
+            {
+                mesh_->Grab();
+            }
         }
 
         CMeshSceneNode::~CMeshSceneNode()
         {
-            delete mesh_;
+            DropMesh(mesh_);
         }
 
         void CMeshSceneNode::SetMesh(IMesh* mesh)
         {
             if (mesh != nullptr)
             {
+                mesh->Grab();
+                DropMesh(mesh_);
                 mesh_ = mesh;
                 CopyMaterials();
             }
@@ -104,6 +111,22 @@ namespace kong
 #endif
         }
 
+        bool CMeshSceneNode::SubmitRenderItems(CRenderQueue& queue)
+        {
+            // the bounding box is drawn by Render()
+            if (mesh_ == nullptr || draw_bounding_box_)
+            {
+                return false;
+            }
+
+            for (u32 i = 0; i < mesh_->GetMeshBufferCount(); i++)
+            {
+                IMeshBuffer *mesh_buffer = mesh_->GetMeshBuffer(i);
+                queue.Add(mesh_buffer, mesh_buffer->GetMaterial(), absolute_tranform_, rendering_mode_);
+            }
+            return true;
+        }
+
         const core::aabbox3d<f32>& CMeshSceneNode::GetBoundingBox() const
         {
             return mesh_ != nullptr ? mesh_->GetBoundingBox() : box_;
@@ -0,0 +1,123 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CNormalMapGenerator.h"
+#include "Vector.h"
+#include <cstring>
+
+namespace kong
+{
+    namespace video
+    {
+        //! normal map lookup 32 bit version
+        static inline f32 nml32(int x, int y, int pitch, int height, const s32 *p)
+        {
+            if (x < 0)
+                x = pitch - 1;
+            if (x >= pitch)
+                x = 0;
+            if (y < 0)
+                y = height - 1;
+            if (y >= height)
+                y = 0;
+            return (f32)(((p[(y * pitch) + x]) >> 16) & 0xff);
+        }
+
+        //! normal map lookup 16 bit version
+        static inline f32 nml16(int x, int y, int pitch, int height, const s16 *p)
+        {
+            if (x < 0)
+                x = pitch - 1;
+            if (x >= pitch)
+                x = 0;
+            if (y < 0)
+                y = height - 1;
+            if (y >= height)
+                y = 0;
+
+            return (f32)getAverage(p[(y * pitch) + x]);
+        }
+
+        //! returns the normal of the surface at a texel, scaled to 0..255
+        template <class T, class Lookup>
+        static core::vector3df GetNormal(s32 x, s32 y, s32 pitch, s32 height, const T* in, f32 amplitude,
+            f32 hh, f32 vh, s32 v_sign, Lookup lookup)
+        {
+            core::vector3df h1((x - 1)*hh, lookup(x - 1, y, pitch, height, in)*amplitude, y*vh);
+            core::vector3df h2((x + 1)*hh, lookup(x + 1, y, pitch, height, in)*amplitude, y*vh);
+            core::vector3df v1(x*hh, lookup(x, y - v_sign, pitch, height, in)*amplitude, (y - 1)*vh);
+            core::vector3df v2(x*hh, lookup(x, y + v_sign, pitch, height, in)*amplitude, (y + 1)*vh);
+
+            core::vector3df v = v1 - v2;
+            core::vector3df h = h1 - h2;
+
+            core::vector3df n = v.CrossProduct(h);
+            n.Normalize();
+            n *= 0.5f;
+            n += core::vector3df(0.5f, 0.5f, 0.5f); // now between 0 and 1
+            n *= 255.0f;
+            return n;
+        }
+
+        bool CNormalMapGenerator::IsFormatSupported(ECOLOR_FORMAT format)
+        {
+            return format == ECF_A8R8G8B8 || format == ECF_A1R5G5B5;
+        }
+
+        bool CNormalMapGenerator::Make(void* data, ECOLOR_FORMAT format, const core::Dimension2d<u32>& size, u32 pitch, f32 amplitude)
+        {
+            if (data == nullptr || !IsFormatSupported(format))
+            {
+                return false;
+            }
+
+            amplitude = amplitude / 255.0f;
+            const f32 vh = size.height_ / (f32)size.width_;
+            const f32 hh = size.height_ / (f32)size.height_;
+            const s32 height = size.height_;
+
+            if (format == ECF_A8R8G8B8)
+            {
+                s32 *p = static_cast<s32*>(data);
+                const s32 texel_pitch = pitch / 4;
+
+                // the normals are computed from the unchanged heights
+                s32 *in = new s32[height * texel_pitch];
+                memcpy(in, p, height * texel_pitch * 4);
+
+                for (s32 x = 0; x < texel_pitch; ++x)
+                    for (s32 y = 0; y < height; ++y)
+                    {
+                        // the 32 bit version takes the vertical slope from the opposite neighbours
+                        const core::vector3df n = GetNormal(x, y, texel_pitch, height, in, amplitude, hh, vh, -1, nml32);
+                        const s32 texel_height = (s32)nml32(x, y, texel_pitch, height, in);
+                        p[y*texel_pitch + x] = video::SColor(
+                            texel_height, // store height in alpha
+                            (s32)n.x_, (s32)n.z_, (s32)n.y_).color_;
+                    }
+
+                delete[] in;
+            }
+            else
+            {
+                s16 *p = static_cast<s16*>(data);
+                const s32 texel_pitch = pitch / 2;
+
+                s16 *in = new s16[height * texel_pitch];
+                memcpy(in, p, height * texel_pitch * 2);
+
+                for (s32 x = 0; x < texel_pitch; ++x)
+                    for (s32 y = 0; y < height; ++y)
+                    {
+                        const core::vector3df n = GetNormal(x, y, texel_pitch, height, in, amplitude, hh, vh, 1, nml16);
+                        p[y*texel_pitch + x] = video::RGBA16((u32)n.x_, (u32)n.z_, (u32)n.y_);
+                    }
+
+                delete[] in;
+            }
+
+            return true;
+        }
+
+    } // end namespace video
+} // end namespace kong
@@ -0,0 +1,607 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CNullDriver.h"
+
+#include "IMeshBuffer.h"
+#include "CImage.h"
+#include "CNormalMapGenerator.h"
+#include "IReadFile.h"
+#include "CMeshManipulator.h"
+#include "os.h"
+
+namespace kong
+{
+    namespace video
+    {
+        //! creates a loader which is able to load png images
+        IImageLoader* CreateImageLoaderPng();
+
+        //! creates a loader which is able to load jpeg images
+        IImageLoader* CreateImageLoaderJpg();
+
+        //! creates a loader which is able to load tga images
+        IImageLoader* CreateImageLoaderTGA();
+
+        //! creates a loader which is able to load dds images
+        IImageLoader* CreateImageLoaderDDS();
+
+        CNullDriver::CNullDriver(io::IFileSystem* io, const core::Dimension2d<u32>& screen_size)
+            : io_(io), screen_size_(screen_size), rendering_mode_(ERM_MESH), shadow_enable_(false), shadow_texture_size_(2048, 2048), shadow_atlas_size_(4096),
+              view_port_(0, 0, screen_size.width_, screen_size.height_)
+        {
+            // create manipulator
+            mesh_manipulator_ = new scene::CMeshManipulator();
+
+#ifdef _KONG_COMPILE_WITH_JPG_LOADER_
+            surface_loader_.PushBack(video::CreateImageLoaderJpg());
+#endif
+#ifdef _KONG_COMPILE_WITH_PNG_LOADER_
+            surface_loader_.PushBack(video::CreateImageLoaderPng());
+#endif
+#ifdef _KONG_COMPILE_WITH_TGA_LOADER_
+            surface_loader_.PushBack(video::CreateImageLoaderTGA());
+#endif
+#ifdef _KONG_COMPILE_WITH_DDS_LOADER_
+            surface_loader_.PushBack(video::CreateImageLoaderDDS());
+#endif
+        }
+
+        CNullDriver::~CNullDriver()
+        {
+            for (u32 i = 0; i < textures_.Size(); ++i)
+            {
+                delete textures_[i].Surface;
+            }
+
+            for (u32 i = 0; i < surface_loader_.Size(); ++i)
+            {
+                delete surface_loader_[i];
+            }
+
+            delete mesh_manipulator_;
+        }
+
+        void CNullDriver::SetMaterial(const SMaterial& material)
+        {
+            material_ = material;
+        }
+
+        bool CNullDriver::BeginScene(bool back_buffer, bool z_buffer, SColor color)
+        {
+            return true;
+        }
+
+        bool CNullDriver::EndScene()
+        {
+            return true;
+        }
+
+        void CNullDriver::SetTransform(u32 state, const core::Matrixf& mat)
+        {
+            if (state < ETS_COUNT)
+            {
+                matrices_[state] = mat;
+            }
+        }
+
+        void CNullDriver::Draw3DLine(const core::Vector3Df& start, const core::Vector3Df& end, SColor color)
+        {
+        }
+
+        void CNullDriver::Draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+            const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect, SColor color, bool useAlphaChannelOfTexture)
+        {
+        }
+
+        void CNullDriver::Draw2DImage(const video::ITexture* texture, const core::position2d<f32>& destPos,
+            const core::rect<f32>& sourceRect, SColor color)
+        {
+        }
+
+        void CNullDriver::DrawMeshBuffer(const scene::IMeshBuffer* mesh_buffer)
+        {
+        }
+
+        void CNullDriver::DrawMeshBufferInstanced(const scene::IMeshBuffer* mesh_buffer, const core::Matrixf* transforms, u32 count)
+        {
+            for (u32 i = 0; i < count; ++i)
+            {
+                SetTransform(ETS_WORLD, transforms[i]);
+                DrawMeshBuffer(mesh_buffer);
+            }
+        }
+
+        void CNullDriver::RemoveHardwareBuffer(const scene::IMeshBuffer* mesh_buffer)
+        {
+        }
+
+        void CNullDriver::RemoveAllHardwareBuffers()
+        {
+        }
+
+        IImage* CNullDriver::CreateImage(ECOLOR_FORMAT format, const core::Dimension2d<u32>& size)
+        {
+            if (IImage::IsRenderTargetOnlyFormat(format))
+            {
+                //os::Printer::log("Could not create IImage, format only supported for render target textures.", ELL_WARNING);
+                return nullptr;
+            }
+
+            return new CImage(format, size);
+        }
+
+        IImage* CNullDriver::CreateImage(ECOLOR_FORMAT format, IImage* imageToCopy)
+        {
+            //os::Printer::log("Deprecated method, please create an empty image instead and use copyTo().", ELL_WARNING);
+            if (IImage::IsRenderTargetOnlyFormat(format))
+            {
+                //os::Printer::log("Could not create IImage, format only supported for render target textures.", ELL_WARNING);
+                return nullptr;
+            }
+
+            CImage* tmp = new CImage(format, imageToCopy->GetDimension());
+            imageToCopy->CopyTo(tmp);
+            return tmp;
+        }
+
+        //! Creates a software image from a file.
+        IImage* CNullDriver::CreateImageFromFile(const io::path& filename)
+        {
+            if (!filename.size())
+                return 0;
+
+            IImage* image = 0;
+            io::IReadFile* file = io_->CreateAndOpenFile(filename);
+
+            if (file)
+            {
+                image = CreateImageFromFile(file);
+                delete file;
+            }
+            else
+            {
+                //os::Printer::log("Could not open file of image", filename, ELL_WARNING);
+            }
+
+            return image;
+        }
+
+
+        //! Creates a software image from a file.
+        IImage* CNullDriver::CreateImageFromFile(io::IReadFile* file)
+        {
+            if (!file)
+                return 0;
+
+            IImage* image = 0;
+
+            s32 i;
+
+            // try to load file based on file extension
+            for (i = surface_loader_.Size() - 1; i >= 0; --i)
+            {
+                if (surface_loader_[i]->IsALoadableFileExtension(file->GetFileName()))
+                {
+                    // reset file position which might have changed due to previous loadImage calls
+                    file->Seek(0);
+                    image = surface_loader_[i]->LoadImage(file);
+                    if (image)
+                        return image;
+                }
+            }
+
+            // try to load file based on what is in it
+            for (i = surface_loader_.Size() - 1; i >= 0; --i)
+            {
+                // dito
+                file->Seek(0);
+                if (surface_loader_[i]->IsALoadableFileFormat(file))
+                {
+                    file->Seek(0);
+                    image = surface_loader_[i]->LoadImage(file);
+                    if (image)
+                        return image;
+                }
+            }
+
+            return nullptr; // failed to load
+        }
+
+
+        video::ITexture* CNullDriver::LoadTextureFromFile(io::IReadFile* file, const io::path& hashName)
+        {
+            ITexture* texture = 0;
+            IImage* image = CreateImageFromFile(file);
+
+            if (image)
+            {
+                // create texture from surface
+                texture = CreateDeviceDependentTexture(image, hashName.size() ? hashName : file->GetFileName());
+                //os::Printer::log("Loaded texture", file->getFileName());
+                //image->drop();
+                delete image;
+            }
+
+            return texture;
+        }
+
+
+        //! looks if the image is already loaded
+        video::ITexture* CNullDriver::FindTexture(const io::path& filename)
+        {
+            SSurface s;
+            SDummyTexture dummy(filename);
+            s.Surface = &dummy;
+
+            s32 index = textures_.BinarySearch(s);
+            if (index != -1)
+                return textures_[index].Surface;
+
+            return nullptr;
+        }
+
+        //! loads a Texture
+        ITexture* CNullDriver::GetTexture(const io::path& filename)
+        {
+            // Identify textures by their absolute filenames if possible.
+            const io::path absolutePath = io_->GetAbsolutePath(filename);
+
+            ITexture* texture = FindTexture(absolutePath);
+            if (texture)
+                return texture;
+
+            // Then try the raw filename, which might be in an Archive
+            texture = FindTexture(filename);
+            if (texture)
+                return texture;
+
+            // Now try to open the file using the complete path.
+            io::IReadFile* file = io_->CreateAndOpenFile(absolutePath);
+
+            if (!file)
+            {
+                // Try to open it using the raw filename.
+                file = io_->CreateAndOpenFile(filename);
+            }
+
+            if (file)
+            {
+                // Re-check name for actual archive names
+                texture = FindTexture(file->GetFileName());
+                if (texture)
+                {
+                    delete file;
+                    return texture;
+                }
+
+                texture = LoadTextureFromFile(file);
+                delete file;
+
+                if (texture)
+                {
+                    AddTexture(texture);
+                    //texture->drop(); // drop it because we created it, one grab too much
+                }
+                else
+                {
+                    //os::Printer::log("Could not load texture", filename, ELL_ERROR);
+                }
+                return texture;
+            }
+            else
+            {
+                //os::Printer::log("Could not open file of texture", filename, ELL_WARNING);
+                return nullptr;
+            }
+        }
+
+
+        //! loads a Texture
+        ITexture* CNullDriver::GetTexture(io::IReadFile* file)
+        {
+            ITexture* texture = 0;
+
+            if (file)
+            {
+                texture = FindTexture(file->GetFileName());
+
+                if (texture)
+                    return texture;
+
+                texture = LoadTextureFromFile(file);
+
+                if (texture)
+                {
+                    AddTexture(texture);
+                    //texture->drop(); // drop it because we created it, one grab too much
+                }
+
+                if (!texture)
+                {
+                    //os::Printer::log("Could not load texture", file->getFileName(), ELL_WARNING);
+                }
+            }
+
+            return texture;
+        }
+
+        //! there are no worker threads, so the texture is loaded at once
+        ITexture* CNullDriver::GetTextureAsync(const io::path& filename)
+        {
+            return GetTexture(filename);
+        }
+
+        u32 CNullDriver::GetPendingTextureCount() const
+        {
+            return 0;
+        }
+
+        void CNullDriver::SetTextureUploadBudget(u32 bytes)
+        {
+        }
+
+        void CNullDriver::SetTextureMemoryBudget(u32 bytes)
+        {
+        }
+
+        u32 CNullDriver::GetTextureMemorySize() const
+        {
+            return 0;
+        }
+
+        //! Creates a texture from a loaded IImage.
+        ITexture* CNullDriver::AddTexture(const io::path& name, IImage* image, void* mipmapData)
+        {
+            if (0 == name.size() || !image)
+                return nullptr;
+
+            ITexture* t = CreateDeviceDependentTexture(image, name, mipmapData);
+            if (t)
+            {
+                AddTexture(t);
+                //t->drop();
+            }
+            return t;
+        }
+
+
+        //! creates a Texture
+        ITexture* CNullDriver::AddTexture(const core::Dimension2d<u32>& size,
+            const io::path& name, ECOLOR_FORMAT format)
+        {
+            if (IImage::IsRenderTargetOnlyFormat(format))
+            {
+                //os::Printer::log("Could not create ITexture, format only supported for render target textures.", ELL_WARNING);
+                return 0;
+            }
+
+            if (name.size() == 0)
+            {
+                return nullptr;
+            }
+
+            IImage* image = new CImage(format, size);
+            ITexture* t = CreateDeviceDependentTexture(image, name);
+            //image->drop();
+            delete image;
+            AddTexture(t);
+
+            //if (t)
+            //    t->drop();
+
+            return t;
+        }
+
+        //! adds a surface, not loaded or created by the Irrlicht Engine
+        void CNullDriver::AddTexture(video::ITexture* texture)
+        {
+            if (texture)
+            {
+                SSurface s;
+                s.Surface = texture;
+                //texture->grab();
+
+                textures_.PushBack(s);
+
+                // the new texture is now at the end of the texture list. when searching for
+                // the next new texture, the texture array will be sorted and the index of this texture
+                // will be changed. to let the order be more consistent to the user, sort
+                // the textures now already although this isn't necessary:
+
+                textures_.Sort();
+            }
+        }
+
+
+        void CNullDriver::MakeNormalMapTexture(video::ITexture* texture, f32 amplitude) const
+        {
+            if (!texture)
+                return;
+
+            if (!CNormalMapGenerator::IsFormatSupported(texture->GetColorFormat()))
+            {
+                os::Printer::log("Error: Unsupported texture color format for making normal map.", ELL_ERROR);
+                return;
+            }
+
+            void *data = texture->Lock();
+            if (!data)
+            {
+                os::Printer::log("Could not lock texture for making normal map.", ELL_ERROR);
+                return;
+            }
+
+            CNormalMapGenerator::Make(data, texture->GetColorFormat(), texture->GetSize(), texture->GetPitch(), amplitude);
+            texture->Unlock();
+            texture->RegenerateMipMapLevels();
+        }
+
+
+        //! returns a device dependent texture from a software surface (IImage)
+        video::ITexture* CNullDriver::CreateDeviceDependentTexture(IImage* surface, const io::path& name, void* mipmapData)
+        {
+            return new SDummyTexture(name);
+        }
+
+        scene::IMeshManipulator* CNullDriver::GetMeshManipulator()
+        {
+            return mesh_manipulator_;
+        }
+
+        const core::Dimension2d<u32>& CNullDriver::GetScreenSize() const
+        {
+            return screen_size_;
+        }
+
+        const core::Dimension2d<u32>& CNullDriver::GetCurrentRenderTargetSize() const
+        {
+            return screen_size_;
+        }
+
+        void CNullDriver::DeleteAllDynamicLights()
+        {
+            lights_.Resize(0);
+        }
+
+        s32 CNullDriver::AddDynamicLight(const SLight& light)
+        {
+            lights_.PushBack(light);
+
+            return lights_.Size() - 1;
+        }
+
+        void CNullDriver::ActivateDynamicLights()
+        {
+        }
+
+        u32 CNullDriver::GetMaximalDynamicLightAmount() const
+        {
+            return 8;
+        }
+
+        u32 CNullDriver::GetDynamicLightCount() const
+        {
+            return lights_.Size();
+        }
+
+        const SLight& CNullDriver::GetDynamicLight(u32 idx) const
+        {
+            if (idx < lights_.Size())
+                return lights_[idx];
+            else
+                return *(static_cast<SLight*>(nullptr));
+        }
+
+        void CNullDriver::SetMainLight(const SLight& light)
+        {
+        }
+
+        void CNullDriver::SetActiveCameraPosition(core::Vector3Df position) const
+        {
+        }
+
+        void CNullDriver::SetRenderingMode(E_RENDERING_MODE mode)
+        {
+            rendering_mode_ = mode;
+        }
+
+        ECOLOR_FORMAT CNullDriver::GetColorFormat() const
+        {
+            return ECF_A8R8G8B8;
+        }
+
+        void CNullDriver::EnableShadow(bool flag)
+        {
+            shadow_enable_ = flag;
+        }
+
+        void CNullDriver::BeginShadowRender()
+        {
+        }
+
+        void CNullDriver::EndShadowRender()
+        {
+        }
+
+        void CNullDriver::BeginShadowCascade(u32 cascade, const core::Matrixf& view, const core::Matrixf& projection, f32 split_depth)
+        {
+            SetTransform(ETS_LIGHT_VIEW, view);
+            SetTransform(ETS_LIGHT_PROJECTION, projection);
+        }
+
+        u32 CNullDriver::GetMaximalShadowCascadeAmount() const
+        {
+            return MAX_SHADOW_CASCADES;
+        }
+
+        const core::Dimension2d<u32>& CNullDriver::GetShadowTextureSize() const
+        {
+            return shadow_texture_size_;
+        }
+
+        u32 CNullDriver::GetShadowAtlasSize() const
+        {
+            return shadow_atlas_size_;
+        }
+
+        void CNullDriver::AddShadowAtlasView(u32 light, const core::rect<s32>& tile, const core::Matrixf& view,
+            const core::Matrixf& projection, f32 split_depth)
+        {
+        }
+
+        void CNullDriver::BeginShadowAtlasTile(const core::rect<s32>& tile, const core::Matrixf& view, const core::Matrixf& projection)
+        {
+            SetTransform(ETS_LIGHT_VIEW, view);
+            SetTransform(ETS_LIGHT_PROJECTION, projection);
+        }
+
+        void CNullDriver::setViewPort(const core::rect<s32>& area)
+        {
+            core::rect<s32> vp = area;
+            core::rect<s32> rendert(0, 0, GetCurrentRenderTargetSize().width_, GetCurrentRenderTargetSize().height_);
+            vp.clipAgainst(rendert);
+
+            if (vp.getHeight() > 0 && vp.getWidth() > 0)
+            {
+                view_port_ = vp;
+            }
+        }
+
+        const core::rect<s32>& CNullDriver::getViewPort() const
+        {
+            return view_port_;
+        }
+
+        void CNullDriver::RenderFirstPass()
+        {
+        }
+
+        void CNullDriver::RenderSecondPass()
+        {
+        }
+
+        void CNullDriver::CheckError()
+        {
+        }
+
+        void CNullDriver::DrawSpaceFillQuad()
+        {
+        }
+
+        void CNullDriver::RenderFxaaPass()
+        {
+        }
+
+        IImage* CNullDriver::CreateScreenShot()
+        {
+            return nullptr;
+        }
+
+        //! creates a video driver which keeps all state but does not draw
+        IVideoDriver* CreateNullDriver(io::IFileSystem* io, const core::Dimension2d<u32>& screen_size)
+        {
+            return new CNullDriver(io, screen_size);
+        }
+    } // end namespace video
+} // end namespace kong
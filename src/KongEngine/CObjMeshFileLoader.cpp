@@ -28,9 +28,21 @@ namespace kong
 
         static const u32 WORD_BUFFER_LENGTH = 512;
 
+        // files of at least two chunks are parsed on several threads
+        static const long OBJ_CHUNK_SIZE = 256 * 1024;
+
+        // reads the element like core::Array::operator[] would with count elements in the array
+        template <class T>
+        static T getClamped(const core::Array<T>& arr, s32 idx, u32 count)
+        {
+            if (idx > 0 && static_cast<u32>(idx) < count)
+                return arr.ConstPointer()[idx];
+            return count ? arr.ConstPointer()[0] : T();
+        }
+
         //! Constructor
         COBJMeshFileLoader::COBJMeshFileLoader(scene::ISceneManager* smgr, io::IFileSystem* fs)
-            : SceneManager(smgr), FileSystem(fs)
+            : SceneManager(smgr), FileSystem(fs), ThreadPool(nullptr)
         {
 #ifdef _DEBUG
             //setDebugName("COBJMeshFileLoader");
@@ -41,6 +53,7 @@ namespace kong
         //! destructor
         COBJMeshFileLoader::~COBJMeshFileLoader()
         {
+            delete ThreadPool;
         }
 
 
@@ -64,10 +77,7 @@ namespace kong
 
             const u32 WORD_BUFFER_LENGTH = 512;
 
-            core::Array<core::Vector3Df> vertexBuffer;
-            core::Array<core::Vector3Df> normalsBuffer;
-            core::Array<core::Vector2Df> textureCoordBuffer;
-
+            MaterialFiles.Clear();
             SObjMtl * currMtl = new SObjMtl();
             Materials.PushBack(currMtl);
             u32 smoothingGroup = 0;
@@ -75,206 +85,233 @@ namespace kong
             const io::path fullName = file->GetFileName();
             const io::path relPath = FileSystem->GetFileDir(fullName) + "/";
 
-            c8* buf = new c8[filesize];
-            memset(buf, 0, filesize);
-            file->Read((void*)buf, filesize);
+            c8* bufCopy;
+            const c8* const buf = getFileContents(file, bufCopy);
             const c8* const bufEnd = buf + filesize;
 
-            // Process obj information
-            const c8* bufPtr = buf;
+            // Split the file at line breaks and read the vertex data and faces of the parts in parallel
+            u32 chunkCount = 1;
+            if (filesize >= 2 * OBJ_CHUNK_SIZE)
+            {
+                if (!ThreadPool)
+                    ThreadPool = new core::CThreadPool();
+                chunkCount = core::min_(static_cast<u32>(filesize / OBJ_CHUNK_SIZE), ThreadPool->GetThreadCount() * 4);
+            }
+
+            SObjChunk* chunks = new SObjChunk[chunkCount];
+            chunks[0].Begin = buf;
+            for (u32 c = 1; c < chunkCount; ++c)
+            {
+                // only '\n' ends a line for every statement, some skip a single '\r'
+                const c8* split = core::max_(buf + filesize / chunkCount * c, chunks[c - 1].Begin);
+                while (split != bufEnd && *split != '\n')
+                    ++split;
+
+                chunks[c].Begin = goFirstWord(split, bufEnd);
+                chunks[c - 1].End = chunks[c].Begin;
+            }
+            chunks[chunkCount - 1].End = bufEnd;
+
+            if (chunkCount > 1)
+                ThreadPool->ParallelFor(chunkCount, [this, chunks, bufEnd](u32 c) { parseChunk(chunks[c], bufEnd); });
+            else
+                parseChunk(chunks[0], bufEnd);
+
+            // The faces can reference the vertex data of all chunks before them
+            core::Array<core::Vector3Df> vertexBuffer;
+            core::Array<core::Vector3Df> normalsBuffer;
+            core::Array<core::Vector2Df> textureCoordBuffer;
+            core::Array<u32> chunkOffsets;
+            chunkOffsets.Resize(chunkCount * 3);
+            u32 positionTotal = 0, texCoordTotal = 0, normalTotal = 0;
+            for (u32 c = 0; c < chunkCount; ++c)
+            {
+                chunkOffsets.Pointer()[c * 3 + 0] = positionTotal;
+                chunkOffsets.Pointer()[c * 3 + 1] = texCoordTotal;
+                chunkOffsets.Pointer()[c * 3 + 2] = normalTotal;
+                positionTotal += chunks[c].Positions.Size();
+                texCoordTotal += chunks[c].TexCoords.Size();
+                normalTotal += chunks[c].Normals.Size();
+            }
+
+            vertexBuffer.Resize(positionTotal);
+            textureCoordBuffer.Resize(texCoordTotal);
+            normalsBuffer.Resize(normalTotal);
+            for (u32 c = 0; c < chunkCount; ++c)
+            {
+                const u32* offsets = chunkOffsets.ConstPointer() + c * 3;
+                for (u32 i = 0; i < chunks[c].Positions.Size(); ++i)
+                    vertexBuffer.Pointer()[offsets[0] + i] = chunks[c].Positions.ConstPointer()[i];
+                for (u32 i = 0; i < chunks[c].TexCoords.Size(); ++i)
+                    textureCoordBuffer.Pointer()[offsets[1] + i] = chunks[c].TexCoords.ConstPointer()[i];
+                for (u32 i = 0; i < chunks[c].Normals.Size(); ++i)
+                    normalsBuffer.Pointer()[offsets[2] + i] = chunks[c].Normals.ConstPointer()[i];
+            }
+
+            // corners of the current face, kept across lines to avoid reallocating it
+            core::Array<int> faceCorners;
+
+            // Process obj information, the statements are merged in file order
             core::stringc grpName, mtlName;
             bool mtlChanged = false;
             //bool useGroups = !SceneManager->GetParameters()->getAttributeAsBool(OBJ_LOADER_IGNORE_GROUPS);
             //bool useMaterials = !SceneManager->GetParameters()->getAttributeAsBool(OBJ_LOADER_IGNORE_MATERIAL_FILES);
             bool useGroups = false;
             bool useMaterials = true;
-            while (bufPtr != bufEnd)
+            for (u32 c = 0; c < chunkCount; ++c)
             {
-                switch (bufPtr[0])
-                {
-                case 'm':	// mtllib (material)
+                const SObjChunk& chunk = chunks[c];
+                const u32* offsets = chunkOffsets.ConstPointer() + c * 3;
+
+                for (u32 st = 0; st < chunk.Statements.Size(); ++st)
                 {
-                    if (useMaterials)
-                    {
-                        c8 name[WORD_BUFFER_LENGTH];
-                        //bufPtr = goAndCopyNextWord(name, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-                        bufPtr = goAndCopyNextWordIgnorSpace(name, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-#ifdef _KONG_DEBUG_OBJ_LOADER_
-                        os::Printer::log("Reading material file", name);
-#endif
-                        readMTL(name, relPath);
-                    }
-                }
-                    break;
+                    const SObjStatement& statement = chunk.Statements.ConstPointer()[st];
+                    const c8* bufPtr = statement.Line;
 
-                case 'v':               // v, vn, vt
-                    switch (bufPtr[1])
+                    switch (bufPtr[0])
                     {
-                    case ' ':          // vertex
+                    case 'm':	// mtllib (material)
                     {
-                        core::vector3df vec;
-                        bufPtr = readVec3(bufPtr, vec, bufEnd);
-                        vertexBuffer.PushBack(vec);
+                        if (useMaterials)
+                        {
+                            c8 name[WORD_BUFFER_LENGTH];
+                            //bufPtr = goAndCopyNextWord(name, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+                            bufPtr = goAndCopyNextWordIgnorSpace(name, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+#ifdef _KONG_DEBUG_OBJ_LOADER_
+                            os::Printer::log("Reading material file", name);
+#endif
+                            readMTL(name, relPath);
+                        }
                     }
                         break;
 
-                    case 'n':       // normal
+                    case 'g': // group name
                     {
-                        core::vector3df vec;
-                        bufPtr = readVec3(bufPtr, vec, bufEnd);
-                        normalsBuffer.PushBack(vec);
+                        c8 grp[WORD_BUFFER_LENGTH];
+                        bufPtr = goAndCopyNextWord(grp, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+#ifdef _KONG_DEBUG_OBJ_LOADER_
+                        os::Printer::log("Loaded group start", grp, ELL_DEBUG);
+#endif
+                        if (useGroups)
+                        {
+                            if (0 != grp[0])
+                                grpName = grp;
+                            else
+                                grpName = "default";
+                        }
+                        mtlChanged = true;
                     }
                         break;
 
-                    case 't':       // texcoord
+                    case 's': // smoothing can be a group or off (equiv. to 0)
                     {
-                        core::vector2df vec;
-                        bufPtr = readUV(bufPtr, vec, bufEnd);
-                        textureCoordBuffer.PushBack(vec);
-                    }
-                        break;
-                    }
-                    break;
-
-                case 'g': // group name
-                {
-                    c8 grp[WORD_BUFFER_LENGTH];
-                    bufPtr = goAndCopyNextWord(grp, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+                        c8 smooth[WORD_BUFFER_LENGTH];
+                        bufPtr = goAndCopyNextWord(smooth, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
 #ifdef _KONG_DEBUG_OBJ_LOADER_
-                    os::Printer::log("Loaded group start", grp, ELL_DEBUG);
+                        os::Printer::log("Loaded smoothing group start", smooth, ELL_DEBUG);
 #endif
-                    if (useGroups)
-                    {
-                        if (0 != grp[0])
-                            grpName = grp;
+                        if (core::stringc("off") == smooth)
+                            smoothingGroup = 0;
                         else
-                            grpName = "default";
+                            smoothingGroup = core::strtoul10(smooth);
                     }
-                    mtlChanged = true;
-                }
-                    break;
-
-                case 's': // smoothing can be a group or off (equiv. to 0)
-                {
-                    c8 smooth[WORD_BUFFER_LENGTH];
-                    bufPtr = goAndCopyNextWord(smooth, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-#ifdef _KONG_DEBUG_OBJ_LOADER_
-                    os::Printer::log("Loaded smoothing group start", smooth, ELL_DEBUG);
-#endif
-                    if (core::stringc("off") == smooth)
-                        smoothingGroup = 0;
-                    else
-                        smoothingGroup = core::strtoul10(smooth);
-                }
-                    break;
+                        break;
 
-                case 'u': // usemtl
-                    // get name of material
-                {
-                    c8 matName[WORD_BUFFER_LENGTH];
-                    bufPtr = goAndCopyNextWord(matName, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+                    case 'u': // usemtl
+                        // get name of material
+                    {
+                        c8 matName[WORD_BUFFER_LENGTH];
+                        bufPtr = goAndCopyNextWord(matName, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
 #ifdef _KONG_DEBUG_OBJ_LOADER_
-                    os::Printer::log("Loaded material start", matName, ELL_DEBUG);
+                        os::Printer::log("Loaded material start", matName, ELL_DEBUG);
 #endif
-                    mtlName = matName;
-                    mtlChanged = true;
-                }
-                    break;
-
-                case 'f':               // face
-                {
-                    c8 vertexWord[WORD_BUFFER_LENGTH]; // for retrieving vertex data
-                    video::S3DVertex v;
-                    // Assign vertex color from currently active material's diffuse color
-                    if (mtlChanged)
-                    {
-                        // retrieve the material
-                        SObjMtl *useMtl = findMtl(mtlName, grpName);
-                        // only change material if we found it
-                        if (useMtl)
-                            currMtl = useMtl;
-                        mtlChanged = false;
+                        mtlName = matName;
+                        mtlChanged = true;
                     }
-                    if (currMtl)
-                        v.color_ = currMtl->Meshbuffer->material_.diffuse_color_;
-
-                    // get all vertices data in this face (current line of obj file)
-                    const core::stringc wordBuffer = copyLine(bufPtr, bufEnd);
-                    const c8* linePtr = wordBuffer.c_str();
-                    const c8* const endPtr = linePtr + wordBuffer.size();
-
-                    core::Array<int> faceCorners;
-                    faceCorners.Reallocate(32); // should be large enough
+                        break;
 
-                    // read in all vertices
-                    linePtr = goNextWord(linePtr, endPtr);
-                    while (0 != linePtr[0])
+                    case 'f':               // face
                     {
-                        // Array to communicate with retrieveVertexIndices()
-                        // sends the buffer sizes and gets the actual indices
-                        // if index not set returns -1
-                        s32 Idx[3];
-                        Idx[1] = Idx[2] = -1;
-
-                        // read in next vertex's data
-                        u32 wlength = copyWord(vertexWord, linePtr, WORD_BUFFER_LENGTH, endPtr);
-                        // this function will also convert obj's 1-based index to c++'s 0-based index
-                        retrieveVertexIndices(vertexWord, Idx, vertexWord + wlength + 1, vertexBuffer.Size(), textureCoordBuffer.Size(), normalsBuffer.Size());
-                        v.pos_ = vertexBuffer[Idx[0]];
-                        if (-1 != Idx[1])
-                            v.texcoord_ = textureCoordBuffer[Idx[1]];
-                        else
-                            v.texcoord_.Set(0.0f, 0.0f);
-                        if (-1 != Idx[2])
-                            v.normal_ = normalsBuffer[Idx[2]];
-                        else
+                        video::S3DVertex v;
+                        // Assign vertex color from currently active material's diffuse color
+                        if (mtlChanged)
                         {
-                            v.normal_.Set(0.0f, 0.0f, 0.0f);
-                            currMtl->RecalculateNormals = true;
+                            // retrieve the material
+                            SObjMtl *useMtl = findMtl(mtlName, grpName);
+                            // only change material if we found it
+                            if (useMtl)
+                                currMtl = useMtl;
+                            mtlChanged = false;
                         }
+                        if (currMtl)
+                            v.color_ = currMtl->Meshbuffer->material_.diffuse_color_;
+
+                        // sizes of the buffers at this line of the file
+                        const u32 vbsize = offsets[0] + statement.PositionCount;
+                        const u32 vtsize = offsets[1] + statement.TexCoordCount;
+                        const u32 vnsize = offsets[2] + statement.NormalCount;
 
-                        int vertLocation;
-                        core::Map<video::S3DVertex, int>::Node* n = currMtl->VertMap.find(v);
-                        if (n)
+                        // most materials get about as many vertices as there are positions
+                        if (currMtl->Meshbuffer->vertices_.Empty())
+                            currMtl->VertMap.reserve(core::min_(vbsize, 8192u));
+
+                        // read in all vertices
+                        const s32* corner = chunk.Corners.ConstPointer() + statement.FirstCorner * 3;
+                        for (u32 i = 0; i < statement.CornerCount; ++i, corner += 3)
                         {
-                            vertLocation = n->getValue();
+                            // the numbers read by parseChunk, converted to 0-based indices
+                            // if index not set it becomes -1
+                            s32 Idx[3] = { corner[0], corner[1], corner[2] };
+                            convertVertexIndices(Idx, vbsize, vtsize, vnsize);
+                            if (-1 == Idx[2])
+                                currMtl->RecalculateNormals = true;
+
+                            // corners with the same indices share one vertex
+                            const s32 newLocation = currMtl->Meshbuffer->vertices_.Size();
+                            const s32 vertLocation = currMtl->VertMap.findOrInsert(Idx, newLocation);
+                            if (vertLocation == newLocation)
+                            {
+                                // out of range indices fall back to the first element read so far
+                                v.pos_ = getClamped(vertexBuffer, Idx[0], vbsize);
+                                if (-1 != Idx[1])
+                                    v.texcoord_ = getClamped(textureCoordBuffer, Idx[1], vtsize);
+                                else
+                                    v.texcoord_.Set(0.0f, 0.0f);
+                                if (-1 != Idx[2])
+                                    v.normal_ = getClamped(normalsBuffer, Idx[2], vnsize);
+                                else
+                                    v.normal_.Set(0.0f, 0.0f, 0.0f);
+
+                                currMtl->Meshbuffer->vertices_.PushBack(v);
+                            }
+
+                            faceCorners.PushBack(vertLocation);
                         }
-                        else
+
+                        // triangulate the face
+                        const int* corners = faceCorners.ConstPointer();
+                        for (u32 i = 1; i + 1 < faceCorners.Size(); ++i)
                         {
-                            currMtl->Meshbuffer->vertices_.PushBack(v);
-                            vertLocation = currMtl->Meshbuffer->vertices_.Size() - 1;
-                            currMtl->VertMap.insert(v, vertLocation);
+                            // Add a triangle
+                            //currMtl->Meshbuffer->indices_.PushBack(faceCorners[i + 1]);
+                            //currMtl->Meshbuffer->indices_.PushBack(faceCorners[i]);
+                            //currMtl->Meshbuffer->indices_.PushBack(faceCorners[0]);
+                            // buffers with more than 65536 vertices switch to 32 bit indices
+                            currMtl->Meshbuffer->PushBackIndex(corners[0]);
+                            currMtl->Meshbuffer->PushBackIndex(corners[i]);
+                            currMtl->Meshbuffer->PushBackIndex(corners[i + 1]);
                         }
-
-                        faceCorners.PushBack(vertLocation);
-
-                        // go to next vertex
-                        linePtr = goNextWord(linePtr, endPtr);
+                        faceCorners.Clear(); // fast clear
                     }
+                        break;
 
-                    // triangulate the face
-                    for (u32 i = 1; i < faceCorners.Size() - 1; ++i)
-                    {
-                        // Add a triangle
-                        //currMtl->Meshbuffer->indices_.PushBack(faceCorners[i + 1]);
-                        //currMtl->Meshbuffer->indices_.PushBack(faceCorners[i]);
-                        //currMtl->Meshbuffer->indices_.PushBack(faceCorners[0]);
-                        currMtl->Meshbuffer->indices_.PushBack(faceCorners[0]);
-                        currMtl->Meshbuffer->indices_.PushBack(faceCorners[i]);
-                        currMtl->Meshbuffer->indices_.PushBack(faceCorners[i + 1]);
-                    }
-                    faceCorners.Resize(0); // fast clear
-                    faceCorners.Reallocate(32); 
-                }
-                    break;
+                    default:
+                        break;
+                    }	// end switch(bufPtr[0])
+                }	// end for all statements
+            }	// end for all chunks
 
-                case '#': // comment
-                default:
-                    break;
-                }	// end switch(bufPtr[0])
-                // eat up rest of line
-                bufPtr = goNextLine(bufPtr, bufEnd);
-            }	// end while(bufPtr && (bufPtr-buf<filesize))
+            delete[] chunks;
 
             SMesh* mesh = new SMesh();
 
@@ -327,7 +364,7 @@ namespace kong
             }
 
             // Clean up the allocate obj file contents
-            delete[] buf;
+            delete[] bufCopy;
             // more cleaning up
             cleanUp();
             //mesh->drop();
@@ -336,6 +373,97 @@ namespace kong
         }
 
 
+        void COBJMeshFileLoader::parseChunk(SObjChunk& chunk, const c8* const bufEnd)
+        {
+            const c8* bufPtr = chunk.Begin;
+            while (bufPtr < chunk.End)
+            {
+                switch (bufPtr[0])
+                {
+                case 'v':               // v, vn, vt
+                    switch (bufPtr[1])
+                    {
+                    case ' ':          // vertex
+                    {
+                        core::vector3df vec;
+                        bufPtr = readVec3(bufPtr, vec, bufEnd);
+                        chunk.Positions.PushBack(vec);
+                    }
+                        break;
+
+                    case 'n':       // normal
+                    {
+                        core::vector3df vec;
+                        bufPtr = readVec3(bufPtr, vec, bufEnd);
+                        chunk.Normals.PushBack(vec);
+                    }
+                        break;
+
+                    case 't':       // texcoord
+                    {
+                        core::vector2df vec;
+                        bufPtr = readUV(bufPtr, vec, bufEnd);
+                        chunk.TexCoords.PushBack(vec);
+                    }
+                        break;
+                    }
+                    break;
+
+                case 'f':               // face
+                {
+                    SObjStatement statement;
+                    statement.Line = bufPtr;
+                    statement.FirstCorner = chunk.Corners.Size() / 3;
+                    statement.PositionCount = chunk.Positions.Size();
+                    statement.TexCoordCount = chunk.TexCoords.Size();
+                    statement.NormalCount = chunk.Normals.Size();
+
+                    // get all vertices data in this face (current line of obj file)
+                    const c8* const endPtr = goLineEnd(bufPtr, bufEnd);
+
+                    // read in all vertices, they are resolved once the sizes of the buffers are known
+                    const c8* linePtr = goNextWord(bufPtr, endPtr);
+                    while (linePtr != endPtr)
+                    {
+                        s32 Idx[3];
+                        linePtr = retrieveVertexIndices(linePtr, Idx, endPtr);
+                        chunk.Corners.PushBack(Idx[0]);
+                        chunk.Corners.PushBack(Idx[1]);
+                        chunk.Corners.PushBack(Idx[2]);
+
+                        // go to next vertex
+                        linePtr = goFirstWord(linePtr, endPtr);
+                    }
+
+                    statement.CornerCount = chunk.Corners.Size() / 3 - statement.FirstCorner;
+                    chunk.Statements.PushBack(statement);
+                }
+                    break;
+
+                case 'm':	// mtllib (material)
+                case 'g':	// group name
+                case 's':	// smoothing group
+                case 'u':	// usemtl
+                {
+                    // only the merge can apply these in order
+                    SObjStatement statement;
+                    statement.Line = bufPtr;
+                    statement.FirstCorner = statement.CornerCount = 0;
+                    statement.PositionCount = statement.TexCoordCount = statement.NormalCount = 0;
+                    chunk.Statements.PushBack(statement);
+                }
+                    break;
+
+                case '#': // comment
+                default:
+                    break;
+                }	// end switch(bufPtr[0])
+                // eat up rest of line
+                bufPtr = goNextLine(bufPtr, bufEnd);
+            }
+        }
+
+
         const c8* COBJMeshFileLoader::readTextures(const c8* bufPtr, const c8* const bufEnd, SObjMtl* currMaterial, const io::path& relPath)
         {
             u8 type = 0; // map_Kd - diffuse color texture map
@@ -496,24 +624,32 @@ namespace kong
         }
 
 
+        void COBJMeshFileLoader::getDependencies(core::Array<io::path>& files) const
+        {
+            for (u32 i = 0; i < MaterialFiles.Size(); ++i)
+                files.PushBack(MaterialFiles[i]);
+        }
+
+
         void COBJMeshFileLoader::readMTL(const c8* fileName, const io::path& relPath)
         {
             const io::path realFile(fileName);
             io::IReadFile * mtlReader;
 
             if (FileSystem->ExistFile(realFile))
-                mtlReader = FileSystem->CreateAndOpenFile(realFile);
+                mtlReader = FileSystem->CreateAndMapFile(realFile);
             else if (FileSystem->ExistFile(relPath + realFile))
-                mtlReader = FileSystem->CreateAndOpenFile(relPath + realFile);
+                mtlReader = FileSystem->CreateAndMapFile(relPath + realFile);
             else if (FileSystem->ExistFile(FileSystem->GetFileBasename(realFile)))
-                mtlReader = FileSystem->CreateAndOpenFile(FileSystem->GetFileBasename(realFile));
+                mtlReader = FileSystem->CreateAndMapFile(FileSystem->GetFileBasename(realFile));
             else
-                mtlReader = FileSystem->CreateAndOpenFile(relPath + FileSystem->GetFileBasename(realFile));
+                mtlReader = FileSystem->CreateAndMapFile(relPath + FileSystem->GetFileBasename(realFile));
             if (!mtlReader)	// fail to open and read file
             {
                 os::Printer::log("Could not open material file", realFile, ELL_WARNING);
                 return;
             }
+            MaterialFiles.PushBack(FileSystem->GetAbsolutePath(mtlReader->GetFileName()));
 
             const long filesize = mtlReader->GetSize();
             if (!filesize)
@@ -523,9 +659,9 @@ namespace kong
                 return;
             }
 
-            c8* buf = new c8[filesize];
-            mtlReader->Read((void*)buf, filesize);
-            const c8* bufEnd = buf + filesize;
+            c8* bufCopy;
+            const c8* const buf = getFileContents(mtlReader, bufCopy);
+            const c8* const bufEnd = buf + filesize;
 
             SObjMtl* currMaterial = 0;
 
@@ -671,24 +807,40 @@ namespace kong
             if (currMaterial)
                 Materials.PushBack(currMaterial);
 
-            delete[] buf;
+            delete[] bufCopy;
             delete mtlReader;
         }
 
 
+        //! Go to the next word and read the float at its start
+        const c8* COBJMeshFileLoader::readFloat(const c8* bufPtr, f32& value, const c8* const bufEnd)
+        {
+            bufPtr = goNextWord(bufPtr, bufEnd, false);
+
+            // the number ends at the latest at the white space which ends the buffer
+            if (bufPtr == bufEnd)
+            {
+                value = 0.f;
+                return bufPtr;
+            }
+
+            // stays inside the word, so the line end is still ahead
+            return core::fast_atof_move(bufPtr, value);
+        }
+
+
         //! Read RGB color
         const c8* COBJMeshFileLoader::readColor(const c8* bufPtr, video::SColor& color, const c8* const bufEnd)
         {
-            const u32 COLOR_BUFFER_LENGTH = 16;
-            c8 colStr[COLOR_BUFFER_LENGTH];
+            f32 value;
 
             color.SetAlpha(255);
-            bufPtr = goAndCopyNextWord(colStr, bufPtr, COLOR_BUFFER_LENGTH, bufEnd);
-            color.SetRed((s32)(core::fast_atof(colStr) * 255.0f));
-            bufPtr = goAndCopyNextWord(colStr, bufPtr, COLOR_BUFFER_LENGTH, bufEnd);
-            color.SetGreen((s32)(core::fast_atof(colStr) * 255.0f));
-            bufPtr = goAndCopyNextWord(colStr, bufPtr, COLOR_BUFFER_LENGTH, bufEnd);
-            color.SetBlue((s32)(core::fast_atof(colStr) * 255.0f));
+            bufPtr = readFloat(bufPtr, value, bufEnd);
+            color.SetRed((s32)(value * 255.0f));
+            bufPtr = readFloat(bufPtr, value, bufEnd);
+            color.SetGreen((s32)(value * 255.0f));
+            bufPtr = readFloat(bufPtr, value, bufEnd);
+            color.SetBlue((s32)(value * 255.0f));
             return bufPtr;
         }
 
@@ -696,15 +848,10 @@ namespace kong
         //! Read 3d vector of floats
         const c8* COBJMeshFileLoader::readVec3(const c8* bufPtr, core::vector3df& vec, const c8* const bufEnd)
         {
-            const u32 WORD_BUFFER_LENGTH = 256;
-            c8 wordBuffer[WORD_BUFFER_LENGTH];
-
-            bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-            vec.x_ = -core::fast_atof(wordBuffer); // change handedness
-            bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-            vec.y_ = core::fast_atof(wordBuffer);
-            bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-            vec.z_ = core::fast_atof(wordBuffer);
+            bufPtr = readFloat(bufPtr, vec.x_, bufEnd);
+            vec.x_ = -vec.x_; // change handedness
+            bufPtr = readFloat(bufPtr, vec.y_, bufEnd);
+            bufPtr = readFloat(bufPtr, vec.z_, bufEnd);
             return bufPtr;
         }
 
@@ -712,13 +859,9 @@ namespace kong
         //! Read 2d vector of floats
         const c8* COBJMeshFileLoader::readUV(const c8* bufPtr, core::vector2df& vec, const c8* const bufEnd)
         {
-            const u32 WORD_BUFFER_LENGTH = 256;
-            c8 wordBuffer[WORD_BUFFER_LENGTH];
-
-            bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-            vec.x_ = core::fast_atof(wordBuffer);
-            bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-            vec.y_ = 1 - core::fast_atof(wordBuffer); // change handedness
+            bufPtr = readFloat(bufPtr, vec.x_, bufEnd);
+            bufPtr = readFloat(bufPtr, vec.y_, bufEnd);
+            vec.y_ = 1 - vec.y_; // change handedness
             return bufPtr;
         }
 
@@ -820,9 +963,9 @@ namespace kong
             }
 
             u32 i = 0;
-            while (inBuf[i])
+            while (&(inBuf[i]) != bufEnd && inBuf[i])
             {
-                if (core::isspace(inBuf[i]) || &(inBuf[i]) == bufEnd)
+                if (core::isspace(inBuf[i]))
                     break;
                 ++i;
             }
@@ -846,9 +989,9 @@ namespace kong
             }
 
             u32 i = 0;
-            while (inBuf[i])
+            while (&(inBuf[i]) != bufEnd && inBuf[i])
             {
-                if (core::isnextline(inBuf[i]) || &(inBuf[i]) == bufEnd)
+                if (core::isnextline(inBuf[i]))
                     break;
                 ++i;
             }
@@ -862,20 +1005,13 @@ namespace kong
         }
 
 
-        core::stringc COBJMeshFileLoader::copyLine(const c8* inBuf, const c8* bufEnd)
+        //! Returns the line break which ends the current line, or bufEnd
+        const c8* COBJMeshFileLoader::goLineEnd(const c8* buf, const c8* const bufEnd)
         {
-            if (!inBuf)
-                return core::stringc();
+            while (buf != bufEnd && *buf != '\n' && *buf != '\r')
+                ++buf;
 
-            const c8* ptr = inBuf;
-            while (ptr<bufEnd)
-            {
-                if (*ptr == '\n' || *ptr == '\r')
-                    break;
-                ++ptr;
-            }
-            // we must avoid the +1 in case the array is used up
-            return core::stringc(inBuf, (u32)(ptr - inBuf + ((ptr < bufEnd) ? 1 : 0)));
+            return buf;
         }
 
 
@@ -894,72 +1030,143 @@ namespace kong
         }
 
 
-        bool COBJMeshFileLoader::retrieveVertexIndices(c8* vertexData, s32* idx, const c8* bufEnd, u32 vbsize, u32 vtsize, u32 vnsize)
+        const c8* COBJMeshFileLoader::retrieveVertexIndices(const c8* vertexData, s32* idx, const c8* bufEnd)
         {
-            c8 word[16] = "";
-            const c8* p = goFirstWord(vertexData, bufEnd);
+            const c8* p = vertexData;
             u32 idxType = 0;	// 0 = posIdx, 1 = texcoordIdx, 2 = normalIdx
 
-            u32 i = 0;
-            while (p != bufEnd)
+            for (;;)
             {
-                if ((core::isdigit(*p)) || (*p == '-'))
+                // if no number was found index will become 0 and later on -1 by decrement
+                idx[idxType] = 0;
+                if (p != bufEnd && (core::isdigit(*p) || *p == '-'))
+                    idx[idxType] = core::strtol10(p, &p);
+
+                // skip anything which is not part of a number
+                while (p != bufEnd && *p != '/' && !core::isspace(*p))
+                    ++p;
+
+                // go to the next kind of index type
+                if (p == bufEnd || *p != '/')
+                    break;
+
+                ++p;
+                if (++idxType > 2)
                 {
-                    // build up the number
-                    word[i++] = *p;
+                    // error checking, shouldn't reach here unless file is wrong
+                    idxType = 0;
                 }
-                else if (*p == '/' || *p == ' ' || *p == '\0')
-                {
-                    // number is completed. Convert and store it
-                    word[i] = '\0';
-                    // if no number was found index will become 0 and later on -1 by decrement
-                    idx[idxType] = core::strtol10(word);
-                    if (idx[idxType]<0)
-                    {
-                        switch (idxType)
-                        {
-                        case 0:
-                            idx[idxType] += vbsize;
-                            break;
-                        case 1:
-                            idx[idxType] += vtsize;
-                            break;
-                        case 2:
-                            idx[idxType] += vnsize;
-                            break;
-                        }
-                    }
-                    else
-                        idx[idxType] -= 1;
+            }
 
-                    // reset the word
-                    word[0] = '\0';
-                    i = 0;
+            // set all missing values to disable (=-1 after conversion)
+            while (++idxType < 3)
+                idx[idxType] = 0;
 
-                    // go to the next kind of index type
-                    if (*p == '/')
-                    {
-                        if (++idxType > 2)
-                        {
-                            // error checking, shouldn't reach here unless file is wrong
-                            idxType = 0;
-                        }
-                    }
-                    else
-                    {
-                        // set all missing values to disable (=-1)
-                        while (++idxType < 3)
-                            idx[idxType] = -1;
-                        ++p;
-                        break; // while
-                    }
-                }
+            return p;
+        }
 
-                // go to the next char
-                ++p;
+
+        void COBJMeshFileLoader::convertVertexIndices(s32* idx, u32 vbsize, u32 vtsize, u32 vnsize)
+        {
+            const u32 sizes[3] = { vbsize, vtsize, vnsize };
+            for (u32 i = 0; i < 3; ++i)
+            {
+                if (idx[i] < 0)
+                    idx[i] += sizes[i];
+                else
+                    idx[i] -= 1;
             }
+        }
 
-            return true;
+
+        const c8* COBJMeshFileLoader::getFileContents(io::IReadFile* file, c8*& copy)
+        {
+            const long filesize = file->GetSize();
+            const c8* mapped = static_cast<const c8*>(file->GetMappedData());
+
+            // numbers are parsed in place and only stop at a non-number character,
+            // which a mapped file has to provide before its end
+            if (mapped && core::isspace(mapped[filesize - 1]))
+            {
+                copy = 0;
+                return mapped;
+            }
+
+            // the terminating 0 stops the number parsing
+            copy = new c8[filesize + 1];
+            memset(copy, 0, filesize + 1);
+            file->Read((void*)copy, filesize);
+            return copy;
+        }
+
+
+        u32 COBJMeshFileLoader::SObjVertexMap::hash(const s32* idx)
+        {
+            return static_cast<u32>(idx[0]) * 73856093u ^
+                static_cast<u32>(idx[1]) * 19349663u ^
+                static_cast<u32>(idx[2]) * 83492791u;
+        }
+
+
+        s32 COBJMeshFileLoader::SObjVertexMap::findOrInsert(const s32* idx, s32 newVertex)
+        {
+            if ((Used + 1) * 2 > Mask + 1)
+                reserve(Used + 1);
+
+            SEntry* entries = Entries.Pointer();
+            u32 slot = hash(idx) & Mask;
+            while (-1 != entries[slot].Vertex)
+            {
+                if (entries[slot].Idx[0] == idx[0] &&
+                    entries[slot].Idx[1] == idx[1] &&
+                    entries[slot].Idx[2] == idx[2])
+                    return entries[slot].Vertex;
+
+                slot = (slot + 1) & Mask;
+            }
+
+            entries[slot].Idx[0] = idx[0];
+            entries[slot].Idx[1] = idx[1];
+            entries[slot].Idx[2] = idx[2];
+            entries[slot].Vertex = newVertex;
+            ++Used;
+            return newVertex;
+        }
+
+
+        void COBJMeshFileLoader::SObjVertexMap::reserve(u32 count)
+        {
+            // keep the table at most half full
+            u32 capacity = 64;
+            while (capacity < count * 2)
+                capacity <<= 1;
+
+            if (capacity <= Mask + 1 && 0 != Mask)
+                return;
+
+            core::Array<SEntry> old;
+            old.Resize(Used);
+            u32 oldCount = 0;
+            for (u32 i = 0; 0 != Mask && i <= Mask; ++i)
+            {
+                if (-1 != Entries.ConstPointer()[i].Vertex)
+                    old.Pointer()[oldCount++] = Entries.ConstPointer()[i];
+            }
+
+            Entries.Resize(capacity);
+            Mask = capacity - 1;
+            SEntry* entries = Entries.Pointer();
+            for (u32 i = 0; i < capacity; ++i)
+                entries[i].Vertex = -1;
+
+            for (u32 i = 0; i < oldCount; ++i)
+            {
+                const SEntry& entry = old.ConstPointer()[i];
+                u32 slot = hash(entry.Idx) & Mask;
+                while (-1 != entries[slot].Vertex)
+                    slot = (slot + 1) & Mask;
+                entries[slot] = entry;
+            }
         }
 
 
@@ -1,23 +1,62 @@
 // Copyright (C) 2018 Lyu Luan
 // This file is part of the "Kong Engine".
+
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_OPENGL_
+
 #include <GL/glew.h>
 #include "COpenGLDeferredShaderDriver.h"
 #include "COpenGLShaderHelper.h"
 #include "COpenGLTexture.h"
+#include "COpenGLResidencyManager.h"
 
 
 namespace kong
 {
     namespace video
     {
+        //! lights the post pass can handle, bound by the size of the light buffers
+        static const u32 MAX_CLUSTERED_LIGHTS = 4096;
+
+        //! floats per light in the light data buffer, six rgba texels
+        static const u32 LIGHT_DATA_SIZE = 24;
+
+        //! floats per shadow view in the shadow view buffer, six rgba texels
+        static const u32 SHADOW_VIEW_SIZE = 24;
+
+        //! width and height of the texture holding the shadow maps of all lights
+        static const u32 SHADOW_ATLAS_SIZE = 4096;
+
+        //! the light buffers use the texture units behind the shadow map
+        static const s32 FIRST_LIGHT_BUFFER_UNIT = SL_DEFERRED_SHADOW - SL_DEFERRED_PASS_0 + 1;
+
+        static const c8* const light_buffer_name[] = {
+            "cluster_tex",
+            "light_index_tex",
+            "light_data_tex",
+            "shadow_view_tex"
+        };
+
+        static const GLenum light_buffer_format[] = {
+            GL_RG32UI,
+            GL_R32UI,
+            GL_RGBA32F,
+            GL_RGBA32F
+        };
+
         COpenGLDeferredShaderDriver::COpenGLDeferredShaderDriver(const SKongCreationParameters& params, io::IFileSystem* file_system, CKongDeviceWin32* device)
             : COpenGLShaderDriver(params, file_system, device), deferred_post_shader_helper_(nullptr),
-              deferred_base_shader_helper_(nullptr), frame_buffers_(nullptr), nr_lights_(32)
+              deferred_base_shader_helper_(nullptr), frame_buffers_(nullptr)
         {
+            memset(light_buffers_, 0, sizeof(light_buffers_));
+            memset(light_textures_, 0, sizeof(light_textures_));
         }
 
         COpenGLDeferredShaderDriver::~COpenGLDeferredShaderDriver()
         {
+            glDeleteTextures(ELB_COUNT, light_textures_);
+            glDeleteBuffers(ELB_COUNT, light_buffers_);
             delete deferred_post_shader_helper_;
             delete deferred_base_shader_helper_;
             delete frame_buffers_;
@@ -45,9 +84,22 @@ namespace kong
             deferred_base_shader_helper_ = new COpenGLShaderHelper(io_, io::SPath("./shaders/deferred_base.vs"), io::SPath("./shaders/deferred_base.fs"));
             deferred_post_shader_helper_ = new COpenGLShaderHelper(io_, io::SPath("./shaders/deferred_post.vs"), io::SPath("./shaders/deferred_post.fs"));
 
+            BindUniformBlocks(deferred_base_shader_helper_);
+            BindUniformBlocks(deferred_post_shader_helper_);
+
             shader_helper_ = deferred_base_shader_helper_;
 
             frame_buffers_ = new COpenGLFBODeferredTexture(params_.window_size_, io::path(), this);
+            residency_manager_->AddRenderTarget(frame_buffers_);
+
+            // the light lists are too long for uniform blocks, the post pass fetches them from texture buffers
+            glGenBuffers(ELB_COUNT, light_buffers_);
+            glGenTextures(ELB_COUNT, light_textures_);
+            for (u32 i = 0; i < ELB_COUNT; i++)
+            {
+                UploadLightBuffer(static_cast<E_LIGHT_BUFFER>(i), nullptr, 0);
+                glTexBuffer(GL_TEXTURE_BUFFER, light_buffer_format[i], light_buffers_[i]);
+            }
 
             shader_helper_->Use();
             shader_helper_->SetBool("texture0_on", false);
@@ -99,10 +151,13 @@ namespace kong
                 EnablePostRenderTexture(i);
             }
 
-            // shadow texture
+            // shadow atlas
             shader_helper_->SetInt(GetUniformName(SL_DEFERRED_SHADOW), SL_DEFERRED_SHADOW - SL_DEFERRED_PASS_0);
             glActiveTexture(GL_TEXTURE0 + SL_DEFERRED_SHADOW - SL_DEFERRED_PASS_0);
-            glBindTexture(GL_TEXTURE_2D, dynamic_cast<const COpenGLTexture*>(shadow_depth_texture_)->GetOpenGLTextureName());
+            if (shadow_depth_texture_ != nullptr)
+            {
+                glBindTexture(GL_TEXTURE_2D, shadow_depth_texture_->GetOpenGLTextureName());
+            }
 
             const f32 data[2] = { params_.window_size_.width_, params_.window_size_.height_ };
             deferred_post_shader_helper_->SetVec2("window_size", data);
@@ -116,9 +171,46 @@ namespace kong
             glBindTexture(GL_TEXTURE_2D, frame_buffers_->GetTextureName(idx));
         }
 
+        void COpenGLDeferredShaderDriver::DeleteAllDynamicLights()
+        {
+            COpenGLDriver::DeleteAllDynamicLights();
+        }
+
+        s32 COpenGLDeferredShaderDriver::AddDynamicLight(const SLight& light)
+        {
+            return COpenGLDriver::AddDynamicLight(light);
+        }
+
         void COpenGLDeferredShaderDriver::ActivateDynamicLights()
         {
-            shader_helper_->SetInt("lights_num", GetDynamicLightCount());
+            light_grid_.Update(matrices_[ETS_VIEW], matrices_[ETS_PROJECTION], lights_.ConstPointer(), lights_.Size());
+            PackLights();
+
+            UploadLightBuffer(ELB_CLUSTERS, light_grid_.GetClusters(), sizeof(u32) * 2 * CLightClusterGrid::CLUSTER_COUNT);
+            UploadLightBuffer(ELB_LIGHT_INDICES, light_grid_.GetLightIndices(), sizeof(u32) * light_grid_.GetLightIndexCount());
+            UploadLightBuffer(ELB_LIGHT_DATA, light_data_.ConstPointer(), sizeof(f32) * light_data_.Size());
+            UploadLightBuffer(ELB_SHADOW_VIEWS, shadow_view_data_.ConstPointer(), sizeof(f32) * shadow_view_data_.Size());
+
+            // the ambient part does not fade with the distance, so it is averaged over all lights
+            f32 ambient[4] = { 0.f, 0.f, 0.f, 0.f };
+            for (u32 i = 0; i < lights_.Size(); i++)
+            {
+                const SColorf &color = lights_[i].ambient_color_;
+                ambient[0] += color.r / lights_.Size();
+                ambient[1] += color.g / lights_.Size();
+                ambient[2] += color.b / lights_.Size();
+                ambient[3] += color.a / lights_.Size();
+            }
+
+            const s32 tiles[2] = { CLightClusterGrid::TILES_X, CLightClusterGrid::TILES_Y };
+            f32 slice_transform[2];
+            light_grid_.GetSliceTransform(slice_transform[0], slice_transform[1]);
+
+            shader_helper_->SetVec4("ambient_light", ambient);
+            shader_helper_->SetInt("global_lights_num", light_grid_.GetGlobalLightCount());
+            shader_helper_->SetVec2i("cluster_tiles", tiles);
+            shader_helper_->SetInt("cluster_slices", CLightClusterGrid::SLICES);
+            shader_helper_->SetVec2("cluster_slice_transform", slice_transform);
         }
 
         void COpenGLDeferredShaderDriver::SetMainLight(const SLight& light)
@@ -128,11 +220,31 @@ namespace kong
 
         void COpenGLDeferredShaderDriver::EnableShadow(bool flag)
         {
+            // the shadow maps of all lights are tiles of one texture
+            if (shadow_color_texture_ == nullptr)
+            {
+                const core::Dimension2d<u32> atlas_size(SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE);
+                shadow_color_texture_ = new COpenGLFBOTexture(atlas_size, io::path(), this, false);
+                shadow_depth_texture_ = new COpenGLFBODepthTexture(atlas_size, io::path(), this, true);
+                shadow_depth_texture_->attach(shadow_color_texture_);
+                residency_manager_->AddRenderTarget(shadow_color_texture_);
+                residency_manager_->AddRenderTarget(shadow_depth_texture_);
+            }
+
             COpenGLDriver::EnableShadow(flag);
         }
 
+        void COpenGLDeferredShaderDriver::BeginShadowRender()
+        {
+            COpenGLShaderDriver::BeginShadowRender();
+
+            shadow_view_data_.Resize(0);
+            light_shadow_views_.Resize(0);
+        }
+
         void COpenGLDeferredShaderDriver::EndShadowRender()
         {            
+            glDisable(GL_SCISSOR_TEST);
             shadow_color_texture_->unbindRTT();
 
             DeleteAllDynamicLights();
@@ -140,43 +252,75 @@ namespace kong
             glViewport(0, 0, params_.window_size_.width_, params_.window_size_.height_);
         }
 
-        void COpenGLDeferredShaderDriver::SetLightUniform(s32 light_idx, s32 light_val_type, const void* val) const
+        u32 COpenGLDeferredShaderDriver::GetShadowAtlasSize() const
         {
-            light_idx -= SL_LIGHT0;
-            if (light_idx < 0 || light_idx >= nr_lights_)
+            return SHADOW_ATLAS_SIZE;
+        }
+
+        void COpenGLDeferredShaderDriver::AddShadowAtlasView(u32 light, const core::rect<s32>& tile, const core::Matrixf& view,
+            const core::Matrixf& projection, f32 split_depth)
+        {
+            if (light >= MAX_CLUSTERED_LIGHTS || tile.getWidth() <= 0 || tile.getHeight() <= 0)
+            {
                 return;
-            core::stringc str = core::stringc("lights[") + core::stringc(light_idx) + "]." + light_uniform_name[light_val_type];
-            //os::Printer::print(str.c_str());
+            }
+
+            const u32 old_size = light_shadow_views_.Size();
+            if (light * 2 + 2 > old_size)
+            {
+                light_shadow_views_.Resize(light * 2 + 2);
+                for (u32 i = old_size; i < light_shadow_views_.Size(); i++)
+                {
+                    light_shadow_views_.Pointer()[i] = 0;
+                }
+            }
 
-            switch (light_val_type)
+            u32 *views = light_shadow_views_.Pointer() + light * 2;
+            if (views[1] == 0)
             {
-            case SL_LIGHT_POSITION:
-            case SL_LIGHT_DIRECTION:
-            case SL_LIGHT_AMBIENT:
-            case SL_LIGHT_DIFFUSE:
-            case SL_LIGHT_SPECULAR:
-            case SL_LIGHT_ATTENUATION:
-                shader_helper_->SetVec4(str.c_str(), static_cast<const f32 *>(val));
-                break;
-            case SL_LIGHT_EXPONENT:
-            case SL_LIGHT_CUTOFF:
-                shader_helper_->SetFloat(str.c_str(), *static_cast<const f32 *>(val));
-            default: break;
+                views[0] = shadow_view_data_.Size() / SHADOW_VIEW_SIZE;
             }
+            views[1]++;
+
+            // moves the normalized device coordinates of the view into its tile, so the transform gives atlas coordinates
+            const f32 inv_size = 1.f / SHADOW_ATLAS_SIZE;
+            core::Matrixf tile_transform;
+            tile_transform.Identity();
+            tile_transform(0, 0) = 0.5f * tile.getWidth() * inv_size;
+            tile_transform(1, 1) = 0.5f * tile.getHeight() * inv_size;
+            tile_transform(3, 0) = (tile.UpperLeftCorner.x_ + 0.5f * tile.getWidth()) * inv_size;
+            tile_transform(3, 1) = (tile.UpperLeftCorner.y_ + 0.5f * tile.getHeight()) * inv_size;
+            const core::Matrixf transform = view * GetShadowAtlasProjection(projection) * tile_transform;
+
+            const u32 offset = shadow_view_data_.Size();
+            shadow_view_data_.Resize(offset + SHADOW_VIEW_SIZE);
+            f32 *data = shadow_view_data_.Pointer() + offset;
+            memcpy(data, transform.Pointer(), sizeof(f32) * 16);
+
+            // the filter taps must not reach into the neighbored tiles
+            data[16] = (tile.UpperLeftCorner.x_ + 0.5f) * inv_size;
+            data[17] = (tile.UpperLeftCorner.y_ + 0.5f) * inv_size;
+            data[18] = (tile.LowerRightCorner.x_ - 0.5f) * inv_size;
+            data[19] = (tile.LowerRightCorner.y_ - 0.5f) * inv_size;
+
+            // split depth and depth bias, the depth of perspective views is not linear
+            data[20] = split_depth;
+            data[21] = projection(2, 3) != 0.f ? 0.00005f : 0.0005f;
+            data[22] = 0.f;
+            data[23] = 0.f;
         }
 
-        void COpenGLDeferredShaderDriver::SetLightUniform(s32 light_idx, s32 light_val_type, f32 val) const
+        void COpenGLDeferredShaderDriver::BeginShadowAtlasTile(const core::rect<s32>& tile, const core::Matrixf& view, const core::Matrixf& projection)
         {
-            light_idx -= SL_LIGHT0;
-            if (light_idx < 0 || light_idx >= nr_lights_)
-                return;
-            core::stringc str = core::stringc("lights[") + core::stringc(light_idx) + "]." + light_uniform_name[light_val_type];
+            glViewport(tile.UpperLeftCorner.x_, tile.UpperLeftCorner.y_, tile.getWidth(), tile.getHeight());
+            glScissor(tile.UpperLeftCorner.x_, tile.UpperLeftCorner.y_, tile.getWidth(), tile.getHeight());
+            glEnable(GL_SCISSOR_TEST);
+            ClearBuffers(color_buffer_clear_, z_buffer_clear_, false, color_clear_);
 
-            shader_helper_->SetFloat(str.c_str(), val);
+            SetTransform(ETS_LIGHT_VIEW, view);
+            SetTransform(ETS_LIGHT_PROJECTION, GetShadowAtlasProjection(projection));
         }
 
-;
-
         void COpenGLDeferredShaderDriver::DrawSpaceFillQuad()
         {
             u16 indices[6] = {
@@ -233,6 +377,99 @@ namespace kong
             const f32 data[2] = { params_.window_size_.width_, params_.window_size_.height_ };
             fxaa_shader_helper_->SetVec2("window_size", data);
         }
+
+        void COpenGLDeferredShaderDriver::UpdateMaxSupportLights()
+        {
+            max_support_lights_ = MAX_CLUSTERED_LIGHTS;
+        }
+
+        void COpenGLDeferredShaderDriver::PackLights()
+        {
+            light_data_.Resize(lights_.Size() * LIGHT_DATA_SIZE);
+            for (u32 i = 0; i < lights_.Size(); i++)
+            {
+                const SLight &light = lights_[i];
+                f32 *data = light_data_.Pointer() + i * LIGHT_DATA_SIZE;
+
+                // position and range, a range of 0 marks a directional light which shines along -position
+                if (light.type_ == ELT_DIRECTIONAL)
+                {
+                    data[0] = -light.direction_.x_;
+                    data[1] = -light.direction_.y_;
+                    data[2] = -light.direction_.z_;
+                    data[3] = 0.f;
+                }
+                else
+                {
+                    data[0] = light.position_.x_;
+                    data[1] = light.position_.y_;
+                    data[2] = light.position_.z_;
+                    data[3] = CLightClusterGrid::GetLightRange(light);
+                }
+
+                // spot direction and exponent
+                data[4] = light.direction_.x_;
+                data[5] = light.direction_.y_;
+                data[6] = light.direction_.z_;
+                data[7] = light.type_ == ELT_SPOT ? light.falloff_ : 0.f;
+
+                data[8] = light.diffuse_color_.r;
+                data[9] = light.diffuse_color_.g;
+                data[10] = light.diffuse_color_.b;
+                data[11] = light.diffuse_color_.a;
+
+                data[12] = light.specular_color_.r;
+                data[13] = light.specular_color_.g;
+                data[14] = light.specular_color_.b;
+                data[15] = light.specular_color_.a;
+
+                // attenuation and spot cutoff
+                data[16] = light.attenuation_.x_;
+                data[17] = light.attenuation_.y_;
+                data[18] = light.attenuation_.z_;
+                data[19] = light.type_ == ELT_SPOT ? light.outer_cone_ : 180.f;
+
+                // first shadow view and view count
+                const bool shadowed = i * 2 + 1 < light_shadow_views_.Size();
+                data[20] = shadowed ? static_cast<f32>(light_shadow_views_.ConstPointer()[i * 2]) : 0.f;
+                data[21] = shadowed ? static_cast<f32>(light_shadow_views_.ConstPointer()[i * 2 + 1]) : 0.f;
+                data[22] = 0.f;
+                data[23] = 0.f;
+            }
+        }
+
+        void COpenGLDeferredShaderDriver::UploadLightBuffer(E_LIGHT_BUFFER buffer, const void* data, u32 size) const
+        {
+            // the buffer is orphaned every frame, it must never be empty
+            glBindBuffer(GL_TEXTURE_BUFFER, light_buffers_[buffer]);
+            glBufferData(GL_TEXTURE_BUFFER, core::max_<u32>(size, sizeof(f32) * 4), nullptr, GL_STREAM_DRAW);
+            if (size > 0)
+            {
+                glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+            }
+            glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+            const s32 unit = FIRST_LIGHT_BUFFER_UNIT + buffer;
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_BUFFER, light_textures_[buffer]);
+            shader_helper_->SetInt(light_buffer_name[buffer], unit);
+        }
+
+        core::Matrixf COpenGLDeferredShaderDriver::GetShadowAtlasProjection(const core::Matrixf& projection)
+        {
+            // perspective projections put the depth into [-1, 1], the shadow shader writes it unchanged
+            if (projection(2, 3) == 0.f)
+            {
+                return projection;
+            }
+
+            core::Matrixf result = projection;
+            for (u32 i = 0; i < 4; i++)
+            {
+                result(i, 2) = 0.5f * projection(i, 2) + 0.5f * projection(i, 3);
+            }
+            return result;
+        }
     } // end namespace video
 } // end namespace kong
 
@@ -257,4 +494,6 @@ namespace kong
         }
 #endif
     }
-}
\ No newline at end of file
+}
+
+#endif // _KONG_COMPILE_WITH_OPENGL_
@@ -6,6 +6,7 @@
 
 #include "COpenGLShaderDriver.h"
 #include "IShaderHelper.h"
+#include "CLightClusterGrid.h"
 
 namespace kong
 {
@@ -34,17 +35,37 @@ namespace kong
             //! Enable deferred post render texture
             void EnablePostRenderTexture(u32 idx) const;
 
+            //! Deletes all dynamic lights, the post pass reads them from the light buffers
+            void DeleteAllDynamicLights() override;
+
+            //! Adds a dynamic light, it is uploaded by ActivateDynamicLights()
+            s32 AddDynamicLight(const SLight& light) override;
+
+            //! Assigns the dynamic lights to the light clusters and uploads them for the post pass
             void ActivateDynamicLights() override;
 
             //! Set main light, used for shadow rendering
             void SetMainLight(const SLight& light) override;
 
-            //! Enable shadows.
+            //! Enable shadows, creates the shadow atlas.
             void EnableShadow(bool flag) override;
 
+            //! Begin shadow rendering, forgets the shadow views of the last frame
+            void BeginShadowRender() override;
+
             //! End shadow rendering
             void EndShadowRender() override;
 
+            //! Returns the width and height of the shadow atlas in texels
+            u32 GetShadowAtlasSize() const override;
+
+            //! Adds a view of a light which is sampled from a tile of the shadow atlas
+            void AddShadowAtlasView(u32 light, const core::rect<s32>& tile, const core::Matrixf& view,
+                const core::Matrixf& projection, f32 split_depth) override;
+
+            //! Begin rendering a tile of the shadow atlas
+            void BeginShadowAtlasTile(const core::rect<s32>& tile, const core::Matrixf& view, const core::Matrixf& projection) override;
+
             // draw a space fill quad
             void DrawSpaceFillQuad() override;
 
@@ -52,10 +73,34 @@ namespace kong
             void RenderFxaaPass() override;
 
         protected:
-            void SetLightUniform(s32 light_idx, s32 light_val_type, const void *val) const override;
-            void SetLightUniform(s32 light_idx, s32 light_val_type, f32 val) const override;
+            void UpdateMaxSupportLights() override;
+
+            //! texture buffers read by the post pass
+            enum E_LIGHT_BUFFER
+            {
+                //! offset and count into the light index list per cluster
+                ELB_CLUSTERS = 0,
 
+                //! light indices of all clusters
+                ELB_LIGHT_INDICES,
 
+                //! colors, positions and ranges of the lights
+                ELB_LIGHT_DATA,
+
+                //! transforms and atlas tiles of the shadow views
+                ELB_SHADOW_VIEWS,
+
+                ELB_COUNT
+            };
+
+            //! writes the lights into light_data_ in the layout of the post shader
+            void PackLights();
+
+            //! uploads data into a light buffer and binds its texture for the post pass
+            void UploadLightBuffer(E_LIGHT_BUFFER buffer, const void* data, u32 size) const;
+
+            //! returns a projection which puts the depth into [0, 1] like the orthogonal shadow cameras
+            static core::Matrixf GetShadowAtlasProjection(const core::Matrixf& projection);
 
             IShaderHelper *deferred_post_shader_helper_;
             IShaderHelper *deferred_base_shader_helper_;
@@ -63,7 +108,16 @@ namespace kong
             // render textures
             COpenGLFBODeferredTexture *frame_buffers_;
 
-            u32 nr_lights_;
+            CLightClusterGrid light_grid_;
+            core::Array<f32> light_data_;
+
+            //! the shadow views added since BeginShadowRender() in the layout of the post shader
+            core::Array<f32> shadow_view_data_;
+
+            //! first shadow view and view count of each light
+            core::Array<u32> light_shadow_views_;
+            u32 light_buffers_[ELB_COUNT];
+            u32 light_textures_[ELB_COUNT];
         };
     } // end namespace video
 } // end namespace video
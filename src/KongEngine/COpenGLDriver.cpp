@@ -1,14 +1,26 @@
 // Copyright (C) 2018 Lyu Luan
 // This file is part of the "Kong Engine".
 
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_OPENGL_
+
 #include "COpenGLDriver.h"
 
 #include <GL/glew.h>
 #include "IMeshBuffer.h"
 #include "CImage.h"
 #include "COpenGLTexture.h"
+#include "COpenGLTextureStreamer.h"
+#include "COpenGLResidencyManager.h"
 #include "IReadFile.h"
 #include "CMeshManipulator.h"
+#include "CBlockCompression.h"
+#include "CNormalMapGenerator.h"
+#include "CImageWriterDDS.h"
+#include "CThreadPool.h"
+#include "IWriteFile.h"
+#include "coreutil.h"
 #include "os.h"
 
 namespace kong
@@ -24,14 +36,18 @@ namespace kong
         //! creates a loader which is able to load tga images
         IImageLoader* CreateImageLoaderTGA();
 
+        //! creates a loader which is able to load dds images
+        IImageLoader* CreateImageLoaderDDS();
+
         COpenGLDriver::COpenGLDriver(const SKongCreationParameters& params, io::IFileSystem* io, CKongDeviceWin32* device)
             : hdc_(nullptr), window_(static_cast<HWND>(params.window_id_)), hrc_(nullptr), device_(device),
-              params_(params), io_(io), max_texture_units_(0), max_supported_textures_(0), max_support_lights_(0),
+              params_(params), io_(io), max_texture_units_(0), max_supported_textures_(0), max_support_lights_(0), max_anisotropy_(0.f),
               shadow_color_texture_(nullptr), shadow_depth_texture_(nullptr), fxaa_src_texture_(nullptr), rendering_mode_(ERM_MESH), color_format_(ECF_A8R8G8B8),
               shadow_enable_(false), color_buffer_clear_(true), z_buffer_clear_(true), shadow_texture_size_(2048, 2048), render_material_texture_on_(true)
         {
             // create manipulator
             mesh_manipulator_ = new scene::CMeshManipulator();
+            thread_pool_ = new core::CThreadPool();
 
 
 #ifdef _KONG_COMPILE_WITH_JPG_LOADER_
@@ -43,11 +59,22 @@ namespace kong
 #ifdef _KONG_COMPILE_WITH_TGA_LOADER_
             surface_loader_.PushBack(video::CreateImageLoaderTGA());
 #endif
+#ifdef _KONG_COMPILE_WITH_DDS_LOADER_
+            surface_loader_.PushBack(video::CreateImageLoaderDDS());
+#endif
+
+            // the workers use the loaders, so they start after them
+            texture_streamer_ = new COpenGLTextureStreamer([this](io::IReadFile* file) { return LoadCachedImage(file, nullptr); });
+            texture_upload_budget_ = 4 * 1024 * 1024;
+            residency_manager_ = new COpenGLResidencyManager([this](COpenGLTexture* texture) { return ReloadTexture(texture); });
         }
 
         COpenGLDriver::~COpenGLDriver()
         {
+            delete texture_streamer_;
+            delete residency_manager_;
             delete mesh_manipulator_;
+            delete thread_pool_;
             delete fxaa_src_texture_;
             delete shadow_depth_texture_;
             delete shadow_color_texture_;
@@ -153,6 +180,10 @@ namespace kong
             glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_texture_units_);
             max_texture_units_ = core::min_<u32>(max_texture_units_, MATERIAL_MAX_TEXTURES);
             max_supported_textures_ = max_texture_units_;
+            if (GLEW_EXT_texture_filter_anisotropic)
+            {
+                glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_anisotropy_);
+            }
             UpdateMaxSupportLights();
 
             int pf = GetPixelFormat(hdc_);
@@ -174,6 +205,7 @@ namespace kong
 
             // used for fxaa
             fxaa_src_texture_ = new COpenGLFBOTexture(params_.window_size_, io::SPath(), this, false);
+            residency_manager_->AddRenderTarget(fxaa_src_texture_);
 
             return true;
         }
@@ -184,7 +216,12 @@ namespace kong
 
             for (auto i = max_texture_units_ - 1; i >= 0; --i)
             {
-                SetActiveTexture(i, material.GetTexture(i));
+                const ITexture *texture = material.GetTexture(i);
+                if (SetActiveTexture(i, texture) && texture != nullptr)
+                {
+                    static_cast<const COpenGLTexture*>(texture)->SetSamplerState(i, material.texture_layer_[i], max_anisotropy_);
+                    residency_manager_->UseTexture(static_cast<const COpenGLTexture*>(texture));
+                }
                 const u32 texture_val = ETS_TEXTURE_0 + i;
                 SetTransform(texture_val, material_.GetTextureMatrix(i));
             }
@@ -197,6 +234,16 @@ namespace kong
             z_buffer_clear_ = z_buffer;
             color_clear_ = color;
             render_material_texture_on_ = true;
+
+            const bool resized = residency_manager_->Update();
+            if (texture_streamer_->Update(texture_upload_budget_) > 0 || resized)
+            {
+                // the uploads bound their textures to the active unit instead of the cached one
+                GLint unit;
+                glGetIntegerv(GL_ACTIVE_TEXTURE, &unit);
+                const ITexture *texture = current_texture_[unit - GL_TEXTURE0];
+                glBindTexture(GL_TEXTURE_2D, texture != nullptr ? static_cast<const COpenGLTexture*>(texture)->GetOpenGLTextureName() : 0);
+            }
             return true;
         }
 
@@ -281,6 +328,8 @@ namespace kong
 
         void COpenGLDriver::DrawMeshBuffer(const scene::IMeshBuffer* mesh_buffer)
         {
+            UpdateStreamingPriority(mesh_buffer, matrices_[ETS_WORLD]);
+
             const S3DVertex *vertices = static_cast<const S3DVertex*>(mesh_buffer->GetVertices());
             u32 vertice_count = mesh_buffer->GetVertexCount();
             const u16 *indices = mesh_buffer->GetIndices();
@@ -299,7 +348,8 @@ namespace kong
             glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(vertices))[0].texcoord_);
             glVertexPointer(3, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(vertices))[0].pos_);
 
-            glDrawElements(GL_TRIANGLES, indices_count, GL_UNSIGNED_SHORT, indices);
+            const GLenum index_type = mesh_buffer->GetIndexType() == EIT_32BIT ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+            glDrawElements(GL_TRIANGLES, indices_count, index_type, indices);
 
             glDisableClientState(GL_COLOR_ARRAY);
             glDisableClientState(GL_VERTEX_ARRAY);
@@ -307,6 +357,25 @@ namespace kong
             glDisableClientState(GL_TEXTURE_COORD_ARRAY);
         }
 
+        void COpenGLDriver::DrawMeshBufferInstanced(const scene::IMeshBuffer* mesh_buffer, const core::Matrixf* transforms, u32 count)
+        {
+            // the fixed function pipeline has no instancing
+            for (u32 i = 0; i < count; ++i)
+            {
+                SetTransform(ETS_WORLD, transforms[i]);
+                DrawMeshBuffer(mesh_buffer);
+            }
+        }
+
+        void COpenGLDriver::RemoveHardwareBuffer(const scene::IMeshBuffer* mesh_buffer)
+        {
+            // fixed function path draws from client memory, nothing to release
+        }
+
+        void COpenGLDriver::RemoveAllHardwareBuffers()
+        {
+        }
+
         IImage* COpenGLDriver::CreateImage(ECOLOR_FORMAT format, const core::Dimension2d<u32>& size)
         {
             if (IImage::IsRenderTargetOnlyFormat(format))
@@ -447,6 +516,120 @@ namespace kong
             return texture;
         }
 
+        video::ITexture* COpenGLDriver::LoadCachedTexture(io::IReadFile* file)
+        {
+            IImage* image = LoadCachedImage(file, thread_pool_);
+            if (image == nullptr)
+                return nullptr;
+
+            COpenGLTexture* texture = static_cast<COpenGLTexture*>(createDeviceDependentTexture(image, file->GetFileName()));
+            texture->SetHasSourceFile(true);
+            delete image;
+            return texture;
+        }
+
+        IImage* COpenGLDriver::LoadCachedImage(io::IReadFile* file, core::CThreadPool* thread_pool)
+        {
+#ifdef _KONG_COMPILE_WITH_COMPRESSED_TEXTURE_CACHE_
+            // a dds file is its own cache
+            const io::path filename = file->GetFileName();
+            if (core::hasFileExtension(filename, "dds"))
+                return CreateImageFromFile(file);
+
+            const io::path compressed_name = filename + COMPRESSED_TEXTURE_EXTENSION;
+            if (io_->IsFileNewer(compressed_name, filename))
+            {
+                io::IReadFile* compressed_file = io_->CreateAndMapFile(compressed_name);
+                if (compressed_file != nullptr)
+                {
+                    IImage* image = CreateImageFromFile(compressed_file);
+                    delete compressed_file;
+                    if (image != nullptr)
+                    {
+                        os::Printer::log("Loaded compressed texture", compressed_name, ELL_INFORMATION);
+                        return image;
+                    }
+                }
+            }
+
+            IImage* image = CreateImageFromFile(file);
+            if (image == nullptr || IImage::IsCompressedFormat(image->GetColorFormat()))
+                return image;
+
+            IImage* source = image;
+            if (source->GetColorFormat() != ECF_A8R8G8B8)
+            {
+                source = new CImage(ECF_A8R8G8B8, image->GetDimension());
+                image->CopyTo(source);
+            }
+
+            const ECOLOR_FORMAT format = CBlockCompression::ChooseFormat(source, IsCompressedFormatSupported(ECF_BC7));
+            IImage* compressed = IsCompressedFormatSupported(format) ? CBlockCompression::Compress(source, format, true, thread_pool) : nullptr;
+            if (source != image)
+                delete source;
+
+            if (compressed == nullptr)
+                return image;
+
+            delete image;
+
+            // an incomplete file is rejected by the loader, so it is compressed and written again next time
+            io::IWriteFile* compressed_file = io_->CreateAndWriteFile(compressed_name);
+            CImageWriterDDS writer;
+            if (compressed_file == nullptr || !writer.WriteImage(compressed_file, compressed))
+                os::Printer::log("Could not write compressed texture", compressed_name, ELL_WARNING);
+            delete compressed_file;
+            return compressed;
+#else
+            return CreateImageFromFile(file);
+#endif
+        }
+
+        //! returns the pixels covered by the screen rectangle around the projected box
+        static f32 GetScreenArea(const core::aabbox3df& box, const core::Matrixf& transform, const core::Dimension2d<u32>& screen_size)
+        {
+            const f32 screen_area = static_cast<f32>(screen_size.width_) * static_cast<f32>(screen_size.height_);
+            f32 min_x = 1.f, min_y = 1.f, max_x = -1.f, max_y = -1.f;
+            for (u32 i = 0; i < 8; ++i)
+            {
+                const core::Vector3Df corner((i & 1) ? box.MaxEdge.x_ : box.MinEdge.x_,
+                    (i & 2) ? box.MaxEdge.y_ : box.MinEdge.y_, (i & 4) ? box.MaxEdge.z_ : box.MinEdge.z_, 1.f);
+                const core::Vector3Df p = transform.Apply(corner);
+
+                // a box reaching behind the camera may cover all of the screen
+                if (p.w_ <= 0.f)
+                    return screen_area;
+
+                min_x = core::min_(min_x, p.x_ / p.w_);
+                min_y = core::min_(min_y, p.y_ / p.w_);
+                max_x = core::max_(max_x, p.x_ / p.w_);
+                max_y = core::max_(max_y, p.y_ / p.w_);
+            }
+
+            const f32 width = core::clamp(max_x, -1.f, 1.f) - core::clamp(min_x, -1.f, 1.f);
+            const f32 height = core::clamp(max_y, -1.f, 1.f) - core::clamp(min_y, -1.f, 1.f);
+            return width > 0.f && height > 0.f ? width * height * 0.25f * screen_area : 0.f;
+        }
+
+        void COpenGLDriver::UpdateStreamingPriority(const scene::IMeshBuffer* mesh_buffer, const core::Matrixf& world)
+        {
+            if (texture_streamer_->GetPendingCount() == 0)
+                return;
+
+            // the area is only computed if one of the textures is pending
+            f32 area = -1.f;
+            for (u32 i = 0; i < MATERIAL_MAX_TEXTURES; ++i)
+            {
+                const ITexture* texture = material_.GetTexture(i);
+                if (texture == nullptr || !texture_streamer_->IsPending(texture))
+                    continue;
+
+                if (area < 0.f)
+                    area = GetScreenArea(mesh_buffer->GetBoundingBox(), world * matrices_[ETS_VIEW] * matrices_[ETS_PROJECTION], GetScreenSize());
+                texture_streamer_->RaisePriority(texture, area);
+            }
+        }
+
         //! creates a matrix in supplied GLfloat array to pass to OpenGL
         inline void COpenGLDriver::GetGLMatrix(f32 gl_matrix[16], const core::Matrixf& m)
         {
@@ -526,7 +709,7 @@ namespace kong
                     return texture;
                 }
 
-                texture = LoadTextureFromFile(file);
+                texture = LoadCachedTexture(file);
                 delete file;
 
                 if (texture)
@@ -577,6 +760,75 @@ namespace kong
             return texture;
         }
 
+        //! loads a Texture on the worker threads of the streamer
+        ITexture* COpenGLDriver::GetTextureAsync(const io::path& filename)
+        {
+            const io::path absolutePath = io_->GetAbsolutePath(filename);
+
+            ITexture* texture = FindTexture(absolutePath);
+            if (texture)
+                return texture;
+
+            texture = FindTexture(filename);
+            if (texture)
+                return texture;
+
+            io::IReadFile* file = io_->CreateAndOpenFile(absolutePath);
+            if (!file)
+                file = io_->CreateAndOpenFile(filename);
+            if (!file)
+                return nullptr;
+
+            texture = FindTexture(file->GetFileName());
+            if (texture)
+            {
+                delete file;
+                return texture;
+            }
+
+            // the placeholder gets the name of the file, so it is found again while it is pending
+            CImage placeholder(ECF_A8R8G8B8, core::Dimension2d<u32>(1, 1));
+            placeholder.Fill(SColor(255, 128, 128, 128));
+            COpenGLTexture* gl_texture = new COpenGLTexture(&placeholder, file->GetFileName(), nullptr, this);
+            gl_texture->SetHasSourceFile(true);
+            AddTexture(gl_texture);
+            texture_streamer_->AddRequest(gl_texture, file);
+            return gl_texture;
+        }
+
+        u32 COpenGLDriver::GetPendingTextureCount() const
+        {
+            return texture_streamer_->GetPendingCount();
+        }
+
+        void COpenGLDriver::SetTextureUploadBudget(u32 bytes)
+        {
+            texture_upload_budget_ = bytes;
+        }
+
+        void COpenGLDriver::SetTextureMemoryBudget(u32 bytes)
+        {
+            residency_manager_->SetBudget(bytes);
+        }
+
+        u32 COpenGLDriver::GetTextureMemorySize() const
+        {
+            return residency_manager_->GetResidentSize();
+        }
+
+        bool COpenGLDriver::ReloadTexture(COpenGLTexture* texture)
+        {
+            if (texture_streamer_->IsPending(texture))
+                return true;
+
+            io::IReadFile* file = io_->CreateAndOpenFile(texture->GetName().GetPath());
+            if (!file)
+                return false;
+
+            texture_streamer_->AddRequest(texture, file);
+            return true;
+        }
+
         //! Creates a texture from a loaded IImage.
         ITexture* COpenGLDriver::AddTexture(const io::path& name, IImage* image, void* mipmapData)
         {
@@ -634,6 +886,8 @@ namespace kong
                 //texture->grab();
 
                 textures_.PushBack(s);
+                if (texture->GetDriverType() == EDT_OPENGL)
+                    residency_manager_->AddTexture(static_cast<COpenGLTexture*>(texture));
 
                 // the new texture is now at the end of the texture list. when searching for
                 // the next new texture, the texture array will be sorted and the index of this texture
@@ -680,6 +934,28 @@ namespace kong
             return result;
         }
 
+        bool COpenGLDriver::IsCompressedFormatSupported(ECOLOR_FORMAT format) const
+        {
+            switch (format)
+            {
+            case ECF_BC1:
+            case ECF_BC2:
+            case ECF_BC3:
+                return GLEW_EXT_texture_compression_s3tc != 0;
+            case ECF_BC4:
+                // gray textures need the green and blue channels swizzled from red
+                return (GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc || GLEW_EXT_texture_compression_rgtc) &&
+                    (GLEW_VERSION_3_3 || GLEW_ARB_texture_swizzle);
+            case ECF_BC5:
+                return GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc || GLEW_EXT_texture_compression_rgtc;
+            case ECF_BC6H:
+            case ECF_BC7:
+                return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+            default:
+                return false;
+            }
+        }
+
         scene::IMeshManipulator* COpenGLDriver::GetMeshManipulator()
         {
             return mesh_manipulator_;
@@ -690,113 +966,48 @@ namespace kong
             if (!texture)
                 return;
 
-            if (texture->GetColorFormat() != ECF_A1R5G5B5 &&
-                texture->GetColorFormat() != ECF_A8R8G8B8)
+            COpenGLTexture* gl_texture = dynamic_cast<COpenGLTexture*>(texture);
+            if (gl_texture != nullptr && gl_texture->HasSourceFile())
             {
-                os::Printer::log("Error: Unsupported texture color format for making normal map.", ELL_ERROR);
-                return;
+                // the cache keeps the heights block compressed, BC4 has only 8 of them per 4x4 block,
+                // so they are decoded from the file again. Decoding does not change the driver.
+                IImage* source = const_cast<COpenGLDriver*>(this)->CreateImageFromFile(texture->GetName().GetPath());
+                if (source != nullptr && source->GetDimension() == texture->GetSize())
+                    gl_texture->SetImage(source);
+                delete source;
+
+                // the texture no longer shows the file, so it keeps its image when it is evicted
+                gl_texture->SetHasSourceFile(false);
             }
 
-            core::Dimension2d<u32> dim = texture->GetSize();
-            amplitude = amplitude / 255.0f;
-            f32 vh = dim.height_ / (f32)dim.width_;
-            f32 hh = dim.height_ / (f32)dim.height_;
+            // a block compressed file has no better heights than its blocks
+            if (gl_texture != nullptr && IImage::IsCompressedFormat(texture->GetColorFormat()))
+                gl_texture->ConvertImage(ECF_A8R8G8B8);
 
-            if (texture->GetColorFormat() == ECF_A8R8G8B8)
+            if (!CNormalMapGenerator::IsFormatSupported(texture->GetColorFormat()))
             {
-                // ECF_A8R8G8B8 version
-
-                s32 *p = static_cast<s32*>(texture->Lock());
-
-                if (!p)
-                {
-                    os::Printer::log("Could not lock texture for making normal map.", ELL_ERROR);
-                    return;
-                }
-
-                // copy texture
-
-                u32 pitch = texture->GetPitch() / 4;
-
-                s32* in = new s32[dim.height_ * pitch];
-                memcpy(in, p, dim.height_ * pitch * 4);
-
-                for (s32 x = 0; x < s32(pitch); ++x)
-                    for (s32 y = 0; y < s32(dim.height_); ++y)
-                    {
-                        // TODO: this could be optimized really a lot
-
-                        core::vector3df h1((x - 1)*hh, nml32(x - 1, y, pitch, dim.height_, in)*amplitude, y*vh);
-                        core::vector3df h2((x + 1)*hh, nml32(x + 1, y, pitch, dim.height_, in)*amplitude, y*vh);
-                        //core::vector3df v1(x*hh, nml32(x, y-1, pitch, dim.Height, in)*amplitude, (y-1)*vh);
-                        //core::vector3df v2(x*hh, nml32(x, y+1, pitch, dim.Height, in)*amplitude, (y+1)*vh);
-                        core::vector3df v1(x*hh, nml32(x, y + 1, pitch, dim.height_, in)*amplitude, (y - 1)*vh);
-                        core::vector3df v2(x*hh, nml32(x, y - 1, pitch, dim.height_, in)*amplitude, (y + 1)*vh);
-
-                        core::vector3df v = v1 - v2;
-                        core::vector3df h = h1 - h2;
-
-                        core::vector3df n = v.CrossProduct(h);
-                        n.Normalize();
-                        n *= 0.5f;
-                        n += core::vector3df(0.5f, 0.5f, 0.5f); // now between 0 and 1
-                        n *= 255.0f;
-
-                        s32 height = (s32)nml32(x, y, pitch, dim.height_, in);
-                        p[y*pitch + x] = video::SColor(
-                            height, // store height in alpha
-                            (s32)n.x_, (s32)n.z_, (s32)n.y_).color_;
-                    }
-
-                delete[] in;
-                texture->Unlock();
+                os::Printer::log("Error: Unsupported texture color format for making normal map.", ELL_ERROR);
+                return;
             }
-            else
-            {
-                // ECF_A1R5G5B5 version
-
-                s16 *p = (s16*)texture->Lock();
-
-                if (!p)
-                {
-                    os::Printer::log("Could not lock texture for making normal map.", ELL_ERROR);
-                    return;
-                }
-
-                u32 pitch = texture->GetPitch() / 2;
-
-                // copy texture
-
-                s16* in = new s16[dim.height_ * pitch];
-                memcpy(in, p, dim.height_ * pitch * 2);
-
-                for (s32 x = 0; x < s32(pitch); ++x)
-                    for (s32 y = 0; y < s32(dim.height_); ++y)
-                    {
-                        // TODO: this could be optimized really a lot
 
-                        core::vector3df h1((x - 1)*hh, nml16(x - 1, y, pitch, dim.height_, in)*amplitude, y*vh);
-                        core::vector3df h2((x + 1)*hh, nml16(x + 1, y, pitch, dim.height_, in)*amplitude, y*vh);
-                        core::vector3df v1(x*hh, nml16(x, y - 1, pitch, dim.height_, in)*amplitude, (y - 1)*vh);
-                        core::vector3df v2(x*hh, nml16(x, y + 1, pitch, dim.height_, in)*amplitude, (y + 1)*vh);
-
-                        core::vector3df v = v1 - v2;
-                        core::vector3df h = h1 - h2;
-
-                        core::vector3df n = v.CrossProduct(h);
-                        n.Normalize();
-                        n *= 0.5f;
-                        n += core::vector3df(0.5f, 0.5f, 0.5f); // now between 0 and 1
-                        n *= 255.0f;
-
-                        p[y*pitch + x] = video::RGBA16((u32)n.x_, (u32)n.z_, (u32)n.y_);
-                    }
-
-                delete[] in;
-                texture->Unlock();
+            void *data = texture->Lock();
+            if (!data)
+            {
+                os::Printer::log("Could not lock texture for making normal map.", ELL_ERROR);
+                return;
             }
 
-            texture->RegenerateMipMapLevels();
+            // normals are averaged as they are when the levels are filtered
+            if (gl_texture != nullptr)
+                gl_texture->SetSRGB(false);
+            CNormalMapGenerator::Make(data, texture->GetColorFormat(), texture->GetSize(), texture->GetPitch(), amplitude);
+            texture->Unlock();
+
+            // the shaders rebuild blue from red and green, the height in alpha is dropped
+            if (gl_texture != nullptr && texture->GetColorFormat() == ECF_A8R8G8B8 && IsCompressedFormatSupported(ECF_BC5))
+                gl_texture->ConvertImage(ECF_BC5, thread_pool_);
+            else
+                texture->RegenerateMipMapLevels();
         }
 
         const core::Dimension2d<u32>& COpenGLDriver::GetScreenSize() const
@@ -878,8 +1089,11 @@ namespace kong
             if (shadow_color_texture_ == nullptr)
             {
                 shadow_color_texture_ = new COpenGLFBOTexture(shadow_texture_size_, io::path(), this, false);
-                shadow_depth_texture_ = new COpenGLFBODepthTexture(shadow_texture_size_, io::path(), this, true);
+                shadow_depth_texture_ = new COpenGLFBODepthTexture(shadow_texture_size_, io::path(), this, true,
+                    GetMaximalShadowCascadeAmount());
                 shadow_depth_texture_->attach(shadow_color_texture_);
+                residency_manager_->AddRenderTarget(shadow_color_texture_);
+                residency_manager_->AddRenderTarget(shadow_depth_texture_);
             }
         }
 
@@ -891,6 +1105,38 @@ namespace kong
         {
         }
 
+        void COpenGLDriver::BeginShadowCascade(u32 cascade, const core::Matrixf& view, const core::Matrixf& projection, f32 split_depth)
+        {
+            SetTransform(ETS_LIGHT_VIEW, view);
+            SetTransform(ETS_LIGHT_PROJECTION, projection);
+        }
+
+        u32 COpenGLDriver::GetMaximalShadowCascadeAmount() const
+        {
+            return 1;
+        }
+
+        const core::Dimension2d<u32>& COpenGLDriver::GetShadowTextureSize() const
+        {
+            return shadow_texture_size_;
+        }
+
+        u32 COpenGLDriver::GetShadowAtlasSize() const
+        {
+            return 0;
+        }
+
+        void COpenGLDriver::AddShadowAtlasView(u32 light, const core::rect<s32>& tile, const core::Matrixf& view,
+            const core::Matrixf& projection, f32 split_depth)
+        {
+        }
+
+        void COpenGLDriver::BeginShadowAtlasTile(const core::rect<s32>& tile, const core::Matrixf& view, const core::Matrixf& projection)
+        {
+            SetTransform(ETS_LIGHT_VIEW, view);
+            SetTransform(ETS_LIGHT_PROJECTION, projection);
+        }
+
         void COpenGLDriver::setViewPort(const core::rect<s32>& area)
         {
             if (area == view_port_)
@@ -933,6 +1179,39 @@ namespace kong
         {
         }
 
+        IImage* COpenGLDriver::CreateScreenShot()
+        {
+            const core::Dimension2d<u32>& size = params_.window_size_;
+            CImage* image = new CImage(ECF_A8R8G8B8, size);
+            u8* pixels = static_cast<u8*>(image->Lock());
+            if (pixels == nullptr)
+            {
+                delete image;
+                return nullptr;
+            }
+
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadBuffer(GL_FRONT);
+            glReadPixels(0, 0, size.width_, size.height_, GL_BGRA, GL_UNSIGNED_BYTE, pixels);
+            glReadBuffer(GL_BACK);
+
+            // opengl returns the rows bottom up
+            const u32 pitch = image->GetPitch();
+            u8* row = new u8[pitch];
+            for (u32 i = 0; i < size.height_ / 2; ++i)
+            {
+                u8* top = pixels + i * pitch;
+                u8* bottom = pixels + (size.height_ - i - 1) * pitch;
+                memcpy(row, top, pitch);
+                memcpy(top, bottom, pitch);
+                memcpy(bottom, row, pitch);
+            }
+            delete[] row;
+
+            image->Unlock();
+            return image;
+        }
+
         void COpenGLDriver::UpdateMaxSupportLights()
         {
             max_support_lights_ = 8;
@@ -1037,4 +1316,6 @@ namespace kong
         }
 #endif
     }
-}
\ No newline at end of file
+}
+
+#endif // _KONG_COMPILE_WITH_OPENGL_
@@ -0,0 +1,180 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "COpenGLResidencyManager.h"
+
+#ifdef _KONG_COMPILE_WITH_OPENGL_
+
+#include "COpenGLTexture.h"
+
+namespace kong
+{
+    namespace video
+    {
+        COpenGLResidencyManager::COpenGLResidencyManager(const ReloadFunction& reload, u32 budget)
+            : reload_(reload), render_target_size_(0), budget_(budget), frame_(1)
+        {
+        }
+
+        void COpenGLResidencyManager::AddTexture(COpenGLTexture* texture)
+        {
+            // a new texture counts as bound, so it is not the first one to be evicted
+            texture->SetLastUseFrame(frame_);
+            textures_.PushBack(texture);
+        }
+
+        void COpenGLResidencyManager::AddRenderTarget(const COpenGLTexture* render_target)
+        {
+            render_target_size_ += render_target->GetMemorySize();
+        }
+
+        void COpenGLResidencyManager::SetBudget(u32 bytes)
+        {
+            budget_ = bytes;
+        }
+
+        u32 COpenGLResidencyManager::GetBudget() const
+        {
+            return budget_;
+        }
+
+        u32 COpenGLResidencyManager::GetResidentSize() const
+        {
+            u32 size = render_target_size_;
+            for (u32 i = 0; i < textures_.Size(); ++i)
+            {
+                size += textures_[i]->GetMemorySize();
+            }
+            return size;
+        }
+
+        void COpenGLResidencyManager::UseTexture(const COpenGLTexture* texture) const
+        {
+            texture->SetLastUseFrame(frame_);
+        }
+
+        bool COpenGLResidencyManager::Update()
+        {
+            ++frame_;
+            const u32 budget = budget_ != 0 ? budget_ : 0xffffffff;
+            u32 size = GetResidentSize();
+
+            // bytes the textures of the last frame need to get all their levels back
+            u32 missing_size = 0;
+            for (u32 i = 0; i < textures_.Size(); ++i)
+            {
+                if (IsUsed(textures_[i]))
+                {
+                    missing_size += textures_[i]->GetLevelsMemorySize(0) - textures_[i]->GetMemorySize();
+                }
+            }
+
+            bool uploaded = false;
+            for (s32 index = FindEvictable(); index != -1 && size + missing_size > budget; index = FindEvictable())
+            {
+                COpenGLTexture *texture = textures_[index];
+                const u32 memory_size = texture->GetMemorySize();
+                if (!texture->Evict())
+                {
+                    break;
+                }
+                size = size - memory_size + texture->GetMemorySize();
+                uploaded = true;
+            }
+
+            // the textures of the last frame get back as many levels as fit
+            for (u32 i = 0; i < textures_.Size(); ++i)
+            {
+                COpenGLTexture *texture = textures_[i];
+                const u32 first_level = texture->GetFirstResidentLevel();
+                if (first_level == 0 || !IsUsed(texture))
+                {
+                    continue;
+                }
+
+                const u32 memory_size = texture->GetMemorySize();
+                if (!texture->HasKeptImage())
+                {
+                    // only the file has the levels, it is streamed in completely
+                    const u32 full_size = texture->GetLevelsMemorySize(0);
+                    if (size - memory_size + full_size <= budget && reload_(texture))
+                    {
+                        size = size - memory_size + full_size;
+                    }
+                    continue;
+                }
+
+                u32 level = 0;
+                while (level < first_level && size - memory_size + texture->GetLevelsMemorySize(level) > budget)
+                {
+                    ++level;
+                }
+                if (level < first_level && texture->SetFirstResidentLevel(level))
+                {
+                    size = size - memory_size + texture->GetMemorySize();
+                    uploaded = true;
+                }
+            }
+
+            // the textures of one frame do not fit, so the largest ones lose their top level
+            for (s32 index = FindDroppable(); index != -1 && size > budget; index = FindDroppable())
+            {
+                COpenGLTexture *texture = textures_[index];
+                const u32 memory_size = texture->GetMemorySize();
+                if (!texture->SetFirstResidentLevel(texture->GetFirstResidentLevel() + 1))
+                {
+                    break;
+                }
+                size = size - memory_size + texture->GetMemorySize();
+                uploaded = true;
+            }
+
+            return uploaded;
+        }
+
+        bool COpenGLResidencyManager::IsUsed(const COpenGLTexture* texture) const
+        {
+            return texture->GetLastUseFrame() + 1 >= frame_;
+        }
+
+        s32 COpenGLResidencyManager::FindEvictable() const
+        {
+            s32 result = -1;
+            for (u32 i = 0; i < textures_.Size(); ++i)
+            {
+                const COpenGLTexture *texture = textures_[i];
+                if (IsUsed(texture) || !texture->HasKeptImage() ||
+                    texture->GetFirstResidentLevel() >= texture->GetEvictedLevel())
+                {
+                    continue;
+                }
+                if (result == -1 || texture->GetLastUseFrame() < textures_[result]->GetLastUseFrame())
+                {
+                    result = i;
+                }
+            }
+            return result;
+        }
+
+        s32 COpenGLResidencyManager::FindDroppable() const
+        {
+            s32 result = -1;
+            for (u32 i = 0; i < textures_.Size(); ++i)
+            {
+                const COpenGLTexture *texture = textures_[i];
+                if (!texture->HasKeptImage() || texture->GetFirstResidentLevel() >= texture->GetEvictedLevel())
+                {
+                    continue;
+                }
+                if (result == -1 || texture->GetMemorySize() > textures_[result]->GetMemorySize())
+                {
+                    result = i;
+                }
+            }
+            return result;
+        }
+
+    } // end namespace video
+} // end namespace kong
+
+#endif
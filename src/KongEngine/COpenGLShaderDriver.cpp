@@ -1,6 +1,10 @@
 // Copyright (C) 2018 Lyu Luan
 // This file is part of the "Kong Engine".
 
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_OPENGL_
+
 #include "COpenGLShaderDriver.h"
 #include "GL/glew.h"
 #include "S3DVertex.h"
@@ -8,22 +12,140 @@
 #include "COpenGLTexture.h"
 #include "COpenGLShaderHelper.h"
 #include "os.h"
+#include "KongMath.h"
+#include <cstring>
 
 namespace kong
 {
     namespace video
     {
+        //! opengl buffer usage for a hardware mapping hint
+        static GLenum GetBufferUsage(scene::E_HARDWARE_MAPPING mapping)
+        {
+            switch (mapping)
+            {
+            case scene::EHM_STATIC:
+                return GL_STATIC_DRAW;
+            case scene::EHM_DYNAMIC:
+                return GL_DYNAMIC_DRAW;
+            case scene::EHM_NEVER:
+            case scene::EHM_STREAM:
+            default:
+                return GL_STREAM_DRAW;
+            }
+        }
+
+        //! first of the four attribute locations of the instance transform, aInstanceTransform in the shaders
+        static const GLuint INSTANCE_TRANSFORM_LOCATION = 7;
+
+        //! materials drawn with the tangent vertex layout
+        static bool IsTangentMaterial(const SMaterial& material)
+        {
+            return material.MaterialType == EMT_NORMAL_MAP_SOLID || material.MaterialType == EMT_PARALLAX_MAP_SOLID
+                || material.MaterialType == EMT_PARALLAX_MAP_TRANSPARENT_ADD_COLOR || material.MaterialType == EMT_PARALLAX_MAP_TRANSPARENT_ADD_COLOR;
+        }
+
+        //! returns the GL type and the size in bytes of an index
+        static GLenum GetIndexType(E_INDEX_TYPE type, u32 &index_size)
+        {
+            index_size = type == EIT_32BIT ? sizeof(u32) : sizeof(u16);
+            return type == EIT_32BIT ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+        }
+
+        //! texture coordinates up to this size are uploaded as half floats, which keep 10 bits of their fraction there
+        static const f32 MAX_HALF_TEXCOORD = 2.f;
+
+        //! converts a float to a half float, rounds to nearest and flushes values too small for a normal half to zero
+        static u16 ToHalfFloat(f32 value)
+        {
+            const u32 bits = core::IR(value);
+            const u16 sign = static_cast<u16>((bits >> 16) & 0x8000);
+            const s32 exponent = static_cast<s32>((bits >> 23) & 0xff) - 127 + 15;
+            const u32 mantissa = bits & 0x7fffff;
+            if (exponent <= 0)
+            {
+                return sign;
+            }
+            if (exponent >= 31)
+            {
+                return sign | 0x7c00;
+            }
+
+            // a carry out of the mantissa correctly moves on to the next exponent
+            u32 half = (static_cast<u32>(exponent) << 10) | (mantissa >> 13);
+            if (mantissa & 0x1000)
+            {
+                ++half;
+            }
+            return sign | static_cast<u16>(half);
+        }
+
+        //! packs a vector with components in [-1, 1] into a normalized GL_INT_2_10_10_10_REV value
+        static u32 PackSnorm1010102(const core::Vector3Df& v)
+        {
+            const s32 x = static_cast<s32>(core::round_(core::clamp(v.x_, -1.f, 1.f) * 511.f));
+            const s32 y = static_cast<s32>(core::round_(core::clamp(v.y_, -1.f, 1.f) * 511.f));
+            const s32 z = static_cast<s32>(core::round_(core::clamp(v.z_, -1.f, 1.f) * 511.f));
+            return (static_cast<u32>(x) & 0x3ff) | ((static_cast<u32>(y) & 0x3ff) << 10) | ((static_cast<u32>(z) & 0x3ff) << 20);
+        }
+
+        //! maps value from [low, low + extent] to a normalized 16 bit integer
+        static u16 QuantizeUnorm16(f32 value, f32 low, f32 extent)
+        {
+            if (extent <= 0.f)
+            {
+                return 0;
+            }
+            return static_cast<u16>(core::round_(core::clamp((value - low) / extent, 0.f, 1.f) * 65535.f));
+        }
+
+        //! uploads data into a buffer object, reuses its storage if it is large enough
+        static void UploadBufferData(GLenum target, u32 buffer, u32 &buffer_size, u32 size, const void *data, scene::E_HARDWARE_MAPPING mapping)
+        {
+            glBindBuffer(target, buffer);
+            if (mapping != scene::EHM_NEVER && mapping != scene::EHM_STREAM && size <= buffer_size)
+            {
+                glBufferSubData(target, 0, size, data);
+            }
+            else
+            {
+                glBufferData(target, size, data, GetBufferUsage(mapping));
+                buffer_size = size;
+            }
+        }
 
         COpenGLShaderDriver::COpenGLShaderDriver(const SKongCreationParameters& params, io::IFileSystem* file_system, CKongDeviceWin32* device,
             io::SPath vertex_path, io::SPath fragment_path)
             : COpenGLDriver(params, file_system, device), shader_helper_(nullptr), shadow_shader_helper_(nullptr),
             base_shader_helper_(nullptr), fxaa_shader_helper_(nullptr), vao_(0), vbo_(0), ebo_(0),
-              vertex_path_(vertex_path), fragment_path_(fragment_path)
+              instance_vbo_(0), instance_vbo_size_(0),
+              material_block_(), normal_mapping_program_(nullptr), normal_mapping_on_(false), position_program_(nullptr), nr_lights_(4), shadow_cascade_count_(0), stream_link_(nullptr), vertex_path_(vertex_path), fragment_path_(fragment_path)
         {
+            for (u32 i = 0; i < SUB_COUNT; i++)
+            {
+                uniform_buffers_[i] = 0;
+            }
+            for (u32 i = 0; i < 4; i++)
+            {
+                position_scale_[i] = 0.f;
+                position_offset_[i] = 0.f;
+            }
+            for (u32 i = 0; i < MAX_SHADOW_CASCADES; i++)
+            {
+                shadow_cascade_splits_[i] = 0.f;
+            }
         }
 
         COpenGLShaderDriver::~COpenGLShaderDriver()
         {
+            RemoveAllHardwareBuffers();
+            DeleteHardwareBuffer(stream_link_.wire_link_);
+            glDeleteBuffers(1, &instance_vbo_);
+            glDeleteBuffers(1, &ebo_);
+            glDeleteBuffers(1, &vbo_);
+            glDeleteVertexArrays(1, &vao_);
+            glDeleteBuffers(SUB_COUNT, uniform_buffers_);
+
             delete shadow_shader_helper_;
             delete base_shader_helper_;
             delete fxaa_shader_helper_;
@@ -45,12 +167,32 @@ namespace kong
             glGenVertexArrays(1, &vao_);
             glGenBuffers(1, &vbo_);
             glGenBuffers(1, &ebo_);
+            glGenBuffers(1, &instance_vbo_);
+            stream_link_.vao_ = vao_;
+            stream_link_.vbo_ = vbo_;
+            stream_link_.ebo_ = ebo_;
 
             if (shader_helper_ == nullptr)
             {
                 return false;
             }
 
+            // one buffer per uniform block, shared by all programs
+            glGenBuffers(SUB_COUNT, uniform_buffers_);
+            glBindBuffer(GL_UNIFORM_BUFFER, uniform_buffers_[SUB_MATERIAL]);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(SShaderMaterial), &material_block_, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_UNIFORM_BUFFER, uniform_buffers_[SUB_LIGHTS]);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(SShaderLight) * nr_lights_, nullptr, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            for (u32 i = 0; i < SUB_COUNT; i++)
+            {
+                glBindBufferBase(GL_UNIFORM_BUFFER, i, uniform_buffers_[i]);
+            }
+
+            BindUniformBlocks(base_shader_helper_);
+            BindUniformBlocks(shadow_shader_helper_);
+            BindUniformBlocks(fxaa_shader_helper_);
+
             shadow_shader_helper_->Use();
             shadow_shader_helper_->SetBool("test_on", false);
 
@@ -58,6 +200,7 @@ namespace kong
             shader_helper_->SetBool("texture0_on", false);
             shader_helper_->SetBool("texture1_on", false);
             shader_helper_->SetBool("normal_mapping_on", false);
+            shader_helper_->SetBool("instancing_on", false);
             shader_helper_->SetBool("light_on", false);
             shader_helper_->SetBool("light0_on", false);
 
@@ -73,52 +216,49 @@ namespace kong
 #ifdef _DEBUG
             CheckError();
 #endif
-            GLfloat data[4];
-            data[0] = material.ambient_color_.GetRed() / 255.f;
-            data[1] = material.ambient_color_.GetGreen() / 255.f;
-            data[2] = material.ambient_color_.GetBlue() / 255.f;
-            data[3] = material.ambient_color_.GetAlpha() / 255.f;
-            SetMaterialUniform(SL_MAT_AMBIENT, data);
-#ifdef _DEBUG
-            CheckError();
-#endif
-
-            data[0] = material.diffuse_color_.GetRed() / 255.f;
-            data[1] = material.diffuse_color_.GetGreen() / 255.f;
-            data[2] = material.diffuse_color_.GetBlue() / 255.f;
-            data[3] = material.diffuse_color_.GetAlpha() / 255.f;
-            SetMaterialUniform(SL_MAT_DIFFUSE, data);
-
-            data[0] = material.specular_color_.GetRed() / 255.f;
-            data[1] = material.specular_color_.GetGreen() / 255.f;
-            data[2] = material.specular_color_.GetBlue() / 255.f;
-            data[3] = material.specular_color_.GetAlpha() / 255.f;
-            SetMaterialUniform(SL_MAT_SPECULAR, data);
-
-            data[0] = material.emissive_color_.GetRed() / 255.f;
-            data[1] = material.emissive_color_.GetGreen() / 255.f;
-            data[2] = material.emissive_color_.GetBlue() / 255.f;
-            data[3] = material.emissive_color_.GetAlpha() / 255.f;
-            SetMaterialUniform(SL_MAT_EMISSIVE, data);
-
-#ifdef _DEBUG
-            CheckError();
-#endif
-
-            SetMaterialUniform(SL_MAT_SHININESS, material.shininess_);
+            SShaderMaterial block;
+            block.ambient[0] = material.ambient_color_.GetRed() / 255.f;
+            block.ambient[1] = material.ambient_color_.GetGreen() / 255.f;
+            block.ambient[2] = material.ambient_color_.GetBlue() / 255.f;
+            block.ambient[3] = material.ambient_color_.GetAlpha() / 255.f;
+
+            block.diffuse[0] = material.diffuse_color_.GetRed() / 255.f;
+            block.diffuse[1] = material.diffuse_color_.GetGreen() / 255.f;
+            block.diffuse[2] = material.diffuse_color_.GetBlue() / 255.f;
+            block.diffuse[3] = material.diffuse_color_.GetAlpha() / 255.f;
+
+            block.specular[0] = material.specular_color_.GetRed() / 255.f;
+            block.specular[1] = material.specular_color_.GetGreen() / 255.f;
+            block.specular[2] = material.specular_color_.GetBlue() / 255.f;
+            block.specular[3] = material.specular_color_.GetAlpha() / 255.f;
+
+            block.emissive[0] = material.emissive_color_.GetRed() / 255.f;
+            block.emissive[1] = material.emissive_color_.GetGreen() / 255.f;
+            block.emissive[2] = material.emissive_color_.GetBlue() / 255.f;
+            block.emissive[3] = material.emissive_color_.GetAlpha() / 255.f;
+
+            block.shininess = material.shininess_;
+            block.padding[0] = block.padding[1] = block.padding[2] = 0.f;
+
+            // the block is shared by all programs, only upload it when it changes
+            if (memcmp(&block, &material_block_, sizeof(SShaderMaterial)) != 0)
+            {
+                material_block_ = block;
+                glBindBuffer(GL_UNIFORM_BUFFER, uniform_buffers_[SUB_MATERIAL]);
+                glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(SShaderMaterial), &material_block_);
+                glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            }
 
 #ifdef _DEBUG
             CheckError();
 #endif
 
-            if (material.MaterialType == EMT_NORMAL_MAP_SOLID || material.MaterialType == EMT_PARALLAX_MAP_SOLID
-                || material.MaterialType == EMT_PARALLAX_MAP_TRANSPARENT_ADD_COLOR || material.MaterialType == EMT_PARALLAX_MAP_TRANSPARENT_ADD_COLOR)
+            const bool normal_mapping_on = IsTangentMaterial(material);
+            if (normal_mapping_program_ != shader_helper_ || normal_mapping_on_ != normal_mapping_on)
             {
-                shader_helper_->SetBool("normal_mapping_on", true);
-            }
-            else
-            {
-                shader_helper_->SetBool("normal_mapping_on", false);
+                shader_helper_->SetBool("normal_mapping_on", normal_mapping_on);
+                normal_mapping_program_ = shader_helper_;
+                normal_mapping_on_ = normal_mapping_on;
             }
 #ifdef _DEBUG
             CheckError();
@@ -160,8 +300,9 @@ namespace kong
 
         void COpenGLShaderDriver::DrawMeshBuffer(const scene::IMeshBuffer* mesh_buffer)
         {
-            if (material_.MaterialType == EMT_NORMAL_MAP_SOLID || material_.MaterialType == EMT_PARALLAX_MAP_SOLID
-                || material_.MaterialType == EMT_PARALLAX_MAP_TRANSPARENT_ADD_COLOR || material_.MaterialType == EMT_PARALLAX_MAP_TRANSPARENT_ADD_COLOR)
+            UpdateStreamingPriority(mesh_buffer, matrices_[ETS_WORLD]);
+
+            if (IsTangentMaterial(material_))
             {
                 DrawTangentMeshBuffer(mesh_buffer);
             }
@@ -171,6 +312,43 @@ namespace kong
             }
         }
 
+        void COpenGLShaderDriver::DrawMeshBufferInstanced(const scene::IMeshBuffer* mesh_buffer, const core::Matrixf* transforms, u32 count)
+        {
+            const GLsizei indices_count = mesh_buffer->GetIndexCount();
+            if (indices_count == 0 || count == 0)
+            {
+                return;
+            }
+
+            for (u32 i = 0; i < count; ++i)
+            {
+                UpdateStreamingPriority(mesh_buffer, transforms[i]);
+            }
+
+            SHWBufferLink *link = UpdateHardwareBuffer(GetBufferLink(mesh_buffer), IsTangentMaterial(material_));
+
+            UploadBufferData(GL_ARRAY_BUFFER, instance_vbo_, instance_vbo_size_, sizeof(core::Matrixf) * count,
+                transforms, scene::EHM_STREAM);
+            SetInstanceAttributes(link, true);
+
+            // the shaders take the world transform from the instance attributes instead of world_transform
+            shader_helper_->Use();
+            SetPositionTransform(link);
+            shader_helper_->SetBool("instancing_on", true);
+            if (link->expanded_)
+            {
+                glDrawArraysInstanced(GL_TRIANGLES, 0, indices_count, count);
+            }
+            else
+            {
+                u32 index_size;
+                const GLenum index_type = GetIndexType(mesh_buffer->GetIndexType(), index_size);
+                glDrawElementsInstanced(GL_TRIANGLES, indices_count, index_type, nullptr, count);
+            }
+            shader_helper_->SetBool("instancing_on", false);
+            glBindVertexArray(0);
+        }
+
         bool COpenGLShaderDriver::SetActiveTexture(u32 stage, const video::ITexture* texture)
         {
             if (!render_material_texture_on_)
@@ -181,8 +359,6 @@ namespace kong
 
             current_texture_.Set(stage, texture);
 
-            core::stringc str_on = core::stringc("texture") + core::stringc(stage) + "_on";
-            
             shader_helper_->Use();
             if (texture == nullptr)
             {
@@ -202,14 +378,14 @@ namespace kong
                 shader_helper_->SetInt(GetUniformName(SL_TEXTURE0 + stage), stage);
                 glActiveTexture(GL_TEXTURE0 + stage);
                 glBindTexture(GL_TEXTURE_2D, dynamic_cast<const COpenGLTexture*>(texture)->GetOpenGLTextureName());
-                shader_helper_->SetBool(str_on.c_str(), true);
+                Enable(SL_TEXTURE0 + stage);
             }
             return true;
         }
 
         void COpenGLShaderDriver::DeleteAllDynamicLights()
         {
-            for (auto i = 0; i < max_support_lights_; i++)
+            for (u32 i = 0; i < GetDynamicLightCount(); i++)
             {
                 Disable(SL_LIGHT0 + i);
             }
@@ -219,84 +395,9 @@ namespace kong
 
         s32 COpenGLShaderDriver::AddDynamicLight(const SLight& light)
         {
-            const int lidx = SL_LIGHT0 + GetDynamicLightCount();
-            GLfloat data[4];
-
-            switch (light.type_)
-            {
-            case video::ELT_SPOT:
-                data[0] = light.direction_.x_;
-                data[1] = light.direction_.y_;
-                data[2] = light.direction_.z_;
-                data[3] = 0.0f;
-                SetLightUniform(lidx, SL_LIGHT_DIRECTION, data);
-
-                // set position
-                data[0] = light.position_.x_;
-                data[1] = light.position_.y_;
-                data[2] = light.position_.z_;
-                data[3] = 1.0f; // 1.0f for positional light
-                SetLightUniform(lidx, SL_LIGHT_POSITION, data);
-
-                SetLightUniform(lidx, SL_LIGHT_EXPONENT, light.falloff_);
-                SetLightUniform(lidx, SL_LIGHT_CUTOFF, light.outer_cone_);
-                break;
-            case video::ELT_POINT:
-                // set position
-                data[0] = light.position_.x_;
-                data[1] = light.position_.y_;
-                data[2] = light.position_.z_;
-                data[3] = 1.0f; // 1.0f for positional light
-                SetLightUniform(lidx, SL_LIGHT_POSITION, data);
-
-                SetLightUniform(lidx, SL_LIGHT_EXPONENT, 0.0f);
-                SetLightUniform(lidx, SL_LIGHT_CUTOFF, 180.0f);
-                break;
-            case video::ELT_DIRECTIONAL:
-                // set direction
-                data[0] = -light.direction_.x_;
-                data[1] = -light.direction_.y_;
-                data[2] = -light.direction_.z_;
-                data[3] = 0.0f; // 0.0f for directional light
-                SetLightUniform(lidx, SL_LIGHT_POSITION, data);
-
-                SetLightUniform(lidx, SL_LIGHT_EXPONENT, 0.0f);
-                SetLightUniform(lidx, SL_LIGHT_CUTOFF, 180.0f);
-                break;
-            default:
-                break;
-            }
-
-            // set diffuse color
-            data[0] = light.diffuse_color_.r;
-            data[1] = light.diffuse_color_.g;
-            data[2] = light.diffuse_color_.b;
-            data[3] = light.diffuse_color_.a;
-            SetLightUniform(lidx, SL_LIGHT_DIFFUSE, data);
-
-            // set specular color
-            data[0] = light.specular_color_.r;
-            data[1] = light.specular_color_.g;
-            data[2] = light.specular_color_.b;
-            data[3] = light.specular_color_.a;
-            SetLightUniform(lidx, SL_LIGHT_SPECULAR, data);
-
-            // set ambient color
-            data[0] = light.ambient_color_.r;
-            data[1] = light.ambient_color_.g;
-            data[2] = light.ambient_color_.b;
-            data[3] = light.ambient_color_.a;
-            SetLightUniform(lidx, SL_LIGHT_AMBIENT, data);
-
-            // 1.0f / (constant + linear * d + quadratic*(d*d);
-
-            // set attenuation
-            data[0] = light.attenuation_.x_;
-            data[1] = light.attenuation_.y_;
-            data[2] = light.attenuation_.z_;
-            SetLightUniform(lidx, SL_LIGHT_ATTENUATION, data);
-
-            Enable(lidx);
+            const u32 idx = GetDynamicLightCount();
+            UpdateLightBlock(idx, light);
+            Enable(SL_LIGHT0 + idx);
 
             shader_helper_->SetBool("light_on", true);
             return COpenGLDriver::AddDynamicLight(light);
@@ -325,11 +426,35 @@ namespace kong
                 shadow_color_texture_->bindRTT();
             }
 
-            ClearBuffers(color_buffer_clear_, z_buffer_clear_, false, color_clear_);
+            // the layers are cleared when their cascade begins
+            shadow_cascade_count_ = 0;
             //glEnable(GL_CULL_FACE); // enables face culling    
             //glCullFace(GL_FRONT); // tells OpenGL to cull back faces (the sane default setting)
         }
 
+        void COpenGLShaderDriver::BeginShadowCascade(u32 cascade, const core::Matrixf& view, const core::Matrixf& projection, f32 split_depth)
+        {
+            if (cascade >= MAX_SHADOW_CASCADES || shadow_depth_texture_ == nullptr)
+            {
+                return;
+            }
+
+            shadow_depth_texture_->AttachLayer(cascade);
+            ClearBuffers(color_buffer_clear_, z_buffer_clear_, false, color_clear_);
+
+            SetTransform(ETS_LIGHT_VIEW, view);
+            SetTransform(ETS_LIGHT_PROJECTION, projection);
+
+            shadow_cascade_transforms_[cascade] = view * projection;
+            shadow_cascade_splits_[cascade] = split_depth;
+            shadow_cascade_count_ = core::max_(shadow_cascade_count_, cascade + 1);
+        }
+
+        u32 COpenGLShaderDriver::GetMaximalShadowCascadeAmount() const
+        {
+            return MAX_SHADOW_CASCADES;
+        }
+
         void COpenGLShaderDriver::EndShadowRender()
         {
             //glCullFace(GL_BACK); // tells OpenGL to cull back faces (the sane default setting)
@@ -347,7 +472,8 @@ namespace kong
 
             shader_helper_->SetInt(GetUniformName(SL_TEXTURE0 + 4), 4);
             glActiveTexture(GL_TEXTURE0 + 4);
-            glBindTexture(GL_TEXTURE_2D, dynamic_cast<const COpenGLTexture*>(shadow_depth_texture_)->GetOpenGLTextureName());
+            glBindTexture(shadow_depth_texture_->GetOpenGLTextureTarget(), shadow_depth_texture_->GetOpenGLTextureName());
+            SetShadowCascadeUniforms();
             //shader_helper_->SetBool("shadow_on", true);
         }
 
@@ -365,154 +491,497 @@ namespace kong
 
         void COpenGLShaderDriver::DrawNormalMeshBuffer(const scene::IMeshBuffer* mesh_buffer)
         {
-            const S3DVertex *vertices = static_cast<const S3DVertex*>(mesh_buffer->GetVertices());
-            u32 vertice_count = mesh_buffer->GetVertexCount();
-            const u16 *indices = mesh_buffer->GetIndices();
-            const GLsizei indices_count = mesh_buffer->GetIndexCount();
+            DrawHardwareBuffer(mesh_buffer, false);
+        }
 
-            glBindVertexArray(vao_);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(S3DVertex)* vertice_count, vertices, GL_STATIC_DRAW);
+        void COpenGLShaderDriver::DrawTangentMeshBuffer(const scene::IMeshBuffer* mesh_buffer)
+        {
+            DrawHardwareBuffer(mesh_buffer, true);
+        }
 
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u16)* indices_count, indices, GL_STATIC_DRAW);
+        void COpenGLShaderDriver::RemoveHardwareBuffer(const scene::IMeshBuffer* mesh_buffer)
+        {
+            core::Map<const scene::IMeshBuffer*, SHWBufferLink*>::Node *node = hw_buffer_map_.find(mesh_buffer);
+            if (node == nullptr)
+            {
+                return;
+            }
 
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(S3DVertex), reinterpret_cast<void *>(offsetof(S3DVertex, pos_)));
-            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(S3DVertex), reinterpret_cast<void *>(offsetof(S3DVertex, normal_)));
-            glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(S3DVertex), reinterpret_cast<void *>(offsetof(S3DVertex, color_)));
-            glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(S3DVertex), reinterpret_cast<void *>(offsetof(S3DVertex, texcoord_)));
+            DeleteHardwareBuffer(node->getValue());
+            hw_buffer_map_.remove(node);
+        }
 
-            glEnableVertexAttribArray(0);
-            glEnableVertexAttribArray(1);
-            glEnableVertexAttribArray(2);
-            glEnableVertexAttribArray(3);
+        void COpenGLShaderDriver::RemoveAllHardwareBuffers()
+        {
+            core::Map<const scene::IMeshBuffer*, SHWBufferLink*>::Iterator it = hw_buffer_map_.getIterator();
+            for (; !it.atEnd(); it++)
+            {
+                DeleteHardwareBuffer(it->getValue());
+            }
+            hw_buffer_map_.clear();
+        }
 
-            if (rendering_mode_ == ERM_WIREFRAME)
+        void COpenGLShaderDriver::DrawHardwareBuffer(const scene::IMeshBuffer* mesh_buffer, bool tangent_layout)
+        {
+            const GLsizei indices_count = mesh_buffer->GetIndexCount();
+            if (indices_count == 0)
             {
-                glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(S3DVertex), reinterpret_cast<void *>(offsetof(S3DVertex, barycentric_)));
-                glEnableVertexAttribArray(4);
+                return;
             }
 
+            SHWBufferLink *link = UpdateHardwareBuffer(GetBufferLink(mesh_buffer), tangent_layout);
+            SetInstanceAttributes(link, false);
+
             shader_helper_->Use();
-            glBindVertexArray(vao_);
-            glDrawElements(GL_TRIANGLES, indices_count, GL_UNSIGNED_SHORT, nullptr);
-            //glBindVertexArray(0);
+            SetPositionTransform(link);
+            if (link->expanded_)
+            {
+                glDrawArrays(GL_TRIANGLES, 0, indices_count);
+            }
+            else
+            {
+                u32 index_size;
+                const GLenum index_type = GetIndexType(mesh_buffer->GetIndexType(), index_size);
+                glDrawElements(GL_TRIANGLES, indices_count, index_type, nullptr);
+            }
+            glBindVertexArray(0);
         }
 
-        void COpenGLShaderDriver::DrawTangentMeshBuffer(const scene::IMeshBuffer* mesh_buffer)
+        COpenGLShaderDriver::SHWBufferLink* COpenGLShaderDriver::GetBufferLink(const scene::IMeshBuffer* mesh_buffer)
         {
-            const S3DVertexTangents *vertices = static_cast<const S3DVertexTangents*>(mesh_buffer->GetVertices());
-            u32 vertice_count = mesh_buffer->GetVertexCount();
-            const u16 *indices = mesh_buffer->GetIndices();
-            const GLsizei indices_count = mesh_buffer->GetIndexCount();
+            if (mesh_buffer->GetHardwareMappingHintVertex() == scene::EHM_NEVER ||
+                mesh_buffer->GetHardwareMappingHintIndex() == scene::EHM_NEVER)
+            {
+                // shared buffers, other draws may have changed their content and layout
+                stream_link_.mesh_buffer_ = mesh_buffer;
+                stream_link_.vertices_ = nullptr;
+                stream_link_.attributes_set_ = false;
+                return &stream_link_;
+            }
+
+            core::Map<const scene::IMeshBuffer*, SHWBufferLink*>::Node *node = hw_buffer_map_.find(mesh_buffer);
+            if (node != nullptr)
+            {
+                return node->getValue();
+            }
+
+            SHWBufferLink *link = CreateBufferLink(mesh_buffer);
+            hw_buffer_map_.insert(mesh_buffer, link);
+            return link;
+        }
+
+        COpenGLShaderDriver::SHWBufferLink* COpenGLShaderDriver::CreateBufferLink(const scene::IMeshBuffer* mesh_buffer) const
+        {
+            SHWBufferLink *link = new SHWBufferLink(mesh_buffer);
+            glGenVertexArrays(1, &link->vao_);
+            glGenBuffers(1, &link->vbo_);
+            glGenBuffers(1, &link->ebo_);
+            return link;
+        }
+
+        COpenGLShaderDriver::SHWBufferLink* COpenGLShaderDriver::UpdateHardwareBuffer(SHWBufferLink* link, bool tangent_layout)
+        {
+            const scene::IMeshBuffer *mesh_buffer = link->mesh_buffer_;
+            const bool is_stream_link = link == &stream_link_;
+            const scene::E_HARDWARE_MAPPING mapping_vertex = is_stream_link ? scene::EHM_NEVER : mesh_buffer->GetHardwareMappingHintVertex();
+            const scene::E_HARDWARE_MAPPING mapping_index = is_stream_link ? scene::EHM_NEVER : mesh_buffer->GetHardwareMappingHintIndex();
+
+            // wireframe draws read an unindexed copy, the shaders need the corner of every vertex
+            const bool expand = rendering_mode_ == ERM_WIREFRAME;
+            if (expand)
+            {
+                if (link->wire_link_ == nullptr)
+                {
+                    link->wire_link_ = CreateBufferLink(mesh_buffer);
+                    link->wire_link_->expanded_ = true;
+                }
+                link = link->wire_link_;
+
+                if (is_stream_link)
+                {
+                    link->mesh_buffer_ = mesh_buffer;
+                    link->vertices_ = nullptr;
+                }
+            }
+
+            // a different vertex array means the address of a deleted buffer got reused
+            const bool new_source = link->vertices_ != mesh_buffer->GetVertices();
+
+            glBindVertexArray(link->vao_);
+
+            // the layout decides which attributes are packed, an expanded copy depends on the indices too
+            if (new_source || link->tangent_layout_ != tangent_layout ||
+                link->changed_id_vertex_ != mesh_buffer->GetVertexChangedID() || link->mapping_vertex_ != mapping_vertex ||
+                (expand && link->changed_id_index_ != mesh_buffer->GetIndexChangedID()))
+            {
+                if (link->mapping_vertex_ != mapping_vertex)
+                {
+                    link->vbo_size_ = 0;
+                }
+
+                PackVertices(mesh_buffer, tangent_layout, expand, link->layout_);
+                UploadBufferData(GL_ARRAY_BUFFER, link->vbo_, link->vbo_size_, packed_vertices_.Size(),
+                    packed_vertices_.ConstPointer(), mapping_vertex);
+
+                // the attribute stream starts behind the positions, so its offset moves with the vertex count
+                link->attributes_set_ = false;
+                link->vertices_ = mesh_buffer->GetVertices();
+                link->changed_id_vertex_ = mesh_buffer->GetVertexChangedID();
+                link->mapping_vertex_ = mapping_vertex;
+                link->tangent_layout_ = tangent_layout;
+                if (expand)
+                {
+                    link->changed_id_index_ = mesh_buffer->GetIndexChangedID();
+                }
+            }
+
+            if (!expand && (new_source || link->changed_id_index_ != mesh_buffer->GetIndexChangedID() || link->mapping_index_ != mapping_index))
+            {
+                if (link->mapping_index_ != mapping_index)
+                {
+                    link->ebo_size_ = 0;
+                }
+
+                // element array binding is part of the vertex array state
+                u32 index_size;
+                GetIndexType(mesh_buffer->GetIndexType(), index_size);
+                UploadBufferData(GL_ELEMENT_ARRAY_BUFFER, link->ebo_, link->ebo_size_, index_size * mesh_buffer->GetIndexCount(),
+                    mesh_buffer->GetIndices(), mapping_index);
+
+                link->changed_id_index_ = mesh_buffer->GetIndexChangedID();
+                link->mapping_index_ = mapping_index;
+            }
+
+            if (!link->attributes_set_)
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, link->vbo_);
+                SetVertexAttributes(link);
+                link->attributes_set_ = true;
+            }
 
-            glBindVertexArray(vao_);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(S3DVertexTangents) * vertice_count, vertices, GL_STATIC_DRAW);
+#ifdef _DEBUG
+            CheckError();
+#endif
+            return link;
+        }
+
+        void COpenGLShaderDriver::PackVertices(const scene::IMeshBuffer* mesh_buffer, bool tangent_layout, bool expand, SVertexLayout& layout)
+        {
+            u32 pitch = sizeof(S3DVertex);
+            switch (mesh_buffer->GetVertexType())
+            {
+            case EVT_2TCOORDS:
+                pitch = sizeof(S3DVertex2TCoords);
+                break;
+            case EVT_TANGENTS:
+                pitch = sizeof(S3DVertexTangents);
+                break;
+            default:
+                break;
+            }
+
+            // all vertex types start with the members of S3DVertex
+            const u8 *source = static_cast<const u8*>(mesh_buffer->GetVertices());
+            const u32 count = expand ? mesh_buffer->GetIndexCount() : mesh_buffer->GetVertexCount();
+            auto vertex = [&](u32 i) -> const S3DVertex&
+            {
+                return *reinterpret_cast<const S3DVertex*>(source + pitch * (expand ? mesh_buffer->GetIndex(i) : i));
+            };
+
+            core::aabbox3df box;
+            bool half_texcoords = true;
+            for (u32 i = 0; i < count; ++i)
+            {
+                const S3DVertex &v = vertex(i);
+                if (i == 0)
+                {
+                    box.reset(v.pos_);
+                }
+                else
+                {
+                    box.addInternalPoint(v.pos_);
+                }
+                half_texcoords = half_texcoords && fabsf(v.texcoord_.x_) <= MAX_HALF_TEXCOORD && fabsf(v.texcoord_.y_) <= MAX_HALF_TEXCOORD;
+            }
+
+            layout.quantized_positions_ = params_.quantize_vertex_positions_;
+            layout.half_texcoords_ = half_texcoords;
+            layout.tangents_ = tangent_layout && mesh_buffer->GetVertexType() == EVT_TANGENTS;
+
+            const u32 position_size = layout.quantized_positions_ ? sizeof(u16) * 4 : sizeof(f32) * 3;
+            layout.attribute_offset_ = position_size * count;
+            layout.attribute_stride_ = sizeof(u32) * 2 + (half_texcoords ? sizeof(u16) * 2 : sizeof(f32) * 2) +
+                (layout.tangents_ ? sizeof(u32) * 2 : 0);
+
+            const core::Vector3Df extent = box.MaxEdge - box.MinEdge;
+            const f32 scale[4] = { extent.x_, extent.y_, extent.z_, 1.f };
+            const f32 offset[4] = { box.MinEdge.x_, box.MinEdge.y_, box.MinEdge.z_, 0.f };
+            for (u32 i = 0; i < 4; ++i)
+            {
+                layout.position_scale_[i] = layout.quantized_positions_ ? scale[i] : 1.f;
+                layout.position_offset_[i] = layout.quantized_positions_ ? offset[i] : 0.f;
+            }
+
+            packed_vertices_.Resize(layout.attribute_offset_ + layout.attribute_stride_ * count);
+            u8 *positions = packed_vertices_.Pointer();
+            u8 *attributes = positions + layout.attribute_offset_;
+            for (u32 i = 0; i < count; ++i)
+            {
+                const S3DVertex &v = vertex(i);
+                if (layout.quantized_positions_)
+                {
+                    const u16 quantized[4] = { QuantizeUnorm16(v.pos_.x_, offset[0], extent.x_),
+                        QuantizeUnorm16(v.pos_.y_, offset[1], extent.y_), QuantizeUnorm16(v.pos_.z_, offset[2], extent.z_), 0 };
+                    memcpy(positions, quantized, sizeof(quantized));
+                }
+                else
+                {
+                    memcpy(positions, &v.pos_, sizeof(f32) * 3);
+                }
+                positions += position_size;
 
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u16)* indices_count, indices, GL_STATIC_DRAW);
+                const u32 normal = PackSnorm1010102(v.normal_);
+                memcpy(attributes, &normal, sizeof(u32));
+                memcpy(attributes + sizeof(u32), &v.color_.color_, sizeof(u32));
+                u8 *next = attributes + sizeof(u32) * 2;
+                if (half_texcoords)
+                {
+                    const u16 texcoord[2] = { ToHalfFloat(v.texcoord_.x_), ToHalfFloat(v.texcoord_.y_) };
+                    memcpy(next, texcoord, sizeof(texcoord));
+                    next += sizeof(texcoord);
+                }
+                else
+                {
+                    memcpy(next, &v.texcoord_, sizeof(f32) * 2);
+                    next += sizeof(f32) * 2;
+                }
 
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(S3DVertexTangents), reinterpret_cast<void *>(offsetof(S3DVertexTangents, pos_)));
-            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(S3DVertexTangents), reinterpret_cast<void *>(offsetof(S3DVertexTangents, normal_)));
-            glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(S3DVertexTangents), reinterpret_cast<void *>(offsetof(S3DVertexTangents, color_)));
-            glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(S3DVertexTangents), reinterpret_cast<void *>(offsetof(S3DVertexTangents, texcoord_)));
-            glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(S3DVertexTangents), reinterpret_cast<void *>(offsetof(S3DVertexTangents, tangent_)));
-            glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, sizeof(S3DVertexTangents), reinterpret_cast<void *>(offsetof(S3DVertexTangents, binormal_)));
+                if (layout.tangents_)
+                {
+                    const S3DVertexTangents &t = static_cast<const S3DVertexTangents&>(v);
+                    const u32 tangent[2] = { PackSnorm1010102(t.tangent_), PackSnorm1010102(t.binormal_) };
+                    memcpy(next, tangent, sizeof(tangent));
+                }
+                attributes += layout.attribute_stride_;
+            }
+        }
+
+        void COpenGLShaderDriver::SetVertexAttributes(const SHWBufferLink* link) const
+        {
+            const SVertexLayout &layout = link->layout_;
+            if (layout.quantized_positions_)
+            {
+                glVertexAttribPointer(0, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(u16) * 4, nullptr);
+            }
+            else
+            {
+                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(f32) * 3, nullptr);
+            }
+
+            const GLsizei stride = layout.attribute_stride_;
+            size_t offset = layout.attribute_offset_;
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, reinterpret_cast<void *>(offset));
+            offset += sizeof(u32);
+            glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_FALSE, stride, reinterpret_cast<void *>(offset));
+            offset += sizeof(u32);
+            if (layout.half_texcoords_)
+            {
+                glVertexAttribPointer(3, 2, GL_HALF_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(offset));
+                offset += sizeof(u16) * 2;
+            }
+            else
+            {
+                glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(offset));
+                offset += sizeof(f32) * 2;
+            }
+
+            if (layout.tangents_)
+            {
+                glVertexAttribPointer(5, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, reinterpret_cast<void *>(offset));
+                glVertexAttribPointer(6, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, reinterpret_cast<void *>(offset + sizeof(u32)));
+                glEnableVertexAttribArray(5);
+                glEnableVertexAttribArray(6);
+            }
+            else
+            {
+                glDisableVertexAttribArray(5);
+                glDisableVertexAttribArray(6);
+            }
 
             glEnableVertexAttribArray(0);
             glEnableVertexAttribArray(1);
             glEnableVertexAttribArray(2);
             glEnableVertexAttribArray(3);
-            glEnableVertexAttribArray(5);
-            glEnableVertexAttribArray(6);
+        }
 
-            if (rendering_mode_ == ERM_WIREFRAME)
+        void COpenGLShaderDriver::SetPositionTransform(const SHWBufferLink* link)
+        {
+            const SVertexLayout &layout = link->layout_;
+            if (position_program_ == shader_helper_ &&
+                memcmp(position_scale_, layout.position_scale_, sizeof(position_scale_)) == 0 &&
+                memcmp(position_offset_, layout.position_offset_, sizeof(position_offset_)) == 0)
             {
-                glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(S3DVertexTangents), reinterpret_cast<void *>(offsetof(S3DVertexTangents, barycentric_)));
-                glEnableVertexAttribArray(4);
+                return;
             }
 
-            shader_helper_->Use();
-            glBindVertexArray(vao_);
-            glDrawElements(GL_TRIANGLES, indices_count, GL_UNSIGNED_SHORT, nullptr);
-            glBindVertexArray(0);
+            shader_helper_->SetVec4("position_scale", layout.position_scale_);
+            shader_helper_->SetVec4("position_offset", layout.position_offset_);
+            position_program_ = shader_helper_;
+            memcpy(position_scale_, layout.position_scale_, sizeof(position_scale_));
+            memcpy(position_offset_, layout.position_offset_, sizeof(position_offset_));
         }
 
-        void COpenGLShaderDriver::UpdateMaxSupportLights()
+        void COpenGLShaderDriver::SetInstanceAttributes(SHWBufferLink* link, bool on) const
         {
-            max_support_lights_ = 4;
+            if (link->instancing_on_ == on)
+            {
+                return;
+            }
+
+            // a mat4 attribute takes four locations, one per column
+            if (on)
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+                for (GLuint i = 0; i < 4; ++i)
+                {
+                    glVertexAttribPointer(INSTANCE_TRANSFORM_LOCATION + i, 4, GL_FLOAT, GL_FALSE, sizeof(core::Matrixf),
+                        reinterpret_cast<void *>(sizeof(f32) * 4 * i));
+                    glVertexAttribDivisor(INSTANCE_TRANSFORM_LOCATION + i, 1);
+                    glEnableVertexAttribArray(INSTANCE_TRANSFORM_LOCATION + i);
+                }
+            }
+            else
+            {
+                for (GLuint i = 0; i < 4; ++i)
+                {
+                    glDisableVertexAttribArray(INSTANCE_TRANSFORM_LOCATION + i);
+                }
+            }
+            link->instancing_on_ = on;
         }
 
-        void COpenGLShaderDriver::SetMaterialUniform(s32 material_val_type, const void *val) const
+        void COpenGLShaderDriver::DeleteHardwareBuffer(SHWBufferLink* link) const
         {
-            if (material_val_type >= SL_MATERIAL_COUNT || material_val_type < 0)
+            if (link == nullptr || link == &stream_link_)
             {
                 return;
             }
-            switch (material_val_type)
-            {
-            case SL_MAT_AMBIENT:
-            case SL_MAT_DIFFUSE:
-            case SL_MAT_SPECULAR:
-            case SL_MAT_EMISSIVE:
-                shader_helper_->SetVec4(material_uniform_name[material_val_type], static_cast<const f32 *>(val));
-                break;
-            case SL_MAT_SHININESS:
-                shader_helper_->SetFloat(material_uniform_name[material_val_type], *static_cast<const f32 *>(val));
-            default: break;
-            }
-            
+
+            DeleteHardwareBuffer(link->wire_link_);
+            glDeleteBuffers(1, &link->ebo_);
+            glDeleteBuffers(1, &link->vbo_);
+            glDeleteVertexArrays(1, &link->vao_);
+            delete link;
+        }
+
+        void COpenGLShaderDriver::UpdateMaxSupportLights()
+        {
+            max_support_lights_ = 4;
         }
 
-        void COpenGLShaderDriver::SetMaterialUniform(s32 material_val_type, f32 val) const
+        void COpenGLShaderDriver::BindUniformBlocks(IShaderHelper* shader_helper) const
         {
-            if (material_val_type >= SL_MATERIAL_COUNT || material_val_type < 0)
+            if (shader_helper == nullptr)
             {
                 return;
             }
 
-            shader_helper_->SetFloat(material_uniform_name[material_val_type], val);
+            for (u32 i = 0; i < SUB_COUNT; i++)
+            {
+                shader_helper->BindUniformBlock(shader_uniform_block_name[i], i);
+            }
         }
 
-        void COpenGLShaderDriver::SetLightUniform(s32 light_idx, s32 light_val_type, const void* val) const
+        void COpenGLShaderDriver::UpdateLightBlock(u32 idx, const SLight& light) const
         {
-            if (light_idx < SL_LIGHT0 || light_idx >= SL_LIGHT0 + max_support_lights_ || 
-                light_val_type < 0 || light_val_type >= SL_LIGHT_COUNT)
+            if (idx >= nr_lights_)
             {
                 return;
             }
 
-            core::stringc str = core::stringc(shader_uniform_name[light_idx]) + "." + light_uniform_name[light_val_type];
-            //os::Printer::print(str.c_str());
+            SShaderLight block;
+            memset(&block, 0, sizeof(SShaderLight));
 
-            switch (light_val_type)
+            switch (light.type_)
             {
-            case SL_LIGHT_POSITION:
-            case SL_LIGHT_DIRECTION:
-            case SL_LIGHT_AMBIENT:
-            case SL_LIGHT_DIFFUSE:
-            case SL_LIGHT_SPECULAR:
-            case SL_LIGHT_ATTENUATION:
-                shader_helper_->SetVec4(str.c_str(), static_cast<const f32 *>(val));
+            case video::ELT_SPOT:
+                block.direction[0] = light.direction_.x_;
+                block.direction[1] = light.direction_.y_;
+                block.direction[2] = light.direction_.z_;
+                block.direction[3] = 0.0f;
+
+                // set position
+                block.position[0] = light.position_.x_;
+                block.position[1] = light.position_.y_;
+                block.position[2] = light.position_.z_;
+                block.position[3] = 1.0f; // 1.0f for positional light
+
+                block.exponent = light.falloff_;
+                block.cutoff = light.outer_cone_;
+                break;
+            case video::ELT_POINT:
+                // set position
+                block.position[0] = light.position_.x_;
+                block.position[1] = light.position_.y_;
+                block.position[2] = light.position_.z_;
+                block.position[3] = 1.0f; // 1.0f for positional light
+
+                block.exponent = 0.0f;
+                block.cutoff = 180.0f;
+                break;
+            case video::ELT_DIRECTIONAL:
+                // set direction
+                block.position[0] = -light.direction_.x_;
+                block.position[1] = -light.direction_.y_;
+                block.position[2] = -light.direction_.z_;
+                block.position[3] = 0.0f; // 0.0f for directional light
+
+                block.exponent = 0.0f;
+                block.cutoff = 180.0f;
+                break;
+            default:
                 break;
-            case SL_LIGHT_EXPONENT:
-            case SL_LIGHT_CUTOFF:
-                shader_helper_->SetFloat(str.c_str(), *static_cast<const f32 *>(val));
-            default: break;
             }
+
+            // set diffuse color
+            block.diffuse[0] = light.diffuse_color_.r;
+            block.diffuse[1] = light.diffuse_color_.g;
+            block.diffuse[2] = light.diffuse_color_.b;
+            block.diffuse[3] = light.diffuse_color_.a;
+
+            // set specular color
+            block.specular[0] = light.specular_color_.r;
+            block.specular[1] = light.specular_color_.g;
+            block.specular[2] = light.specular_color_.b;
+            block.specular[3] = light.specular_color_.a;
+
+            // set ambient color
+            block.ambient[0] = light.ambient_color_.r;
+            block.ambient[1] = light.ambient_color_.g;
+            block.ambient[2] = light.ambient_color_.b;
+            block.ambient[3] = light.ambient_color_.a;
+
+            // 1.0f / (constant + linear * d + quadratic*(d*d);
+
+            // set attenuation
+            block.attenuation[0] = light.attenuation_.x_;
+            block.attenuation[1] = light.attenuation_.y_;
+            block.attenuation[2] = light.attenuation_.z_;
+
+            glBindBuffer(GL_UNIFORM_BUFFER, uniform_buffers_[SUB_LIGHTS]);
+            glBufferSubData(GL_UNIFORM_BUFFER, sizeof(SShaderLight) * idx, sizeof(SShaderLight), &block);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
         }
 
-        void COpenGLShaderDriver::SetLightUniform(s32 light_idx, s32 light_val_type, f32 val) const
+        void COpenGLShaderDriver::SetShadowCascadeUniforms() const
         {
-            if (light_idx < SL_LIGHT0 || light_idx >= SL_LIGHT0 + max_support_lights_ ||
-                light_val_type < 0 || light_val_type >= SL_LIGHT_COUNT)
+            shader_helper_->SetInt("shadow_cascades_num", shadow_cascade_count_);
+            for (u32 i = 0; i < shadow_cascade_count_; i++)
             {
-                return;
+                const std::string index = "[" + std::to_string(i) + "]";
+                shader_helper_->SetMatrix4("shadow_transforms" + index, shadow_cascade_transforms_[i]);
+                shader_helper_->SetFloat("shadow_splits" + index, shadow_cascade_splits_[i]);
             }
-
-            core::stringc str = core::stringc(shader_uniform_name[light_idx]) + "." + light_uniform_name[light_val_type];
-            shader_helper_->SetFloat(str.c_str(), val);
         }
 
         void COpenGLShaderDriver::Enable(s32 idx) const
@@ -522,8 +991,7 @@ namespace kong
                 return;
             }
 
-            core::stringc str = core::stringc(shader_uniform_name[idx]) + "_on";
-            shader_helper_->SetBool(str.c_str(), true);
+            shader_helper_->SetBool(shader_uniform_on_name[idx], true);
         }
 
         void COpenGLShaderDriver::Disable(s32 idx) const
@@ -533,8 +1001,7 @@ namespace kong
                 return;
             }
 
-            core::stringc str = core::stringc(shader_uniform_name[idx]) + "_on";
-            shader_helper_->SetBool(str.c_str(), false);
+            shader_helper_->SetBool(shader_uniform_on_name[idx], false);
         }
 
         const c8* COpenGLShaderDriver::GetUniformName(s32 idx) const
@@ -570,4 +1037,6 @@ namespace kong
         }
 #endif
     }
-}
\ No newline at end of file
+}
+
+#endif // _KONG_COMPILE_WITH_OPENGL_
@@ -1,6 +1,10 @@
 // Copyright (C) 2018 Lyu Luan
 // This file is part of the "Kong Engine".
 
+#include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_OPENGL_
+
 #include "COpenGLShaderHelper.h"
 #include "IReadFile.h"
 #include "KongMath.h"
@@ -35,54 +39,137 @@ namespace kong
 
         void COpenGLShaderHelper::SetBool(const std::string& name, bool value) const
         {
-            //const GLint location = glGetUniformLocation(id_, name.c_str());
-            //if (location >= 0)
-            //    glUniform1i(location, static_cast<s32>(value));
-            glUniform1i(glGetUniformLocation(id_, name.c_str()), static_cast<s32>(value));
+            SetBool(GetUniformLocation(name), value);
         }
 
         void COpenGLShaderHelper::SetInt(const std::string& name, s32 value) const
         {
-            const GLint location = glGetUniformLocation(id_, name.c_str());
-            if (location >= 0)
-                glUniform1i(location, value);
+            SetInt(GetUniformLocation(name), value);
         }
 
         void COpenGLShaderHelper::SetFloat(const std::string& name, f32 value) const
         {
-            const GLint location = glGetUniformLocation(id_, name.c_str());
-            if (location >= 0)
-                glUniform1f(location, value);
+            SetFloat(GetUniformLocation(name), value);
         }
 
         void COpenGLShaderHelper::SetMatrix4(const std::string& name, const core::Matrixf& mat) const
         {
-            const GLint location = glGetUniformLocation(id_, name.c_str());
-            if (location >= 0)
-                glUniformMatrix4fv(location, 1, GL_FALSE, mat.Pointer());
+            SetMatrix4(GetUniformLocation(name), mat);
         }
 
         void COpenGLShaderHelper::SetVec2(const std::string& name, const f32* vec2) const
         {
-            const GLint location = glGetUniformLocation(id_, name.c_str());
-            if (location >= 0)
-                glUniform2fv(location, 1, vec2);
+            SetVec2(GetUniformLocation(name), vec2);
         }
 
         void COpenGLShaderHelper::SetVec2i(const std::string& name, const s32* vec2) const
         {
-            const GLint location = glGetUniformLocation(id_, name.c_str());
+            const GLint location = GetUniformLocation(name);
             if (location >= 0)
                 glUniform2iv(location, 1, vec2);
         }
 
         void COpenGLShaderHelper::SetVec4(const std::string& name, const f32* vec4) const
         {
-            const GLint location = glGetUniformLocation(id_, name.c_str());
+            SetVec4(GetUniformLocation(name), vec4);
+        }
+
+        s32 COpenGLShaderHelper::GetUniformLocation(const std::string& name) const
+        {
+            const auto it = uniform_locations_.find(name);
+            if (it == uniform_locations_.end())
+                return -1;
+
+            return it->second;
+        }
+
+        void COpenGLShaderHelper::SetBool(s32 location, bool value) const
+        {
+            if (location >= 0)
+                glUniform1i(location, static_cast<s32>(value));
+        }
+
+        void COpenGLShaderHelper::SetInt(s32 location, s32 value) const
+        {
+            if (location >= 0)
+                glUniform1i(location, value);
+        }
+
+        void COpenGLShaderHelper::SetFloat(s32 location, f32 value) const
+        {
+            if (location >= 0)
+                glUniform1f(location, value);
+        }
+
+        void COpenGLShaderHelper::SetMatrix4(s32 location, const core::Matrixf& mat) const
+        {
+            if (location >= 0)
+                glUniformMatrix4fv(location, 1, GL_FALSE, mat.Pointer());
+        }
+
+        void COpenGLShaderHelper::SetVec2(s32 location, const f32* vec2) const
+        {
+            if (location >= 0)
+                glUniform2fv(location, 1, vec2);
+        }
+
+        void COpenGLShaderHelper::SetVec4(s32 location, const f32* vec4) const
+        {
             if (location >= 0)
                 glUniform4fv(location, 1, vec4);
         }
 
+        bool COpenGLShaderHelper::BindUniformBlock(const std::string& name, u32 binding) const
+        {
+            const GLuint block_index = glGetUniformBlockIndex(id_, name.c_str());
+            if (block_index == GL_INVALID_INDEX)
+                return false;
+
+            glUniformBlockBinding(id_, block_index, binding);
+            return true;
+        }
+
+        void COpenGLShaderHelper::ResolveUniformLocations()
+        {
+            uniform_locations_.clear();
+
+            GLint uniform_count = 0;
+            GLint max_name_length = 0;
+            glGetProgramiv(id_, GL_ACTIVE_UNIFORMS, &uniform_count);
+            glGetProgramiv(id_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+            if (uniform_count <= 0 || max_name_length <= 0)
+                return;
+
+            c8 *name = new c8[max_name_length];
+            for (GLint i = 0; i < uniform_count; i++)
+            {
+                GLint size = 0;
+                GLenum type = 0;
+                GLsizei length = 0;
+                glGetActiveUniform(id_, i, max_name_length, &length, &size, &type, name);
+
+                // members of uniform blocks have no location
+                const GLint location = glGetUniformLocation(id_, name);
+                if (location < 0)
+                    continue;
+
+                std::string uniform_name(name, length);
+                uniform_locations_[uniform_name] = location;
+
+                // arrays of basic types are reported once as "name[0]", elements have consecutive locations
+                if (uniform_name.size() > 3 && uniform_name.compare(uniform_name.size() - 3, 3, "[0]") == 0)
+                {
+                    const std::string base_name = uniform_name.substr(0, uniform_name.size() - 3);
+                    uniform_locations_[base_name] = location;
+                    for (GLint j = 1; j < size; j++)
+                    {
+                        uniform_locations_[base_name + "[" + std::to_string(j) + "]"] = location + j;
+                    }
+                }
+            }
+            delete[] name;
+        }
+
         void COpenGLShaderHelper::InitShader(const io::SPath& vertex_path, const io::SPath& fragment_path)
         {
             // 1. read shader files
@@ -140,6 +227,10 @@ namespace kong
                 glGetProgramInfoLog(id_, 512, NULL, infoLog);
                 std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
             }
+            else
+            {
+                ResolveUniformLocations();
+            }
 
             // delete shaders
             glDeleteShader(vertex);
@@ -151,4 +242,6 @@ namespace kong
             delete fs_file;
         }
     } // end namespace video
-} // end namespace kong
\ No newline at end of file
+} // end namespace kong
+
+#endif // _KONG_COMPILE_WITH_OPENGL_
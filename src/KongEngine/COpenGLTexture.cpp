@@ -2,18 +2,23 @@
 // This file is part of the "Kong Engine".
 
 #include "KongCompileConfig.h"
+
+#ifdef _KONG_COMPILE_WITH_OPENGL_
+
 #include <GL/glew.h>
 #include "os.h"
 #include <iostream>
 #include <cassert>
-
-#ifdef _KONG_COMPILE_WITH_OPENGL_
+#include <cstring>
 
 #include "KongTypes.h"
 #include "COpenGLTexture.h"
 #include "COpenGLDriver.h"
 //#include "os.h"
 #include "CColorConverter.h"
+#include "CImage.h"
+#include "CImagePyramid.h"
+#include "CBlockCompression.h"
 
 #include "KongString.h"
 
@@ -37,24 +42,13 @@ namespace kong
         COpenGLTexture::COpenGLTexture(IImage* origImage, const io::path& name, void* mipmapData, COpenGLDriver* driver)
             : ITexture(name), ColorFormat(ECF_A8R8G8B8), driver_(driver), image_(nullptr), MipImage(nullptr),
             texture_name_(0), internal_format_(GL_RGBA), pixel_format_(GL_BGRA_EXT),
-            pixel_type_(GL_UNSIGNED_BYTE), MipLevelStored(0), MipmapLegacyMode(true),
+            pixel_type_(GL_UNSIGNED_BYTE), MipLevelStored(0), has_mip_maps_(true), MipmapLegacyMode(true),
             is_render_target_(false), AutomaticMipmapUpdate(false),
-            ReadOnlyLock(false), KeepImage(true)
+            ReadOnlyLock(false), KeepImage(true), has_source_file_(false), srgb_(true), level_count_(1), first_level_(0),
+            memory_size_(0), last_use_frame_(0)
         {
-            GetImageValues(origImage);
-
             glGenTextures(1, &texture_name_);
-
-            image_ = driver_->CreateImage(ColorFormat, image_size_);
-            origImage->CopyTo(image_);
-
-            UploadTexture(true, mipmapData);
-
-            if (!KeepImage)
-            {
-                delete image_;
-                image_ = nullptr;
-            }
+            SetImage(origImage, mipmapData);
         }
 
 
@@ -62,9 +56,10 @@ namespace kong
         COpenGLTexture::COpenGLTexture(const io::path& name, COpenGLDriver* driver)
             : ITexture(name), ColorFormat(ECF_A8R8G8B8), driver_(driver), image_(0), MipImage(0),
             texture_name_(0), internal_format_(GL_RGBA), pixel_format_(GL_BGRA_EXT),
-            pixel_type_(GL_UNSIGNED_BYTE), MipLevelStored(0), has_mip_maps_(true),
+            pixel_type_(GL_UNSIGNED_BYTE), MipLevelStored(0), has_mip_maps_(false),
             MipmapLegacyMode(true), is_render_target_(false), AutomaticMipmapUpdate(false),
-            ReadOnlyLock(false), KeepImage(true)
+            ReadOnlyLock(false), KeepImage(true), has_source_file_(false), srgb_(true), level_count_(1), first_level_(0),
+            memory_size_(0), last_use_frame_(0)
         {
 #ifdef _DEBUG
             //setDebugName("COpenGLTexture");
@@ -88,6 +83,70 @@ namespace kong
         }
 
 
+        //! replaces the content of the texture
+        void COpenGLTexture::SetImage(IImage* image, void* mipmapData)
+        {
+            GetImageValues(image);
+            delete image_;
+            image_ = nullptr;
+            ColorFormat = ECF_A8R8G8B8;
+            has_mip_maps_ = true;
+
+            IImage *decompressed = nullptr;
+            if (IImage::IsCompressedFormat(image->GetColorFormat()))
+            {
+                if (driver_->IsCompressedFormatSupported(image->GetColorFormat()))
+                {
+                    // the levels are kept, so the texture can be decompressed or restored again
+                    if (KeepImage)
+                    {
+                        CImage *kept = new CImage(image->GetColorFormat(), image_size_, image->Lock(), false);
+                        image->Unlock();
+
+                        const u32 count = image->GetMipMapLevelCount();
+                        if (count > 1 && image->GetMipMapsData() != nullptr)
+                        {
+                            u32 data_size = 0;
+                            for (u32 level = 1; level < count; ++level)
+                            {
+                                const core::Dimension2d<u32> size = CImagePyramid::GetLevelSize(image_size_, level);
+                                data_size += IImage::GetDataSizeFromFormat(image->GetColorFormat(), size.width_, size.height_);
+                            }
+                            u8 *levels = new u8[data_size];
+                            memcpy(levels, image->GetMipMapsData(), data_size);
+                            kept->SetMipMapsData(levels, count);
+                        }
+                        image_ = kept;
+                    }
+                    UploadCompressedTexture(image);
+                    return;
+                }
+
+                // the blocks can not be sampled, so level 0 is decompressed and the mip maps are filtered from it
+                decompressed = CBlockCompression::Decompress(image);
+                image = decompressed;
+                mipmapData = nullptr;
+            }
+            else if (mipmapData == nullptr && image->GetColorFormat() == ECF_A8R8G8B8 &&
+                image->GetMipMapLevelCount() == CImagePyramid::GetLevelCount(image_size_))
+            {
+                mipmapData = image->GetMipMapsData();
+            }
+
+            image_ = driver_->CreateImage(ColorFormat, image_size_);
+            image->CopyTo(image_);
+            delete decompressed;
+
+            UploadTexture(true, mipmapData);
+
+            if (!KeepImage)
+            {
+                delete image_;
+                image_ = nullptr;
+            }
+        }
+
+
         //! Get opengl values for the GPU texture storage
         GLint COpenGLTexture::getOpenGLFormatAndParametersFromColorFormat(ECOLOR_FORMAT format,
             GLint& filtering,
@@ -208,6 +267,28 @@ namespace kong
 #endif
             }
                 break;
+                // Block compressed formats, only used with glCompressedTexImage2D
+            case ECF_BC1:
+                internalformat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                break;
+            case ECF_BC2:
+                internalformat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+                break;
+            case ECF_BC3:
+                internalformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                break;
+            case ECF_BC4:
+                internalformat = GL_COMPRESSED_RED_RGTC1;
+                break;
+            case ECF_BC5:
+                internalformat = GL_COMPRESSED_RG_RGTC2;
+                break;
+            case ECF_BC6H:
+                internalformat = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+                break;
+            case ECF_BC7:
+                internalformat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+                break;
             default:
             {
                 //os::Printer::log("Unsupported texture format", ELL_ERROR);
@@ -243,41 +324,210 @@ namespace kong
         //! copies the the texture into an open gl texture.
         void COpenGLTexture::UploadTexture(bool newTexture, void* mipmapData, u32 level)
         {
+            const u32 defined_levels = level_count_ - first_level_;
             void *data = image_->Lock();
             GLint filtering;
             GLenum colorformat;
             GLenum type;
             const GLenum internalformat = getOpenGLFormatAndParametersFromColorFormat(ColorFormat, filtering, colorformat, type);
 
+            BindWithDefaultParameters();
+
+            if (data != nullptr)
+            {
+                glTexImage2D(GL_TEXTURE_2D, 0, internalformat, image_size_.width_, image_size_.height_, 0, colorformat, type, data);
+            }
+            image_->Unlock();
+
+            if (has_mip_maps_)
+            {
+                UploadMipMapLevels(mipmapData);
+            }
+
+            level_count_ = has_mip_maps_ ? CImagePyramid::GetLevelCount(image_size_) : 1;
+            first_level_ = 0;
+            ReleaseLevels(level_count_, defined_levels);
+            memory_size_ = GetLevelsMemorySize(0);
+        }
+
+
+        void COpenGLTexture::UploadCompressedTexture(IImage* image, u32 first_level)
+        {
+            GLint filtering;
+            GLenum colorformat;
+            GLenum type;
+            ColorFormat = image->GetColorFormat();
+            const GLenum internalformat = getOpenGLFormatAndParametersFromColorFormat(ColorFormat, filtering, colorformat, type);
+            const u32 count = image->GetMipMapLevelCount();
+            const u32 defined_levels = level_count_ - first_level_;
+            has_mip_maps_ = count > 1;
+
+            BindWithDefaultParameters();
+
+            // the stored levels are packed one after another, a partial chain just ends earlier
+            const u8 *level_data = static_cast<const u8 *>(image->Lock());
+            const u8 *mip_maps_data = static_cast<const u8 *>(image->GetMipMapsData());
+            for (u32 level = 0; level < count; ++level)
+            {
+                const core::Dimension2d<u32> size = CImagePyramid::GetLevelSize(image_size_, level);
+                const u32 data_size = IImage::GetDataSizeFromFormat(ColorFormat, size.width_, size.height_);
+                if (level >= first_level)
+                {
+                    glCompressedTexImage2D(GL_TEXTURE_2D, level - first_level, internalformat, size.width_, size.height_, 0,
+                        data_size, level_data);
+                }
+                level_data = level == 0 ? mip_maps_data : level_data + data_size;
+            }
+            image->Unlock();
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, count - 1 - first_level);
+
+            level_count_ = count;
+            first_level_ = first_level;
+            ReleaseLevels(count - first_level, defined_levels);
+            memory_size_ = GetLevelsMemorySize(first_level);
+
+            // single channel textures are sampled as gray, like the uncompressed ones
+            if (ColorFormat == ECF_BC4 && (GLEW_VERSION_3_3 || GLEW_ARB_texture_swizzle))
+            {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+            }
+        }
+
+
+        void COpenGLTexture::UploadFilteredLevels(u32 first_level)
+        {
+            GLint filtering;
+            GLenum colorformat;
+            GLenum type;
+            const GLenum internalformat = getOpenGLFormatAndParametersFromColorFormat(ColorFormat, filtering, colorformat, type);
+            const u32 defined_levels = level_count_ - first_level_;
+
+            BindWithDefaultParameters();
+
+            CImagePyramid pyramid;
+            pyramid.Build(image_, srgb_);
+            for (u32 level = first_level; level < pyramid.GetLevelCount(); ++level)
+            {
+                IImage *image = pyramid.GetLevel(level);
+                const core::Dimension2d<u32> size = image->GetDimension();
+                glTexImage2D(GL_TEXTURE_2D, level - first_level, internalformat, size.width_, size.height_, 0, colorformat, type, image->Lock());
+                image->Unlock();
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, pyramid.GetLevelCount() - 1 - first_level);
+
+            level_count_ = pyramid.GetLevelCount();
+            first_level_ = first_level;
+            ReleaseLevels(level_count_ - first_level, defined_levels);
+            memory_size_ = GetLevelsMemorySize(first_level);
+        }
+
+
+        void COpenGLTexture::ReleaseLevels(u32 first_level, u32 level_count)
+        {
+            // levels past GL_TEXTURE_MAX_LEVEL are not sampled, but keep their memory until they are redefined
+            for (u32 level = first_level; level < level_count; ++level)
+            {
+                glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            }
+        }
+
+
+        void COpenGLTexture::BindWithDefaultParameters()
+        {
             glBindTexture(GL_TEXTURE_2D, texture_name_);
             // set the render filter and interpolation
             //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, has_mip_maps_ ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            if (GLEW_VERSION_3_3 || GLEW_ARB_texture_swizzle)
+            {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_GREEN);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_BLUE);
+            }
 
-            if (data != nullptr)
+            // the first material using the texture sets all parameters again
+            sampler_state_.min_filter_ = -1;
+            sampler_state_.mag_filter_ = -1;
+            sampler_state_.wrap_u_ = -1;
+            sampler_state_.wrap_v_ = -1;
+            sampler_state_.anisotropy_ = -1.f;
+            sampler_state_.lod_bias_ = -1.f;
+        }
+
+
+        void COpenGLTexture::UploadMipMapLevels(void* mipmapData)
+        {
+            GLint filtering;
+            GLenum colorformat;
+            GLenum type;
+            const GLenum internalformat = getOpenGLFormatAndParametersFromColorFormat(ColorFormat, filtering, colorformat, type);
+            const u32 count = CImagePyramid::GetLevelCount(image_size_);
+
+            if (mipmapData != nullptr)
             {
-                glTexImage2D(GL_TEXTURE_2D, 0, internalformat, image_size_.width_, image_size_.height_, 0, colorformat, type, data);
+                // the levels are packed one after another with 4 bytes per texel
+                const u8 *level_data = static_cast<const u8 *>(mipmapData);
+                for (u32 level = 1; level < count; ++level)
+                {
+                    const core::Dimension2d<u32> size = CImagePyramid::GetLevelSize(image_size_, level);
+                    glTexImage2D(GL_TEXTURE_2D, level, internalformat, size.width_, size.height_, 0, colorformat, type, level_data);
+                    level_data += size.width_ * size.height_ * 4;
+                }
             }
-            image_->Unlock();
+            else
+            {
+                CImagePyramid pyramid;
+                pyramid.Build(image_, srgb_);
+                for (u32 level = 1; level < pyramid.GetLevelCount(); ++level)
+                {
+                    IImage *image = pyramid.GetLevel(level);
+                    const core::Dimension2d<u32> size = image->GetDimension();
+                    glTexImage2D(GL_TEXTURE_2D, level, internalformat, size.width_, size.height_, 0, colorformat, type, image->Lock());
+                    image->Unlock();
+                }
+            }
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, count - 1);
         }
 
 
         //! lock function
         void* COpenGLTexture::Lock(E_TEXTURE_LOCK_MODE mode, u32 mipmapLevel)
         {
-            glBindTexture(GL_TEXTURE_2D, texture_name_);
-            return nullptr;
+            // only the kept level 0 of uncompressed textures can be changed
+            if (image_ == nullptr || mipmapLevel != 0 || IImage::IsCompressedFormat(ColorFormat))
+            {
+                return nullptr;
+            }
+
+            ReadOnlyLock = mode == ETLM_READ_ONLY;
+            return image_->Lock();
         }
 
 
         //! unlock function
         void COpenGLTexture::Unlock()
         {
-            glBindTexture(GL_TEXTURE_2D, 0);
+            if (image_ == nullptr || IImage::IsCompressedFormat(ColorFormat))
+            {
+                return;
+            }
+
+            image_->Unlock();
+            if (!ReadOnlyLock)
+            {
+                // the file does not have the changes, so the kept image can not be released any more
+                has_source_file_ = false;
+                UploadTexture(false);
+            }
+            ReadOnlyLock = false;
         }
 
 
@@ -337,6 +587,280 @@ namespace kong
         //! modifying the texture
         void COpenGLTexture::RegenerateMipMapLevels(void* mipmapData)
         {
+            if (!has_mip_maps_ || image_ == nullptr)
+            {
+                return;
+            }
+
+            // the dropped levels stay dropped, the resident ones are filtered from level 0 again
+            if (first_level_ != 0)
+            {
+                UploadFilteredLevels(first_level_);
+                return;
+            }
+
+            glBindTexture(GL_TEXTURE_2D, texture_name_);
+            UploadMipMapLevels(mipmapData);
+        }
+
+
+        bool COpenGLTexture::ConvertImage(ECOLOR_FORMAT format, core::CThreadPool* thread_pool)
+        {
+            if (format == ColorFormat)
+            {
+                return true;
+            }
+            if (image_ == nullptr || is_render_target_)
+            {
+                return false;
+            }
+
+            IImage *converted = nullptr;
+            if (IImage::IsCompressedFormat(format))
+            {
+                if (ColorFormat == ECF_A8R8G8B8 && driver_->IsCompressedFormatSupported(format))
+                {
+                    converted = CBlockCompression::Compress(image_, format, srgb_, thread_pool);
+                }
+            }
+            else if (format == ECF_A8R8G8B8 && IImage::IsCompressedFormat(ColorFormat))
+            {
+                converted = CBlockCompression::Decompress(image_);
+            }
+
+            if (converted == nullptr)
+            {
+                return false;
+            }
+
+            // the texture name stays the same, only the levels are defined again
+            SetImage(converted);
+            delete converted;
+            return true;
+        }
+
+
+        u32 COpenGLTexture::GetMemorySize() const
+        {
+            return memory_size_;
+        }
+
+
+        u32 COpenGLTexture::GetLevelsMemorySize(u32 first_level) const
+        {
+            u32 memory_size = 0;
+            for (u32 level = first_level; level < level_count_; ++level)
+            {
+                const core::Dimension2d<u32> size = CImagePyramid::GetLevelSize(image_size_, level);
+                memory_size += IImage::GetDataSizeFromFormat(ColorFormat, size.width_, size.height_);
+            }
+            return memory_size;
+        }
+
+
+        u32 COpenGLTexture::GetLevelCount() const
+        {
+            return level_count_;
+        }
+
+
+        u32 COpenGLTexture::GetFirstResidentLevel() const
+        {
+            return first_level_;
+        }
+
+
+        u32 COpenGLTexture::GetEvictedLevel() const
+        {
+            if (is_render_target_)
+            {
+                return 0;
+            }
+
+            u32 level = 0;
+            while (level + 1 < level_count_)
+            {
+                const core::Dimension2d<u32> size = CImagePyramid::GetLevelSize(image_size_, level);
+                if (core::max_(size.width_, size.height_) <= EVICTED_TEXTURE_SIZE)
+                {
+                    break;
+                }
+                ++level;
+            }
+            return level;
+        }
+
+
+        bool COpenGLTexture::SetFirstResidentLevel(u32 level)
+        {
+            if (level == first_level_)
+            {
+                return true;
+            }
+            if (image_ == nullptr || is_render_target_ || level >= level_count_)
+            {
+                return false;
+            }
+
+            if (IImage::IsCompressedFormat(ColorFormat))
+            {
+                UploadCompressedTexture(image_, level);
+            }
+            else if (level == 0)
+            {
+                UploadTexture(false);
+            }
+            else
+            {
+                UploadFilteredLevels(level);
+            }
+            return true;
+        }
+
+
+        bool COpenGLTexture::Evict()
+        {
+            const u32 level = GetEvictedLevel();
+            if (level == 0 || !SetFirstResidentLevel(level))
+            {
+                return false;
+            }
+
+            // the file has the levels as well, so system memory is freed too
+            if (has_source_file_)
+            {
+                delete image_;
+                image_ = nullptr;
+            }
+            return true;
+        }
+
+
+        bool COpenGLTexture::HasKeptImage() const
+        {
+            return image_ != nullptr;
+        }
+
+
+        void COpenGLTexture::SetHasSourceFile(bool has_source_file)
+        {
+            has_source_file_ = has_source_file;
+        }
+
+
+        bool COpenGLTexture::HasSourceFile() const
+        {
+            return has_source_file_;
+        }
+
+
+        void COpenGLTexture::SetSRGB(bool srgb)
+        {
+            srgb_ = srgb;
+        }
+
+
+        bool COpenGLTexture::IsSRGB() const
+        {
+            return srgb_;
+        }
+
+
+        void COpenGLTexture::SetLastUseFrame(u32 frame) const
+        {
+            last_use_frame_ = frame;
+        }
+
+
+        u32 COpenGLTexture::GetLastUseFrame() const
+        {
+            return last_use_frame_;
+        }
+
+
+        //! returns the OpenGL wrap mode of a texture clamp mode
+        static GLint GetOpenGLWrap(u8 clamp)
+        {
+            switch (clamp)
+            {
+            case ETC_CLAMP:
+            case ETC_CLAMP_TO_EDGE:
+                return GL_CLAMP_TO_EDGE;
+            case ETC_CLAMP_TO_BORDER:
+                return GL_CLAMP_TO_BORDER;
+            case ETC_MIRROR:
+                return GL_MIRRORED_REPEAT;
+            case ETC_MIRROR_CLAMP:
+            case ETC_MIRROR_CLAMP_TO_EDGE:
+            case ETC_MIRROR_CLAMP_TO_BORDER:
+                return GLEW_VERSION_4_4 || GLEW_ARB_texture_mirror_clamp_to_edge ? GL_MIRROR_CLAMP_TO_EDGE : GL_MIRRORED_REPEAT;
+            default:
+                return GL_REPEAT;
+            }
+        }
+
+
+        void COpenGLTexture::SetSamplerState(u32 stage, const SMaterialLayer& layer, f32 max_anisotropy) const
+        {
+            if (is_render_target_)
+            {
+                return;
+            }
+
+            SSamplerState state;
+            if (layer.TrilinearFilter && has_mip_maps_)
+            {
+                state.min_filter_ = GL_LINEAR_MIPMAP_LINEAR;
+            }
+            else if (layer.BilinearFilter || layer.TrilinearFilter)
+            {
+                state.min_filter_ = has_mip_maps_ ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR;
+            }
+            else
+            {
+                state.min_filter_ = has_mip_maps_ ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
+            }
+            state.mag_filter_ = layer.BilinearFilter || layer.TrilinearFilter ? GL_LINEAR : GL_NEAREST;
+            state.wrap_u_ = GetOpenGLWrap(layer.TextureWrapU);
+            state.wrap_v_ = GetOpenGLWrap(layer.TextureWrapV);
+            state.anisotropy_ = max_anisotropy > 0.f ? core::clamp(static_cast<f32>(layer.AnisotropicFilter), 1.f, max_anisotropy) : 0.f;
+            state.lod_bias_ = layer.LODBias * 0.125f;
+
+            if (state.min_filter_ == sampler_state_.min_filter_ && state.mag_filter_ == sampler_state_.mag_filter_ &&
+                state.wrap_u_ == sampler_state_.wrap_u_ && state.wrap_v_ == sampler_state_.wrap_v_ &&
+                state.anisotropy_ == sampler_state_.anisotropy_ && state.lod_bias_ == sampler_state_.lod_bias_)
+            {
+                return;
+            }
+
+            glActiveTexture(GL_TEXTURE0 + stage);
+            glBindTexture(GL_TEXTURE_2D, texture_name_);
+            if (state.min_filter_ != sampler_state_.min_filter_)
+            {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, state.min_filter_);
+            }
+            if (state.mag_filter_ != sampler_state_.mag_filter_)
+            {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, state.mag_filter_);
+            }
+            if (state.wrap_u_ != sampler_state_.wrap_u_)
+            {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, state.wrap_u_);
+            }
+            if (state.wrap_v_ != sampler_state_.wrap_v_)
+            {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, state.wrap_v_);
+            }
+            if (state.anisotropy_ != sampler_state_.anisotropy_ && state.anisotropy_ > 0.f)
+            {
+                glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, state.anisotropy_);
+            }
+            if (state.lod_bias_ != sampler_state_.lod_bias_)
+            {
+                glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, state.lod_bias_);
+            }
+            glActiveTexture(GL_TEXTURE0);
+            sampler_state_ = state;
         }
 
 
@@ -422,6 +946,12 @@ namespace kong
             // attach color texture to frame buffer
             glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture_name_, 0);
 
+            memory_size_ = IImage::GetDataSizeFromFormat(ColorFormat, image_size_.width_, image_size_.height_);
+            if (depth_test)
+            {
+                memory_size_ += image_size_.width_ * image_size_.height_ * 4;
+            }
+
 #ifdef _DEBUG
             checkFBOStatus(driver);
 #endif
@@ -466,9 +996,10 @@ namespace kong
             const core::Dimension2d<u32>& size,
             const io::path& name,
             COpenGLDriver* driver,
-            bool useStencil)
+            bool useStencil,
+            u32 layers)
             : COpenGLTexture(name, driver), DepthRenderBuffer(0),
-            StencilRenderBuffer(0), UseStencil(useStencil)
+            StencilRenderBuffer(0), UseStencil(useStencil), layers_(core::max_<u32>(layers, 1))
         {
 #ifdef _DEBUG
             //setDebugName("COpenGLTextureFBO_Depth");
@@ -481,7 +1012,18 @@ namespace kong
             pixel_format_ = GL_UNSIGNED_BYTE;
             has_mip_maps_ = false;
 
-            if (useStencil)
+            if (useStencil && layers_ > 1)
+            {
+                // one depth layer per cascade, rendered one after another
+                glGenTextures(1, &DepthRenderBuffer);
+                glBindTexture(GL_TEXTURE_2D_ARRAY, DepthRenderBuffer);
+                glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32, image_size_.width_,
+                    image_size_.height_, layers_, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+            }
+            else if (useStencil)
             {
                 glGenTextures(1, &DepthRenderBuffer);
                 glBindTexture(GL_TEXTURE_2D, DepthRenderBuffer);
@@ -514,6 +1056,7 @@ namespace kong
             }
 
             texture_name_ = DepthRenderBuffer;
+            memory_size_ = image_size_.width_ * image_size_.height_ * 4 * layers_;
         }
 
 
@@ -546,7 +1089,11 @@ namespace kong
                 return false;
             video::COpenGLFBOTexture* rtt = static_cast<video::COpenGLFBOTexture*>(renderTex);
             rtt->bindRTT();
-            if (UseStencil)
+            if (UseStencil && layers_ > 1)
+            {
+                AttachLayer(0);
+            }
+            else if (UseStencil)
             {
                 // attach stencil texture to stencil buffer
                 //glFramebufferTexture2D(GL_FRAMEBUFFER,
@@ -582,6 +1129,24 @@ namespace kong
             return true;
         }
 
+        void COpenGLFBODepthTexture::AttachLayer(u32 layer) const
+        {
+            if (layer < layers_)
+            {
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, DepthRenderBuffer, 0, layer);
+            }
+        }
+
+        u32 COpenGLFBODepthTexture::GetLayerCount() const
+        {
+            return layers_;
+        }
+
+        GLenum COpenGLFBODepthTexture::GetOpenGLTextureTarget() const
+        {
+            return layers_ > 1 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+        }
+
         
 
         COpenGLFBODeferredTexture::COpenGLFBODeferredTexture(const core::Dimension2d<u32>& size, const io::path& name, COpenGLDriver* driver)
@@ -655,6 +1220,9 @@ namespace kong
             glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, image_size_.width_, image_size_.height_);
             glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_texture_name_);
 
+            // two half float rgb targets, the rgba target and the depth buffer
+            memory_size_ = image_size_.width_ * image_size_.height_ * (6 + 6 + 4 + 4);
+
             //// depth buffer
             //glGenTextures(1, &depth_texture_name_);
             //glBindTexture(GL_TEXTURE_2D, depth_texture_name_);
@@ -0,0 +1,247 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "COpenGLTextureStreamer.h"
+
+#ifdef _KONG_COMPILE_WITH_OPENGL_
+
+#include "COpenGLTexture.h"
+#include "CImage.h"
+#include "CImagePyramid.h"
+#include "os.h"
+#include <cstring>
+
+namespace kong
+{
+    namespace video
+    {
+        //! gives uncompressed images their full mip chain, so the render thread only has to upload them
+        static IImage* AddMipMaps(IImage* image)
+        {
+            if (image == nullptr || IImage::IsCompressedFormat(image->GetColorFormat()))
+            {
+                return image;
+            }
+
+            CImage *result = dynamic_cast<CImage *>(image);
+            if (result == nullptr || image->GetColorFormat() != ECF_A8R8G8B8)
+            {
+                result = new CImage(ECF_A8R8G8B8, image->GetDimension());
+                image->CopyTo(result);
+                delete image;
+            }
+
+            const core::Dimension2d<u32> size = result->GetDimension();
+            const u32 count = CImagePyramid::GetLevelCount(size);
+            if (count == 1 || result->GetMipMapLevelCount() == count)
+            {
+                return result;
+            }
+
+            CImagePyramid pyramid;
+            pyramid.Build(result);
+            u32 mip_maps_size = 0;
+            for (u32 level = 1; level < count; ++level)
+            {
+                mip_maps_size += pyramid.GetLevel(level)->GetImageDataSizeInBytes();
+            }
+
+            // the levels after level 0 are stored one after another
+            u8 *mip_maps = new u8[mip_maps_size];
+            u8 *target = mip_maps;
+            for (u32 level = 1; level < count; ++level)
+            {
+                IImage *level_image = pyramid.GetLevel(level);
+                memcpy(target, level_image->Lock(), level_image->GetImageDataSizeInBytes());
+                level_image->Unlock();
+                target += level_image->GetImageDataSizeInBytes();
+            }
+            result->SetMipMapsData(mip_maps, count);
+            return result;
+        }
+
+        COpenGLTextureStreamer::COpenGLTextureStreamer(const DecodeFunction& decode, u32 thread_count)
+            : decode_(decode), stop_(false)
+        {
+            if (thread_count == 0)
+            {
+                // the render thread keeps its own core
+                const u32 cores = std::thread::hardware_concurrency();
+                thread_count = cores > 1 ? cores - 1 : 1;
+            }
+
+            for (u32 i = 0; i < thread_count; ++i)
+            {
+                workers_.emplace_back(&COpenGLTextureStreamer::WorkerLoop, this);
+            }
+        }
+
+        COpenGLTextureStreamer::~COpenGLTextureStreamer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_condition_.notify_all();
+
+            for (auto& worker : workers_)
+            {
+                worker.join();
+            }
+
+            for (u32 i = 0; i < requests_.Size(); ++i)
+            {
+                delete requests_[i]->file_;
+                delete requests_[i]->image_;
+                delete requests_[i];
+            }
+        }
+
+        void COpenGLTextureStreamer::AddRequest(COpenGLTexture* texture, io::IReadFile* file)
+        {
+            SRequest *request = new SRequest();
+            request->texture_ = texture;
+            request->file_ = file;
+            request->image_ = nullptr;
+            request->priority_ = 0.f;
+            request->frame_priority_ = 0.f;
+            request->state_ = ERS_QUEUED;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                requests_.PushBack(request);
+            }
+            wake_condition_.notify_one();
+        }
+
+        bool COpenGLTextureStreamer::IsPending(const ITexture* texture) const
+        {
+            return FindTexture(texture) != -1;
+        }
+
+        u32 COpenGLTextureStreamer::GetPendingCount() const
+        {
+            return requests_.Size();
+        }
+
+        void COpenGLTextureStreamer::RaisePriority(const ITexture* texture, f32 screen_area)
+        {
+            const s32 index = FindTexture(texture);
+            if (index != -1)
+            {
+                SRequest *request = requests_[index];
+                request->frame_priority_ = core::max_(request->frame_priority_, screen_area);
+            }
+        }
+
+        u32 COpenGLTextureStreamer::Update(u32 byte_budget)
+        {
+            if (requests_.Empty())
+            {
+                return 0;
+            }
+
+            core::Array<SRequest*> finished;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                // the workers pick their next file by the sizes of the last frame
+                for (u32 i = 0; i < requests_.Size(); ++i)
+                {
+                    requests_[i]->priority_ = requests_[i]->frame_priority_;
+                    requests_[i]->frame_priority_ = 0.f;
+                }
+
+                u32 bytes = 0;
+                for (s32 index = FindRequest(ERS_DECODED); index != -1; index = FindRequest(ERS_DECODED))
+                {
+                    // the mip map levels add up to a third of level 0
+                    const IImage *image = requests_[index]->image_;
+                    const u32 size = image != nullptr ? image->GetImageDataSizeInBytes() / 3 * 4 : 0;
+                    if (!finished.Empty() && bytes + size > byte_budget)
+                    {
+                        break;
+                    }
+
+                    bytes += size;
+                    finished.PushBack(requests_[index]);
+                    requests_.Erase(index);
+                }
+            }
+
+            for (u32 i = 0; i < finished.Size(); ++i)
+            {
+                SRequest *request = finished[i];
+                if (request->image_ != nullptr)
+                {
+                    request->texture_->SetImage(request->image_);
+                    delete request->image_;
+                }
+                else
+                {
+                    os::Printer::log("Could not load streamed texture", request->texture_->GetName().GetPath(), ELL_ERROR);
+                }
+                delete request;
+            }
+            return finished.Size();
+        }
+
+        void COpenGLTextureStreamer::WorkerLoop()
+        {
+            for (;;)
+            {
+                SRequest *request;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_condition_.wait(lock, [this] { return stop_ || FindRequest(ERS_QUEUED) != -1; });
+                    if (stop_)
+                    {
+                        return;
+                    }
+                    request = requests_[FindRequest(ERS_QUEUED)];
+                    request->state_ = ERS_DECODING;
+                }
+
+                // the request stays in the list until Update takes it, which waits for ERS_DECODED
+                IImage *image = AddMipMaps(decode_(request->file_));
+                delete request->file_;
+                request->file_ = nullptr;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    request->image_ = image;
+                    request->state_ = ERS_DECODED;
+                }
+            }
+        }
+
+        s32 COpenGLTextureStreamer::FindRequest(E_REQUEST_STATE state) const
+        {
+            // the first request wins between equal priorities, so unseen textures load in order
+            s32 result = -1;
+            for (u32 i = 0; i < requests_.Size(); ++i)
+            {
+                if (requests_[i]->state_ == state && (result == -1 || requests_[i]->priority_ > requests_[result]->priority_))
+                {
+                    result = static_cast<s32>(i);
+                }
+            }
+            return result;
+        }
+
+        s32 COpenGLTextureStreamer::FindTexture(const ITexture* texture) const
+        {
+            for (u32 i = 0; i < requests_.Size(); ++i)
+            {
+                if (requests_[i]->texture_ == texture)
+                {
+                    return static_cast<s32>(i);
+                }
+            }
+            return -1;
+        }
+
+    } // end namespace video
+} // end namespace kong
+
+#endif
@@ -20,7 +20,7 @@ namespace kong
 
         CPlaneSceneNode::~CPlaneSceneNode()
         {
-            delete mesh_;
+            DropMesh(mesh_);
         }
 
         const core::aabbox3d<f32>& CPlaneSceneNode::GetBoundingBox() const
@@ -60,8 +60,12 @@ namespace kong
 
         void CPlaneSceneNode::SetMesh(IMesh* mesh)
         {
-            //delete mesh_;
-            mesh_ = mesh;
+            if (mesh != nullptr)
+            {
+                mesh->Grab();
+                DropMesh(mesh_);
+                mesh_ = mesh;
+            }
         }
 
         IMesh* CPlaneSceneNode::GetMesh()
@@ -131,16 +135,6 @@ namespace kong
 
             buffer->indices_.Reallocate(36);
 
-            // reallocate the barycentric buffer
-            for (int i = 0; i < 6; i++)
-            {
-                int idx = i * 4;
-                buffer->vertices_[idx].barycentric_ = core::vector3df(1.f, 0.f, 0.f);
-                buffer->vertices_[idx + 1].barycentric_ = core::vector3df(0.f, 1.f, 0.f);
-                buffer->vertices_[idx + 2].barycentric_ = core::vector3df(0.f, 0.f, 1.f);
-                buffer->vertices_[idx + 3].barycentric_ = core::vector3df(0.f, 1.f, 0.f);
-            }
-
             for (auto indice : indices)
             {
                 buffer->indices_.PushBack(indice);
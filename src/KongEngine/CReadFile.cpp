@@ -72,8 +72,10 @@ namespace kong
 
 #if defined ( _KONG_WCHAR_FILESYSTEM )
             file_ = _wfopen(filename_.c_str(), L"rb");
-#else
+#elif defined(_MSC_VER)
             fopen_s(&file_, filename_.c_str(), "rb");
+#else
+            file_ = fopen(filename_.c_str(), "rb");
 #endif
 
             if (file_)
@@ -0,0 +1,252 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CRenderQueue.h"
+#include "IVideoDriver.h"
+#include "KongMath.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        bool CRenderQueue::STextureSet::operator<(const STextureSet& other) const
+        {
+            for (u32 i = 0; i < video::MATERIAL_MAX_TEXTURES; ++i)
+            {
+                if (textures_[i] != other.textures_[i])
+                {
+                    return textures_[i] < other.textures_[i];
+                }
+            }
+            return false;
+        }
+
+        bool CRenderQueue::STextureSet::operator==(const STextureSet& other) const
+        {
+            for (u32 i = 0; i < video::MATERIAL_MAX_TEXTURES; ++i)
+            {
+                if (textures_[i] != other.textures_[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        u32 CRenderQueue::HashMaterial(const video::SMaterial& material)
+        {
+            const u32 values[] = {
+                material.ambient_color_.color_, material.diffuse_color_.color_,
+                material.specular_color_.color_, material.emissive_color_.color_,
+                core::IR(material.shininess_), static_cast<u32>(material.MaterialType),
+                material.ZBuffer, material.ZWriteEnable, material.BackfaceCulling,
+                material.FrontfaceCulling, material.Lighting, material.Wireframe
+            };
+
+            // fnv-1a
+            u32 hash = 2166136261u;
+            for (u32 i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+            {
+                hash = (hash ^ values[i]) * 16777619u;
+            }
+            return hash ^ (hash >> KEY_MATERIAL_BITS);
+        }
+
+        bool CRenderQueue::CanInstance(const SRenderItem& item, const SRenderItem& other)
+        {
+            return item.mesh_buffer_ == other.mesh_buffer_ && item.rendering_mode_ == other.rendering_mode_ &&
+                (item.material_ == other.material_ ||
+                (item.texture_set_ == other.texture_set_ && *item.material_ == *other.material_));
+        }
+
+        template <typename K>
+        u32 CRenderQueue::GetId(core::Map<K, SKeyId>& ids, u32& next_id, const K& key, u32 bits) const
+        {
+            typename core::Map<K, SKeyId>::Node *node = ids.find(key);
+            if (node != nullptr)
+            {
+                node->getValue().frame_ = frame_;
+                return node->getValue().id_;
+            }
+
+            if (next_id >= (1u << bits))
+            {
+                ids.clear();
+                next_id = 0;
+            }
+
+            SKeyId id;
+            id.id_ = next_id++;
+            id.frame_ = frame_;
+            ids.insert(key, id);
+            return id.id_;
+        }
+
+        template <typename K>
+        void CRenderQueue::PruneIds(core::Map<K, SKeyId>& ids, u32& next_id, u32 bits) const
+        {
+            core::Array<K> unused;
+            for (typename core::Map<K, SKeyId>::Iterator it = ids.getIterator(); !it.atEnd(); it++)
+            {
+                if (it->getValue().frame_ != frame_)
+                {
+                    unused.PushBack(it->getKey());
+                }
+            }
+            for (u32 i = 0; i < unused.Size(); ++i)
+            {
+                ids.remove(unused[i]);
+            }
+
+            // the ids stay the same until the field would run out of them in the middle of a frame
+            if (next_id >= (1u << bits) / 2)
+            {
+                next_id = 0;
+                for (typename core::Map<K, SKeyId>::Iterator it = ids.getIterator(); !it.atEnd(); it++)
+                {
+                    it->getValue().id_ = next_id++;
+                }
+            }
+        }
+
+        CRenderQueue::CRenderQueue()
+            : next_texture_set_id_(0), next_buffer_id_(0), frame_(0),
+            draw_calls_(0), instances_(0), material_changes_(0)
+        {
+        }
+
+        void CRenderQueue::Add(const IMeshBuffer* mesh_buffer, const video::SMaterial& material,
+            const core::Matrixf& transform, video::E_RENDERING_MODE rendering_mode)
+        {
+            STextureSet texture_set;
+            for (u32 i = 0; i < video::MATERIAL_MAX_TEXTURES; ++i)
+            {
+                texture_set.textures_[i] = material.GetTexture(i);
+            }
+
+            SRenderItem item;
+            item.texture_set_ = GetId(texture_set_ids_, next_texture_set_id_, texture_set, KEY_TEXTURE_BITS);
+            item.mesh_buffer_ = mesh_buffer;
+            item.material_ = &material;
+            item.transform_ = &transform;
+            item.rendering_mode_ = rendering_mode;
+
+            const u32 type = core::min_(static_cast<u32>(material.MaterialType), (1u << KEY_TYPE_BITS) - 1);
+            const u32 mode = core::min_(static_cast<u32>(rendering_mode), (1u << KEY_MODE_BITS) - 1);
+
+            u64 key = mode;
+            key = (key << KEY_TYPE_BITS) | type;
+            key = (key << KEY_TEXTURE_BITS) | item.texture_set_;
+            key = (key << KEY_MATERIAL_BITS) | (HashMaterial(material) & ((1u << KEY_MATERIAL_BITS) - 1));
+            key = (key << KEY_BUFFER_BITS) | GetId(buffer_ids_, next_buffer_id_, mesh_buffer, KEY_BUFFER_BITS);
+            item.key_ = key;
+
+            items_.PushBack(item);
+        }
+
+        void CRenderQueue::Render(video::IVideoDriver* driver)
+        {
+            draw_calls_ = 0;
+            instances_ = 0;
+            material_changes_ = 0;
+
+            // buffers and textures which were not added this frame may be deleted before the next one
+            PruneIds(texture_set_ids_, next_texture_set_id_, KEY_TEXTURE_BITS);
+            PruneIds(buffer_ids_, next_buffer_id_, KEY_BUFFER_BITS);
+            ++frame_;
+
+            if (driver == nullptr || items_.Empty())
+            {
+                Clear();
+                return;
+            }
+
+            items_.Sort();
+
+            // the driver state is unknown before the first item
+            const SRenderItem *last = nullptr;
+            const core::Matrixf *world = nullptr;
+            u32 i = 0;
+            while (i < items_.Size())
+            {
+                const SRenderItem& item = items_.ConstPointer()[i];
+
+                if (last == nullptr || item.rendering_mode_ != last->rendering_mode_)
+                {
+                    driver->SetRenderingMode(item.rendering_mode_);
+                }
+
+                // the texture set ids tell apart most materials before all their values are compared
+                if (last == nullptr || (item.material_ != last->material_ &&
+                    (item.texture_set_ != last->texture_set_ || *item.material_ != *last->material_)))
+                {
+                    driver->SetMaterial(*item.material_);
+                    ++material_changes_;
+                }
+
+                // equal keys are next to each other, so all instances of a buffer are one run
+                u32 end = i + 1;
+                while (end < items_.Size() && CanInstance(items_.ConstPointer()[end], item))
+                {
+                    ++end;
+                }
+
+                if (end - i > 1)
+                {
+                    instance_transforms_.Resize(0);
+                    for (u32 j = i; j < end; ++j)
+                    {
+                        instance_transforms_.PushBack(*items_.ConstPointer()[j].transform_);
+                    }
+
+                    driver->DrawMeshBufferInstanced(item.mesh_buffer_, instance_transforms_.ConstPointer(), end - i);
+                    instances_ += end - i;
+
+                    // the world transform of the driver is undefined now
+                    world = nullptr;
+                }
+                else
+                {
+                    if (item.transform_ != world)
+                    {
+                        driver->SetTransform(video::ETS_WORLD, *item.transform_);
+                        world = item.transform_;
+                    }
+                    driver->DrawMeshBuffer(item.mesh_buffer_);
+                }
+
+                ++draw_calls_;
+                last = &items_.ConstPointer()[end - 1];
+                i = end;
+            }
+
+            Clear();
+        }
+
+        void CRenderQueue::Clear()
+        {
+            // keeps the memory for the next frame
+            items_.Resize(0);
+        }
+
+        u32 CRenderQueue::GetItemCount() const
+        {
+            return items_.Size();
+        }
+
+        u32 CRenderQueue::GetDrawCallCount() const
+        {
+            return draw_calls_;
+        }
+
+        u32 CRenderQueue::GetInstanceCount() const
+        {
+            return instances_;
+        }
+
+        u32 CRenderQueue::GetMaterialChangeCount() const
+        {
+            return material_changes_;
+        }
+    } // end namespace scene
+} // end namespace kong
@@ -9,6 +9,11 @@
 #include "CLightSceneNode.h"
 #include "CPlaneSceneNode.h"
 #include "COrthogonalCameraSceneNode.h"
+#include "CCompiledMeshFileLoader.h"
+#include "CCompiledMeshWriter.h"
+#include "CMeshCache.h"
+#include "IWriteFile.h"
+#include <chrono>
 
 #ifdef _KONG_COMPILE_WITH_OBJ_LOADER_
 #include "CObjMeshFileLoader.h"
@@ -18,10 +23,27 @@ namespace kong
 {
     namespace scene
     {
+        //! smallest shadow map of a light in the shadow atlas
+        static const u32 SHADOW_ATLAS_MIN_TILE = 64;
+
+        //! returns the milliseconds since start and restarts the measurement
+        static f32 RestartPassTimer(std::chrono::high_resolution_clock::time_point& start)
+        {
+            const std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+            const f32 elapsed = std::chrono::duration<f32, std::milli>(now - start).count();
+            start = now;
+            return elapsed;
+        }
+
         CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem *fs)
             : ISceneNode(nullptr, nullptr), driver_(driver), shadow_color_(150, 0, 0, 0),
-            ambient_light_(0, 0, 0, 0), active_camera_(nullptr), file_system_(fs), shadow_enable_(false), light_index_num_(0), main_light_index_(0)
+            ambient_light_(0, 0, 0, 0), active_camera_(nullptr), file_system_(fs), shadow_enable_(false),
+            shadow_cascades_(video::MAX_SHADOW_CASCADES), shadow_split_lambda_(0.75f), shadow_distance_(0.f), light_index_num_(0), main_light_index_(0),
+            culling_enabled_(false), culling_frame_(0)
         {
+            mesh_cache_ = new CMeshCache(driver);
+            compiled_mesh_loader_ = new CCompiledMeshFileLoader(this, fs);
+            MeshLoaderList.PushBack(compiled_mesh_loader_);
 #ifdef _KONG_COMPILE_WITH_OBJ_LOADER_
             MeshLoaderList.PushBack(new COBJMeshFileLoader(this, fs));
 #endif
@@ -54,13 +76,29 @@ namespace kong
                 delete shadow_node_list_[i];
             }
             shadow_node_list_.Clear();
+
+            // meshes which nodes still show are deleted together with the nodes
+            delete mesh_cache_;
         }
 
         IAnimatedMesh* CSceneManager::getMesh(const io::path& filename)
         {
-            IAnimatedMesh* msh = nullptr;
+            // a mesh is loaded once and shared by all its users
+            const io::path absolute_name = file_system_->GetAbsolutePath(filename);
+            IAnimatedMesh* msh = mesh_cache_->GetMeshByName(absolute_name);
+            if (msh != nullptr)
+                return msh;
 
-            io::IReadFile* file = file_system_->CreateAndOpenFile(filename);
+            msh = LoadCompiledMesh(filename);
+            if (msh != nullptr)
+            {
+                mesh_cache_->AddMesh(absolute_name, msh);
+                msh->Drop();
+                return msh;
+            }
+
+            // mesh loaders can parse mapped files without copying them
+            io::IReadFile* file = file_system_->CreateAndMapFile(filename);
             if (!file)
             {
                 os::Printer::log("Could not load mesh, because file could not be opened: ", filename, ELL_ERROR);
@@ -68,6 +106,7 @@ namespace kong
             }
 
             // iterate the list in reverse order so user-added loaders can override the built-in ones
+            IMeshLoader* loader = nullptr;
             s32 count = MeshLoaderList.Size();
             for (s32 i = count - 1; i >= 0; --i)
             {
@@ -78,8 +117,7 @@ namespace kong
                     msh = MeshLoaderList[i]->createMesh(file);
                     if (msh != nullptr)
                     {
-                        //MeshCache->addMesh(filename, msh);
-                        //msh->drop();
+                        loader = MeshLoaderList[i];
                         break;
                     }
                 }
@@ -90,7 +128,12 @@ namespace kong
             if (msh == nullptr)
                 os::Printer::log("Could not load mesh, file format seems to be unsupported", filename, ELL_ERROR);
             else
+            {
                 os::Printer::log("Loaded mesh", filename, ELL_INFORMATION);
+                WriteCompiledMesh(filename, msh, loader);
+                mesh_cache_->AddMesh(absolute_name, msh);
+                msh->Drop();
+            }
 
             return msh;
         }
@@ -101,8 +144,8 @@ namespace kong
                 return 0;
 
             io::path name = file->GetFileName();
-            //IAnimatedMesh* msh = MeshCache->getMeshByName(file->getFileName());
-            IAnimatedMesh* msh = nullptr;
+            const io::path absolute_name = file_system_->GetAbsolutePath(name);
+            IAnimatedMesh* msh = mesh_cache_->GetMeshByName(absolute_name);
             if (msh != nullptr)
                 return msh;
 
@@ -116,20 +159,71 @@ namespace kong
                     file->Seek(0);
                     msh = MeshLoaderList[i]->createMesh(file);
                     if (msh)
-                    {
-                        //MeshCache->addMesh(file->getFileName(), msh);
-                        //msh->drop();
                         break;
-                    }
                 }
             }
 
             if (!msh)
                 os::Printer::log("Could not load mesh, file format seems to be unsupported", file->GetFileName(), ELL_ERROR);
             else
+            {
                 os::Printer::log("Loaded mesh", file->GetFileName(), ELL_INFORMATION);
+                mesh_cache_->AddMesh(absolute_name, msh);
+                msh->Drop();
+            }
+
+            return msh;
+        }
+
+        IAnimatedMesh* CSceneManager::LoadCompiledMesh(const io::path& filename)
+        {
+#ifdef _KONG_COMPILE_WITH_COMPILED_MESH_CACHE_
+            // a compiled mesh is its own cache
+            const io::path compiled_name = filename + COMPILED_MESH_EXTENSION;
+            if (compiled_mesh_loader_->isALoadableFileExtension(filename) ||
+                !file_system_->IsFileNewer(compiled_name, filename))
+                return nullptr;
+
+            io::IReadFile* file = file_system_->CreateAndMapFile(compiled_name);
+            if (file == nullptr)
+                return nullptr;
+
+            // the loader rejects a compiled mesh older than its dependencies before building it
+            IAnimatedMesh* msh = compiled_mesh_loader_->createMesh(file);
+            delete file;
+            if (msh == nullptr)
+                return nullptr;
 
+            os::Printer::log("Loaded compiled mesh", compiled_name, ELL_INFORMATION);
             return msh;
+#else
+            return nullptr;
+#endif
+        }
+
+        void CSceneManager::WriteCompiledMesh(const io::path& filename, IAnimatedMesh* mesh, const IMeshLoader* loader)
+        {
+#ifdef _KONG_COMPILE_WITH_COMPILED_MESH_CACHE_
+            if (compiled_mesh_loader_->isALoadableFileExtension(filename) || mesh->getFrameCount() != 1)
+                return;
+
+            const io::path compiled_name = filename + COMPILED_MESH_EXTENSION;
+            io::IWriteFile* file = file_system_->CreateAndWriteFile(compiled_name);
+            if (file == nullptr)
+            {
+                os::Printer::log("Could not write compiled mesh", compiled_name, ELL_WARNING);
+                return;
+            }
+
+            core::Array<io::path> dependencies;
+            loader->getDependencies(dependencies);
+
+            // an incomplete file is rejected by the loader, so it is parsed and written again next time
+            CCompiledMeshWriter writer;
+            if (!writer.WriteMesh(file, mesh, dependencies))
+                os::Printer::log("Could not write compiled mesh", compiled_name, ELL_WARNING);
+            delete file;
+#endif
         }
 
         IMeshSceneNode* CSceneManager::AddCubeSceneNode(f32 size, ISceneNode* parent, s32 id,
@@ -251,6 +345,16 @@ namespace kong
         {
             shadow_enable_ = flag;
             driver_->EnableShadow(flag);
+
+            // the driver creates new shadow textures
+            shadow_atlas_.InvalidateTiles();
+        }
+
+        void CSceneManager::SetShadowCascades(u32 count, f32 split_lambda, f32 max_distance)
+        {
+            shadow_cascades_ = core::clamp(count, 1u, video::MAX_SHADOW_CASCADES);
+            shadow_split_lambda_ = core::clamp(split_lambda, 0.f, 1.f);
+            shadow_distance_ = core::max_(max_distance, 0.f);
         }
 
         video::SColor CSceneManager::GetShadowColor() const
@@ -291,38 +395,40 @@ namespace kong
             // do animations and other stuff.
             OnAnimate(0);
 
+            render_statistics_.Reset();
 
             // let all nodes register themselves
+            BeginCulling();
             OnRegisterSceneNode();
+            EndCulling();
+
+            std::chrono::high_resolution_clock::time_point pass_start = std::chrono::high_resolution_clock::now();
 
             // render shadow pass
             if (shadow_enable_)
             {
-                driver_->BeginShadowRender();
-
                 // set light transform used for shadow
                 u32 max_lights = light_list_.Size();
                 max_lights = core::min_(driver_->GetMaximalDynamicLightAmount(), max_lights);
 
-                for (u32 i = 0; i < max_lights; ++i)
+                ILightSceneNode *main_light = nullptr;
+                for (u32 i = 0; i < max_lights && main_light == nullptr; ++i)
                 {
                     if (dynamic_cast<ILightSceneNode *>(light_list_[i])->GetLightIndex() == main_light_index_)
                     {
-                        dynamic_cast<ILightSceneNode *>(light_list_[i])->ResetCameraTransform(solid_node_list_);
-                        dynamic_cast<ILightSceneNode *>(light_list_[i])->RenderShadow();
+                        main_light = dynamic_cast<ILightSceneNode *>(light_list_[i]);
                     }
                 }
 
-                // render default objects
+                if (driver_->GetShadowAtlasSize() > 0)
                 {
-                    for (u32 i = 0; i < solid_node_list_.Size(); ++i)
-                    {
-                        solid_node_list_[i].node_->Render();
-                    }
-
-                    //solid_node_list_.Resize(0);
+                    RenderShadowAtlas(max_lights);
+                }
+                else
+                {
+                    RenderShadowMaps(main_light);
                 }
-                driver_->EndShadowRender();
+                render_statistics_.pass_time_[ERPT_SHADOW] = RestartPassTimer(pass_start);
             }
 
             // render first pass
@@ -344,12 +450,14 @@ namespace kong
                 {
                     for (u32 i = 0; i < solid_node_list_.Size(); ++i)
                     {
-                        solid_node_list_[i].node_->Render();
+                        SubmitNode(solid_node_list_[i].node_);
                     }
+                    FlushRenderQueue();
 
                     //solid_node_list_.Resize(0);
                 }
             }
+            render_statistics_.pass_time_[ERPT_GEOMETRY] = RestartPassTimer(pass_start);
 
             // render second pass
             driver_->RenderSecondPass();
@@ -401,11 +509,18 @@ namespace kong
 
                 driver_->DrawSpaceFillQuad();
             }
+            render_statistics_.pass_time_[ERPT_LIGHTING] = RestartPassTimer(pass_start);
 
             driver_->RenderFxaaPass();
             {
                 driver_->DrawSpaceFillQuad();
             }
+            render_statistics_.pass_time_[ERPT_POST_PROCESS] = RestartPassTimer(pass_start);
+        }
+
+        const SRenderStatistics& CSceneManager::GetRenderStatistics() const
+        {
+            return render_statistics_;
         }
 
         void CSceneManager::RemoveAll()
@@ -444,29 +559,20 @@ namespace kong
                 cam_world_pos_ = active_camera_->GetAbsolutePosition();
             }
 
+            render_statistics_.Reset();
+
             // let all nodes register themselves
+            BeginCulling();
             OnRegisterSceneNode();
+            EndCulling();
+
+            std::chrono::high_resolution_clock::time_point pass_start = std::chrono::high_resolution_clock::now();
 
             //render shadow
             if (shadow_enable_)
             {
-                driver_->BeginShadowRender();
-
-                // render lights
-                dynamic_cast<ILightSceneNode *>(light_list_[0])->ResetCameraTransform(solid_node_list_);
-                dynamic_cast<ILightSceneNode *>(light_list_[0])->RenderShadow();
-
-                // render default objects
-                {
-                    for (u32 i = 0; i < solid_node_list_.Size(); ++i)
-                    {
-                        solid_node_list_[i].node_->Render();
-                    }
-
-                    //solid_node_list_.Resize(0);
-                }
-
-                driver_->EndShadowRender();
+                RenderShadowMaps(light_list_.Empty() ? nullptr : dynamic_cast<ILightSceneNode *>(light_list_[0]));
+                render_statistics_.pass_time_[ERPT_SHADOW] = RestartPassTimer(pass_start);
             }
 
             //render lights scenes
@@ -496,11 +602,13 @@ namespace kong
             {
                 for (u32 i = 0; i < solid_node_list_.Size(); ++i)
                 {
-                    solid_node_list_[i].node_->Render();
+                    SubmitNode(solid_node_list_[i].node_);
                 }
+                FlushRenderQueue();
 
                 solid_node_list_.Resize(0);
             }
+            render_statistics_.pass_time_[ERPT_GEOMETRY] = RestartPassTimer(pass_start);
         }
 
         video::IVideoDriver* CSceneManager::GetVideoDriver() const
@@ -548,7 +656,7 @@ namespace kong
                 //taken = 1;
                 break;
             case ESNRP_SOLID:
-                //if (!isCulled(node))
+                if (!IsCulled(node))
                 {
                     solid_node_list_.PushBack(node);
                     taken = 1;
@@ -608,25 +716,467 @@ namespace kong
                 break;
             }
 
-#ifdef _KONG_SCENEMANAGER_DEBUG
-            s32 index = Parameters.findAttribute("calls");
-            Parameters.setAttribute(index, Parameters.getAttributeAsInt(index) + 1);
-
-            if (!taken)
+            ++render_statistics_.registered_nodes_;
+            if (taken)
             {
-                index = Parameters.findAttribute("culled");
-                Parameters.setAttribute(index, Parameters.getAttributeAsInt(index) + 1);
+                ++render_statistics_.visible_nodes_;
+            }
+            else
+            {
+                ++render_statistics_.culled_nodes_;
             }
-#endif
 
             return taken;
         }
 
+        void CSceneManager::BeginCulling()
+        {
+            ++culling_frame_;
+            dirty_boxes_.Resize(0);
+
+            // without a camera there is no frustum, everything is drawn
+            culling_enabled_ = active_camera_ != nullptr;
+            if (culling_enabled_)
+            {
+                view_frustum_ = active_camera_->GetViewFrustum();
+                culling_tree_.MarkVisible(view_frustum_, culling_frame_);
+            }
+        }
+
+        void CSceneManager::EndCulling()
+        {
+            // deleted and hidden nodes leave their shadows behind
+            removed_proxies_.Resize(0);
+            culling_tree_.RemoveUnregistered(culling_frame_, &removed_proxies_);
+            for (u32 i = 0; i < removed_proxies_.Size(); ++i)
+            {
+                dirty_boxes_.PushBack(proxy_states_.ConstPointer()[removed_proxies_.ConstPointer()[i]].box_);
+            }
+            render_statistics_.changed_nodes_ += removed_proxies_.Size();
+        }
+
+        void CSceneManager::TrackNodeChanges(ISceneNode* node, s32 proxy, const core::aabbox3df& box, bool created)
+        {
+            if (static_cast<u32>(proxy) >= proxy_states_.Size())
+            {
+                proxy_states_.Resize(proxy + 1);
+            }
+
+            SProxyState &state = proxy_states_.Pointer()[proxy];
+            const u32 geometry_id = node->GetGeometryChangedID();
+            if (!created)
+            {
+                if (state.transform_ == node->GetAbsoluteTransformation() && state.geometry_id_ == geometry_id && state.box_ == box)
+                {
+                    return;
+                }
+                dirty_boxes_.PushBack(state.box_);
+            }
+
+            dirty_boxes_.PushBack(box);
+            ++render_statistics_.changed_nodes_;
+            state.transform_ = node->GetAbsoluteTransformation();
+            state.box_ = box;
+            state.geometry_id_ = geometry_id;
+        }
+
+        bool CSceneManager::IsShadowViewDirty(const SViewFrustum& frustum) const
+        {
+            // the casters reach back to the light, like in CollectShadowCasters()
+            const u32 plane_mask = SViewFrustum::ALL_PLANES & ~(1 << SViewFrustum::VF_NEAR_PLANE);
+            for (u32 i = 0; i < dirty_boxes_.Size(); ++i)
+            {
+                u32 node_mask = plane_mask;
+                if (frustum.ClassifyBox(dirty_boxes_.ConstPointer()[i], node_mask) != EFR_OUTSIDE)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void CSceneManager::CollectShadowCasters(ILightSceneNode* light)
+        {
+            shadow_caster_list_.Resize(0);
+
+            // nothing visible receives a shadow
+            if (solid_node_list_.Empty())
+            {
+                return;
+            }
+
+            // without the near plane the frustum reaches back to the light, so it
+            // contains everything which can throw a shadow onto the receivers
+            const SViewFrustum frustum = light->GetShadowCamera()->GetViewFrustum();
+            const u32 plane_mask = SViewFrustum::ALL_PLANES & ~(1 << SViewFrustum::VF_NEAR_PLANE);
+            culling_tree_.CollectVisible(frustum, shadow_caster_list_, plane_mask);
+
+            // the tree tests enlarged boxes
+            u32 count = 0;
+            ISceneNode** casters = shadow_caster_list_.Pointer();
+            for (u32 i = 0; i < shadow_caster_list_.Size(); ++i)
+            {
+                u32 node_mask = plane_mask;
+                if (frustum.ClassifyBox(casters[i]->GetTransformedBoundingBox(), node_mask) != EFR_OUTSIDE)
+                {
+                    casters[count++] = casters[i];
+                }
+            }
+            shadow_caster_list_.Resize(count);
+
+            light->FitShadowCasters(shadow_caster_list_);
+        }
+
+        void CSceneManager::RenderShadowMaps(ILightSceneNode* light)
+        {
+            driver_->BeginShadowRender();
+
+            std::chrono::high_resolution_clock::time_point cascade_start = std::chrono::high_resolution_clock::now();
+            const bool cascaded = light != nullptr && light->GetLightType() == video::ELT_DIRECTIONAL && active_camera_ != nullptr;
+            const u32 cascades = cascaded ? core::min_(shadow_cascades_, driver_->GetMaximalShadowCascadeAmount()) : 1;
+
+            f32 slice_start = 0.f;
+            f32 splits[video::MAX_SHADOW_CASCADES] = { FLT_MAX };
+            if (cascaded)
+            {
+                GetShadowSplits(cascades, slice_start, splits);
+            }
+
+            for (u32 i = 0; i < cascades; ++i)
+            {
+                shadow_caster_list_.Resize(0);
+
+                const f32 split_depth = splits[i];
+                bool receivers = false;
+                if (light != nullptr && !solid_node_list_.Empty())
+                {
+                    if (cascaded)
+                    {
+                        core::vector3df corners[8];
+                        GetViewSliceCorners(active_camera_, slice_start, split_depth, corners);
+                        receivers = light->FitShadowCascade(corners, solid_node_list_, driver_->GetShadowTextureSize().width_);
+                    }
+                    else
+                    {
+                        light->ResetCameraTransform(solid_node_list_);
+                        receivers = true;
+                    }
+                }
+
+                // an empty cascade is still cleared, so it throws no old shadows
+                if (receivers)
+                {
+                    CollectShadowCasters(light);
+                }
+                ICameraSceneNode *shadow_camera = light != nullptr ? light->GetShadowCamera() : nullptr;
+                if (shadow_camera != nullptr)
+                {
+                    driver_->BeginShadowCascade(i, shadow_camera->GetViewTransform(), shadow_camera->GetProjectTransform(), split_depth);
+                }
+
+                // render shadow casters
+                for (u32 j = 0; j < shadow_caster_list_.Size(); ++j)
+                {
+                    SubmitNode(shadow_caster_list_.ConstPointer()[j]);
+                }
+                FlushRenderQueue();
+
+                render_statistics_.shadow_casters_ += shadow_caster_list_.Size();
+                render_statistics_.cascade_casters_[i] = shadow_caster_list_.Size();
+                render_statistics_.cascade_time_[i] = RestartPassTimer(cascade_start);
+                slice_start = split_depth;
+            }
+            render_statistics_.shadow_cascades_ = cascades;
+
+            driver_->EndShadowRender();
+        }
+
+        void CSceneManager::RenderShadowAtlas(u32 light_count)
+        {
+            driver_->BeginShadowRender();
+
+            // the main light comes first, the others by the size they have on the screen
+            const u32 atlas_size = driver_->GetShadowAtlasSize();
+            shadow_atlas_.SetSize(atlas_size, SHADOW_ATLAS_MIN_TILE);
+            shadow_atlas_.BeginFrame();
+            shadow_light_list_.Resize(0);
+
+            const bool cascaded = active_camera_ != nullptr;
+            const u32 cascades = core::min_(shadow_cascades_, video::MAX_SHADOW_CASCADES);
+            for (u32 i = 0; i < light_count; ++i)
+            {
+                ILightSceneNode *light = dynamic_cast<ILightSceneNode *>(light_list_[i]);
+                const video::SLight &light_data = light->GetLightData();
+                if (!light_data.cast_shadows_ || light->GetShadowCamera() == nullptr)
+                {
+                    continue;
+                }
+
+                const f32 coverage = GetScreenCoverage(light_data);
+                const f32 priority = light->GetLightIndex() == main_light_index_ ? 2.f : coverage;
+
+                SShadowLight shadow_light;
+                shadow_light.light_ = light;
+                shadow_light.slot_ = i;
+                shadow_light.view_count_ = 0;
+                u32 size = 0;
+                switch (light_data.type_)
+                {
+                case video::ELT_DIRECTIONAL:
+                    shadow_light.view_count_ = cascaded ? cascades : 0;
+                    size = atlas_size / 4;
+                    break;
+                case video::ELT_SPOT:
+                    shadow_light.view_count_ = 1;
+                    size = static_cast<u32>(coverage * atlas_size / 4);
+                    break;
+                case video::ELT_POINT:
+                    shadow_light.view_count_ = 6;
+                    size = static_cast<u32>(coverage * atlas_size / 8);
+                    break;
+                default: ;
+                }
+                if (shadow_light.view_count_ == 0)
+                {
+                    continue;
+                }
+
+                size = core::max_(size, SHADOW_ATLAS_MIN_TILE);
+                shadow_light.first_request_ = shadow_atlas_.Request(light, 0, size, priority);
+                for (u32 j = 1; j < shadow_light.view_count_; ++j)
+                {
+                    shadow_atlas_.Request(light, j, size, priority);
+                }
+                shadow_light_list_.PushBack(shadow_light);
+            }
+            shadow_atlas_.EndFrame();
+
+            f32 split_near = 0.f;
+            f32 splits[video::MAX_SHADOW_CASCADES] = { FLT_MAX };
+            if (cascaded)
+            {
+                GetShadowSplits(cascades, split_near, splits);
+            }
+
+            std::chrono::high_resolution_clock::time_point cascade_start = std::chrono::high_resolution_clock::now();
+            for (u32 i = 0; i < shadow_light_list_.Size(); ++i)
+            {
+                const SShadowLight &shadow_light = shadow_light_list_.ConstPointer()[i];
+                ILightSceneNode *light = shadow_light.light_;
+                const bool directional = light->GetLightType() == video::ELT_DIRECTIONAL;
+                const bool main_light = light->GetLightIndex() == main_light_index_;
+
+                // a cube or spot light with a view missing throws no shadow at all, cascades
+                // end at the first one without a tile
+                u32 view_count = shadow_light.view_count_;
+                for (u32 j = 0; j < shadow_light.view_count_; ++j)
+                {
+                    if (shadow_atlas_.GetTile(shadow_light.first_request_ + j).getWidth() == 0)
+                    {
+                        view_count = directional ? j : 0;
+                        break;
+                    }
+                }
+
+                f32 slice_start = split_near;
+                for (u32 j = 0; j < view_count; ++j)
+                {
+                    const u32 request = shadow_light.first_request_ + j;
+                    const core::rect<s32> &tile = shadow_atlas_.GetTile(request);
+                    const f32 split_depth = directional ? splits[j] : FLT_MAX;
+
+                    bool receivers = false;
+                    if (directional)
+                    {
+                        core::vector3df corners[8];
+                        GetViewSliceCorners(active_camera_, slice_start, split_depth, corners);
+                        receivers = light->FitShadowCascade(corners, solid_node_list_, tile.getWidth());
+                        slice_start = split_depth;
+                    }
+                    else
+                    {
+                        receivers = light->FitShadowView(j);
+                    }
+
+                    // fitting the casters moves the eye of the view back and its far plane out, so the
+                    // receivers sample and the cache compares the view the casters are rendered with
+                    shadow_caster_list_.Resize(0);
+                    if (receivers)
+                    {
+                        CollectShadowCasters(light);
+                    }
+
+                    ICameraSceneNode *shadow_camera = light->GetShadowCamera();
+                    const core::Matrixf view = shadow_camera->GetViewTransform();
+                    const core::Matrixf projection = shadow_camera->GetProjectTransform();
+                    driver_->AddShadowAtlasView(shadow_light.slot_, tile, view, projection, split_depth);
+
+                    // a tile keeps its shadows until the view or a node throwing shadows into it changes,
+                    // a view without receivers is only cleared, its camera is left from another view
+                    ++render_statistics_.shadow_views_;
+                    core::Matrixf transform;
+                    if (receivers)
+                    {
+                        transform = view * projection;
+                    }
+                    else
+                    {
+                        transform.Zero();
+                    }
+                    if (shadow_atlas_.IsTileValid(request, transform) && !IsShadowViewDirty(shadow_camera->GetViewFrustum()))
+                    {
+                        ++render_statistics_.cached_shadow_views_;
+                        continue;
+                    }
+
+                    // an empty view is still cleared, so it throws no old shadows
+                    driver_->BeginShadowAtlasTile(tile, view, projection);
+                    for (u32 k = 0; k < shadow_caster_list_.Size(); ++k)
+                    {
+                        SubmitNode(shadow_caster_list_.ConstPointer()[k]);
+                    }
+                    FlushRenderQueue();
+                    shadow_atlas_.SetTileRendered(request, transform);
+                    render_statistics_.shadow_casters_ += shadow_caster_list_.Size();
+
+                    if (main_light && directional)
+                    {
+                        render_statistics_.cascade_casters_[j] = shadow_caster_list_.Size();
+                        render_statistics_.cascade_time_[j] = RestartPassTimer(cascade_start);
+                    }
+                }
+
+                if (main_light && directional)
+                {
+                    render_statistics_.shadow_cascades_ = view_count;
+                }
+            }
+
+            driver_->EndShadowRender();
+        }
+
+        void CSceneManager::GetShadowSplits(u32 cascades, f32& split_near, f32* splits) const
+        {
+            // blend of uniform and logarithmic splits of the shadowed part of the view
+            split_near = core::max_(active_camera_->GetZn(), 1e-3f);
+            f32 split_far = active_camera_->GetZf();
+            if (shadow_distance_ > 0.f)
+            {
+                split_far = core::clamp(shadow_distance_, split_near, split_far);
+            }
+
+            for (u32 i = 0; i < cascades; ++i)
+            {
+                const f32 uniform_split = split_near + (split_far - split_near) * (i + 1) / cascades;
+                const f32 log_split = split_near * powf(split_far / split_near, f32(i + 1) / cascades);
+                splits[i] = i + 1 == cascades ? split_far : core::lerp(uniform_split, log_split, shadow_split_lambda_);
+            }
+        }
+
+        f32 CSceneManager::GetScreenCoverage(const video::SLight& light) const
+        {
+            if (light.type_ == video::ELT_DIRECTIONAL || active_camera_ == nullptr)
+            {
+                return 1.f;
+            }
+
+            // projected diameter of the light sphere over the height of the view, 2 * r * P11 / (2 * w)
+            const core::Matrixf projection = active_camera_->GetProjectTransform();
+            const f32 distance = light.position_.GetDistanceFrom(active_camera_->GetEye());
+            if (distance <= light.radius_)
+            {
+                return 1.f;
+            }
+
+            const f32 w = distance * projection(2, 3) + projection(3, 3);
+            return core::clamp(light.radius_ * projection(1, 1) / w, 0.f, 1.f);
+        }
+
+        void CSceneManager::GetViewSliceCorners(ICameraSceneNode* camera, f32 near_depth, f32 far_depth, core::vector3df* corners) const
+        {
+            const core::Matrixf view = camera->GetViewTransform();
+            const core::Matrixf inverse = (view * camera->GetProjectTransform()).Inverse();
+
+            // every corner of the screen is a line through the view, two points of it give the
+            // points at any depth for perspective and orthogonal cameras alike
+            for (u32 i = 0; i < 4; ++i)
+            {
+                const f32 x = (i & 1) ? 1.f : -1.f;
+                const f32 y = (i & 2) ? 1.f : -1.f;
+                core::vector3df line[2];
+                f32 depth[2];
+                for (u32 j = 0; j < 2; ++j)
+                {
+                    const core::vector3df p = inverse.Apply(core::vector3df(x, y, j * 0.5f, 1.f));
+                    line[j] = core::vector3df(p.x_ / p.w_, p.y_ / p.w_, p.z_ / p.w_);
+                    depth[j] = view.Apply(line[j]).z_;
+                }
+
+                const core::vector3df step = (line[1] - line[0]) / (depth[1] - depth[0]);
+                corners[i] = line[0] + step * (near_depth - depth[0]);
+                corners[i + 4] = line[0] + step * (far_depth - depth[0]);
+            }
+        }
+
+        bool CSceneManager::IsCulled(ISceneNode* node)
+        {
+            const core::aabbox3df box = node->GetTransformedBoundingBox();
+
+            // the proxy id may have been reused after the node was skipped for a frame
+            s32 proxy = node->GetCullingProxy();
+            bool moved = true;
+            const bool created = culling_tree_.GetSceneNode(proxy) != node;
+            if (!created)
+            {
+                moved = culling_tree_.MoveProxy(proxy, box);
+            }
+            else
+            {
+                proxy = culling_tree_.CreateProxy(node, box);
+                node->SetCullingProxy(proxy);
+            }
+            culling_tree_.SetRegistered(proxy, culling_frame_);
+            TrackNodeChanges(node, proxy, box, created);
+
+            if (!culling_enabled_)
+            {
+                return false;
+            }
+
+            // the tree was culled before the node left its enlarged box
+            if (moved)
+            {
+                return view_frustum_.IsBoxOutside(box);
+            }
+            return !culling_tree_.IsVisible(proxy, culling_frame_);
+        }
+
+        void CSceneManager::SubmitNode(ISceneNode* node)
+        {
+            if (!node->SubmitRenderItems(render_queue_))
+            {
+                node->Render();
+            }
+        }
+
+        void CSceneManager::FlushRenderQueue()
+        {
+            render_queue_.Render(driver_);
+            render_statistics_.draw_calls_ += render_queue_.GetDrawCallCount();
+            render_statistics_.instances_ += render_queue_.GetInstanceCount();
+            render_statistics_.material_changes_ += render_queue_.GetMaterialChangeCount();
+        }
+
         IMeshManipulator* CSceneManager::GetMeshManipulator()
         {
             return driver_->GetMeshManipulator();
         }
 
+        IMeshCache* CSceneManager::GetMeshCache()
+        {
+            return mesh_cache_;
+        }
+
         const core::aabbox3d<f32>& CSceneManager::GetBoundingBox() const
         {
             _KONG_DEBUG_BREAK_IF(true) // Bounding Box of Scene Manager wanted.
@@ -0,0 +1,302 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CShadowAtlas.h"
+
+namespace kong
+{
+    namespace scene
+    {
+        CShadowAtlas::CShadowAtlas()
+            : size_(0), min_tile_size_(0), levels_(0)
+        {
+        }
+
+        void CShadowAtlas::SetSize(u32 size, u32 min_tile_size)
+        {
+            min_tile_size = core::min_(min_tile_size, size);
+            if (size == size_ && min_tile_size == min_tile_size_)
+            {
+                return;
+            }
+
+            size_ = size;
+            min_tile_size_ = min_tile_size;
+            levels_ = 0;
+            while (min_tile_size > 0 && (size >> levels_) > min_tile_size)
+            {
+                ++levels_;
+            }
+
+            // (4^(levels + 1) - 1) / 3 nodes
+            const u32 node_count = ((1u << (2 * (levels_ + 1))) - 1) / 3;
+            node_state_.Resize(node_count);
+            node_state_.SetAll(ENS_FREE);
+            node_x_.Resize(node_count);
+            node_y_.Resize(node_count);
+            node_x_.Pointer()[0] = 0;
+            node_y_.Pointer()[0] = 0;
+            for (u32 node = 0, level = 0, level_end = 1; node < node_count; ++node)
+            {
+                if (node == level_end)
+                {
+                    ++level;
+                    level_end = level_end * 4 + 1;
+                }
+
+                const u32 first_child = node * 4 + 1;
+                if (first_child >= node_count)
+                {
+                    continue;
+                }
+
+                const s32 half = static_cast<s32>(size_ >> (level + 1));
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    node_x_.Pointer()[first_child + i] = node_x_.ConstPointer()[node] + ((i & 1) ? half : 0);
+                    node_y_.Pointer()[first_child + i] = node_y_.ConstPointer()[node] + ((i & 2) ? half : 0);
+                }
+            }
+
+            tiles_.Resize(0);
+            requests_.Resize(0);
+        }
+
+        u32 CShadowAtlas::GetSize() const
+        {
+            return size_;
+        }
+
+        u32 CShadowAtlas::GetMinTileSize() const
+        {
+            return min_tile_size_;
+        }
+
+        void CShadowAtlas::BeginFrame()
+        {
+            requests_.Resize(0);
+            for (u32 i = 0; i < tiles_.Size(); ++i)
+            {
+                tiles_.Pointer()[i].requested_ = false;
+            }
+        }
+
+        u32 CShadowAtlas::Request(const void* owner, u32 view, u32 size, f32 priority)
+        {
+            SRequest request;
+            request.owner_ = owner;
+            request.view_ = view;
+            request.size_ = size;
+            request.priority_ = priority;
+            request.tile_ = -1;
+            requests_.PushBack(request);
+            return requests_.Size() - 1;
+        }
+
+        void CShadowAtlas::EndFrame()
+        {
+            if (size_ == 0)
+            {
+                return;
+            }
+
+            // a view asking for the size of its tile keeps it, also when a full atlas made it smaller
+            SRequest *requests = requests_.Pointer();
+            for (u32 i = 0; i < requests_.Size(); ++i)
+            {
+                const u32 size = size_ >> GetLevel(requests[i].size_);
+                for (u32 j = 0; j < tiles_.Size(); ++j)
+                {
+                    STile &tile = tiles_.Pointer()[j];
+                    if (!tile.requested_ && tile.owner_ == requests[i].owner_ && tile.view_ == requests[i].view_ && tile.requested_size_ == size)
+                    {
+                        tile.requested_ = true;
+                        requests[i].tile_ = static_cast<s32>(j);
+                        break;
+                    }
+                }
+            }
+
+            // free the other tiles, the tile indices of the requests move along
+            for (u32 j = tiles_.Size(); j-- > 0;)
+            {
+                if (tiles_.ConstPointer()[j].requested_)
+                {
+                    continue;
+                }
+
+                Free(tiles_.ConstPointer()[j].node_);
+                tiles_.Erase(j);
+                for (u32 i = 0; i < requests_.Size(); ++i)
+                {
+                    if (requests[i].tile_ > static_cast<s32>(j))
+                    {
+                        --requests[i].tile_;
+                    }
+                }
+            }
+
+            // place the new views by priority
+            placements_.Resize(0);
+            for (u32 i = 0; i < requests_.Size(); ++i)
+            {
+                if (requests[i].tile_ < 0 && requests[i].size_ > 0)
+                {
+                    const SPlacement placement = { requests[i].priority_, requests[i].size_, i };
+                    placements_.PushBack(placement);
+                }
+            }
+            placements_.Sort();
+
+            for (u32 i = 0; i < placements_.Size(); ++i)
+            {
+                SRequest &request = requests[placements_.ConstPointer()[i].request_];
+
+                // a full atlas hands out smaller tiles
+                const u32 requested_level = GetLevel(request.size_);
+                for (u32 level = requested_level; level <= levels_; ++level)
+                {
+                    const s32 node = Allocate(0, 0, level);
+                    if (node < 0)
+                    {
+                        continue;
+                    }
+
+                    STile tile;
+                    tile.owner_ = request.owner_;
+                    tile.view_ = request.view_;
+                    tile.node_ = static_cast<u32>(node);
+                    tile.size_ = size_ >> level;
+                    tile.requested_size_ = size_ >> requested_level;
+                    tile.rect_ = core::rect<s32>(node_x_.ConstPointer()[node], node_y_.ConstPointer()[node],
+                        node_x_.ConstPointer()[node] + tile.size_, node_y_.ConstPointer()[node] + tile.size_);
+                    tile.rendered_ = false;
+                    tile.requested_ = true;
+                    tiles_.PushBack(tile);
+                    request.tile_ = static_cast<s32>(tiles_.Size() - 1);
+                    break;
+                }
+            }
+        }
+
+        const core::rect<s32>& CShadowAtlas::GetTile(u32 request) const
+        {
+            if (request >= requests_.Size() || requests_.ConstPointer()[request].tile_ < 0)
+            {
+                return empty_tile_;
+            }
+            return tiles_.ConstPointer()[requests_.ConstPointer()[request].tile_].rect_;
+        }
+
+        bool CShadowAtlas::IsTileValid(u32 request, const core::Matrixf& transform) const
+        {
+            if (request >= requests_.Size() || requests_.ConstPointer()[request].tile_ < 0)
+            {
+                return false;
+            }
+
+            const STile &tile = tiles_.ConstPointer()[requests_.ConstPointer()[request].tile_];
+            return tile.rendered_ && tile.transform_ == transform;
+        }
+
+        void CShadowAtlas::SetTileRendered(u32 request, const core::Matrixf& transform)
+        {
+            if (request >= requests_.Size() || requests_.ConstPointer()[request].tile_ < 0)
+            {
+                return;
+            }
+
+            STile &tile = tiles_.Pointer()[requests_.ConstPointer()[request].tile_];
+            tile.transform_ = transform;
+            tile.rendered_ = true;
+        }
+
+        void CShadowAtlas::InvalidateTiles()
+        {
+            for (u32 i = 0; i < tiles_.Size(); ++i)
+            {
+                tiles_.Pointer()[i].rendered_ = false;
+            }
+        }
+
+        u32 CShadowAtlas::GetLevel(u32 size) const
+        {
+            u32 level = 0;
+            while (level < levels_ && (size_ >> level) > size)
+            {
+                ++level;
+            }
+            return level;
+        }
+
+        s32 CShadowAtlas::Allocate(u32 node, u32 level, u32 target_level)
+        {
+            u8 &state = node_state_.Pointer()[node];
+            if (state == ENS_USED)
+            {
+                return -1;
+            }
+
+            if (level == target_level)
+            {
+                if (state != ENS_FREE)
+                {
+                    return -1;
+                }
+                state = ENS_USED;
+                return static_cast<s32>(node);
+            }
+
+            // split nodes are searched first, so free nodes stay whole for large tiles
+            const u32 first_child = node * 4 + 1;
+            if (state == ENS_SPLIT)
+            {
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    if (node_state_.ConstPointer()[first_child + i] == ENS_SPLIT)
+                    {
+                        const s32 found = Allocate(first_child + i, level + 1, target_level);
+                        if (found >= 0)
+                        {
+                            return found;
+                        }
+                    }
+                }
+            }
+
+            for (u32 i = 0; i < 4; ++i)
+            {
+                if (node_state_.ConstPointer()[first_child + i] == ENS_FREE)
+                {
+                    const s32 found = Allocate(first_child + i, level + 1, target_level);
+                    if (found >= 0)
+                    {
+                        state = ENS_SPLIT;
+                        return found;
+                    }
+                }
+            }
+
+            return -1;
+        }
+
+        void CShadowAtlas::Free(u32 node)
+        {
+            node_state_.Pointer()[node] = ENS_FREE;
+            while (node > 0)
+            {
+                const u32 parent = (node - 1) / 4;
+                const u32 first_child = parent * 4 + 1;
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    if (node_state_.ConstPointer()[first_child + i] != ENS_FREE)
+                    {
+                        return;
+                    }
+                }
+                node_state_.Pointer()[parent] = ENS_FREE;
+                node = parent;
+            }
+        }
+    } // end namespace scene
+} // end namespace kong
@@ -0,0 +1,1258 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CSoftwareDriver.h"
+
+#include <cmath>
+#include <cstring>
+#include "IMeshBuffer.h"
+#include "S3DVertex.h"
+#include "CSoftwareTexture.h"
+#include "KongMath.h"
+#include "os.h"
+
+#ifdef _KONG_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
+namespace kong
+{
+    namespace video
+    {
+        //! width and height of the screen tiles the triangles are binned into
+        const s32 SOFTWARE_TILE_SIZE = 64;
+
+        //! vertices transformed by one job
+        const u32 SOFTWARE_VERTEX_BATCH = 4096;
+
+        //! same limit as the deferred shader driver
+        const u32 SOFTWARE_MAX_LIGHTS = 32;
+
+        // shadow PCF, the same taps as the shaders
+        const f32 poisson_disk[4][2] = {
+            { -0.94201624f, -0.39906216f },
+            { 0.94558609f, -0.76890725f },
+            { -0.094184101f, -0.92938870f },
+            { 0.34495938f, 0.29387760f }
+        };
+
+        //! transforms a point by an engine matrix, row vector convention
+        static inline void TransformPoint(const f32* m, f32 x, f32 y, f32 z, f32* out)
+        {
+            for (u32 i = 0; i < 4; ++i)
+            {
+                out[i] = x * m[i] + y * m[4 + i] + z * m[8 + i] + m[12 + i];
+            }
+        }
+
+        //! transforms a direction by an engine matrix, row vector convention
+        static inline void TransformDirection(const f32* m, f32 x, f32 y, f32 z, f32* out)
+        {
+            for (u32 i = 0; i < 3; ++i)
+            {
+                out[i] = x * m[i] + y * m[4 + i] + z * m[8 + i];
+            }
+        }
+
+        static inline f32 Dot3(const f32* a, const f32* b)
+        {
+            return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        static inline void Normalize3(f32* v)
+        {
+            const f32 length_sq = Dot3(v, v);
+            if (length_sq > 0.f)
+            {
+                const f32 inv_length = 1.f / sqrtf(length_sq);
+                v[0] *= inv_length;
+                v[1] *= inv_length;
+                v[2] *= inv_length;
+            }
+        }
+
+        static inline f32 SmoothStep(f32 edge0, f32 edge1, f32 x)
+        {
+            if (edge1 <= edge0)
+            {
+                return x < edge0 ? 0.f : 1.f;
+            }
+            const f32 t = core::clamp((x - edge0) / (edge1 - edge0), 0.f, 1.f);
+            return t * t * (3.f - 2.f * t);
+        }
+
+        static inline void UnpackColor(u32 color, f32* out)
+        {
+            const f32 inv = 1.f / 255.f;
+            out[0] = ((color >> 16) & 0xff) * inv;
+            out[1] = ((color >> 8) & 0xff) * inv;
+            out[2] = (color & 0xff) * inv;
+            out[3] = ((color >> 24) & 0xff) * inv;
+        }
+
+        static inline u32 PackColor(const f32* color)
+        {
+            const u32 r = static_cast<u32>(core::clamp(color[0], 0.f, 1.f) * 255.f + 0.5f);
+            const u32 g = static_cast<u32>(core::clamp(color[1], 0.f, 1.f) * 255.f + 0.5f);
+            const u32 b = static_cast<u32>(core::clamp(color[2], 0.f, 1.f) * 255.f + 0.5f);
+            const u32 a = static_cast<u32>(core::clamp(color[3], 0.f, 1.f) * 255.f + 0.5f);
+            return (a << 24) | (r << 16) | (g << 8) | b;
+        }
+
+        static inline void ColorToFloat(const SColor& color, f32* out)
+        {
+            UnpackColor(color.color_, out);
+        }
+
+        //! bilinear fetch with repeat addressing, the first image row is v = 0
+        static void SampleTexture(const CSoftwareTexture* texture, f32 u, f32 v, f32* out)
+        {
+            CImage* image = texture->GetImage();
+            const core::Dimension2d<u32>& size = image->GetDimension();
+            const u32* texels = static_cast<const u32*>(image->Lock());
+            const u32 pitch = image->GetPitch() / 4;
+
+            u -= floorf(u);
+            v -= floorf(v);
+
+            const f32 fx = u * size.width_ - 0.5f;
+            const f32 fy = v * size.height_ - 0.5f;
+            const f32 x_floor = floorf(fx);
+            const f32 y_floor = floorf(fy);
+            const f32 tx = fx - x_floor;
+            const f32 ty = fy - y_floor;
+
+            const s32 w = static_cast<s32>(size.width_);
+            const s32 h = static_cast<s32>(size.height_);
+            const s32 x0 = (static_cast<s32>(x_floor) + w) % w;
+            const s32 y0 = (static_cast<s32>(y_floor) + h) % h;
+            const s32 x1 = (x0 + 1) % w;
+            const s32 y1 = (y0 + 1) % h;
+
+            f32 c00[4], c10[4], c01[4], c11[4];
+            UnpackColor(texels[y0 * pitch + x0], c00);
+            UnpackColor(texels[y0 * pitch + x1], c10);
+            UnpackColor(texels[y1 * pitch + x0], c01);
+            UnpackColor(texels[y1 * pitch + x1], c11);
+
+            for (u32 i = 0; i < 4; ++i)
+            {
+                const f32 top = c00[i] + (c10[i] - c00[i]) * tx;
+                const f32 bottom = c01[i] + (c11[i] - c01[i]) * tx;
+                out[i] = top + (bottom - top) * ty;
+            }
+        }
+
+        CSoftwareDriver::CSoftwareDriver(const SKongCreationParameters& params, io::IFileSystem* io)
+            : CNullDriver(io, params.window_size_), params_(params), thread_pool_(nullptr),
+              color_buffer_(nullptr), color_data_(nullptr), color_pitch_(0), depth_buffer_(nullptr), depth_pitch_(0),
+              shadow_buffer_(nullptr), shadow_pitch_(0), gbuffer_(nullptr),
+              target_(ESRT_COLOR), target_depth_(nullptr), target_pitch_(0), tiles_x_(0), tiles_y_(0),
+              bins_(nullptr), bin_count_(0), lights_dirty_(true), color_buffer_clear_(true), z_buffer_clear_(true),
+              shadow_map_valid_(false), resolve_pending_(false)
+        {
+            thread_pool_ = new core::CThreadPool();
+
+            const core::Dimension2d<u32>& size = params_.window_size_;
+            color_buffer_ = new CImage(ECF_A8R8G8B8, size);
+            color_data_ = static_cast<u32*>(color_buffer_->Lock());
+            color_pitch_ = color_buffer_->GetPitch() / 4;
+
+            // pad the rows so four depth values can always be loaded at once
+            depth_pitch_ = (size.width_ + 3) & ~3u;
+            depth_buffer_ = new f32[depth_pitch_ * size.height_];
+            shadow_pitch_ = (shadow_texture_size_.width_ + 3) & ~3u;
+            shadow_buffer_ = new f32[shadow_pitch_ * shadow_texture_size_.height_];
+            gbuffer_ = new SGBufferTexel[size.width_ * size.height_];
+
+            const u32 screen_tiles = ((size.width_ + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE) *
+                ((size.height_ + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE);
+            const u32 shadow_tiles = ((shadow_texture_size_.width_ + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE) *
+                ((shadow_texture_size_.height_ + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE);
+            bin_count_ = core::max_(screen_tiles, shadow_tiles);
+            bins_ = new core::Array<u32>[bin_count_];
+
+            camera_position_[0] = camera_position_[1] = camera_position_[2] = 0.f;
+
+            color_buffer_->Fill(SColor(255, 0, 0, 0));
+            for (u32 i = 0; i < depth_pitch_ * size.height_; ++i)
+            {
+                depth_buffer_[i] = 1.f;
+            }
+            for (u32 i = 0; i < shadow_pitch_ * shadow_texture_size_.height_; ++i)
+            {
+                shadow_buffer_[i] = 1.f;
+            }
+
+            SetRenderTarget(ESRT_COLOR);
+        }
+
+        CSoftwareDriver::~CSoftwareDriver()
+        {
+            delete thread_pool_;
+            delete[] bins_;
+            delete[] gbuffer_;
+            delete[] shadow_buffer_;
+            delete[] depth_buffer_;
+            delete color_buffer_;
+        }
+
+        bool CSoftwareDriver::BeginScene(bool back_buffer, bool z_buffer, SColor color)
+        {
+            triangles_.Clear();
+            states_.Clear();
+            for (u32 i = 0; i < bin_count_; ++i)
+            {
+                bins_[i].Clear();
+            }
+
+            color_buffer_clear_ = back_buffer;
+            z_buffer_clear_ = z_buffer;
+            color_clear_ = color;
+            shadow_map_valid_ = false;
+            resolve_pending_ = false;
+
+            SetRenderTarget(ESRT_COLOR);
+
+            if (back_buffer)
+            {
+                color_buffer_->Fill(color);
+            }
+
+            if (z_buffer)
+            {
+                const u32 count = depth_pitch_ * params_.window_size_.height_;
+                for (u32 i = 0; i < count; ++i)
+                {
+                    depth_buffer_[i] = 1.f;
+                }
+            }
+
+            return true;
+        }
+
+        bool CSoftwareDriver::EndScene()
+        {
+            Flush();
+            return true;
+        }
+
+        void CSoftwareDriver::SetTransform(u32 state, const core::Matrixf& mat)
+        {
+            CNullDriver::SetTransform(state, mat);
+
+            switch (state)
+            {
+            case ETS_VIEW:
+                {
+                    // the camera sits at the translation of the inverse view matrix
+                    const core::Matrixf inverse = mat.Inverse();
+                    camera_position_[0] = inverse[12];
+                    camera_position_[1] = inverse[13];
+                    camera_position_[2] = inverse[14];
+                }
+                break;
+            case ETS_LIGHT_VIEW:
+            case ETS_LIGHT_PROJECTION:
+                light_transform_ = matrices_[ETS_LIGHT_VIEW] * matrices_[ETS_LIGHT_PROJECTION];
+                break;
+            default:
+                break;
+            }
+        }
+
+        void CSoftwareDriver::Draw3DLine(const core::Vector3Df& start, const core::Vector3Df& end, SColor color)
+        {
+            if (target_ != ESRT_COLOR)
+            {
+                return;
+            }
+
+            Flush();
+
+            const core::Matrixf transform = matrices_[ETS_WORLD] * matrices_[ETS_VIEW] * matrices_[ETS_PROJECTION];
+            f32 p0[4], p1[4];
+            TransformPoint(transform.Pointer(), start.x_, start.y_, start.z_, p0);
+            TransformPoint(transform.Pointer(), end.x_, end.y_, end.z_, p1);
+
+            // clip against the near plane
+            const f32 d0 = p0[2] + p0[3];
+            const f32 d1 = p1[2] + p1[3];
+            if (d0 < 0.f && d1 < 0.f)
+            {
+                return;
+            }
+            if (d0 < 0.f || d1 < 0.f)
+            {
+                const f32 t = d0 / (d0 - d1);
+                f32* outside = d0 < 0.f ? p0 : p1;
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    outside[i] = p0[i] + (p1[i] - p0[i]) * t;
+                }
+            }
+
+            const core::rect<s32>& vp = target_view_port_;
+            const f32 vp_w = static_cast<f32>(vp.getWidth());
+            const f32 vp_h = static_cast<f32>(vp.getHeight());
+            f32 screen[2][3];
+            const f32* points[2] = { p0, p1 };
+            for (u32 i = 0; i < 2; ++i)
+            {
+                const f32 inv_w = 1.f / points[i][3];
+                screen[i][0] = vp.UpperLeftCorner.x_ + (points[i][0] * inv_w * 0.5f + 0.5f) * vp_w;
+                screen[i][1] = vp.UpperLeftCorner.y_ + (0.5f - points[i][1] * inv_w * 0.5f) * vp_h;
+                screen[i][2] = points[i][2] * inv_w * 0.5f + 0.5f;
+            }
+
+            const f32 dx = screen[1][0] - screen[0][0];
+            const f32 dy = screen[1][1] - screen[0][1];
+            const s32 steps = core::max_(1, static_cast<s32>(core::max_(fabsf(dx), fabsf(dy)) + 0.5f));
+            const u32 packed = color.color_;
+
+            for (s32 i = 0; i <= steps; ++i)
+            {
+                const f32 t = static_cast<f32>(i) / steps;
+                const s32 x = static_cast<s32>(screen[0][0] + dx * t);
+                const s32 y = static_cast<s32>(screen[0][1] + dy * t);
+                if (x < vp.UpperLeftCorner.x_ || x >= vp.LowerRightCorner.x_ ||
+                    y < vp.UpperLeftCorner.y_ || y >= vp.LowerRightCorner.y_)
+                {
+                    continue;
+                }
+
+                const f32 z = screen[0][2] + (screen[1][2] - screen[0][2]) * t;
+                f32& depth = depth_buffer_[y * depth_pitch_ + x];
+                if (z < depth && z <= 1.f)
+                {
+                    depth = z;
+                    color_data_[y * color_pitch_ + x] = packed;
+                }
+            }
+        }
+
+        void CSoftwareDriver::Draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+            const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect, SColor color, bool useAlphaChannelOfTexture)
+        {
+            if (texture == nullptr || texture->GetDriverType() != EDT_SOFTWARE || target_ != ESRT_COLOR)
+            {
+                return;
+            }
+
+            Flush();
+
+            CImage* image = static_cast<const CSoftwareTexture*>(texture)->GetImage();
+            if (useAlphaChannelOfTexture || color != SColor(255, 255, 255, 255))
+            {
+                image->CopyToWithAlpha(color_buffer_, destPos, sourceRect, color, clipRect);
+            }
+            else
+            {
+                image->CopyTo(color_buffer_, destPos, sourceRect, clipRect);
+            }
+        }
+
+        void CSoftwareDriver::Draw2DImage(const video::ITexture* texture, const core::position2d<f32>& destPos,
+            const core::rect<f32>& sourceRect, SColor color)
+        {
+            const core::position2d<s32> pos(static_cast<s32>(destPos.x_), static_cast<s32>(destPos.y_));
+            const core::rect<s32> source(static_cast<s32>(sourceRect.UpperLeftCorner.x_), static_cast<s32>(sourceRect.UpperLeftCorner.y_),
+                static_cast<s32>(sourceRect.LowerRightCorner.x_), static_cast<s32>(sourceRect.LowerRightCorner.y_));
+            Draw2DImage(texture, pos, source, nullptr, color, true);
+        }
+
+        void CSoftwareDriver::DrawMeshBuffer(const scene::IMeshBuffer* mesh_buffer)
+        {
+            if (mesh_buffer == nullptr)
+            {
+                return;
+            }
+
+            const u32 vertex_count = mesh_buffer->GetVertexCount();
+            const u32 index_count = mesh_buffer->GetIndexCount();
+            if (vertex_count == 0 || index_count < 3)
+            {
+                return;
+            }
+
+            u32 vertex_pitch = sizeof(S3DVertex);
+            switch (mesh_buffer->GetVertexType())
+            {
+            case EVT_2TCOORDS:
+                vertex_pitch = sizeof(S3DVertex2TCoords);
+                break;
+            case EVT_TANGENTS:
+                vertex_pitch = sizeof(S3DVertexTangents);
+                break;
+            default:
+                break;
+            }
+
+            // remember the material, the triangles are shaded when the tiles are flushed
+            SRasterState state;
+            ColorToFloat(material_.ambient_color_, state.ambient_);
+            ColorToFloat(material_.diffuse_color_, state.diffuse_);
+            ColorToFloat(material_.specular_color_, state.specular_);
+            state.shininess_ = material_.shininess_;
+            state.texture_ = nullptr;
+            const ITexture* texture = material_.GetTexture(0);
+            if (texture != nullptr && texture->GetDriverType() == EDT_SOFTWARE)
+            {
+                state.texture_ = static_cast<const CSoftwareTexture*>(texture);
+            }
+            state.wireframe_ = rendering_mode_ == ERM_WIREFRAME;
+            state.shadow_ = shadow_enable_ && shadow_map_valid_ && target_ == ESRT_COLOR;
+            state.camera_[0] = camera_position_[0];
+            state.camera_[1] = camera_position_[1];
+            state.camera_[2] = camera_position_[2];
+            states_.PushBack(state);
+            const u32 state_index = states_.Size() - 1;
+
+            const core::Matrixf& world = matrices_[ETS_WORLD];
+            const core::Matrixf transform = target_ == ESRT_SHADOW ? world * light_transform_
+                : world * matrices_[ETS_VIEW] * matrices_[ETS_PROJECTION];
+            const core::Matrixf light_world = world * light_transform_;
+            const f32* transform_matrix = transform.Pointer();
+            const f32* world_matrix = world.Pointer();
+            const f32* light_matrix = light_world.Pointer();
+            const bool depth_only = target_ == ESRT_SHADOW;
+            const bool shadow = state.shadow_;
+
+            vertices_.Resize(vertex_count);
+            SRasterVertex* out = vertices_.Pointer();
+            const u8* vertex_data = static_cast<const u8*>(mesh_buffer->GetVertices());
+
+            thread_pool_->ParallelFor((vertex_count + SOFTWARE_VERTEX_BATCH - 1) / SOFTWARE_VERTEX_BATCH, [&](u32 batch)
+            {
+                const u32 end = core::min_(vertex_count, (batch + 1) * SOFTWARE_VERTEX_BATCH);
+                for (u32 i = batch * SOFTWARE_VERTEX_BATCH; i < end; ++i)
+                {
+                    const S3DVertex& vertex = *reinterpret_cast<const S3DVertex*>(vertex_data + i * vertex_pitch);
+                    SRasterVertex& raster = out[i];
+                    const f32 x = vertex.pos_.x_;
+                    const f32 y = vertex.pos_.y_;
+                    const f32 z = vertex.pos_.z_;
+
+                    TransformPoint(transform_matrix, x, y, z, raster.clip_);
+                    if (depth_only)
+                    {
+                        continue;
+                    }
+
+                    f32 world_position[4];
+                    TransformPoint(world_matrix, x, y, z, world_position);
+                    raster.varying_[ESV_WORLD + 0] = world_position[0];
+                    raster.varying_[ESV_WORLD + 1] = world_position[1];
+                    raster.varying_[ESV_WORLD + 2] = world_position[2];
+                    TransformDirection(world_matrix, vertex.normal_.x_, vertex.normal_.y_, vertex.normal_.z_, &raster.varying_[ESV_NORMAL]);
+                    ColorToFloat(vertex.color_, &raster.varying_[ESV_COLOR]);
+                    raster.varying_[ESV_TEXCOORD + 0] = vertex.texcoord_.x_;
+                    raster.varying_[ESV_TEXCOORD + 1] = vertex.texcoord_.y_;
+
+                    if (shadow)
+                    {
+                        TransformPoint(light_matrix, x, y, z, &raster.varying_[ESV_LIGHT]);
+                    }
+                    else
+                    {
+                        memset(&raster.varying_[ESV_LIGHT], 0, sizeof(f32) * 4);
+                    }
+                }
+            });
+
+            for (u32 i = 0; i + 2 < index_count; i += 3)
+            {
+                const u32 i0 = mesh_buffer->GetIndex(i);
+                const u32 i1 = mesh_buffer->GetIndex(i + 1);
+                const u32 i2 = mesh_buffer->GetIndex(i + 2);
+                if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count)
+                {
+                    continue;
+                }
+
+                ClipAndSetupTriangle(out[i0], out[i1], out[i2], state_index);
+            }
+        }
+
+        IImage* CSoftwareDriver::CreateScreenShot()
+        {
+            Flush();
+
+            CImage* image = new CImage(ECF_A8R8G8B8, params_.window_size_);
+            color_buffer_->CopyTo(image);
+            return image;
+        }
+
+        const core::Dimension2d<u32>& CSoftwareDriver::GetCurrentRenderTargetSize() const
+        {
+            return target_size_;
+        }
+
+        void CSoftwareDriver::DeleteAllDynamicLights()
+        {
+            // pending triangles are shaded with the lights they were drawn with
+            Flush();
+            CNullDriver::DeleteAllDynamicLights();
+            lights_dirty_ = true;
+        }
+
+        s32 CSoftwareDriver::AddDynamicLight(const SLight& light)
+        {
+            Flush();
+            lights_dirty_ = true;
+            return CNullDriver::AddDynamicLight(light);
+        }
+
+        u32 CSoftwareDriver::GetMaximalDynamicLightAmount() const
+        {
+            return SOFTWARE_MAX_LIGHTS;
+        }
+
+        void CSoftwareDriver::BeginShadowRender()
+        {
+            Flush();
+            SetRenderTarget(ESRT_SHADOW);
+
+            if (z_buffer_clear_)
+            {
+                const u32 count = shadow_pitch_ * shadow_texture_size_.height_;
+                for (u32 i = 0; i < count; ++i)
+                {
+                    shadow_buffer_[i] = 1.f;
+                }
+            }
+        }
+
+        void CSoftwareDriver::EndShadowRender()
+        {
+            Flush();
+            SetRenderTarget(ESRT_COLOR);
+            shadow_map_valid_ = true;
+        }
+
+        u32 CSoftwareDriver::GetMaximalShadowCascadeAmount() const
+        {
+            return 1;
+        }
+
+        u32 CSoftwareDriver::GetShadowAtlasSize() const
+        {
+            return 0;
+        }
+
+        void CSoftwareDriver::RenderFirstPass()
+        {
+            Flush();
+            SetRenderTarget(ESRT_GBUFFER);
+
+            // covered texels are found through the depth buffer, no need to clear the geometry buffer
+            if (z_buffer_clear_)
+            {
+                const u32 count = depth_pitch_ * params_.window_size_.height_;
+                for (u32 i = 0; i < count; ++i)
+                {
+                    depth_buffer_[i] = 1.f;
+                }
+            }
+        }
+
+        void CSoftwareDriver::RenderSecondPass()
+        {
+            Flush();
+            SetRenderTarget(ESRT_COLOR);
+            DeleteAllDynamicLights();
+            resolve_pending_ = true;
+        }
+
+        void CSoftwareDriver::DrawSpaceFillQuad()
+        {
+            Flush();
+
+            // the quad of the second pass lights the geometry buffer, fxaa is not done on the cpu
+            if (resolve_pending_)
+            {
+                ResolveGBuffer();
+                resolve_pending_ = false;
+            }
+        }
+
+        void CSoftwareDriver::RenderFxaaPass()
+        {
+            Flush();
+        }
+
+        video::ITexture* CSoftwareDriver::CreateDeviceDependentTexture(IImage* surface, const io::path& name, void* mipmapData)
+        {
+            return new CSoftwareTexture(surface, name);
+        }
+
+        void CSoftwareDriver::SetRenderTarget(E_SOFTWARE_RENDER_TARGET target)
+        {
+            target_ = target;
+
+            if (target == ESRT_SHADOW)
+            {
+                target_depth_ = shadow_buffer_;
+                target_pitch_ = shadow_pitch_;
+                target_size_ = shadow_texture_size_;
+                target_view_port_ = core::rect<s32>(0, 0, shadow_texture_size_.width_, shadow_texture_size_.height_);
+            }
+            else
+            {
+                target_depth_ = depth_buffer_;
+                target_pitch_ = depth_pitch_;
+                target_size_ = params_.window_size_;
+                target_view_port_ = view_port_;
+            }
+
+            tiles_x_ = (target_size_.width_ + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+            tiles_y_ = (target_size_.height_ + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+        }
+
+        void CSoftwareDriver::Flush()
+        {
+            if (triangles_.Empty())
+            {
+                states_.Clear();
+                return;
+            }
+
+            if (lights_dirty_)
+            {
+                UpdateShadeLights();
+            }
+
+            thread_pool_->ParallelFor(tiles_x_ * tiles_y_, [this](u32 tile)
+            {
+                RasterizeTile(tile);
+            });
+
+            for (u32 i = 0; i < tiles_x_ * tiles_y_; ++i)
+            {
+                bins_[i].Clear();
+            }
+            triangles_.Clear();
+            states_.Clear();
+        }
+
+        void CSoftwareDriver::ClipAndSetupTriangle(const SRasterVertex& v0, const SRasterVertex& v1, const SRasterVertex& v2, u32 state)
+        {
+            const SRasterVertex* input[3] = { &v0, &v1, &v2 };
+
+            // reject triangles which lie completely outside one of the frustum planes
+            u32 outcode_and = ~0u;
+            u32 outcode_or = 0;
+            for (u32 i = 0; i < 3; ++i)
+            {
+                const f32* c = input[i]->clip_;
+                u32 outcode = 0;
+                if (c[0] < -c[3]) outcode |= 1;
+                if (c[0] > c[3]) outcode |= 2;
+                if (c[1] < -c[3]) outcode |= 4;
+                if (c[1] > c[3]) outcode |= 8;
+                if (c[2] < -c[3]) outcode |= 16;
+                if (c[2] > c[3]) outcode |= 32;
+                outcode_and &= outcode;
+                outcode_or |= outcode;
+            }
+
+            if (outcode_and != 0)
+            {
+                return;
+            }
+
+            if ((outcode_or & 16) == 0)
+            {
+                SetupTriangle(input, state);
+                return;
+            }
+
+            // clip against the near plane z = -w, the other planes are handled by the scissor
+            SRasterVertex clipped[4];
+            u32 clipped_count = 0;
+            for (u32 i = 0; i < 3; ++i)
+            {
+                const SRasterVertex& a = *input[i];
+                const SRasterVertex& b = *input[(i + 1) % 3];
+                const f32 da = a.clip_[2] + a.clip_[3];
+                const f32 db = b.clip_[2] + b.clip_[3];
+
+                if (da >= 0.f)
+                {
+                    clipped[clipped_count++] = a;
+                }
+
+                if ((da >= 0.f) != (db >= 0.f))
+                {
+                    const f32 t = da / (da - db);
+                    SRasterVertex& v = clipped[clipped_count++];
+                    for (u32 k = 0; k < 4; ++k)
+                    {
+                        v.clip_[k] = a.clip_[k] + (b.clip_[k] - a.clip_[k]) * t;
+                    }
+                    for (u32 k = 0; k < ESV_COUNT; ++k)
+                    {
+                        v.varying_[k] = a.varying_[k] + (b.varying_[k] - a.varying_[k]) * t;
+                    }
+                }
+            }
+
+            for (u32 i = 2; i < clipped_count; ++i)
+            {
+                const SRasterVertex* fan[3] = { &clipped[0], &clipped[i - 1], &clipped[i] };
+                SetupTriangle(fan, state);
+            }
+        }
+
+        void CSoftwareDriver::SetupTriangle(const SRasterVertex* v[3], u32 state)
+        {
+            const core::rect<s32>& vp = target_view_port_;
+            const f32 vp_w = static_cast<f32>(vp.getWidth());
+            const f32 vp_h = static_cast<f32>(vp.getHeight());
+            const bool depth_only = target_ == ESRT_SHADOW;
+
+            SRasterTriangle triangle;
+            f32 sx[3], sy[3];
+            for (u32 i = 0; i < 3; ++i)
+            {
+                const f32* c = v[i]->clip_;
+                const f32 inv_w = 1.f / c[3];
+                sx[i] = vp.UpperLeftCorner.x_ + (c[0] * inv_w * 0.5f + 0.5f) * vp_w;
+                sy[i] = vp.UpperLeftCorner.y_ + (0.5f - c[1] * inv_w * 0.5f) * vp_h;
+
+                // the shadow shader writes the raw ndc depth
+                const f32 ndc_z = c[2] * inv_w;
+                triangle.depth_[i] = depth_only ? ndc_z : ndc_z * 0.5f + 0.5f;
+                triangle.inv_w_[i] = inv_w;
+            }
+
+            const f32 area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+            if (!(fabsf(area) > 1e-8f))
+            {
+                return;
+            }
+
+            // pixel centers inside the bounding box, clamped to the viewport
+            const f32 min_x = core::min_(sx[0], core::min_(sx[1], sx[2]));
+            const f32 max_x = core::max_(sx[0], core::max_(sx[1], sx[2]));
+            const f32 min_y = core::min_(sy[0], core::min_(sy[1], sy[2]));
+            const f32 max_y = core::max_(sy[0], core::max_(sy[1], sy[2]));
+            triangle.min_x_ = core::max_(static_cast<s32>(ceilf(min_x - 0.5f)), vp.UpperLeftCorner.x_);
+            triangle.max_x_ = core::min_(static_cast<s32>(floorf(max_x - 0.5f)), vp.LowerRightCorner.x_ - 1);
+            triangle.min_y_ = core::max_(static_cast<s32>(ceilf(min_y - 0.5f)), vp.UpperLeftCorner.y_);
+            triangle.max_y_ = core::min_(static_cast<s32>(floorf(max_y - 0.5f)), vp.LowerRightCorner.y_ - 1);
+            if (triangle.min_x_ > triangle.max_x_ || triangle.min_y_ > triangle.max_y_)
+            {
+                return;
+            }
+
+            // edge i is opposite to vertex i, dividing by the signed area accepts both windings
+            const f32 inv_area = 1.f / area;
+            for (u32 i = 0; i < 3; ++i)
+            {
+                const u32 a = (i + 1) % 3;
+                const u32 b = (i + 2) % 3;
+                triangle.edge_a_[i] = (sy[a] - sy[b]) * inv_area;
+                triangle.edge_b_[i] = (sx[b] - sx[a]) * inv_area;
+                triangle.edge_c_[i] = (sx[a] * sy[b] - sy[a] * sx[b]) * inv_area;
+
+                // a shared edge has opposite coefficients in its two triangles, exactly one owns it
+                triangle.edge_owner_[i] = triangle.edge_a_[i] > 0.f || (triangle.edge_a_[i] == 0.f && triangle.edge_b_[i] > 0.f);
+
+                if (!depth_only)
+                {
+                    memcpy(triangle.varying_[i], v[i]->varying_, sizeof(f32) * ESV_COUNT);
+                }
+            }
+            triangle.state_ = state;
+
+            const u32 index = triangles_.Size();
+            triangles_.PushBack(triangle);
+
+            const s32 tile_x0 = triangle.min_x_ / SOFTWARE_TILE_SIZE;
+            const s32 tile_x1 = triangle.max_x_ / SOFTWARE_TILE_SIZE;
+            const s32 tile_y0 = triangle.min_y_ / SOFTWARE_TILE_SIZE;
+            const s32 tile_y1 = triangle.max_y_ / SOFTWARE_TILE_SIZE;
+            for (s32 ty = tile_y0; ty <= tile_y1; ++ty)
+            {
+                for (s32 tx = tile_x0; tx <= tile_x1; ++tx)
+                {
+                    bins_[ty * tiles_x_ + tx].PushBack(index);
+                }
+            }
+        }
+
+        void CSoftwareDriver::RasterizeTile(u32 tile)
+        {
+            const core::Array<u32>& bin = bins_[tile];
+            if (bin.Empty())
+            {
+                return;
+            }
+
+            const s32 tile_x0 = static_cast<s32>(tile % tiles_x_) * SOFTWARE_TILE_SIZE;
+            const s32 tile_y0 = static_cast<s32>(tile / tiles_x_) * SOFTWARE_TILE_SIZE;
+            const s32 tile_x1 = tile_x0 + SOFTWARE_TILE_SIZE - 1;
+            const s32 tile_y1 = tile_y0 + SOFTWARE_TILE_SIZE - 1;
+            const bool depth_only = target_ == ESRT_SHADOW;
+            const u32* indices = bin.ConstPointer();
+            const SRasterTriangle* triangles = triangles_.ConstPointer();
+
+            // triangles are visited in submission order, so the result does not depend on the thread count
+            for (u32 t = 0; t < bin.Size(); ++t)
+            {
+                const SRasterTriangle& tri = triangles[indices[t]];
+                const s32 x0 = core::max_(tri.min_x_, tile_x0);
+                const s32 x1 = core::min_(tri.max_x_, tile_x1);
+                const s32 y0 = core::max_(tri.min_y_, tile_y0);
+                const s32 y1 = core::min_(tri.max_y_, tile_y1);
+                if (x0 > x1 || y0 > y1)
+                {
+                    continue;
+                }
+
+                // depth is affine in screen space
+                const f32 za = tri.depth_[0] * tri.edge_a_[0] + tri.depth_[1] * tri.edge_a_[1] + tri.depth_[2] * tri.edge_a_[2];
+                const f32 zb = tri.depth_[0] * tri.edge_b_[0] + tri.depth_[1] * tri.edge_b_[1] + tri.depth_[2] * tri.edge_b_[2];
+                const f32 zc = tri.depth_[0] * tri.edge_c_[0] + tri.depth_[1] * tri.edge_c_[1] + tri.depth_[2] * tri.edge_c_[2];
+
+#ifdef _KONG_COMPILE_WITH_SSE2_
+                // four pixels of a row per step, the tiles start on a multiple of four
+                const s32 x_start = x0 & ~3;
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 one = _mm_set1_ps(1.f);
+                const __m128 lane = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+                const __m128 first_x = _mm_set1_ps(x0 + 0.5f);
+                const __m128 last_x = _mm_set1_ps(x1 + 0.5f);
+                const __m128 four = _mm_set1_ps(4.f);
+                const __m128 owner_mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                const __m128 a0 = _mm_set1_ps(tri.edge_a_[0]);
+                const __m128 a1 = _mm_set1_ps(tri.edge_a_[1]);
+                const __m128 a2 = _mm_set1_ps(tri.edge_a_[2]);
+                const __m128 az = _mm_set1_ps(za);
+                const __m128 step0 = _mm_mul_ps(a0, four);
+                const __m128 step1 = _mm_mul_ps(a1, four);
+                const __m128 step2 = _mm_mul_ps(a2, four);
+                const __m128 stepz = _mm_mul_ps(az, four);
+                const __m128 owner0 = tri.edge_owner_[0] ? owner_mask : zero;
+                const __m128 owner1 = tri.edge_owner_[1] ? owner_mask : zero;
+                const __m128 owner2 = tri.edge_owner_[2] ? owner_mask : zero;
+
+                for (s32 y = y0; y <= y1; ++y)
+                {
+                    const f32 py = y + 0.5f;
+                    __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<f32>(x_start)), lane);
+                    __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), _mm_set1_ps(tri.edge_b_[0] * py + tri.edge_c_[0]));
+                    __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), _mm_set1_ps(tri.edge_b_[1] * py + tri.edge_c_[1]));
+                    __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), _mm_set1_ps(tri.edge_b_[2] * py + tri.edge_c_[2]));
+                    __m128 z = _mm_add_ps(_mm_mul_ps(az, px), _mm_set1_ps(zb * py + zc));
+                    f32* depth_row = target_depth_ + y * target_pitch_;
+
+                    for (s32 x = x_start; x <= x1; x += 4)
+                    {
+                        // a pixel on an edge is covered only if the triangle owns that edge
+                        __m128 inside = _mm_and_ps(_mm_cmpge_ps(px, first_x), _mm_cmple_ps(px, last_x));
+                        inside = _mm_and_ps(inside, _mm_or_ps(_mm_cmpgt_ps(e0, zero), _mm_and_ps(_mm_cmpeq_ps(e0, zero), owner0)));
+                        inside = _mm_and_ps(inside, _mm_or_ps(_mm_cmpgt_ps(e1, zero), _mm_and_ps(_mm_cmpeq_ps(e1, zero), owner1)));
+                        inside = _mm_and_ps(inside, _mm_or_ps(_mm_cmpgt_ps(e2, zero), _mm_and_ps(_mm_cmpeq_ps(e2, zero), owner2)));
+
+                        if (_mm_movemask_ps(inside) != 0)
+                        {
+                            const __m128 depth = depth_only ? _mm_max_ps(z, zero) : z;
+                            const __m128 old_depth = _mm_loadu_ps(depth_row + x);
+                            const __m128 pass = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(depth, old_depth), _mm_cmple_ps(depth, one)));
+                            const s32 mask = _mm_movemask_ps(pass);
+
+                            if (mask != 0)
+                            {
+                                _mm_storeu_ps(depth_row + x, _mm_or_ps(_mm_and_ps(pass, depth), _mm_andnot_ps(pass, old_depth)));
+
+                                if (!depth_only)
+                                {
+                                    f32 l0[4], l1[4], l2[4];
+                                    _mm_storeu_ps(l0, e0);
+                                    _mm_storeu_ps(l1, e1);
+                                    _mm_storeu_ps(l2, e2);
+                                    for (s32 k = 0; k < 4; ++k)
+                                    {
+                                        if (mask & (1 << k))
+                                        {
+                                            const f32 lambda[3] = { l0[k], l1[k], l2[k] };
+                                            ShadePixel(tri, x + k, y, lambda);
+                                        }
+                                    }
+                                }
+                            }
+                        }
+
+                        px = _mm_add_ps(px, four);
+                        e0 = _mm_add_ps(e0, step0);
+                        e1 = _mm_add_ps(e1, step1);
+                        e2 = _mm_add_ps(e2, step2);
+                        z = _mm_add_ps(z, stepz);
+                    }
+                }
+#else
+                for (s32 y = y0; y <= y1; ++y)
+                {
+                    const f32 py = y + 0.5f;
+                    f32* depth_row = target_depth_ + y * target_pitch_;
+
+                    for (s32 x = x0; x <= x1; ++x)
+                    {
+                        const f32 px = x + 0.5f;
+                        f32 lambda[3];
+                        bool inside = true;
+                        for (u32 i = 0; i < 3 && inside; ++i)
+                        {
+                            lambda[i] = tri.edge_a_[i] * px + tri.edge_b_[i] * py + tri.edge_c_[i];
+                            inside = lambda[i] > 0.f || (lambda[i] == 0.f && tri.edge_owner_[i]);
+                        }
+
+                        if (!inside)
+                        {
+                            continue;
+                        }
+
+                        f32 depth = za * px + zb * py + zc;
+                        if (depth_only)
+                        {
+                            depth = core::max_(depth, 0.f);
+                        }
+
+                        if (depth < depth_row[x] && depth <= 1.f)
+                        {
+                            depth_row[x] = depth;
+                            if (!depth_only)
+                            {
+                                ShadePixel(tri, x, y, lambda);
+                            }
+                        }
+                    }
+                }
+#endif
+            }
+        }
+
+        void CSoftwareDriver::ShadePixel(const SRasterTriangle& triangle, s32 x, s32 y, const f32 lambda[3])
+        {
+            const SRasterState& state = states_.ConstPointer()[triangle.state_];
+
+            // perspective correct weights
+            f32 weight[3] = {
+                lambda[0] * triangle.inv_w_[0],
+                lambda[1] * triangle.inv_w_[1],
+                lambda[2] * triangle.inv_w_[2]
+            };
+            const f32 inv_sum = 1.f / (weight[0] + weight[1] + weight[2]);
+            weight[0] *= inv_sum;
+            weight[1] *= inv_sum;
+            weight[2] *= inv_sum;
+
+            f32 varying[ESV_COUNT];
+            for (u32 i = 0; i < ESV_COUNT; ++i)
+            {
+                varying[i] = weight[0] * triangle.varying_[0][i] + weight[1] * triangle.varying_[1][i] + weight[2] * triangle.varying_[2][i];
+            }
+
+            f32 color[4];
+            if (state.wireframe_)
+            {
+                // same edge factor as the shaders, the derivative of a barycentric is its edge gradient
+                f32 edge = 1.f;
+                for (u32 i = 0; i < 3; ++i)
+                {
+                    const f32 width = fabsf(triangle.edge_a_[i]) + fabsf(triangle.edge_b_[i]);
+                    edge = core::min_(edge, SmoothStep(0.f, width * 1.5f, lambda[i]));
+                }
+                color[0] = color[1] = color[2] = 0.5f * (1.f - edge);
+                color[3] = 1.f - edge;
+            }
+            else if (state.texture_ != nullptr)
+            {
+                SampleTexture(state.texture_, varying[ESV_TEXCOORD], varying[ESV_TEXCOORD + 1], color);
+            }
+            else if (target_ == ESRT_GBUFFER)
+            {
+                memcpy(color, state.diffuse_, sizeof(color));
+            }
+            else
+            {
+                memcpy(color, &varying[ESV_COLOR], sizeof(color));
+            }
+
+            f32* normal = &varying[ESV_NORMAL];
+            Normalize3(normal);
+
+            if (target_ == ESRT_GBUFFER)
+            {
+                SGBufferTexel& texel = gbuffer_[y * params_.window_size_.width_ + x];
+                memcpy(texel.position_, &varying[ESV_WORLD], sizeof(texel.position_));
+                memcpy(texel.normal_, normal, sizeof(texel.normal_));
+                memcpy(texel.diffuse_, color, sizeof(texel.diffuse_));
+                return;
+            }
+
+            if (!state.wireframe_ && !shade_lights_.Empty())
+            {
+                const f32 shadow = state.shadow_ ? CalculateShadowFactor(&varying[ESV_LIGHT]) : 1.f;
+                f32 light_color[3] = { 0.f, 0.f, 0.f };
+                AccumulateLights(&varying[ESV_WORLD], normal, state.camera_, state.ambient_, state.diffuse_,
+                    state.specular_, state.shininess_, shadow, 1.f, light_color);
+                color[0] *= light_color[0];
+                color[1] *= light_color[1];
+                color[2] *= light_color[2];
+            }
+
+            // alpha blending as set up by the OpenGL drivers
+            u32& pixel = color_data_[y * color_pitch_ + x];
+            if (color[3] < 1.f)
+            {
+                f32 destination[4];
+                UnpackColor(pixel, destination);
+                const f32 alpha = core::max_(color[3], 0.f);
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    color[i] = color[i] * alpha + destination[i] * (1.f - alpha);
+                }
+            }
+            pixel = PackColor(color);
+        }
+
+        void CSoftwareDriver::AccumulateLights(const f32 position[3], const f32 normal[3], const f32 camera[3],
+            const f32 ambient[4], const f32 diffuse[4], const f32 specular[4], f32 shininess,
+            f32 shadow, f32 ambient_scale, f32 light_color[3]) const
+        {
+            f32 view_direction[3] = { camera[0] - position[0], camera[1] - position[1], camera[2] - position[2] };
+            Normalize3(view_direction);
+
+            const SShadeLight* lights = shade_lights_.ConstPointer();
+            for (u32 l = 0; l < shade_lights_.Size(); ++l)
+            {
+                const SShadeLight& light = lights[l];
+                f32 light_direction[3];
+                f32 attenuation = 1.f;
+
+                if (light.position_[3] == 0.f)
+                {
+                    // directional light
+                    light_direction[0] = light.position_[0];
+                    light_direction[1] = light.position_[1];
+                    light_direction[2] = light.position_[2];
+                }
+                else
+                {
+                    light_direction[0] = light.position_[0] - position[0];
+                    light_direction[1] = light.position_[1] - position[1];
+                    light_direction[2] = light.position_[2] - position[2];
+                    const f32 dist = sqrtf(Dot3(light_direction, light_direction));
+                    attenuation = 1.f / (light.attenuation_[0] + light.attenuation_[1] * dist + light.attenuation_[2] * dist * dist);
+
+                    // cone restriction
+                    if (light.exponent_ > 0.000001f)
+                    {
+                        f32 to_point[3] = { -light_direction[0], -light_direction[1], -light_direction[2] };
+                        Normalize3(to_point);
+                        const f32 spot = Dot3(to_point, light.direction_);
+                        if (spot < light.cutoff_cos_)
+                        {
+                            attenuation = 0.f;
+                        }
+                        else
+                        {
+                            attenuation *= powf(spot, light.exponent_);
+                        }
+                    }
+                }
+
+                Normalize3(light_direction);
+
+                f32 result[3];
+                for (u32 i = 0; i < 3; ++i)
+                {
+                    result[i] = light.ambient_[i] * ambient[i] * ambient_scale;
+                }
+
+                // ignore back face
+                const f32 diffuse_factor = Dot3(light_direction, normal);
+                if (diffuse_factor > 0.f)
+                {
+                    const f32 reflect_direction[3] = {
+                        2.f * diffuse_factor * normal[0] - light_direction[0],
+                        2.f * diffuse_factor * normal[1] - light_direction[1],
+                        2.f * diffuse_factor * normal[2] - light_direction[2]
+                    };
+                    const f32 specular_factor = powf(core::max_(Dot3(view_direction, reflect_direction), 0.f), shininess);
+                    const f32 scale = shadow * attenuation;
+
+                    for (u32 i = 0; i < 3; ++i)
+                    {
+                        result[i] += scale * (diffuse_factor * light.diffuse_[i] * diffuse[i] +
+                            specular_factor * light.specular_[i] * specular[i]);
+                    }
+                }
+
+                light_color[0] += result[0];
+                light_color[1] += result[1];
+                light_color[2] += result[2];
+            }
+        }
+
+        f32 CSoftwareDriver::CalculateShadowFactor(const f32 light_position[4]) const
+        {
+            if (light_position[3] <= 0.f)
+            {
+                return 1.f;
+            }
+
+            const f32 inv_w = 1.f / light_position[3];
+            const f32 u = light_position[0] * inv_w * 0.5f + 0.5f;
+            const f32 v = light_position[1] * inv_w * 0.5f + 0.5f;
+            const f32 light_depth = light_position[2] * inv_w;
+            const f32 bias = 0.0005f;
+
+            // the shadow map rows run top down like the color buffer
+            const s32 w = static_cast<s32>(shadow_texture_size_.width_);
+            const s32 h = static_cast<s32>(shadow_texture_size_.height_);
+            auto fetch = [this, w, h](f32 s, f32 t) -> f32
+            {
+                const s32 x = core::s32_clamp(static_cast<s32>(s * w), 0, w - 1);
+                const s32 y = core::s32_clamp(static_cast<s32>((1.f - t) * h), 0, h - 1);
+                return shadow_buffer_[y * shadow_pitch_ + x];
+            };
+
+            if (light_depth - bias <= fetch(u, v))
+            {
+                return 1.f;
+            }
+
+            f32 shadow = 0.2f;
+            for (u32 i = 0; i < 4; ++i)
+            {
+                if (fetch(u + poisson_disk[i][0] / 700.f, v + poisson_disk[i][1] / 700.f) >= light_depth - bias)
+                {
+                    shadow += 0.2f;
+                }
+            }
+
+            return shadow;
+        }
+
+        void CSoftwareDriver::ResolveGBuffer()
+        {
+            if (lights_dirty_)
+            {
+                UpdateShadeLights();
+            }
+
+            // the space fill quad is drawn with the default material
+            const SMaterial material;
+            f32 ambient[4], diffuse[4], specular[4];
+            ColorToFloat(material.ambient_color_, ambient);
+            ColorToFloat(material.diffuse_color_, diffuse);
+            ColorToFloat(material.specular_color_, specular);
+            const f32 shininess = material.shininess_;
+            const f32 ambient_scale = shade_lights_.Empty() ? 1.f : 1.f / shade_lights_.Size();
+            const bool shadow = shadow_enable_ && shadow_map_valid_;
+            const f32* light_matrix = light_transform_.Pointer();
+            const u32 width = params_.window_size_.width_;
+            const u32 clear = color_clear_.color_;
+
+            thread_pool_->ParallelFor(params_.window_size_.height_, [&](u32 y)
+            {
+                const f32* depth_row = depth_buffer_ + y * depth_pitch_;
+                const SGBufferTexel* texel_row = gbuffer_ + y * width;
+                u32* color_row = color_data_ + y * color_pitch_;
+
+                for (u32 x = 0; x < width; ++x)
+                {
+                    if (depth_row[x] >= 1.f)
+                    {
+                        color_row[x] = clear;
+                        continue;
+                    }
+
+                    const SGBufferTexel& texel = texel_row[x];
+                    f32 shadow_factor = 1.f;
+                    if (shadow)
+                    {
+                        f32 light_position[4];
+                        TransformPoint(light_matrix, texel.position_[0], texel.position_[1], texel.position_[2], light_position);
+                        shadow_factor = CalculateShadowFactor(light_position);
+                    }
+
+                    f32 color[4] = { 0.f, 0.f, 0.f, 1.f };
+                    AccumulateLights(texel.position_, texel.normal_, camera_position_, ambient, diffuse, specular,
+                        shininess, shadow_factor, ambient_scale, color);
+                    color[0] *= texel.diffuse_[0];
+                    color[1] *= texel.diffuse_[1];
+                    color[2] *= texel.diffuse_[2];
+                    color_row[x] = PackColor(color);
+                }
+            });
+        }
+
+        void CSoftwareDriver::UpdateShadeLights()
+        {
+            const u32 count = core::min_(lights_.Size(), SOFTWARE_MAX_LIGHTS);
+            shade_lights_.Resize(count);
+            SShadeLight* out = shade_lights_.Pointer();
+
+            for (u32 i = 0; i < count; ++i)
+            {
+                const SLight& light = lights_[i];
+                SShadeLight& shade = out[i];
+                memset(&shade, 0, sizeof(SShadeLight));
+
+                switch (light.type_)
+                {
+                case ELT_SPOT:
+                    shade.exponent_ = light.falloff_;
+                    shade.cutoff_cos_ = cosf(light.outer_cone_ * core::DEGTORAD);
+                    // fall through
+                case ELT_POINT:
+                    shade.position_[0] = light.position_.x_;
+                    shade.position_[1] = light.position_.y_;
+                    shade.position_[2] = light.position_.z_;
+                    shade.position_[3] = 1.f;
+                    break;
+                case ELT_DIRECTIONAL:
+                    shade.position_[0] = -light.direction_.x_;
+                    shade.position_[1] = -light.direction_.y_;
+                    shade.position_[2] = -light.direction_.z_;
+                    shade.position_[3] = 0.f;
+                    break;
+                default:
+                    break;
+                }
+
+                shade.direction_[0] = light.direction_.x_;
+                shade.direction_[1] = light.direction_.y_;
+                shade.direction_[2] = light.direction_.z_;
+                Normalize3(shade.direction_);
+
+                shade.ambient_[0] = light.ambient_color_.r;
+                shade.ambient_[1] = light.ambient_color_.g;
+                shade.ambient_[2] = light.ambient_color_.b;
+                shade.diffuse_[0] = light.diffuse_color_.r;
+                shade.diffuse_[1] = light.diffuse_color_.g;
+                shade.diffuse_[2] = light.diffuse_color_.b;
+                shade.specular_[0] = light.specular_color_.r;
+                shade.specular_[1] = light.specular_color_.g;
+                shade.specular_[2] = light.specular_color_.b;
+                shade.attenuation_[0] = light.attenuation_.x_;
+                shade.attenuation_[1] = light.attenuation_.y_;
+                shade.attenuation_[2] = light.attenuation_.z_;
+            }
+
+            lights_dirty_ = false;
+        }
+
+#ifdef _KONG_COMPILE_WITH_SOFTWARE_
+        IVideoDriver* CreateSoftwareDriver(const SKongCreationParameters& params, io::IFileSystem* io)
+        {
+            return new CSoftwareDriver(params, io);
+        }
+#endif
+    } // end namespace video
+} // end namespace kong
@@ -0,0 +1,78 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CSoftwareTexture.h"
+#include "CBlockCompression.h"
+
+namespace kong
+{
+    namespace video
+    {
+        CSoftwareTexture::CSoftwareTexture(IImage* surface, const io::path& name)
+            : ITexture(name), image_(nullptr)
+        {
+            if (surface != nullptr)
+            {
+                original_size_ = surface->GetDimension();
+                if (IImage::IsCompressedFormat(surface->GetColorFormat()))
+                {
+                    image_ = static_cast<CImage *>(CBlockCompression::Decompress(surface));
+                }
+                else
+                {
+                    image_ = new CImage(ECF_A8R8G8B8, original_size_);
+                    surface->CopyTo(image_);
+                }
+            }
+            else
+            {
+                image_ = new CImage(ECF_A8R8G8B8, core::Dimension2d<u32>(1, 1));
+                image_->Fill(SColor(255, 255, 255, 255));
+            }
+        }
+
+        CSoftwareTexture::~CSoftwareTexture()
+        {
+            delete image_;
+        }
+
+        void* CSoftwareTexture::Lock(E_TEXTURE_LOCK_MODE mode, u32 mipmapLevel)
+        {
+            return image_->Lock();
+        }
+
+        void CSoftwareTexture::Unlock()
+        {
+            image_->Unlock();
+        }
+
+        const core::Dimension2d<u32>& CSoftwareTexture::GetOriginalSize() const
+        {
+            return original_size_;
+        }
+
+        const core::Dimension2d<u32>& CSoftwareTexture::GetSize() const
+        {
+            return image_->GetDimension();
+        }
+
+        E_DRIVER_TYPE CSoftwareTexture::GetDriverType() const
+        {
+            return EDT_SOFTWARE;
+        }
+
+        ECOLOR_FORMAT CSoftwareTexture::GetColorFormat() const
+        {
+            return ECF_A8R8G8B8;
+        }
+
+        u32 CSoftwareTexture::GetPitch() const
+        {
+            return image_->GetPitch();
+        }
+
+        void CSoftwareTexture::RegenerateMipMapLevels(void* mipmapData)
+        {
+        }
+    } // end namespace video
+} // end namespace kong
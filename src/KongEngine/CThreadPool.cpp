@@ -0,0 +1,114 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CThreadPool.h"
+
+namespace kong
+{
+    namespace core
+    {
+        CThreadPool::CThreadPool(u32 thread_count)
+            : job_(nullptr), next_job_(0), job_count_(0), busy_workers_(0), generation_(0), stop_(false)
+        {
+            if (thread_count == 0)
+            {
+                thread_count = std::thread::hardware_concurrency();
+            }
+
+            // the calling thread is the first worker
+            for (u32 i = 1; i < thread_count; ++i)
+            {
+                workers_.emplace_back(&CThreadPool::WorkerLoop, this);
+            }
+        }
+
+        CThreadPool::~CThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_condition_.notify_all();
+
+            for (auto& worker : workers_)
+            {
+                worker.join();
+            }
+        }
+
+        u32 CThreadPool::GetThreadCount() const
+        {
+            return static_cast<u32>(workers_.size()) + 1;
+        }
+
+        void CThreadPool::ParallelFor(u32 job_count, const std::function<void(u32)>& job)
+        {
+            if (job_count == 0)
+            {
+                return;
+            }
+
+            if (workers_.empty() || job_count == 1)
+            {
+                for (u32 i = 0; i < job_count; ++i)
+                {
+                    job(i);
+                }
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                job_ = &job;
+                job_count_ = job_count;
+                next_job_ = 0;
+                busy_workers_ = static_cast<u32>(workers_.size());
+                ++generation_;
+            }
+            wake_condition_.notify_all();
+
+            RunJobs();
+
+            // job_ has to stay valid until every worker left this generation
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_condition_.wait(lock, [this] { return busy_workers_ == 0; });
+            job_ = nullptr;
+        }
+
+        void CThreadPool::WorkerLoop()
+        {
+            u32 generation = 0;
+
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_condition_.wait(lock, [this, generation] { return stop_ || generation_ != generation; });
+                    if (stop_)
+                    {
+                        return;
+                    }
+                    generation = generation_;
+                }
+
+                RunJobs();
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (--busy_workers_ == 0)
+                    {
+                        done_condition_.notify_one();
+                    }
+                }
+            }
+        }
+
+        void CThreadPool::RunJobs()
+        {
+            for (u32 i = next_job_++; i < job_count_; i = next_job_++)
+            {
+                (*job_)(i);
+            }
+        }
+    } // end namespace core
+} // end namespace kong
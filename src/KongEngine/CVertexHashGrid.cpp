@@ -0,0 +1,148 @@
+// Copyright (C) 2018 Lyu Luan
+// This file is part of the "Kong Engine".
+
+#include "CVertexHashGrid.h"
+#include <cmath>
+
+namespace kong
+{
+    namespace scene
+    {
+        // keeps the grid usable for a tolerance of 0
+        static const f64 MIN_CELL_SIZE = 1e-5;
+
+        CVertexHashGrid::CVertexHashGrid(f32 tolerance, u32 expected_vertex_count)
+            : cell_mask_(0), used_cells_(0), vertex_count_(0)
+        {
+            // every position within tolerance lies in the same or a neighbouring cell
+            f64 cell_size = 2.0 * static_cast<f64>(tolerance);
+            if (!(cell_size > MIN_CELL_SIZE))
+            {
+                cell_size = MIN_CELL_SIZE;
+            }
+            inv_cell_size_ = 1.0 / cell_size;
+
+            u32 capacity = 64;
+            while (capacity < expected_vertex_count * 2 && capacity < 0x40000000)
+            {
+                capacity <<= 1;
+            }
+
+            cells_.Resize(capacity);
+            cell_mask_ = capacity - 1;
+            next_.Reallocate(expected_vertex_count);
+            Clear();
+        }
+
+        void CVertexHashGrid::Clear()
+        {
+            SCell* cells = cells_.Pointer();
+            for (u32 i = 0; i <= cell_mask_; ++i)
+            {
+                cells[i].first_ = EMPTY_CELL;
+            }
+
+            used_cells_ = 0;
+            next_.Clear();
+            vertex_count_ = 0;
+        }
+
+        u32 CVertexHashGrid::Add(const core::vector3df& position)
+        {
+            const s32 x = GetCellCoordinate(position.x_);
+            const s32 y = GetCellCoordinate(position.y_);
+            const s32 z = GetCellCoordinate(position.z_);
+
+            const u32 index = vertex_count_++;
+            next_.PushBack(static_cast<u32>(EMPTY_CELL));
+
+            SCell& cell = cells_.Pointer()[FindSlot(x, y, z)];
+            if (cell.first_ == EMPTY_CELL)
+            {
+                cell.x_ = x;
+                cell.y_ = y;
+                cell.z_ = z;
+                cell.first_ = index;
+                cell.last_ = index;
+
+                if (++used_cells_ * 2 > cell_mask_ + 1)
+                {
+                    Grow();
+                }
+            }
+            else
+            {
+                next_.Pointer()[cell.last_] = index;
+                cell.last_ = index;
+            }
+
+            return index;
+        }
+
+        s32 CVertexHashGrid::GetCellCoordinate(f32 value) const
+        {
+            // leaves room for the neighbour offsets, NaN ends up in the lowest cell
+            static const f64 limit = 2147483646.0;
+
+            const f64 cell = floor(static_cast<f64>(value) * inv_cell_size_);
+            if (!(cell > -limit))
+            {
+                return -2147483646;
+            }
+            if (cell > limit)
+            {
+                return 2147483646;
+            }
+            return static_cast<s32>(cell);
+        }
+
+        u32 CVertexHashGrid::HashCell(s32 x, s32 y, s32 z)
+        {
+            return static_cast<u32>(x) * 73856093u ^ static_cast<u32>(y) * 19349663u ^ static_cast<u32>(z) * 83492791u;
+        }
+
+        u32 CVertexHashGrid::FindSlot(s32 x, s32 y, s32 z) const
+        {
+            const SCell* cells = cells_.ConstPointer();
+            u32 slot = HashCell(x, y, z) & cell_mask_;
+
+            while (cells[slot].first_ != EMPTY_CELL &&
+                (cells[slot].x_ != x || cells[slot].y_ != y || cells[slot].z_ != z))
+            {
+                slot = (slot + 1) & cell_mask_;
+            }
+
+            return slot;
+        }
+
+        void CVertexHashGrid::Grow()
+        {
+            const u32 old_capacity = cell_mask_ + 1;
+
+            core::Array<SCell> old_cells;
+            old_cells.Resize(old_capacity);
+            for (u32 i = 0; i < old_capacity; ++i)
+            {
+                old_cells.Pointer()[i] = cells_.ConstPointer()[i];
+            }
+
+            cells_.Resize(old_capacity * 2);
+            cell_mask_ = old_capacity * 2 - 1;
+
+            SCell* cells = cells_.Pointer();
+            for (u32 i = 0; i <= cell_mask_; ++i)
+            {
+                cells[i].first_ = EMPTY_CELL;
+            }
+
+            for (u32 i = 0; i < old_capacity; ++i)
+            {
+                const SCell& cell = old_cells.ConstPointer()[i];
+                if (cell.first_ != EMPTY_CELL)
+                {
+                    cells[FindSlot(cell.x_, cell.y_, cell.z_)] = cell;
+                }
+            }
+        }
+    } // end namespace scene
+} // end namespace kong
@@ -66,8 +66,10 @@ namespace kong
 
 #if defined(_KONG_WCHAR_FILESYSTEM)
             file_ = _wfopen(filename_.c_str(), append ? L"ab" : L"wb");
-#else
+#elif defined(_MSC_VER)
             fopen_s(&file_, filename_.c_str(), append ? "ab" : "wb");
+#else
+            file_ = fopen(filename_.c_str(), append ? "ab" : "wb");
 #endif
             if (file_ != nullptr)
             {
@@ -16,6 +16,10 @@
 #include "CKongDeviceWin32.h"
 #endif
 
+#ifdef _KONG_COMPILE_WITH_HEADLESS_DEVICE_
+#include "CKongDeviceHeadless.h"
+#endif
+
 namespace kong
 {
     KONG_API KongDevice* KONGCALLCONV CreateDevice(
@@ -39,8 +43,13 @@ namespace kong
         KongDevice *dev = nullptr;
 
 #ifdef _KONG_COMPILE_WITH_WINDOWS_DEVICE_
-        //if (params.DeviceType == EIDT_WIN32 || (!dev && params.DeviceType == EIDT_BEST))
-        dev = new CKongDeviceWin32(params);
+        if (params.device_type_ == EIDT_WIN32 || (!dev && params.device_type_ == EIDT_BEST))
+            dev = new CKongDeviceWin32(params);
+#endif
+
+#ifdef _KONG_COMPILE_WITH_HEADLESS_DEVICE_
+        if (params.device_type_ == EIDT_HEADLESS || (!dev && params.device_type_ == EIDT_BEST))
+            dev = new CKongDeviceHeadless(params);
 #endif
 
         return dev;
@@ -9,6 +9,7 @@
 #include "os.h"
 #include "Map.h"
 #include "KongMath.h"
+#include "CVertexHashGrid.h"
 
 namespace kong
 {
@@ -69,6 +70,7 @@ namespace kong
                         idx[i + 2] = tmp;
                     }
                 }
+                buffer->SetDirty(EBT_INDEX);
             }
         }
 
@@ -136,6 +138,8 @@ namespace kong
                 recalculateNormalsT<u16>(buffer, smooth, angleWeighted);
             else
                 recalculateNormalsT<u32>(buffer, smooth, angleWeighted);
+
+            buffer->SetDirty(EBT_VERTEX);
         }
 
 
@@ -471,6 +475,8 @@ namespace kong
                     recalculateTangentsT<u16>(buffer, recalculateNormals, smooth, angleWeighted);
                 else
                     recalculateTangentsT<u32>(buffer, recalculateNormals, smooth, angleWeighted);
+
+                buffer->SetDirty(EBT_VERTEX);
             }
         }
 
@@ -546,6 +552,8 @@ namespace kong
                 makePlanarTextureMappingT<u16>(buffer, resolution);
             else
                 makePlanarTextureMappingT<u32>(buffer, resolution);
+
+            buffer->SetDirty(EBT_VERTEX);
         }
 
 
@@ -614,6 +622,8 @@ namespace kong
                 makePlanarTextureMappingT<u16>(buffer, resolutionS, resolutionT, axis, offset);
             else
                 makePlanarTextureMappingT<u32>(buffer, resolutionS, resolutionT, axis, offset);
+
+            buffer->SetDirty(EBT_VERTEX);
         }
 
 
@@ -632,7 +642,6 @@ namespace kong
 
 
         //! Clones a static IMesh into a modifyable SMesh.
-        // not yet 32bit
         SMesh* CMeshManipulator::createMeshCopy(scene::IMesh* mesh) const
         {
             if (!mesh)
@@ -657,10 +666,10 @@ namespace kong
                     for (u32 i = 0; i < vcount; ++i)
                         buffer->vertices_.PushBack(vertices[i]);
                     const u32 icount = mb->GetIndexCount();
-                    buffer->indices_.Reallocate(icount);
-                    const u16* indices = mb->GetIndices();
+                    buffer->SetIndexType(mb->GetIndexType());
+                    buffer->ReallocateIndices(icount);
                     for (u32 i = 0; i < icount; ++i)
-                        buffer->indices_.PushBack(indices[i]);
+                        buffer->PushBackIndex(mb->GetIndex(i));
                     clone->AddMeshBuffer(buffer);
                     //buffer->drop();
                 }
@@ -675,10 +684,10 @@ namespace kong
                     for (u32 i = 0; i < vcount; ++i)
                         buffer->vertices_.PushBack(vertices[i]);
                     const u32 icount = mb->GetIndexCount();
-                    buffer->indices_.Reallocate(icount);
-                    const u16* indices = mb->GetIndices();
+                    buffer->SetIndexType(mb->GetIndexType());
+                    buffer->ReallocateIndices(icount);
                     for (u32 i = 0; i < icount; ++i)
-                        buffer->indices_.PushBack(indices[i]);
+                        buffer->PushBackIndex(mb->GetIndex(i));
                     clone->AddMeshBuffer(buffer);
                     //buffer->drop();
                 }
@@ -693,10 +702,10 @@ namespace kong
                     for (u32 i = 0; i < vcount; ++i)
                         buffer->vertices_.PushBack(vertices[i]);
                     const u32 icount = mb->GetIndexCount();
-                    buffer->indices_.Reallocate(icount);
-                    const u16* indices = mb->GetIndices();
+                    buffer->SetIndexType(mb->GetIndexType());
+                    buffer->ReallocateIndices(icount);
                     for (u32 i = 0; i < icount; ++i)
-                        buffer->indices_.PushBack(indices[i]);
+                        buffer->PushBackIndex(mb->GetIndex(i));
                     clone->AddMeshBuffer(buffer);
                     //buffer->drop();
                 }
@@ -711,7 +720,6 @@ namespace kong
 
 
         //! Creates a copy of the mesh, which will only consist of unique primitives
-        // not yet 32bit
         IMesh* CMeshManipulator::createMeshUniquePrimitives(IMesh* mesh) const
         {
             if (!mesh)
@@ -725,7 +733,6 @@ namespace kong
             {
                 const IMeshBuffer* const mb = mesh->GetMeshBuffer(b);
                 const s32 idxCnt = mb->GetIndexCount();
-                const u16* idx = mb->GetIndices();
 
                 switch (mb->GetVertexType())
                 {
@@ -738,16 +745,16 @@ namespace kong
                         (video::S3DVertex*)mb->GetVertices();
 
                     buffer->vertices_.Reallocate(idxCnt);
-                    buffer->indices_.Reallocate(idxCnt);
+                    buffer->ReallocateIndices(idxCnt);
                     for (s32 i = 0; i<idxCnt; i += 3)
                     {
-                        buffer->vertices_.PushBack(v[idx[i + 0]]);
-                        buffer->vertices_.PushBack(v[idx[i + 1]]);
-                        buffer->vertices_.PushBack(v[idx[i + 2]]);
+                        buffer->vertices_.PushBack(v[mb->GetIndex(i + 0)]);
+                        buffer->vertices_.PushBack(v[mb->GetIndex(i + 1)]);
+                        buffer->vertices_.PushBack(v[mb->GetIndex(i + 2)]);
 
-                        buffer->indices_.PushBack(i + 0);
-                        buffer->indices_.PushBack(i + 1);
-                        buffer->indices_.PushBack(i + 2);
+                        buffer->PushBackIndex(i + 0);
+                        buffer->PushBackIndex(i + 1);
+                        buffer->PushBackIndex(i + 2);
                     }
 
                     buffer->SetBoundingBox(mb->GetBoundingBox());
@@ -764,16 +771,16 @@ namespace kong
                         (video::S3DVertex2TCoords*)mb->GetVertices();
 
                     buffer->vertices_.Reallocate(idxCnt);
-                    buffer->indices_.Reallocate(idxCnt);
+                    buffer->ReallocateIndices(idxCnt);
                     for (s32 i = 0; i<idxCnt; i += 3)
                     {
-                        buffer->vertices_.PushBack(v[idx[i + 0]]);
-                        buffer->vertices_.PushBack(v[idx[i + 1]]);
-                        buffer->vertices_.PushBack(v[idx[i + 2]]);
+                        buffer->vertices_.PushBack(v[mb->GetIndex(i + 0)]);
+                        buffer->vertices_.PushBack(v[mb->GetIndex(i + 1)]);
+                        buffer->vertices_.PushBack(v[mb->GetIndex(i + 2)]);
 
-                        buffer->indices_.PushBack(i + 0);
-                        buffer->indices_.PushBack(i + 1);
-                        buffer->indices_.PushBack(i + 2);
+                        buffer->PushBackIndex(i + 0);
+                        buffer->PushBackIndex(i + 1);
+                        buffer->PushBackIndex(i + 2);
                     }
                     buffer->SetBoundingBox(mb->GetBoundingBox());
                     clone->AddMeshBuffer(buffer);
@@ -789,16 +796,16 @@ namespace kong
                         (video::S3DVertexTangents*)mb->GetVertices();
 
                     buffer->vertices_.Reallocate(idxCnt);
-                    buffer->indices_.Reallocate(idxCnt);
+                    buffer->ReallocateIndices(idxCnt);
                     for (s32 i = 0; i<idxCnt; i += 3)
                     {
-                        buffer->vertices_.PushBack(v[idx[i + 0]]);
-                        buffer->vertices_.PushBack(v[idx[i + 1]]);
-                        buffer->vertices_.PushBack(v[idx[i + 2]]);
+                        buffer->vertices_.PushBack(v[mb->GetIndex(i + 0)]);
+                        buffer->vertices_.PushBack(v[mb->GetIndex(i + 1)]);
+                        buffer->vertices_.PushBack(v[mb->GetIndex(i + 2)]);
 
-                        buffer->indices_.PushBack(i + 0);
-                        buffer->indices_.PushBack(i + 1);
-                        buffer->indices_.PushBack(i + 2);
+                        buffer->PushBackIndex(i + 0);
+                        buffer->PushBackIndex(i + 1);
+                        buffer->PushBackIndex(i + 2);
                     }
 
                     buffer->SetBoundingBox(mb->GetBoundingBox());
@@ -815,14 +822,53 @@ namespace kong
         }
 
 
+        //! Copies the unique vertices of v into out and fills the redirect list
+        /** A vertex is mapped to the first earlier vertex which is equal to it,
+        the grid only limits the candidates to those with a close position. */
+        template <class T, class E>
+        static void weldVertices(const T* v, u32 vertexCount, core::Array<T>& out,
+            u32* redirects, f32 tolerance, const E& equals)
+        {
+            CVertexHashGrid grid(tolerance, vertexCount);
+            out.Reallocate(vertexCount);
+
+            for (u32 i = 0; i < vertexCount; ++i)
+            {
+                const s32 j = grid.FindFirst(v[i].pos_, [&](u32 k) { return equals(v[i], v[k]); });
+                grid.Add(v[i].pos_);
+
+                if (j >= 0)
+                {
+                    redirects[i] = redirects[j];
+                }
+                else
+                {
+                    redirects[i] = out.Size();
+                    out.PushBack(v[i]);
+                }
+            }
+        }
+
+        //! Writes the indices of mb, redirected to the welded vertices, into buffer
+        template <class T>
+        static void redirectIndices(const IMeshBuffer* mb, const u32* redirects, CMeshBuffer<T>* buffer)
+        {
+            const u32 indexCount = mb->GetIndexCount();
+            buffer->ReallocateIndices(indexCount);
+            for (u32 i = 0; i < indexCount; ++i)
+            {
+                buffer->PushBackIndex(redirects[mb->GetIndex(i)]);
+            }
+        }
+
+
         //! Creates a copy of a mesh, which will have identical vertices welded together
-        // not yet 32bit
         IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
         {
             SMesh* clone = new SMesh();
             clone->bounding_box_ = mesh->GetBoundingBox();
 
-            core::Array<u16> redirects;
+            core::Array<u32> redirects;
 
             for (u32 b = 0; b<mesh->GetMeshBufferCount(); ++b)
             {
@@ -830,9 +876,7 @@ namespace kong
                 // reset redirect list
                 redirects.Resize(mb->GetVertexCount());
 
-                const u16* indices = 0;
-                u32 indexCount = 0;
-                core::Array<u16>* outIdx = 0;
+                const u32 vertexCount = mb->GetVertexCount();
 
                 switch (mb->GetVertexType())
                 {
@@ -844,39 +888,16 @@ namespace kong
                     clone->AddMeshBuffer(buffer);
                     //buffer->drop();
 
-                    video::S3DVertex* v =
-                        (video::S3DVertex*)mb->GetVertices();
-
-                    u32 vertexCount = mb->GetVertexCount();
-
-                    indices = mb->GetIndices();
-                    indexCount = mb->GetIndexCount();
-                    outIdx = &buffer->indices_;
-
-                    buffer->vertices_.Reallocate(vertexCount);
-
-                    for (u32 i = 0; i < vertexCount; ++i)
+                    weldVertices((const video::S3DVertex*)mb->GetVertices(), vertexCount,
+                        buffer->vertices_, redirects.Pointer(), tolerance,
+                        [tolerance](const video::S3DVertex& a, const video::S3DVertex& b)
                     {
-                        bool found = false;
-                        for (u32 j = 0; j < i; ++j)
-                        {
-                            if (v[i].pos_.Equals(v[j].pos_, tolerance) &&
-                                v[i].normal_.Equals(v[j].normal_, tolerance) &&
-                                v[i].texcoord_.Equals(v[j].texcoord_) &&
-                                (v[i].color_ == v[j].color_))
-                            {
-                                redirects[i] = redirects[j];
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (!found)
-                        {
-                            redirects[i] = buffer->vertices_.Size();
-                            buffer->vertices_.PushBack(v[i]);
-                        }
-                    }
-
+                        return a.pos_.Equals(b.pos_, tolerance) &&
+                            a.normal_.Equals(b.normal_, tolerance) &&
+                            a.texcoord_.Equals(b.texcoord_) &&
+                            (a.color_ == b.color_);
+                    });
+                    redirectIndices(mb, redirects.ConstPointer(), buffer);
                     break;
                 }
                 case video::EVT_2TCOORDS:
@@ -887,39 +908,17 @@ namespace kong
                     clone->AddMeshBuffer(buffer);
                     //buffer->drop();
 
-                    video::S3DVertex2TCoords* v =
-                        (video::S3DVertex2TCoords*)mb->GetVertices();
-
-                    u32 vertexCount = mb->GetVertexCount();
-
-                    indices = mb->GetIndices();
-                    indexCount = mb->GetIndexCount();
-                    outIdx = &buffer->indices_;
-
-                    buffer->vertices_.Reallocate(vertexCount);
-
-                    for (u32 i = 0; i < vertexCount; ++i)
+                    weldVertices((const video::S3DVertex2TCoords*)mb->GetVertices(), vertexCount,
+                        buffer->vertices_, redirects.Pointer(), tolerance,
+                        [tolerance](const video::S3DVertex2TCoords& a, const video::S3DVertex2TCoords& b)
                     {
-                        bool found = false;
-                        for (u32 j = 0; j < i; ++j)
-                        {
-                            if (v[i].pos_.Equals(v[j].pos_, tolerance) &&
-                                v[i].normal_.Equals(v[j].normal_, tolerance) &&
-                                v[i].texcoord_.Equals(v[j].texcoord_) &&
-                                v[i].texcoord2_.Equals(v[j].texcoord2_) &&
-                                (v[i].color_ == v[j].color_))
-                            {
-                                redirects[i] = redirects[j];
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (!found)
-                        {
-                            redirects[i] = buffer->vertices_.Size();
-                            buffer->vertices_.PushBack(v[i]);
-                        }
-                    }
+                        return a.pos_.Equals(b.pos_, tolerance) &&
+                            a.normal_.Equals(b.normal_, tolerance) &&
+                            a.texcoord_.Equals(b.texcoord_) &&
+                            a.texcoord2_.Equals(b.texcoord2_) &&
+                            (a.color_ == b.color_);
+                    });
+                    redirectIndices(mb, redirects.ConstPointer(), buffer);
                     break;
                 }
                 case video::EVT_TANGENTS:
@@ -930,62 +929,30 @@ namespace kong
                     clone->AddMeshBuffer(buffer);
                     //buffer->drop();
 
-                    video::S3DVertexTangents* v =
-                        (video::S3DVertexTangents*)mb->GetVertices();
-
-                    u32 vertexCount = mb->GetVertexCount();
-
-                    indices = mb->GetIndices();
-                    indexCount = mb->GetIndexCount();
-                    outIdx = &buffer->indices_;
-
-                    buffer->vertices_.Reallocate(vertexCount);
-
-                    for (u32 i = 0; i < vertexCount; ++i)
+                    weldVertices((const video::S3DVertexTangents*)mb->GetVertices(), vertexCount,
+                        buffer->vertices_, redirects.Pointer(), tolerance,
+                        [tolerance](const video::S3DVertexTangents& a, const video::S3DVertexTangents& b)
                     {
-                        bool found = false;
-                        for (u32 j = 0; j < i; ++j)
-                        {
-                            if (v[i].pos_.Equals(v[j].pos_, tolerance) &&
-                                v[i].normal_.Equals(v[j].normal_, tolerance) &&
-                                v[i].texcoord_.Equals(v[j].texcoord_) &&
-                                v[i].tangent_.Equals(v[j].tangent_, tolerance) &&
-                                v[i].binormal_.Equals(v[j].binormal_, tolerance) &&
-                                (v[i].color_ == v[j].color_))
-                            {
-                                redirects[i] = redirects[j];
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (!found)
-                        {
-                            redirects[i] = buffer->vertices_.Size();
-                            buffer->vertices_.PushBack(v[i]);
-                        }
-                    }
+                        return a.pos_.Equals(b.pos_, tolerance) &&
+                            a.normal_.Equals(b.normal_, tolerance) &&
+                            a.texcoord_.Equals(b.texcoord_) &&
+                            a.tangent_.Equals(b.tangent_, tolerance) &&
+                            a.binormal_.Equals(b.binormal_, tolerance) &&
+                            (a.color_ == b.color_);
+                    });
+                    redirectIndices(mb, redirects.ConstPointer(), buffer);
                     break;
                 }
                 default:
                     os::Printer::log("Cannot create welded mesh, vertex type unsupported", ELL_ERROR);
                     break;
                 }
-
-                // write the buffer's index list
-                core::Array<u16> &Indices = *outIdx;
-
-                Indices.Resize(indexCount);
-                for (u32 i = 0; i<indexCount; ++i)
-                {
-                    Indices[i] = redirects[indices[i]];
-                }
             }
             return clone;
         }
 
 
         //! Creates a copy of the mesh, which will only consist of S3DVertexTangents vertices.
-        // not yet 32bit
         IMesh* CMeshManipulator::createMeshWithTangents(IMesh* mesh, bool recalculateNormals, bool smooth, bool angleWeighted, bool calculateTangents) const
         {
             if (!mesh)
@@ -1000,13 +967,12 @@ namespace kong
             {
                 const IMeshBuffer* const original = mesh->GetMeshBuffer(b);
                 const u32 idxCnt = original->GetIndexCount();
-                const u16* idx = original->GetIndices();
 
                 SMeshBufferTangents* buffer = new SMeshBufferTangents();
 
                 buffer->material_ = original->GetMaterial();
                 buffer->vertices_.Reallocate(idxCnt);
-                buffer->indices_.Reallocate(idxCnt);
+                buffer->ReallocateIndices(idxCnt);
 
                 core::Map<video::S3DVertexTangents, int> vertMap;
                 int vertLocation;
@@ -1017,6 +983,7 @@ namespace kong
                 video::S3DVertexTangents vNew;
                 for (u32 i = 0; i<idxCnt; ++i)
                 {
+                    const u32 index = original->GetIndex(i);
                     switch (vType)
                     {
                     case video::EVT_STANDARD:
@@ -1024,7 +991,7 @@ namespace kong
                         const video::S3DVertex* v =
                             (const video::S3DVertex*)original->GetVertices();
                         vNew = video::S3DVertexTangents(
-                            v[idx[i]].pos_, v[idx[i]].normal_, v[idx[i]].color_, v[idx[i]].texcoord_);
+                            v[index].pos_, v[index].normal_, v[index].color_, v[index].texcoord_);
                     }
                     break;
                     case video::EVT_2TCOORDS:
@@ -1032,14 +999,14 @@ namespace kong
                         const video::S3DVertex2TCoords* v =
                             (const video::S3DVertex2TCoords*)original->GetVertices();
                         vNew = video::S3DVertexTangents(
-                            v[idx[i]].pos_, v[idx[i]].normal_, v[idx[i]].color_, v[idx[i]].texcoord_);
+                            v[index].pos_, v[index].normal_, v[index].color_, v[index].texcoord_);
                     }
                     break;
                     case video::EVT_TANGENTS:
                     {
                         const video::S3DVertexTangents* v =
                             (const video::S3DVertexTangents*)original->GetVertices();
-                        vNew = v[idx[i]];
+                        vNew = v[index];
                     }
                     break;
                     }
@@ -1056,7 +1023,7 @@ namespace kong
                     }
 
                     // create new indices
-                    buffer->indices_.PushBack(vertLocation);
+                    buffer->PushBackIndex(vertLocation);
                 }
                 buffer->RecalculateBoundingBox();
 
@@ -1085,13 +1052,12 @@ namespace kong
             {
                 const IMeshBuffer* const original = mesh->GetMeshBuffer(b);
                 const u32 idxCnt = original->GetIndexCount();
-                const u16* idx = original->GetIndices();
 
                 SMeshBufferTangents* buffer = new SMeshBufferTangents();
 
                 buffer->material_ = original->GetMaterial();
                 buffer->vertices_.Reallocate(idxCnt);
-                buffer->indices_.Reallocate(idxCnt);
+                buffer->ReallocateIndices(idxCnt);
 
                 core::Map<video::S3DVertexTangents, int> vertMap;
                 int vertLocation;
@@ -1102,6 +1068,7 @@ namespace kong
                 video::S3DVertexTangents vNew;
                 for (u32 i = 0; i<idxCnt; ++i)
                 {
+                    const u32 index = original->GetIndex(i);
                     switch (vType)
                     {
                     case video::EVT_STANDARD:
@@ -1109,7 +1076,7 @@ namespace kong
                         const video::S3DVertex* v =
                             (const video::S3DVertex*)original->GetVertices();
                         vNew = video::S3DVertexTangents(
-                            v[idx[i]].pos_, v[idx[i]].normal_, v[idx[i]].color_, v[idx[i]].texcoord_);
+                            v[index].pos_, v[index].normal_, v[index].color_, v[index].texcoord_);
                     }
                         break;
                     case video::EVT_2TCOORDS:
@@ -1117,14 +1084,14 @@ namespace kong
                         const video::S3DVertex2TCoords* v =
                             (const video::S3DVertex2TCoords*)original->GetVertices();
                         vNew = video::S3DVertexTangents(
-                            v[idx[i]].pos_, v[idx[i]].normal_, v[idx[i]].color_, v[idx[i]].texcoord_);
+                            v[index].pos_, v[index].normal_, v[index].color_, v[index].texcoord_);
                     }
                         break;
                     case video::EVT_TANGENTS:
                     {
                         const video::S3DVertexTangents* v =
                             (const video::S3DVertexTangents*)original->GetVertices();
-                        vNew = v[idx[i]];
+                        vNew = v[index];
                     }
                         break;
                     }
@@ -1141,7 +1108,7 @@ namespace kong
                     }
 
                     // create new indices
-                    buffer->indices_.PushBack(vertLocation);
+                    buffer->PushBackIndex(vertLocation);
                 }
                 buffer->RecalculateBoundingBox();
 
@@ -1156,7 +1123,6 @@ namespace kong
         }
 
         //! Creates a copy of the mesh, which will only consist of S3DVertex2TCoords vertices.
-        // not yet 32bit
         IMesh* CMeshManipulator::createMeshWith2TCoords(IMesh* mesh) const
         {
             if (!mesh)
@@ -1171,12 +1137,11 @@ namespace kong
             {
                 const IMeshBuffer* const original = mesh->GetMeshBuffer(b);
                 const u32 idxCnt = original->GetIndexCount();
-                const u16* idx = original->GetIndices();
 
                 SMeshBufferLightMap* buffer = new SMeshBufferLightMap();
                 buffer->material_ = original->GetMaterial();
                 buffer->vertices_.Reallocate(idxCnt);
-                buffer->indices_.Reallocate(idxCnt);
+                buffer->ReallocateIndices(idxCnt);
 
                 core::Map<video::S3DVertex2TCoords, int> vertMap;
                 int vertLocation;
@@ -1187,6 +1152,7 @@ namespace kong
                 video::S3DVertex2TCoords vNew;
                 for (u32 i = 0; i<idxCnt; ++i)
                 {
+                    const u32 index = original->GetIndex(i);
                     switch (vType)
                     {
                     case video::EVT_STANDARD:
@@ -1194,14 +1160,14 @@ namespace kong
                         const video::S3DVertex* v =
                             (const video::S3DVertex*)original->GetVertices();
                         vNew = video::S3DVertex2TCoords(
-                            v[idx[i]].pos_, v[idx[i]].normal_, v[idx[i]].color_, v[idx[i]].texcoord_, v[idx[i]].texcoord_);
+                            v[index].pos_, v[index].normal_, v[index].color_, v[index].texcoord_, v[index].texcoord_);
                     }
                     break;
                     case video::EVT_2TCOORDS:
                     {
                         const video::S3DVertex2TCoords* v =
                             (const video::S3DVertex2TCoords*)original->GetVertices();
-                        vNew = v[idx[i]];
+                        vNew = v[index];
                     }
                     break;
                     case video::EVT_TANGENTS:
@@ -1209,7 +1175,7 @@ namespace kong
                         const video::S3DVertexTangents* v =
                             (const video::S3DVertexTangents*)original->GetVertices();
                         vNew = video::S3DVertex2TCoords(
-                            v[idx[i]].pos_, v[idx[i]].normal_, v[idx[i]].color_, v[idx[i]].texcoord_, v[idx[i]].texcoord_);
+                            v[index].pos_, v[index].normal_, v[index].color_, v[index].texcoord_, v[index].texcoord_);
                     }
                     break;
                     }
@@ -1226,7 +1192,7 @@ namespace kong
                     }
 
                     // create new indices
-                    buffer->indices_.PushBack(vertLocation);
+                    buffer->PushBackIndex(vertLocation);
                 }
                 buffer->RecalculateBoundingBox();
 
@@ -1241,7 +1207,6 @@ namespace kong
 
 
         //! Creates a copy of the mesh, which will only consist of S3DVertex vertices.
-        // not yet 32bit
         IMesh* CMeshManipulator::createMeshWith1TCoords(IMesh* mesh) const
         {
             if (!mesh)
@@ -1255,12 +1220,11 @@ namespace kong
             {
                 IMeshBuffer* original = mesh->GetMeshBuffer(b);
                 const u32 idxCnt = original->GetIndexCount();
-                const u16* idx = original->GetIndices();
 
                 SMeshBuffer* buffer = new SMeshBuffer();
                 buffer->material_ = original->GetMaterial();
                 buffer->vertices_.Reallocate(idxCnt);
-                buffer->indices_.Reallocate(idxCnt);
+                buffer->ReallocateIndices(idxCnt);
 
                 core::Map<video::S3DVertex, int> vertMap;
                 int vertLocation;
@@ -1270,13 +1234,14 @@ namespace kong
                 video::S3DVertex vNew;
                 for (u32 i = 0; i<idxCnt; ++i)
                 {
+                    const u32 index = original->GetIndex(i);
                     switch (vType)
                     {
                     case video::EVT_STANDARD:
                     {
                         video::S3DVertex* v =
                             (video::S3DVertex*)original->GetVertices();
-                        vNew = v[idx[i]];
+                        vNew = v[index];
                     }
                     break;
                     case video::EVT_2TCOORDS:
@@ -1284,7 +1249,7 @@ namespace kong
                         video::S3DVertex2TCoords* v =
                             (video::S3DVertex2TCoords*)original->GetVertices();
                         vNew = video::S3DVertex(
-                            v[idx[i]].pos_, v[idx[i]].normal_, v[idx[i]].color_, v[idx[i]].texcoord_);
+                            v[index].pos_, v[index].normal_, v[index].color_, v[index].texcoord_);
                     }
                     break;
                     case video::EVT_TANGENTS:
@@ -1292,7 +1257,7 @@ namespace kong
                         video::S3DVertexTangents* v =
                             (video::S3DVertexTangents*)original->GetVertices();
                         vNew = video::S3DVertex(
-                            v[idx[i]].pos_, v[idx[i]].normal_, v[idx[i]].color_, v[idx[i]].texcoord_);
+                            v[index].pos_, v[index].normal_, v[index].color_, v[index].texcoord_);
                     }
                     break;
                     }
@@ -1309,7 +1274,7 @@ namespace kong
                     }
 
                     // create new indices
-                    buffer->indices_.PushBack(vertLocation);
+                    buffer->PushBackIndex(vertLocation);
                 }
                 buffer->RecalculateBoundingBox();
                 // add new buffer
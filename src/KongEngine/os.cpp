@@ -139,7 +139,7 @@ namespace kong
 #include <time.h>
 #include <sys/time.h>
 
-namespace irr
+namespace kong
 {
     namespace os
     {
@@ -10,7 +10,7 @@ in vec4 world_normal;
 in vec4 world_tangent;
 in vec4 world_bitangent;
 
-in vec4 light_position;
+in float view_depth;
 
 struct Light
 {
@@ -53,7 +53,11 @@ uniform bool normal_mapping_on;
 
 // lights control flags
 uniform bool light_on;
-uniform Light light0;
+const int NR_LIGHTS = 4;
+layout (std140) uniform LightBlock
+{
+    Light lights[NR_LIGHTS];
+};
 uniform bool light0_on;
 
 // wireframe control flags
@@ -61,12 +65,21 @@ uniform int wireframe_on;
 
 uniform vec4 cam_position;
 
-uniform Material material;
+layout (std140) uniform MaterialBlock
+{
+    Material material;
+};
 
-// shadow mapping
-uniform sampler2D texture4;
+// shadow mapping, one layer per cascade
+uniform sampler2DArray texture4;
 uniform bool shadow_on;
 
+// light transforms and view space depths at which the cascades end
+const int MAX_SHADOW_CASCADES = 4;
+uniform mat4 shadow_transforms[MAX_SHADOW_CASCADES];
+uniform float shadow_splits[MAX_SHADOW_CASCADES];
+uniform int shadow_cascades_num;
+
 // shadow PCF
 vec2 poisson_dick[4] = vec2[](
   vec2( -0.94201624, -0.39906216 ),
@@ -77,9 +90,21 @@ vec2 poisson_dick[4] = vec2[](
 
 float CaluateShadowFactor()
 {
+    // the nearest cascade which reaches behind the pixel
+    int cascade = 0;
+    while (cascade < shadow_cascades_num && view_depth > shadow_splits[cascade])
+    {
+        cascade++;
+    }
+    if (cascade >= shadow_cascades_num)
+    {
+        return 1.f;
+    }
+
+    vec4 light_position = shadow_transforms[cascade] * world_position;
     vec2 shadow_uv = light_position.xy / light_position.w * 0.5 + 0.5;
 //    shadow_uv.y = 1.0 - shadow_uv.y;
-    float closest_depth = texture(texture4, shadow_uv).x;
+    float closest_depth = texture(texture4, vec3(shadow_uv, cascade)).x;
 
     float bias = 0.0005f;
     float shadow = 0.2f;
@@ -92,7 +117,7 @@ float CaluateShadowFactor()
     {
         for (int i=0;i<4;i++)
         {
-            if ( texture(texture4, shadow_uv + poisson_dick[i] / 700.0f ).x  >= light_depth - bias )
+            if ( texture(texture4, vec3(shadow_uv + poisson_dick[i] / 700.0f, cascade) ).x  >= light_depth - bias )
             {
                 shadow += 0.2f;
             }
@@ -162,7 +187,9 @@ vec4 CalculateLight(Light light, bool light_n_on)
 //            mat3 TBN = transpose(mat3(world_tangent.xyz, world_bitangent.xyz, normal_direction));
             view_direction = TBN * view_direction;
             light_direction = TBN * light_direction;
-            normal_direction = normalize(texture(texture1, outTexcoord).rgb * 2.0 - 1.0);
+            // blue is rebuilt from red and green, BC5 normal maps only store these two
+            vec2 normal_xy = texture(texture1, outTexcoord).rg * 2.0 - 1.0;
+            normal_direction = vec3(normal_xy, sqrt(max(1.0 - dot(normal_xy, normal_xy), 0.0)));
         }
 
         // diffuse factor
@@ -232,7 +259,7 @@ void main()
 
         if (light_on)
         {
-            vec3 light_color = CalculateLight(light0, light0_on).xyz;
+            vec3 light_color = CalculateLight(lights[0], light0_on).xyz;
             //light_color += CalculateLight(light1, light1_on);
             //light_color += CalculateLight(light2, light2_on);
             //light_color += CalculateLight(light3, light3_on);
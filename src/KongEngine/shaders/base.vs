@@ -4,9 +4,6 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec4 aClr;
 layout (location = 3) in vec2 aTexcoord;
 
-//switch between wireframe and meshframe
-layout (location = 4) in vec3 aBC;
-
 //tangent used for normal mapping
 layout (location = 5) in vec3 aTangent;
 layout (location = 6) in vec3 aBitangent;
@@ -15,6 +12,18 @@ uniform mat4 world_transform;
 uniform mat4 view_transform;
 uniform mat4 project_transform;
 
+// per instance world transform, replaces world_transform for instanced draws
+layout (location = 7) in mat4 aInstanceTransform;
+uniform bool instancing_on;
+
+// restores positions which were uploaded as 16 bit fractions of the bounding box
+uniform vec4 position_scale;
+uniform vec4 position_offset;
+
+// wireframe draws are not indexed, every three vertices are a triangle
+const int ERM_WIREFRAME = 0x00000001;
+uniform int wireframe_on;
+
 out vec4 outClr;
 out vec2 outTexcoord;
 out vec3 outBC;
@@ -24,36 +33,30 @@ out vec4 world_normal;
 out vec4 world_tangent;
 out vec4 world_bitangent;
 
-out vec4 light_position;
+// view space depth, selects the shadow cascade
+out float view_depth;
 
 // normal mapping flag
 uniform bool normal_mapping_on;
 
-// shadow mapping flag
-uniform bool shadow_on;
-
-// light transform
-uniform mat4 light_view_transform;
-uniform mat4 light_projection_transform;
-
 void main()
 {
-	gl_Position = project_transform * view_transform * world_transform * vec4(aPos.x, aPos.y, aPos.z, 1.0);
+	mat4 world = instancing_on ? aInstanceTransform : world_transform;
+	vec3 pos = aPos * position_scale.xyz + position_offset.xyz;
+
+	gl_Position = project_transform * view_transform * world * vec4(pos, 1.0);
 	outClr = vec4(aClr.z, aClr.y, aClr.x, aClr.w) / 255.f;
 	outTexcoord = aTexcoord;
-	outBC = aBC;
+	int corner = gl_VertexID % 3;
+	outBC = wireframe_on == ERM_WIREFRAME ? vec3(corner == 0, corner == 1, corner == 2) : vec3(0.0);
 
-	world_position = world_transform * vec4(aPos.x, aPos.y, aPos.z, 1.0);
+	world_position = world * vec4(pos, 1.0);
+	view_depth = (view_transform * world_position).z;
 	
-	world_normal = world_transform * vec4(aNormal.xyz, 0.0);
+	world_normal = world * vec4(aNormal.xyz, 0.0);
 	if (normal_mapping_on)
 	{
-		world_tangent = world_transform * vec4(aTangent, 0.0);
-		world_bitangent = world_transform * vec4(aBitangent, 0.0);
-	}
-
-	if (shadow_on)
-	{
-		light_position = light_projection_transform * light_view_transform * world_position;
+		world_tangent = world * vec4(aTangent, 0.0);
+		world_bitangent = world * vec4(aBitangent, 0.0);
 	}
 }
\ No newline at end of file
@@ -40,7 +40,10 @@ uniform bool normal_mapping_on;
 // wireframe control flags
 uniform int wireframe_on;
 
-uniform Material material;
+layout (std140) uniform MaterialBlock
+{
+    Material material;
+};
 
 vec3 CalculateNormal()
 {
@@ -53,7 +56,9 @@ vec3 CalculateNormal()
         mat3 TBN = mat3(T, B, N);
 
 //        mat3 TBN = transpose(mat3(world_tangent.xyz, world_bitangent.xyz, normal_direction));
-        normal_direction = TBN * normalize(texture(texture1, outTexcoord).rgb * 2.0 - 1.0);
+        // blue is rebuilt from red and green, BC5 normal maps only store these two
+        vec2 normal_xy = texture(texture1, outTexcoord).rg * 2.0 - 1.0;
+        normal_direction = TBN * vec3(normal_xy, sqrt(max(1.0 - dot(normal_xy, normal_xy), 0.0)));
     }
 
     return normal_direction;
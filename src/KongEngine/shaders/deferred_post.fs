@@ -13,20 +13,6 @@ uniform bool test_on;
 
 uniform vec2 window_size;
 
-struct Light
-{
-    vec4 position;
-    vec4 direction;
-    vec4 ambient;
-    vec4 diffuse;
-    vec4 specular;
-    vec4 attenuation;
-    float exponent;
-    float cutoff;
-    float padding1;
-    float padding2;
-};
-
 struct Material
 {
     vec4 ambient;
@@ -36,20 +22,34 @@ struct Material
     float shininess;
 };
 
-uniform Material material;
+layout (std140) uniform MaterialBlock
+{
+    Material material;
+};
 
-const int NR_LIGHTS = 32;
-uniform Light lights[NR_LIGHTS];
-uniform int lights_num;
+// light clusters, see CLightClusterGrid
+uniform usamplerBuffer cluster_tex;
+uniform usamplerBuffer light_index_tex;
+uniform samplerBuffer light_data_tex;
+uniform ivec2 cluster_tiles;
+uniform int cluster_slices;
+uniform vec2 cluster_slice_transform;
+
+// directional lights at the start of the light index list
+uniform int global_lights_num;
+
+// average ambient color of all lights
+uniform vec4 ambient_light;
+
+uniform mat4 view_transform;
 
 uniform vec4 cam_position;
 
 // shadow control flag
 uniform bool shadow_on;
 
-// light camera transform
-uniform mat4 light_view_transform;
-uniform mat4 light_projection_transform;
+// shadow views of the lights in the shadow atlas
+uniform samplerBuffer shadow_view_tex;
 
 // shadow PCF
 vec2 poisson_dick[4] = vec2[](
@@ -59,32 +59,64 @@ vec2 poisson_dick[4] = vec2[](
   vec2( 0.34495938, 0.29387760 )
 );
 
-float CalculateShadowFactor()
+// transform into the atlas, tile bounds, split depth and bias
+const int SHADOW_VIEW_SIZE = 6;
+
+float CalculateShadowFactor(int first_view, int view_count, vec4 light_position, vec3 world_position, float view_depth)
 {
-    if (!shadow_on)
+    if (!shadow_on || view_count == 0)
         return 1.f;
 
-    vec2 texture_uv =  tex_uv;
-    vec4 world_position = texture(position_tex, texture_uv);
-    vec4 lightspace_position = light_projection_transform * light_view_transform * world_position;
+    int view = 0;
+    if (light_position.w == 0.0)
+    {
+        // the cascades of a directional light, the nearest one which reaches behind the pixel
+        while (view < view_count && view_depth > texelFetch(shadow_view_tex, (first_view + view) * SHADOW_VIEW_SIZE + 5).x)
+        {
+            view++;
+        }
+        if (view >= view_count)
+            return 1.f;
+    }
+    else if (view_count == 6)
+    {
+        // the cube face of a point light
+        vec3 to_pixel = world_position - light_position.xyz;
+        vec3 axis_distance = abs(to_pixel);
+        if (axis_distance.x >= axis_distance.y && axis_distance.x >= axis_distance.z)
+            view = to_pixel.x >= 0.0 ? 0 : 1;
+        else if (axis_distance.y >= axis_distance.z)
+            view = to_pixel.y >= 0.0 ? 2 : 3;
+        else
+            view = to_pixel.z >= 0.0 ? 4 : 5;
+    }
 
-    vec2 shadow_uv = lightspace_position.xy / lightspace_position.w * 0.5 + 0.5;
+    int base = (first_view + view) * SHADOW_VIEW_SIZE;
+    mat4 shadow_transform = mat4(texelFetch(shadow_view_tex, base), texelFetch(shadow_view_tex, base + 1),
+        texelFetch(shadow_view_tex, base + 2), texelFetch(shadow_view_tex, base + 3));
+    vec4 tile = texelFetch(shadow_view_tex, base + 4);
+    float bias = texelFetch(shadow_view_tex, base + 5).y;
+
+    vec4 lightspace_position = shadow_transform * vec4(world_position, 1.0);
+    vec2 shadow_uv = lightspace_position.xy / lightspace_position.w;
+    float light_depth = lightspace_position.z / lightspace_position.w;
+    if (light_depth > 1.0)
+        return 1.f;
 
-//    shadow_uv.y = 1.0 - shadow_uv.y;
-    float closest_depth = texture(shadow_tex, shadow_uv).x;
+    float closest_depth = texture(shadow_tex, clamp(shadow_uv, tile.xy, tile.zw)).x;
 
-    float bias = 0.0005f;
     float shadow = 0.2f;
-    float light_depth = lightspace_position.z / lightspace_position.w;
-    if (lightspace_position.z / lightspace_position.w - bias <= closest_depth)
+    if (light_depth - bias <= closest_depth)
     {
         shadow = 1.0f;
     }
     else
     {
+        // the taps are about one and a half texels wide
+        vec2 texel = 1.5 / vec2(textureSize(shadow_tex, 0));
         for (int i=0;i<4;i++)
         {
-            if ( texture(shadow_tex, shadow_uv + poisson_dick[i] / 700.0f ).x  >= light_depth - bias )
+            if ( texture(shadow_tex, clamp(shadow_uv + poisson_dick[i] * texel, tile.xy, tile.zw)).x  >= light_depth - bias )
             {
                 shadow += 0.2f;
             }
@@ -94,79 +126,97 @@ float CalculateShadowFactor()
     return shadow;
 }
 
-vec4 CalculateLight()
-{
-    int max_lights = min(NR_LIGHTS, lights_num);
-    vec2 texture_uv = tex_uv;
-    vec4 res_light = vec4(0, 0, 0, 0);
-
-    vec4 world_position = texture(position_tex, texture_uv);
-    vec4 world_normal = texture(normal_tex, texture_uv);
-    vec4 diffuse_color = texture(diffuse_tex, texture_uv);
-
-    float shadow_factor = CalculateShadowFactor();
+// position and range, direction and exponent, diffuse, specular, attenuation and cutoff, shadow views
+const int LIGHT_DATA_SIZE = 6;
 
-    for (int i = 0; i < max_lights; i++)
+vec4 CalculateLight(int light_index, vec3 world_position, vec3 world_normal, vec3 view_direction, float view_depth)
+{
+    int base = light_index * LIGHT_DATA_SIZE;
+    vec4 position = texelFetch(light_data_tex, base);
+    vec4 direction = texelFetch(light_data_tex, base + 1);
+    vec4 attenuation = texelFetch(light_data_tex, base + 4);
+
+    float light_attenuation;
+    vec3 light_direction;
+    if (position.w == 0.0)
+    {
+        // it is a directional light, the position is the negated direction
+        light_direction = position.xyz;
+        light_attenuation = 1.f;
+    }
+    else
     {
-        vec4 res_ambient = vec4(0.f, 0.f, 0.f, 1.f);
-        vec4 res_diffuse = vec4(0.f, 0.f, 0.f, 1.f);
-        vec4 res_specular = vec4(0.f, 0.f, 0.f, 1.f);
-        float light_attenuation;
-        vec3 light_direction;
-        if(lights[i].position.w == 0.0) 
+        // NOT a directional light, position.w is its range
+        light_direction = position.xyz - world_position;
+        float dist = length(light_direction);
+        if (dist > position.w)
         {
-            // it is a directional lights[i].
-            // get the direction by converting to vec3 (ignore W) and negate it
-            light_direction = lights[i].position.xyz;
-            light_attenuation = 1.f;
+            return vec4(0.f);
         }
-        else 
-        {
-            // NOT a directional lights[i]
-            light_direction = lights[i].position.xyz - world_position.xyz;
-            float dist = length(light_direction);
-            light_attenuation = 1.f / (lights[i].attenuation.x + lights[i].attenuation.y * dist + lights[i].attenuation.z * dist * dist);
+        light_attenuation = 1.f / (attenuation.x + attenuation.y * dist + attenuation.z * dist * dist);
 
-            // cone restriction
-            if (lights[i].exponent > 0.000001f)
+        // cone restriction
+        if (direction.w > 0.000001f)
+        {
+            float spot_attenuation = dot(normalize(-light_direction), normalize(direction.xyz));
+            float light_direction_angle = degrees(acos(spot_attenuation));
+            if (light_direction_angle > attenuation.w)
             {
-                float spot_attenuation = dot(normalize(-light_direction), normalize(lights[i].direction.xyz));
-                float light_direction_angle = degrees(acos(spot_attenuation));
-                if (light_direction_angle > lights[i].cutoff)
-                {
-                    light_attenuation = 0.f;
-                    //light_attenuation *= pow(spot_attenuation, lights[i].exponent);
-                }
-                else
-                {
-                    light_attenuation *= pow(spot_attenuation, lights[i].exponent);
-                    //light_attenuation = 0.f;
-                }
+                return vec4(0.f);
             }
+            light_attenuation *= pow(spot_attenuation, direction.w);
         }
-        // ambient color
-        res_ambient = lights[i].ambient * material.ambient;
-        
-        light_direction = normalize(light_direction);
-        vec3 view_direction = normalize(cam_position.xyz - world_position.xyz);
-        vec3 normal_direction = world_normal.xyz;
-
-        // diffuse factor
-        float diffuse_factor = dot(light_direction, normal_direction);
-
-        // ignore back face
-        if (diffuse_factor > 0.f)
-        {
-//            vec3 view_direction = normalize(cam_position.xyz - world_position.xyz);
-            vec3 reflect_direction = reflect(-light_direction, normal_direction);
-            float specular_factor = pow(max(dot(view_direction, reflect_direction), 0.f), material.shininess);
+    }
 
-            res_diffuse = diffuse_factor * (lights[i].diffuse * material.diffuse);
-            res_specular = specular_factor * (lights[i].specular * material.specular);
-        }
+    light_direction = normalize(light_direction);
+
+    // diffuse factor, ignore back face
+    float diffuse_factor = dot(light_direction, world_normal);
+    if (diffuse_factor <= 0.f)
+    {
+        return vec4(0.f);
+    }
 
+    vec3 reflect_direction = reflect(-light_direction, world_normal);
+    float specular_factor = pow(max(dot(view_direction, reflect_direction), 0.f), material.shininess);
+
+    vec4 res_diffuse = diffuse_factor * (texelFetch(light_data_tex, base + 2) * material.diffuse);
+    vec4 res_specular = specular_factor * (texelFetch(light_data_tex, base + 3) * material.specular);
+
+    vec4 shadow_views = texelFetch(light_data_tex, base + 5);
+    float shadow_factor = CalculateShadowFactor(int(shadow_views.x), int(shadow_views.y), position, world_position, view_depth);
+    return shadow_factor * light_attenuation * (res_diffuse + res_specular);
+}
 
-        res_light += res_ambient / max_lights + shadow_factor * light_attenuation * (res_diffuse + res_specular);
+vec4 CalculateLights()
+{
+    vec2 texture_uv = tex_uv;
+
+    vec4 world_position = texture(position_tex, texture_uv);
+    vec3 world_normal = texture(normal_tex, texture_uv).xyz;
+    vec4 diffuse_color = texture(diffuse_tex, texture_uv);
+    vec3 view_direction = normalize(cam_position.xyz - world_position.xyz);
+
+    // the cascades and the cluster of the pixel depend on its view space depth
+    float depth = max((view_transform * vec4(world_position.xyz, 1.0)).z, 1e-6);
+
+    vec4 res_light = ambient_light * material.ambient;
+
+    for (int i = 0; i < global_lights_num; i++)
+    {
+        int light_index = int(texelFetch(light_index_tex, i).x);
+        res_light += CalculateLight(light_index, world_position.xyz, world_normal, view_direction, depth);
+    }
+
+    // the cluster of the pixel, the slices are exponential in view space depth
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / window_size * vec2(cluster_tiles)), ivec2(0), cluster_tiles - 1);
+    int slice = clamp(int(floor(log(depth) * cluster_slice_transform.x + cluster_slice_transform.y)), 0, cluster_slices - 1);
+    uvec2 cluster = texelFetch(cluster_tex, (slice * cluster_tiles.y + tile.y) * cluster_tiles.x + tile.x).xy;
+
+    for (uint i = 0u; i < cluster.y; i++)
+    {
+        int light_index = int(texelFetch(light_index_tex, int(cluster.x + i)).x);
+        res_light += CalculateLight(light_index, world_position.xyz, world_normal, view_direction, depth);
     }
 
     res_light *= diffuse_color;
@@ -174,14 +224,13 @@ vec4 CalculateLight()
     return res_light;
 }
 
-
 void main()
 {
 //    FragColor.r = 0.5;
 //    FragColor = vec4(light_position.z, 0.0, 0.0, 1.0);
 //    FragColor = vec4(vec3(0.5), 1.0);
     
-    FragColor = CalculateLight();
+    FragColor = CalculateLights();
 //    FragColor = vec4(0.5, 0.0, 0.0, 1.0);
 
 //    if (test_on)
@@ -3,6 +3,14 @@ layout (location = 0) in vec3 aPos;
 
 uniform mat4 world_transform;
 
+// per instance world transform, replaces world_transform for instanced draws
+layout (location = 7) in mat4 aInstanceTransform;
+uniform bool instancing_on;
+
+// restores positions which were uploaded as 16 bit fractions of the bounding box
+uniform vec4 position_scale;
+uniform vec4 position_offset;
+
 uniform mat4 light_projection_transform;
 uniform mat4 light_view_transform;
 
@@ -10,6 +18,9 @@ out vec4 light_position;
 
 void main()
 {
-	gl_Position = light_projection_transform * light_view_transform * world_transform * vec4(aPos.x, aPos.y, aPos.z, 1.0);
+	mat4 world = instancing_on ? aInstanceTransform : world_transform;
+	vec3 pos = aPos * position_scale.xyz + position_offset.xyz;
+
+	gl_Position = light_projection_transform * light_view_transform * world * vec4(pos, 1.0);
 	light_position = gl_Position;
 }
\ No newline at end of file